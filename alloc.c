@@ -29,7 +29,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 #include "ndtypes.h"
+#include "arena.h"
+#include "overflow.h"
+#include "sync.h"
 
 
 #if defined(_MSC_VER)
@@ -40,9 +44,133 @@
 /* Custom allocation and free functions */
 void *(* ndt_mallocfunc)(size_t size) = malloc;
 void *(* ndt_reallocfunc)(void *ptr, size_t size) = realloc;
-void (* ndt_free)(void *ptr) = free;
+void (* ndt_freefunc)(void *ptr) = free;
 
 
+/*****************************************************************************/
+/*                            Allocation regions                             */
+/*****************************************************************************/
+
+/* Every block is preceded by its size, blocks are REGION_ALIGN aligned. */
+#define REGION_ALIGN 16
+#define REGION_CHUNK 4096
+#define REGION_ROUND(n) (((n) + (REGION_ALIGN-1)) & ~(size_t)(REGION_ALIGN-1))
+#define CHUNK_HEADER REGION_ROUND(sizeof(region_chunk_t))
+
+struct region_chunk {
+    region_chunk_t *next;
+    size_t size;    /* usable bytes after the header */
+    size_t used;
+};
+
+/* The region that is active on this thread. */
+static NDT_THREAD_LOCAL region_t *region_current = NULL;
+
+void
+region_begin(region_t *r)
+{
+    r->chunks = NULL;
+    r->prev = region_current;
+    region_current = r;
+}
+
+void
+region_end(region_t *r)
+{
+    region_current = r->prev;
+}
+
+void
+region_free(region_t *r)
+{
+    region_chunk_t *c, *next;
+
+    for (c = r->chunks; c != NULL; c = next) {
+        next = c->next;
+        ndt_freefunc(c);
+    }
+    r->chunks = NULL;
+}
+
+static int
+region_contains(const region_t *r, const void *ptr)
+{
+    const region_chunk_t *c;
+    uintptr_t p = (uintptr_t)ptr;
+    uintptr_t start;
+
+    for (c = r->chunks; c != NULL; c = c->next) {
+        start = (uintptr_t)c + CHUNK_HEADER;
+        if (p >= start && p < start + c->size) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static void *
+region_alloc(region_t *r, size_t size)
+{
+    region_chunk_t *c = r->chunks;
+    size_t need, n;
+    char *p;
+
+    if (size > SIZE_MAX / 2 - CHUNK_HEADER - REGION_CHUNK) {
+        return NULL;
+    }
+    need = REGION_ALIGN + REGION_ROUND(size);
+
+    if (c == NULL || c->size - c->used < need) {
+        n = c == NULL || c->size > SIZE_MAX / 4 ? REGION_CHUNK : 2 * c->size;
+        if (n < need) {
+            n = need;
+        }
+        c = ndt_mallocfunc(CHUNK_HEADER + n);
+        if (c == NULL) {
+            return NULL;
+        }
+        c->next = r->chunks;
+        c->size = n;
+        c->used = 0;
+        r->chunks = c;
+    }
+
+    p = (char *)c + CHUNK_HEADER + c->used;
+    c->used += need;
+    *(size_t *)p = size;
+
+    return p + REGION_ALIGN;
+}
+
+static void *
+region_realloc(region_t *r, void *ptr, size_t size)
+{
+    size_t old;
+    void *p;
+
+    if (ptr == NULL) {
+        return region_alloc(r, size);
+    }
+
+    old = *(size_t *)((char *)ptr - REGION_ALIGN);
+    if (size <= old) {
+        return ptr;
+    }
+
+    p = region_alloc(r, size);
+    if (p != NULL) {
+        memcpy(p, ptr, old);
+    }
+
+    return p;
+}
+
+
+/*****************************************************************************/
+/*                           Allocation functions                            */
+/*****************************************************************************/
+
 /* malloc with overflow checking */
 void *
 ndt_alloc(size_t nmemb, size_t size)
@@ -51,6 +179,10 @@ ndt_alloc(size_t nmemb, size_t size)
         return NULL;
     }
 
+    if (region_current != NULL) {
+        return region_alloc(region_current, nmemb * size);
+    }
+
     return ndt_mallocfunc(nmemb * size);
 }
 
@@ -62,5 +194,37 @@ ndt_realloc(void *ptr, size_t nmemb, size_t size)
         return NULL;
     }
 
+    /* Memory from outside of the region keeps its allocator. */
+    if (region_current != NULL &&
+        (ptr == NULL || region_contains(region_current, ptr))) {
+        return region_realloc(region_current, ptr, nmemb * size);
+    }
+
     return ndt_reallocfunc(ptr, nmemb * size);
 }
+
+void
+ndt_free(void *ptr)
+{
+    if (region_current != NULL && region_contains(region_current, ptr)) {
+        return;
+    }
+
+    ndt_freefunc(ptr);
+}
+
+
+/* Overflow checked size arithmetic */
+int
+mul_size(size_t *r, size_t a, size_t b)
+{
+    *r = a * b;
+    return a != 0 && b > SIZE_MAX / a ? -1 : 0;
+}
+
+int
+add_size(size_t *r, size_t a, size_t b)
+{
+    *r = a + b;
+    return b > SIZE_MAX - a ? -1 : 0;
+}
@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2016, Continuum Analytics, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * Redistributions of source code must retain the above copyright notice,
+ * 
+ * this list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "ndtypes.h"
+#include "arena.h"
+
+
+/*****************************************************************************/
+/*                        Arena allocated types                              */
+/*****************************************************************************/
+
+void *
+arena_alloc(arena_t *arena, size_t nmemb, size_t size, size_t align)
+{
+    char *p;
+
+    arena->used = ((arena->used + align - 1) / align) * align;
+    p = arena->ptr ? arena->ptr + arena->used : NULL;
+    arena->used += nmemb * size;
+
+    return p;
+}
+
+char *
+arena_strdup(arena_t *arena, const char *s)
+{
+    size_t len = strlen(s);
+    char *cp;
+
+    cp = arena_alloc(arena, 1, len+1, 1);
+    if (cp) {
+        memcpy(cp, s, len+1);
+    }
+
+    return cp;
+}
+
+static ndt_t *
+copy_datashape(arena_t *arena, const ndt_t *t)
+{
+    ndt_tuple_field_t *tfields;
+    ndt_record_field_t *rfields;
+    ndt_memory_t *types;
+    ndt_dim_t *dim;
+    ndt_t *u, *type;
+    char *name;
+    size_t i;
+
+    u = arena_alloc(arena, 1, sizeof *u, alignof(ndt_t));
+    if (u) {
+        *u = *t;
+        u->refcnt = 1;
+        u->interned = 0;
+        u->arena = 0;
+        u->arena_interior = 1;
+    }
+
+    switch (t->tag) {
+    case Array:
+        dim = arena_alloc(arena, t->Array.ndim, sizeof *dim, alignof(ndt_dim_t));
+        for (i = 0; i < t->Array.ndim; i++) {
+            name = NULL;
+            if (t->Array.dim[i].tag == SymbolicDim) {
+                name = arena_strdup(arena, t->Array.dim[i].SymbolicDim.name);
+            }
+            if (dim) {
+                dim[i] = t->Array.dim[i];
+                if (dim[i].tag == SymbolicDim) {
+                    dim[i].SymbolicDim.name = name;
+                }
+            }
+        }
+        type = copy_datashape(arena, t->Array.dtype);
+        if (u) {
+            u->Array.dim = dim;
+            u->Array.dtype = type;
+        }
+        break;
+    case Option:
+        type = copy_datashape(arena, t->Option.type);
+        if (u) u->Option.type = type;
+        break;
+    case Nominal:
+        name = arena_strdup(arena, t->Nominal.name);
+        if (u) u->Nominal.name = name;
+        break;
+    case Constr:
+        name = arena_strdup(arena, t->Constr.name);
+        type = copy_datashape(arena, t->Constr.type);
+        if (u) {
+            u->Constr.name = name;
+            u->Constr.type = type;
+        }
+        break;
+    case Tuple:
+        tfields = NULL;
+        if (t->Tuple.shape > 0) {
+            tfields = arena_alloc(arena, t->Tuple.shape, sizeof *tfields,
+                                  alignof(ndt_tuple_field_t));
+        }
+        for (i = 0; i < t->Tuple.shape; i++) {
+            type = copy_datashape(arena, t->Tuple.fields[i].type);
+            if (tfields) {
+                tfields[i] = t->Tuple.fields[i];
+                tfields[i].type = type;
+            }
+        }
+        if (u) u->Tuple.fields = tfields;
+        break;
+    case Record:
+        rfields = NULL;
+        if (t->Record.shape > 0) {
+            rfields = arena_alloc(arena, t->Record.shape, sizeof *rfields,
+                                  alignof(ndt_record_field_t));
+        }
+        for (i = 0; i < t->Record.shape; i++) {
+            name = arena_strdup(arena, t->Record.fields[i].name);
+            type = copy_datashape(arena, t->Record.fields[i].type);
+            if (rfields) {
+                rfields[i] = t->Record.fields[i];
+                rfields[i].name = name;
+                rfields[i].type = type;
+            }
+        }
+        if (u) u->Record.fields = rfields;
+        break;
+    case Function:
+        type = copy_datashape(arena, t->Function.ret);
+        if (u) u->Function.ret = type;
+        type = copy_datashape(arena, t->Function.pos);
+        if (u) u->Function.pos = type;
+        type = copy_datashape(arena, t->Function.kwds);
+        if (u) u->Function.kwds = type;
+        break;
+    case Typevar:
+        name = arena_strdup(arena, t->Typevar.name);
+        if (u) u->Typevar.name = name;
+        break;
+    case Categorical:
+        types = arena_alloc(arena, t->Categorical.ntypes, sizeof *types,
+                            alignof(ndt_memory_t));
+        for (i = 0; i < t->Categorical.ntypes; i++) {
+            const ndt_memory_t *mem = &t->Categorical.types[i];
+            name = NULL;
+            if (mem->t->tag == String) {
+                name = arena_strdup(arena, mem->v.String);
+            }
+            type = copy_datashape(arena, mem->t);
+            if (types) {
+                types[i] = *mem;
+                types[i].t = type;
+                if (mem->t->tag == String) {
+                    types[i].v.String = name;
+                }
+            }
+        }
+        if (u) u->Categorical.types = types;
+        break;
+    case Pointer:
+        type = copy_datashape(arena, t->Pointer.type);
+        if (u) u->Pointer.type = type;
+        break;
+    default:
+        break;
+    }
+
+    return u;
+}
+
+/* Return a copy of 't' that is allocated in a single arena block. */
+ndt_t *
+ndt_arena_copy(const ndt_t *t, ndt_context_t *ctx)
+{
+    arena_t arena = { NULL, 0 };
+    ndt_t *u;
+
+    /* count phase */
+    (void)copy_datashape(&arena, t);
+
+    arena.ptr = ndt_alloc(1, arena.used);
+    if (arena.ptr == NULL) {
+        ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+        return NULL;
+    }
+    arena.used = 0;
+
+    u = copy_datashape(&arena, t);
+    u->arena = 1;
+    u->arena_interior = 0;
+
+    return u;
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2016, Continuum Analytics, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * Redistributions of source code must retain the above copyright notice,
+ * 
+ * this list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef ARENA_H
+#define ARENA_H
+
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ndtypes.h"
+
+
+/*
+ * An arena type is a complete type tree (nodes, dimension and field arrays,
+ * names and categorical values) that lives in a single memory block.  The
+ * root is the start of the block and owns the arena: ndt_del() on the root
+ * releases the whole tree with one ndt_free().
+ *
+ * The inner nodes are flagged with 'arena_interior'.  ndt_incref() and
+ * ndt_del() ignore them, so they can be passed to functions that take and
+ * release references.  However, they do not keep the arena alive: to share
+ * a subtree beyond the lifetime of the arena, take a reference to the root.
+ *
+ * Arenas are filled in two passes: in the count phase 'ptr' is NULL and
+ * the allocators only compute the required size, in the copy phase they
+ * return memory from the block.
+ */
+
+typedef struct {
+    char *ptr;      /* NULL for the count phase */
+    size_t used;
+} arena_t;
+
+void *arena_alloc(arena_t *arena, size_t nmemb, size_t size, size_t align);
+char *arena_strdup(arena_t *arena, const char *s);
+
+
+/*
+ * An allocation region is a temporary bump allocator.  While a region is
+ * active on a thread, ndt_alloc() and ndt_realloc() on that thread take
+ * memory from the region and ndt_free() ignores pointers into it, so any
+ * code that uses the ndt allocation functions can build a tree in the region
+ * without a malloc() per node.  region_free() releases the region at once.
+ */
+
+typedef struct region_chunk region_chunk_t;
+
+typedef struct region {
+    region_chunk_t *chunks;     /* newest first */
+    struct region *prev;        /* region that was active before */
+} region_t;
+
+void region_begin(region_t *r);
+void region_end(region_t *r);
+void region_free(region_t *r);
+
+
+#endif /* ARENA_H */
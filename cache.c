@@ -0,0 +1,272 @@
+/*
+ * Copyright (c) 2016, Continuum Analytics, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * Redistributions of source code must retain the above copyright notice,
+ * 
+ * this list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "ndtypes.h"
+#include "hash.h"
+
+
+/*****************************************************************************/
+/*                        Bounded parse result cache                         */
+/*****************************************************************************/
+
+/*
+ * Maps input strings to parsed types.  Replacement uses the CLOCK algorithm:
+ * a hit sets the 'referenced' bit of an entry, the clock hand clears the bits
+ * of referenced entries and evicts the first entry that is not referenced.
+ *
+ * Lookups go through a chained hash index over the entry slots.
+ */
+
+#define NO_ENTRY SIZE_MAX
+
+typedef struct {
+    char *key;          /* owned copy of the input */
+    size_t len;
+    uint64_t hash;
+    ndt_t *type;        /* NULL: free slot */
+    bool referenced;
+    size_t next;        /* next entry in the same bucket */
+} cache_entry_t;
+
+struct ndt_parse_cache {
+    size_t capacity;
+    size_t used;
+    size_t hand;
+    size_t nbuckets;    /* power of two */
+    size_t *buckets;
+    cache_entry_t *entries;
+    ndt_cache_stats_t stats;
+};
+
+
+ndt_parse_cache_t *
+ndt_parse_cache_new(size_t capacity, ndt_context_t *ctx)
+{
+    ndt_parse_cache_t *cache;
+    size_t i;
+
+    if (capacity == 0 || capacity > SIZE_MAX / 4) {
+        ndt_err_format(ctx, NDT_ValueError, "invalid cache capacity: %zu", capacity);
+        return NULL;
+    }
+
+    cache = ndt_alloc(1, sizeof *cache);
+    if (cache == NULL) {
+        ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+        return NULL;
+    }
+
+    cache->nbuckets = 1;
+    while (cache->nbuckets < 2 * capacity) {
+        cache->nbuckets *= 2;
+    }
+
+    cache->buckets = ndt_alloc(cache->nbuckets, sizeof *cache->buckets);
+    if (cache->buckets == NULL) {
+        ndt_free(cache);
+        ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+        return NULL;
+    }
+
+    cache->entries = ndt_alloc(capacity, sizeof *cache->entries);
+    if (cache->entries == NULL) {
+        ndt_free(cache->buckets);
+        ndt_free(cache);
+        ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+        return NULL;
+    }
+
+    for (i = 0; i < cache->nbuckets; i++) {
+        cache->buckets[i] = NO_ENTRY;
+    }
+
+    for (i = 0; i < capacity; i++) {
+        cache->entries[i].key = NULL;
+        cache->entries[i].type = NULL;
+        cache->entries[i].referenced = 0;
+        cache->entries[i].next = NO_ENTRY;
+    }
+
+    cache->capacity = capacity;
+    cache->used = 0;
+    cache->hand = 0;
+    cache->stats.hits = 0;
+    cache->stats.misses = 0;
+    cache->stats.evictions = 0;
+
+    return cache;
+}
+
+static void
+cache_entry_clear(cache_entry_t *entry)
+{
+    ndt_free(entry->key);
+    ndt_del(entry->type);
+    entry->key = NULL;
+    entry->type = NULL;
+    entry->referenced = 0;
+    entry->next = NO_ENTRY;
+}
+
+void
+ndt_parse_cache_del(ndt_parse_cache_t *cache)
+{
+    size_t i;
+
+    if (cache == NULL) {
+        return;
+    }
+
+    for (i = 0; i < cache->capacity; i++) {
+        cache_entry_clear(&cache->entries[i]);
+    }
+
+    ndt_free(cache->entries);
+    ndt_free(cache->buckets);
+    ndt_free(cache);
+}
+
+void
+ndt_parse_cache_stats(const ndt_parse_cache_t *cache, ndt_cache_stats_t *stats)
+{
+    *stats = cache->stats;
+}
+
+static size_t
+cache_lookup(const ndt_parse_cache_t *cache, const char *key, size_t len,
+             uint64_t hash)
+{
+    size_t i;
+
+    for (i = cache->buckets[hash & (cache->nbuckets-1)]; i != NO_ENTRY;
+         i = cache->entries[i].next) {
+        const cache_entry_t *entry = &cache->entries[i];
+        if (entry->hash == hash && entry->len == len &&
+            memcmp(entry->key, key, len) == 0) {
+            return i;
+        }
+    }
+
+    return NO_ENTRY;
+}
+
+/* Remove an entry from its bucket chain and release its contents. */
+static void
+cache_evict(ndt_parse_cache_t *cache, size_t index)
+{
+    cache_entry_t *entry = &cache->entries[index];
+    size_t *link = &cache->buckets[entry->hash & (cache->nbuckets-1)];
+
+    while (*link != index) {
+        link = &cache->entries[*link].next;
+    }
+    *link = entry->next;
+
+    cache_entry_clear(entry);
+    cache->used--;
+    cache->stats.evictions++;
+}
+
+/* Return a free slot, evicting an entry if the cache is full.  Entries are
+   only removed by eviction, so the free slots of a cache that is not full
+   are always at the end. */
+static size_t
+cache_free_slot(ndt_parse_cache_t *cache)
+{
+    size_t i;
+
+    if (cache->used < cache->capacity) {
+        return cache->used;
+    }
+
+    for (;;) {
+        i = cache->hand;
+        cache->hand = (cache->hand + 1) % cache->capacity;
+
+        if (!cache->entries[i].referenced) {
+            cache_evict(cache, i);
+            return i;
+        }
+        cache->entries[i].referenced = 0;
+    }
+}
+
+/*
+ * Return a new reference to the parsed type for 'input'.  The type is shared
+ * with the cache and must not be modified.
+ */
+ndt_t *
+ndt_from_string_cached(ndt_parse_cache_t *cache, const char *input,
+                       ndt_context_t *ctx)
+{
+    cache_entry_t *entry;
+    size_t len = strlen(input);
+    uint64_t hash = hash_data(input, len);
+    ndt_t *t;
+    char *key;
+    size_t i;
+
+    i = cache_lookup(cache, input, len, hash);
+    if (i != NO_ENTRY) {
+        cache->entries[i].referenced = 1;
+        cache->stats.hits++;
+        return ndt_incref(cache->entries[i].type);
+    }
+
+    cache->stats.misses++;
+
+    t = ndt_from_string(input, ctx);
+    if (t == NULL) {
+        return NULL;
+    }
+
+    key = ndt_alloc(1, len+1);
+    if (key == NULL) {
+        ndt_del(t);
+        ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+        return NULL;
+    }
+    memcpy(key, input, len+1);
+
+    i = cache_free_slot(cache);
+    entry = &cache->entries[i];
+    entry->key = key;
+    entry->len = len;
+    entry->hash = hash;
+    entry->type = t;
+    entry->referenced = 0;
+    entry->next = cache->buckets[hash & (cache->nbuckets-1)];
+    cache->buckets[hash & (cache->nbuckets-1)] = i;
+    cache->used++;
+
+    return ndt_incref(t);
+}
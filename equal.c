@@ -146,6 +146,19 @@ categorical_equal(ndt_memory_t *p, size_t plen,
 int
 ndt_equal(const ndt_t *p, const ndt_t *c)
 {
+    if (p == c) {
+        return 1;
+    }
+
+    /* Interned types are unique: distinct objects are never equal. */
+    if (p->interned && c->interned) {
+        return 0;
+    }
+
+    if (p->hash != c->hash) {
+        return 0;
+    }
+
     switch (p->tag) {
     case AnyKind:
     case ScalarKind:
@@ -1,8 +1,9 @@
-/* A Bison parser, made by GNU Bison 3.0.2.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
 /* Bison implementation for Yacc-like parsers in C
 
-   Copyright (C) 1984, 1989-1990, 2000-2013 Free Software Foundation, Inc.
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
 
    This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
@@ -15,7 +16,7 @@
    GNU General Public License for more details.
 
    You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -33,6 +34,10 @@
 /* C LALR(1) parser skeleton written by Richard Stallman, by
    simplifying the original so-called "semantic" parser.  */
 
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
 /* All symbols defined below should begin with yy or YY, to avoid
    infringing on user name space.  This should be done even for local
    variables, as they might otherwise be expanded by user macros.
@@ -40,11 +45,11 @@
    define necessary library symbols; they are noted "INFRINGES ON
    USER NAME SPACE" below.  */
 
-/* Identify Bison output.  */
-#define YYBISON 1
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
 
-/* Bison version.  */
-#define YYBISON_VERSION "3.0.2"
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
 
 /* Skeleton name.  */
 #define YYSKELETON_NAME "yacc.c"
@@ -61,8 +66,8 @@
 
 
 
-/* Copy the first part of user declarations.  */
-#line 1 "grammar.y" /* yacc.c:339  */
+/* First part of user prologue.  */
+#line 1 "grammar.y"
 
 /*
  * Copyright (c) 2016, Continuum Analytics, Inc. All rights reserved.
@@ -92,6 +97,7 @@
  */
 
 
+#include <setjmp.h>
 #include "grammar.h"
 #include "lexer.h"
 
@@ -114,202 +120,227 @@ yylex(YYSTYPE *val, YYLTYPE *loc, yyscan_t scanner, ndt_context_t *ctx)
     return lexfunc(val, loc, scanner, ctx);
 }
 
-#line 118 "grammar.c" /* yacc.c:339  */
+#line 124 "grammar.c"
 
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
+#  else
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
 # ifndef YY_NULLPTR
-#  if defined __cplusplus && 201103L <= __cplusplus
-#   define YY_NULLPTR nullptr
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
 #  else
-#   define YY_NULLPTR 0
+#   define YY_NULLPTR ((void*)0)
 #  endif
 # endif
 
-/* Enabling verbose error messages.  */
-#ifdef YYERROR_VERBOSE
-# undef YYERROR_VERBOSE
-# define YYERROR_VERBOSE 1
-#else
-# define YYERROR_VERBOSE 1
-#endif
-
-/* In a future release of Bison, this section will be replaced
-   by #include "grammar.h".  */
-#ifndef YY_YY_GRAMMAR_H_INCLUDED
-# define YY_YY_GRAMMAR_H_INCLUDED
-/* Debug traces.  */
-#ifndef YYDEBUG
-# define YYDEBUG 0
-#endif
-#if YYDEBUG
-extern int yydebug;
-#endif
-/* "%code requires" blocks.  */
-#line 53 "grammar.y" /* yacc.c:355  */
-
-  #include "ndtypes.h"
-  #include "seq.h"
-  #include "parsefuncs.h"
-  #define YY_TYPEDEF_YY_SCANNER_T
-  typedef void * yyscan_t;
-
-#line 156 "grammar.c" /* yacc.c:355  */
-
-/* Token type.  */
-#ifndef YYTOKENTYPE
-# define YYTOKENTYPE
-  enum yytokentype
-  {
-    ENDMARKER = 0,
-    ANY_KIND = 258,
-    OPTION = 259,
-    SCALAR_KIND = 260,
-    VOID = 261,
-    BOOL = 262,
-    SIGNED_KIND = 263,
-    INT8 = 264,
-    INT16 = 265,
-    INT32 = 266,
-    INT64 = 267,
-    UNSIGNED_KIND = 268,
-    UINT8 = 269,
-    UINT16 = 270,
-    UINT32 = 271,
-    UINT64 = 272,
-    REAL_KIND = 273,
-    FLOAT16 = 274,
-    FLOAT32 = 275,
-    FLOAT64 = 276,
-    COMPLEX_KIND = 277,
-    COMPLEX64 = 278,
-    COMPLEX128 = 279,
-    CATEGORICAL = 280,
-    REAL = 281,
-    COMPLEX = 282,
-    INT = 283,
-    INTPTR = 284,
-    UINTPTR = 285,
-    SIZE = 286,
-    CHAR = 287,
-    STRING = 288,
-    FIXED_STRING_KIND = 289,
-    FIXED_STRING = 290,
-    BYTES = 291,
-    FIXED_BYTES_KIND = 292,
-    FIXED_BYTES = 293,
-    POINTER = 294,
-    FIXED_DIM_KIND = 295,
-    FIXED = 296,
-    VAR = 297,
-    COMMA = 298,
-    COLON = 299,
-    LPAREN = 300,
-    RPAREN = 301,
-    LBRACE = 302,
-    RBRACE = 303,
-    LBRACK = 304,
-    RBRACK = 305,
-    STAR = 306,
-    ELLIPSIS = 307,
-    RARROW = 308,
-    EQUAL = 309,
-    QUESTIONMARK = 310,
-    BAR = 311,
-    ERRTOKEN = 312,
-    INTEGER = 313,
-    FLOATNUMBER = 314,
-    STRINGLIT = 315,
-    NAME_LOWER = 316,
-    NAME_UPPER = 317,
-    NAME_OTHER = 318
-  };
-#endif
-
-/* Value type.  */
-#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
-typedef union YYSTYPE YYSTYPE;
-union YYSTYPE
-{
-#line 81 "grammar.y" /* yacc.c:355  */
-
-    ndt_t *ndt;
-    ndt_dim_t *dim;
-    ndt_dim_seq_t *dim_seq;
-    ndt_tuple_field_t *tuple_field;
-    ndt_tuple_field_seq_t *tuple_field_seq;
-    ndt_record_field_t *record_field;
-    ndt_record_field_seq_t *record_field_seq;
-    ndt_memory_t *typed_value;
-    ndt_memory_seq_t *typed_value_seq;
-    ndt_attr_t *attribute;
-    ndt_attr_seq_t *attribute_seq;
-    enum ndt_variadic_flag variadic_flag;
-    enum ndt_encoding encoding;
-    char *string;
-
-#line 250 "grammar.c" /* yacc.c:355  */
-};
-# define YYSTYPE_IS_TRIVIAL 1
-# define YYSTYPE_IS_DECLARED 1
-#endif
-
-/* Location type.  */
-#if ! defined YYLTYPE && ! defined YYLTYPE_IS_DECLARED
-typedef struct YYLTYPE YYLTYPE;
-struct YYLTYPE
+#include "grammar.h"
+/* Symbol kind.  */
+enum yysymbol_kind_t
 {
-  int first_line;
-  int first_column;
-  int last_line;
-  int last_column;
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_ANY_KIND = 3,                   /* ANY_KIND  */
+  YYSYMBOL_OPTION = 4,                     /* OPTION  */
+  YYSYMBOL_SCALAR_KIND = 5,                /* SCALAR_KIND  */
+  YYSYMBOL_VOID = 6,                       /* VOID  */
+  YYSYMBOL_BOOL = 7,                       /* BOOL  */
+  YYSYMBOL_SIGNED_KIND = 8,                /* SIGNED_KIND  */
+  YYSYMBOL_INT8 = 9,                       /* INT8  */
+  YYSYMBOL_INT16 = 10,                     /* INT16  */
+  YYSYMBOL_INT32 = 11,                     /* INT32  */
+  YYSYMBOL_INT64 = 12,                     /* INT64  */
+  YYSYMBOL_UNSIGNED_KIND = 13,             /* UNSIGNED_KIND  */
+  YYSYMBOL_UINT8 = 14,                     /* UINT8  */
+  YYSYMBOL_UINT16 = 15,                    /* UINT16  */
+  YYSYMBOL_UINT32 = 16,                    /* UINT32  */
+  YYSYMBOL_UINT64 = 17,                    /* UINT64  */
+  YYSYMBOL_REAL_KIND = 18,                 /* REAL_KIND  */
+  YYSYMBOL_FLOAT16 = 19,                   /* FLOAT16  */
+  YYSYMBOL_FLOAT32 = 20,                   /* FLOAT32  */
+  YYSYMBOL_FLOAT64 = 21,                   /* FLOAT64  */
+  YYSYMBOL_COMPLEX_KIND = 22,              /* COMPLEX_KIND  */
+  YYSYMBOL_COMPLEX64 = 23,                 /* COMPLEX64  */
+  YYSYMBOL_COMPLEX128 = 24,                /* COMPLEX128  */
+  YYSYMBOL_CATEGORICAL = 25,               /* CATEGORICAL  */
+  YYSYMBOL_REAL = 26,                      /* REAL  */
+  YYSYMBOL_COMPLEX = 27,                   /* COMPLEX  */
+  YYSYMBOL_INT = 28,                       /* INT  */
+  YYSYMBOL_INTPTR = 29,                    /* INTPTR  */
+  YYSYMBOL_UINTPTR = 30,                   /* UINTPTR  */
+  YYSYMBOL_SIZE = 31,                      /* SIZE  */
+  YYSYMBOL_CHAR = 32,                      /* CHAR  */
+  YYSYMBOL_STRING = 33,                    /* STRING  */
+  YYSYMBOL_FIXED_STRING_KIND = 34,         /* FIXED_STRING_KIND  */
+  YYSYMBOL_FIXED_STRING = 35,              /* FIXED_STRING  */
+  YYSYMBOL_BYTES = 36,                     /* BYTES  */
+  YYSYMBOL_FIXED_BYTES_KIND = 37,          /* FIXED_BYTES_KIND  */
+  YYSYMBOL_FIXED_BYTES = 38,               /* FIXED_BYTES  */
+  YYSYMBOL_POINTER = 39,                   /* POINTER  */
+  YYSYMBOL_FIXED_DIM_KIND = 40,            /* FIXED_DIM_KIND  */
+  YYSYMBOL_FIXED = 41,                     /* FIXED  */
+  YYSYMBOL_VAR = 42,                       /* VAR  */
+  YYSYMBOL_COMMA = 43,                     /* COMMA  */
+  YYSYMBOL_COLON = 44,                     /* COLON  */
+  YYSYMBOL_LPAREN = 45,                    /* LPAREN  */
+  YYSYMBOL_RPAREN = 46,                    /* RPAREN  */
+  YYSYMBOL_LBRACE = 47,                    /* LBRACE  */
+  YYSYMBOL_RBRACE = 48,                    /* RBRACE  */
+  YYSYMBOL_LBRACK = 49,                    /* LBRACK  */
+  YYSYMBOL_RBRACK = 50,                    /* RBRACK  */
+  YYSYMBOL_STAR = 51,                      /* STAR  */
+  YYSYMBOL_ELLIPSIS = 52,                  /* ELLIPSIS  */
+  YYSYMBOL_RARROW = 53,                    /* RARROW  */
+  YYSYMBOL_EQUAL = 54,                     /* EQUAL  */
+  YYSYMBOL_QUESTIONMARK = 55,              /* QUESTIONMARK  */
+  YYSYMBOL_BAR = 56,                       /* BAR  */
+  YYSYMBOL_ERRTOKEN = 57,                  /* ERRTOKEN  */
+  YYSYMBOL_INTEGER = 58,                   /* INTEGER  */
+  YYSYMBOL_FLOATNUMBER = 59,               /* FLOATNUMBER  */
+  YYSYMBOL_STRINGLIT = 60,                 /* STRINGLIT  */
+  YYSYMBOL_NAME_LOWER = 61,                /* NAME_LOWER  */
+  YYSYMBOL_NAME_UPPER = 62,                /* NAME_UPPER  */
+  YYSYMBOL_NAME_OTHER = 63,                /* NAME_OTHER  */
+  YYSYMBOL_YYACCEPT = 64,                  /* $accept  */
+  YYSYMBOL_input = 65,                     /* input  */
+  YYSYMBOL_datashape = 66,                 /* datashape  */
+  YYSYMBOL_array = 67,                     /* array  */
+  YYSYMBOL_array_nooption = 68,            /* array_nooption  */
+  YYSYMBOL_dimension_seq = 69,             /* dimension_seq  */
+  YYSYMBOL_dimension = 70,                 /* dimension  */
+  YYSYMBOL_dtype = 71,                     /* dtype  */
+  YYSYMBOL_dtype_nooption = 72,            /* dtype_nooption  */
+  YYSYMBOL_scalar = 73,                    /* scalar  */
+  YYSYMBOL_signed = 74,                    /* signed  */
+  YYSYMBOL_unsigned = 75,                  /* unsigned  */
+  YYSYMBOL_ieee_float = 76,                /* ieee_float  */
+  YYSYMBOL_ieee_complex = 77,              /* ieee_complex  */
+  YYSYMBOL_alias = 78,                     /* alias  */
+  YYSYMBOL_character = 79,                 /* character  */
+  YYSYMBOL_string = 80,                    /* string  */
+  YYSYMBOL_fixed_string = 81,              /* fixed_string  */
+  YYSYMBOL_encoding = 82,                  /* encoding  */
+  YYSYMBOL_bytes = 83,                     /* bytes  */
+  YYSYMBOL_fixed_bytes = 84,               /* fixed_bytes  */
+  YYSYMBOL_pointer = 85,                   /* pointer  */
+  YYSYMBOL_categorical = 86,               /* categorical  */
+  YYSYMBOL_typed_value_seq = 87,           /* typed_value_seq  */
+  YYSYMBOL_typed_value = 88,               /* typed_value  */
+  YYSYMBOL_variadic_flag = 89,             /* variadic_flag  */
+  YYSYMBOL_comma_variadic_flag = 90,       /* comma_variadic_flag  */
+  YYSYMBOL_tuple_type = 91,                /* tuple_type  */
+  YYSYMBOL_tuple_field_seq = 92,           /* tuple_field_seq  */
+  YYSYMBOL_tuple_field = 93,               /* tuple_field  */
+  YYSYMBOL_record_type = 94,               /* record_type  */
+  YYSYMBOL_record_field_seq = 95,          /* record_field_seq  */
+  YYSYMBOL_record_field = 96,              /* record_field  */
+  YYSYMBOL_record_field_name = 97,         /* record_field_name  */
+  YYSYMBOL_attribute_seq_opt = 98,         /* attribute_seq_opt  */
+  YYSYMBOL_attribute_seq = 99,             /* attribute_seq  */
+  YYSYMBOL_attribute = 100,                /* attribute  */
+  YYSYMBOL_function_type = 101             /* function_type  */
 };
-# define YYLTYPE_IS_DECLARED 1
-# define YYLTYPE_IS_TRIVIAL 1
-#endif
+typedef enum yysymbol_kind_t yysymbol_kind_t;
 
 
 
-int yyparse (yyscan_t scanner, ndt_t **ast, ndt_context_t *ctx);
-/* "%code provides" blocks.  */
-#line 61 "grammar.y" /* yacc.c:355  */
 
-  #define YY_DECL extern int lexfunc(YYSTYPE *yylval_param, YYLTYPE *yylloc_param, yyscan_t yyscanner, ndt_context_t *ctx)
-  extern int lexfunc(YYSTYPE *, YYLTYPE *, yyscan_t, ndt_context_t *);
-  void yyerror(YYLTYPE *loc, yyscan_t scanner, ndt_t **ast, ndt_context_t *ctx, const char *msg);
-
-#line 280 "grammar.c" /* yacc.c:355  */
+#ifdef short
+# undef short
+#endif
 
-#endif /* !YY_YY_GRAMMAR_H_INCLUDED  */
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
 
-/* Copy the second part of user declarations.  */
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
+#endif
 
-#line 286 "grammar.c" /* yacc.c:358  */
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
 
-#ifdef short
-# undef short
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
+#else
+typedef signed char yytype_int8;
 #endif
 
-#ifdef YYTYPE_UINT8
-typedef YYTYPE_UINT8 yytype_uint8;
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
 #else
-typedef unsigned char yytype_uint8;
+typedef short yytype_int16;
 #endif
 
-#ifdef YYTYPE_INT8
-typedef YYTYPE_INT8 yytype_int8;
-#else
-typedef signed char yytype_int8;
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
 #endif
 
-#ifdef YYTYPE_UINT16
-typedef YYTYPE_UINT16 yytype_uint16;
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
 #else
-typedef unsigned short int yytype_uint16;
+typedef short yytype_uint8;
 #endif
 
-#ifdef YYTYPE_INT16
-typedef YYTYPE_INT16 yytype_int16;
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
 #else
-typedef short int yytype_int16;
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
 #endif
 
 #ifndef YYSIZE_T
@@ -317,15 +348,28 @@ typedef short int yytype_int16;
 #  define YYSIZE_T __SIZE_TYPE__
 # elif defined size_t
 #  define YYSIZE_T size_t
-# elif ! defined YYSIZE_T
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
 #  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
 #  define YYSIZE_T size_t
 # else
-#  define YYSIZE_T unsigned int
+#  define YYSIZE_T unsigned
 # endif
 #endif
 
-#define YYSIZE_MAXIMUM ((YYSIZE_T) -1)
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_uint8 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
 
 #ifndef YY_
 # if defined YYENABLE_NLS && YYENABLE_NLS
@@ -339,47 +383,43 @@ typedef short int yytype_int16;
 # endif
 #endif
 
-#ifndef YY_ATTRIBUTE
-# if (defined __GNUC__                                               \
-      && (2 < __GNUC__ || (__GNUC__ == 2 && 96 <= __GNUC_MINOR__)))  \
-     || defined __SUNPRO_C && 0x5110 <= __SUNPRO_C
-#  define YY_ATTRIBUTE(Spec) __attribute__(Spec)
-# else
-#  define YY_ATTRIBUTE(Spec) /* empty */
-# endif
-#endif
 
 #ifndef YY_ATTRIBUTE_PURE
-# define YY_ATTRIBUTE_PURE   YY_ATTRIBUTE ((__pure__))
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
 #endif
 
 #ifndef YY_ATTRIBUTE_UNUSED
-# define YY_ATTRIBUTE_UNUSED YY_ATTRIBUTE ((__unused__))
-#endif
-
-#if !defined _Noreturn \
-     && (!defined __STDC_VERSION__ || __STDC_VERSION__ < 201112)
-# if defined _MSC_VER && 1200 <= _MSC_VER
-#  define _Noreturn __declspec (noreturn)
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
 # else
-#  define _Noreturn YY_ATTRIBUTE ((__noreturn__))
+#  define YY_ATTRIBUTE_UNUSED
 # endif
 #endif
 
 /* Suppress unused-variable warnings by "using" E.  */
 #if ! defined lint || defined __GNUC__
-# define YYUSE(E) ((void) (E))
+# define YY_USE(E) ((void) (E))
 #else
-# define YYUSE(E) /* empty */
+# define YY_USE(E) /* empty */
 #endif
 
-#if defined __GNUC__ && 407 <= __GNUC__ * 100 + __GNUC_MINOR__
 /* Suppress an incorrect diagnostic about yylval being uninitialized.  */
-# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN \
-    _Pragma ("GCC diagnostic push") \
-    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")\
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
     _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
-# define YY_IGNORE_MAYBE_UNINITIALIZED_END \
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
     _Pragma ("GCC diagnostic pop")
 #else
 # define YY_INITIAL_VALUE(Value) Value
@@ -392,8 +432,22 @@ typedef short int yytype_int16;
 # define YY_INITIAL_VALUE(Value) /* Nothing. */
 #endif
 
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
+
+
+#define YY_ASSERT(E) ((void) (0 && (E)))
 
-#if ! defined yyoverflow || YYERROR_VERBOSE
+#if 1
 
 /* The parser invokes alloca or malloc; define the necessary symbols.  */
 
@@ -458,8 +512,7 @@ void free (void *); /* INFRINGES ON USER NAME SPACE */
 #   endif
 #  endif
 # endif
-#endif /* ! defined yyoverflow || YYERROR_VERBOSE */
-
+#endif /* 1 */
 
 #if (! defined yyoverflow \
      && (! defined __cplusplus \
@@ -469,18 +522,19 @@ void free (void *); /* INFRINGES ON USER NAME SPACE */
 /* A type that is properly aligned for any stack member.  */
 union yyalloc
 {
-  yytype_int16 yyss_alloc;
+  yy_state_t yyss_alloc;
   YYSTYPE yyvs_alloc;
   YYLTYPE yyls_alloc;
 };
 
 /* The size of the maximum gap between one aligned stack and the next.  */
-# define YYSTACK_GAP_MAXIMUM (sizeof (union yyalloc) - 1)
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
 
 /* The size of an array large to enough to hold all stacks, each with
    N elements.  */
 # define YYSTACK_BYTES(N) \
-     ((N) * (sizeof (yytype_int16) + sizeof (YYSTYPE) + sizeof (YYLTYPE)) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE) \
+             + YYSIZEOF (YYLTYPE)) \
       + 2 * YYSTACK_GAP_MAXIMUM)
 
 # define YYCOPY_NEEDED 1
@@ -493,11 +547,11 @@ union yyalloc
 # define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
     do                                                                  \
       {                                                                 \
-        YYSIZE_T yynewbytes;                                            \
+        YYPTRDIFF_T yynewbytes;                                         \
         YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
         Stack = &yyptr->Stack_alloc;                                    \
-        yynewbytes = yystacksize * sizeof (*Stack) + YYSTACK_GAP_MAXIMUM; \
-        yyptr += yynewbytes / sizeof (*yyptr);                          \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
       }                                                                 \
     while (0)
 
@@ -509,12 +563,12 @@ union yyalloc
 # ifndef YYCOPY
 #  if defined __GNUC__ && 1 < __GNUC__
 #   define YYCOPY(Dst, Src, Count) \
-      __builtin_memcpy (Dst, Src, (Count) * sizeof (*(Src)))
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
 #  else
 #   define YYCOPY(Dst, Src, Count)              \
       do                                        \
         {                                       \
-          YYSIZE_T yyi;                         \
+          YYPTRDIFF_T yyi;                      \
           for (yyi = 0; yyi < (Count); yyi++)   \
             (Dst)[yyi] = (Src)[yyi];            \
         }                                       \
@@ -537,17 +591,20 @@ union yyalloc
 /* YYNSTATES -- Number of states.  */
 #define YYNSTATES  210
 
-/* YYTRANSLATE[YYX] -- Symbol number corresponding to YYX as returned
-   by yylex, with out-of-bounds checking.  */
-#define YYUNDEFTOK  2
+/* YYMAXUTOK -- Last valid token kind.  */
 #define YYMAXUTOK   318
 
-#define YYTRANSLATE(YYX)                                                \
-  ((unsigned int) (YYX) <= YYMAXUTOK ? yytranslate[YYX] : YYUNDEFTOK)
+
+/* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex, with out-of-bounds checking.  */
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
 
 /* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
-   as returned by yylex, without out-of-bounds checking.  */
-static const yytype_uint8 yytranslate[] =
+   as returned by yylex.  */
+static const yytype_int8 yytranslate[] =
 {
        0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
@@ -584,30 +641,37 @@ static const yytype_uint8 yytranslate[] =
 };
 
 #if YYDEBUG
-  /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
-static const yytype_uint16 yyrline[] =
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+static const yytype_int16 yyrline[] =
 {
-       0,   192,   192,   196,   197,   200,   201,   202,   205,   206,
-     209,   210,   213,   214,   215,   216,   217,   218,   221,   222,
-     223,   226,   227,   228,   229,   230,   231,   232,   233,   234,
-     237,   240,   241,   242,   243,   244,   245,   246,   247,   248,
-     249,   250,   251,   252,   253,   254,   255,   256,   257,   258,
-     259,   262,   263,   264,   265,   268,   269,   270,   271,   274,
-     275,   276,   279,   280,   281,   282,   283,   287,   288,   289,
-     291,   292,   293,   296,   297,   300,   303,   304,   307,   310,
-     313,   316,   319,   322,   323,   326,   327,   328,   331,   332,
-     335,   336,   337,   340,   341,   344,   345,   348,   351,   352,
-     355,   356,   359,   362,   363,   364,   367,   368,   371,   372,
-     375,   376,   377,   380,   382,   384,   386,   388
+       0,   196,   196,   200,   201,   204,   205,   206,   209,   210,
+     213,   214,   217,   218,   219,   220,   221,   222,   225,   226,
+     227,   230,   231,   232,   233,   234,   235,   236,   237,   238,
+     241,   244,   245,   246,   247,   248,   249,   250,   251,   252,
+     253,   254,   255,   256,   257,   258,   259,   260,   261,   262,
+     263,   266,   267,   268,   269,   272,   273,   274,   275,   278,
+     279,   280,   283,   284,   285,   286,   287,   291,   292,   293,
+     295,   296,   297,   300,   301,   304,   307,   308,   311,   314,
+     317,   320,   323,   326,   327,   330,   331,   332,   335,   336,
+     339,   340,   341,   344,   345,   348,   349,   352,   355,   356,
+     359,   360,   363,   366,   367,   368,   371,   372,   375,   376,
+     379,   380,   381,   384,   386,   388,   390,   392
 };
 #endif
 
-#if YYDEBUG || YYERROR_VERBOSE || 1
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
+
+#if 1
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
+
 /* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
    First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
 static const char *const yytname[] =
 {
-  "\"end of file\"", "error", "$undefined", "ANY_KIND", "OPTION",
+  "\"end of file\"", "error", "\"invalid token\"", "ANY_KIND", "OPTION",
   "SCALAR_KIND", "VOID", "BOOL", "SIGNED_KIND", "INT8", "INT16", "INT32",
   "INT64", "UNSIGNED_KIND", "UINT8", "UINT16", "UINT32", "UINT64",
   "REAL_KIND", "FLOAT16", "FLOAT32", "FLOAT64", "COMPLEX_KIND",
@@ -627,35 +691,26 @@ static const char *const yytname[] =
   "record_type", "record_field_seq", "record_field", "record_field_name",
   "attribute_seq_opt", "attribute_seq", "attribute", "function_type", YY_NULLPTR
 };
-#endif
 
-# ifdef YYPRINT
-/* YYTOKNUM[NUM] -- (External) token number corresponding to the
-   (internal) symbol number NUM (which must be that of a token).  */
-static const yytype_uint16 yytoknum[] =
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
 {
-       0,   256,   257,   258,   259,   260,   261,   262,   263,   264,
-     265,   266,   267,   268,   269,   270,   271,   272,   273,   274,
-     275,   276,   277,   278,   279,   280,   281,   282,   283,   284,
-     285,   286,   287,   288,   289,   290,   291,   292,   293,   294,
-     295,   296,   297,   298,   299,   300,   301,   302,   303,   304,
-     305,   306,   307,   308,   309,   310,   311,   312,   313,   314,
-     315,   316,   317,   318
-};
-# endif
+  return yytname[yysymbol];
+}
+#endif
 
-#define YYPACT_NINF -87
+#define YYPACT_NINF (-87)
 
-#define yypact_value_is_default(Yystate) \
-  (!!((Yystate) == (-87)))
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
 
-#define YYTABLE_NINF -107
+#define YYTABLE_NINF (-107)
 
-#define yytable_value_is_error(Yytable_value) \
+#define yytable_value_is_error(Yyn) \
   0
 
-  /* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
-     STATE-NUM.  */
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
 static const yytype_int16 yypact[] =
 {
      388,   -87,   -31,   -87,   -87,   -87,   -87,   -87,   -87,   -87,
@@ -681,10 +736,10 @@ static const yytype_int16 yypact[] =
      -18,   388,    69,   388,   -87,   -87,    70,   -87,   388,   -87
 };
 
-  /* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
-     Performed when YYTABLE does not specify something else to do.  Zero
-     means the default is an error.  */
-static const yytype_uint8 yydefact[] =
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
+static const yytype_int8 yydefact[] =
 {
        0,    21,     0,    22,    31,    32,    33,    51,    52,    53,
       54,    35,    55,    56,    57,    58,    37,    59,    60,    61,
@@ -709,7 +764,7 @@ static const yytype_uint8 yydefact[] =
        0,     0,     0,     0,     9,   115,     0,   116,     0,   117
 };
 
-  /* YYPGOTO[NTERM-NUM].  */
+/* YYPGOTO[NTERM-NUM].  */
 static const yytype_int8 yypgoto[] =
 {
      -87,   -87,     0,   -87,   -36,   -87,    -5,   -49,   -43,   -87,
@@ -718,18 +773,18 @@ static const yytype_int8 yypgoto[] =
      -87,   -39,   -10,   -87,   -38,   -74,   -35,   -87
 };
 
-  /* YYDEFGOTO[NTERM-NUM].  */
-static const yytype_int16 yydefgoto[] =
+/* YYDEFGOTO[NTERM-NUM].  */
+static const yytype_uint8 yydefgoto[] =
 {
-      -1,    48,    87,    50,    51,    52,    53,    54,    55,    56,
+       0,    48,    87,    50,    51,    52,    53,    54,    55,    56,
       57,    58,    59,    60,    61,    62,    63,    64,   118,    65,
       66,    67,    68,   112,   113,    88,   131,    69,    89,    90,
       70,    91,    92,    93,   101,   121,   122,    71
 };
 
-  /* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
-     positive, shift that token.  If negative, reduce the rule whose
-     number is the opposite.  If YYTABLE_NINF, syntax error.  */
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
 static const yytype_int16 yytable[] =
 {
       49,   100,    82,    98,   123,   133,    94,   126,    99,    81,
@@ -878,9 +933,9 @@ static const yytype_int16 yycheck[] =
       62
 };
 
-  /* YYSTOS[STATE-NUM] -- The (internal number of the) accessing
-     symbol of state STATE-NUM.  */
-static const yytype_uint8 yystos[] =
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_int8 yystos[] =
 {
        0,     3,     4,     5,     6,     7,     8,     9,    10,    11,
       12,    13,    14,    15,    16,    17,    18,    19,    20,    21,
@@ -905,8 +960,8 @@ static const yytype_uint8 yystos[] =
       99,    53,    90,    53,    50,    66,    46,    66,    53,    66
 };
 
-  /* YYR1[YYN] -- Symbol number of symbol that rule YYN derives.  */
-static const yytype_uint8 yyr1[] =
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr1[] =
 {
        0,    64,    65,    66,    66,    67,    67,    67,    68,    68,
       69,    69,    70,    70,    70,    70,    70,    70,    71,    71,
@@ -922,8 +977,8 @@ static const yytype_uint8 yyr1[] =
      100,   100,   100,   101,   101,   101,   101,   101
 };
 
-  /* YYR2[YYN] -- Number of symbols on the right hand side of rule YYN.  */
-static const yytype_uint8 yyr2[] =
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
 {
        0,     2,     2,     1,     1,     1,     2,     4,     3,     7,
        1,     3,     1,     2,     4,     1,     2,     1,     1,     2,
@@ -940,39 +995,39 @@ static const yytype_uint8 yyr2[] =
 };
 
 
+enum { YYENOMEM = -2 };
+
 #define yyerrok         (yyerrstatus = 0)
 #define yyclearin       (yychar = YYEMPTY)
-#define YYEMPTY         (-2)
-#define YYEOF           0
 
 #define YYACCEPT        goto yyacceptlab
 #define YYABORT         goto yyabortlab
 #define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
 
 
 #define YYRECOVERING()  (!!yyerrstatus)
 
-#define YYBACKUP(Token, Value)                                  \
-do                                                              \
-  if (yychar == YYEMPTY)                                        \
-    {                                                           \
-      yychar = (Token);                                         \
-      yylval = (Value);                                         \
-      YYPOPSTACK (yylen);                                       \
-      yystate = *yyssp;                                         \
-      goto yybackup;                                            \
-    }                                                           \
-  else                                                          \
-    {                                                           \
-      yyerror (&yylloc, scanner, ast, ctx, YY_("syntax error: cannot back up")); \
-      YYERROR;                                                  \
-    }                                                           \
-while (0)
-
-/* Error token number */
-#define YYTERROR        1
-#define YYERRCODE       256
-
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (&yylloc, scanner, ast, ctx, YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
+
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
 
 /* YYLLOC_DEFAULT -- Set CURRENT to span from RHS[1] to RHS[N].
    If N is 0, then set CURRENT to the empty location which ends
@@ -1016,20 +1071,27 @@ do {                                            \
 } while (0)
 
 
-/* YY_LOCATION_PRINT -- Print the location on the stream.
+/* YYLOCATION_PRINT -- Print the location on the stream.
    This macro was not mandated originally: define only if we know
    we won't break user code: when these are the locations we know.  */
 
-#ifndef YY_LOCATION_PRINT
-# if defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
+# ifndef YYLOCATION_PRINT
+
+#  if defined YY_LOCATION_PRINT
+
+   /* Temporary convenience wrapper in case some people defined the
+      undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YYLOCATION_PRINT(File, Loc)  YY_LOCATION_PRINT(File, *(Loc))
+
+#  elif defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
 
 /* Print *YYLOCP on YYO.  Private, do not rely on its existence. */
 
 YY_ATTRIBUTE_UNUSED
-static unsigned
+static int
 yy_location_print_ (FILE *yyo, YYLTYPE const * const yylocp)
 {
-  unsigned res = 0;
+  int res = 0;
   int end_col = 0 != yylocp->last_column ? yylocp->last_column - 1 : 0;
   if (0 <= yylocp->first_line)
     {
@@ -1049,66 +1111,74 @@ yy_location_print_ (FILE *yyo, YYLTYPE const * const yylocp)
         res += YYFPRINTF (yyo, "-%d", end_col);
     }
   return res;
- }
+}
 
-#  define YY_LOCATION_PRINT(File, Loc)          \
-  yy_location_print_ (File, &(Loc))
+#   define YYLOCATION_PRINT  yy_location_print_
 
-# else
-#  define YY_LOCATION_PRINT(File, Loc) ((void) 0)
-# endif
-#endif
+    /* Temporary convenience wrapper in case some people defined the
+       undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YY_LOCATION_PRINT(File, Loc)  YYLOCATION_PRINT(File, &(Loc))
 
+#  else
+
+#   define YYLOCATION_PRINT(File, Loc) ((void) 0)
+    /* Temporary convenience wrapper in case some people defined the
+       undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YY_LOCATION_PRINT  YYLOCATION_PRINT
+
+#  endif
+# endif /* !defined YYLOCATION_PRINT */
 
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)                    \
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
 do {                                                                      \
   if (yydebug)                                                            \
     {                                                                     \
       YYFPRINTF (stderr, "%s ", Title);                                   \
       yy_symbol_print (stderr,                                            \
-                  Type, Value, Location, scanner, ast, ctx); \
+                  Kind, Value, Location, scanner, ast, ctx); \
       YYFPRINTF (stderr, "\n");                                           \
     }                                                                     \
 } while (0)
 
 
-/*----------------------------------------.
-| Print this symbol's value on YYOUTPUT.  |
-`----------------------------------------*/
+/*-----------------------------------.
+| Print this symbol's value on YYO.  |
+`-----------------------------------*/
 
 static void
-yy_symbol_value_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp, yyscan_t scanner, ndt_t **ast, ndt_context_t *ctx)
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp, yyscan_t scanner, ndt_t **ast, ndt_context_t *ctx)
 {
-  FILE *yyo = yyoutput;
-  YYUSE (yyo);
-  YYUSE (yylocationp);
-  YYUSE (scanner);
-  YYUSE (ast);
-  YYUSE (ctx);
+  FILE *yyoutput = yyo;
+  YY_USE (yyoutput);
+  YY_USE (yylocationp);
+  YY_USE (scanner);
+  YY_USE (ast);
+  YY_USE (ctx);
   if (!yyvaluep)
     return;
-# ifdef YYPRINT
-  if (yytype < YYNTOKENS)
-    YYPRINT (yyoutput, yytoknum[yytype], *yyvaluep);
-# endif
-  YYUSE (yytype);
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
 
-/*--------------------------------.
-| Print this symbol on YYOUTPUT.  |
-`--------------------------------*/
+/*---------------------------.
+| Print this symbol on YYO.  |
+`---------------------------*/
 
 static void
-yy_symbol_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp, yyscan_t scanner, ndt_t **ast, ndt_context_t *ctx)
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp, yyscan_t scanner, ndt_t **ast, ndt_context_t *ctx)
 {
-  YYFPRINTF (yyoutput, "%s %s (",
-             yytype < YYNTOKENS ? "token" : "nterm", yytname[yytype]);
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
 
-  YY_LOCATION_PRINT (yyoutput, *yylocationp);
-  YYFPRINTF (yyoutput, ": ");
-  yy_symbol_value_print (yyoutput, yytype, yyvaluep, yylocationp, scanner, ast, ctx);
-  YYFPRINTF (yyoutput, ")");
+  YYLOCATION_PRINT (yyo, yylocationp);
+  YYFPRINTF (yyo, ": ");
+  yy_symbol_value_print (yyo, yykind, yyvaluep, yylocationp, scanner, ast, ctx);
+  YYFPRINTF (yyo, ")");
 }
 
 /*------------------------------------------------------------------.
@@ -1117,7 +1187,7 @@ yy_symbol_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep, YYL
 `------------------------------------------------------------------*/
 
 static void
-yy_stack_print (yytype_int16 *yybottom, yytype_int16 *yytop)
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
 {
   YYFPRINTF (stderr, "Stack now");
   for (; yybottom <= yytop; yybottom++)
@@ -1140,21 +1210,22 @@ do {                                                            \
 `------------------------------------------------*/
 
 static void
-yy_reduce_print (yytype_int16 *yyssp, YYSTYPE *yyvsp, YYLTYPE *yylsp, int yyrule, yyscan_t scanner, ndt_t **ast, ndt_context_t *ctx)
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp, YYLTYPE *yylsp,
+                 int yyrule, yyscan_t scanner, ndt_t **ast, ndt_context_t *ctx)
 {
-  unsigned long int yylno = yyrline[yyrule];
+  int yylno = yyrline[yyrule];
   int yynrhs = yyr2[yyrule];
   int yyi;
-  YYFPRINTF (stderr, "Reducing stack by rule %d (line %lu):\n",
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
              yyrule - 1, yylno);
   /* The symbols being reduced.  */
   for (yyi = 0; yyi < yynrhs; yyi++)
     {
       YYFPRINTF (stderr, "   $%d = ", yyi + 1);
       yy_symbol_print (stderr,
-                       yystos[yyssp[yyi + 1 - yynrhs]],
-                       &(yyvsp[(yyi + 1) - (yynrhs)])
-                       , &(yylsp[(yyi + 1) - (yynrhs)])                       , scanner, ast, ctx);
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)],
+                       &(yylsp[(yyi + 1) - (yynrhs)]), scanner, ast, ctx);
       YYFPRINTF (stderr, "\n");
     }
 }
@@ -1169,8 +1240,8 @@ do {                                    \
    multiple parsers can coexist.  */
 int yydebug;
 #else /* !YYDEBUG */
-# define YYDPRINTF(Args)
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
 # define YY_STACK_PRINT(Bottom, Top)
 # define YY_REDUCE_PRINT(Rule)
 #endif /* !YYDEBUG */
@@ -1193,28 +1264,77 @@ int yydebug;
 #endif
 
 
-#if YYERROR_VERBOSE
+/* Context of a parse error.  */
+typedef struct
+{
+  yy_state_t *yyssp;
+  yysymbol_kind_t yytoken;
+  YYLTYPE *yylloc;
+} yypcontext_t;
+
+/* Put in YYARG at most YYARGN of the expected tokens given the
+   current YYCTX, and return the number of tokens stored in YYARG.  If
+   YYARG is null, return the number of expected tokens (guaranteed to
+   be less than YYNTOKENS).  Return YYENOMEM on memory exhaustion.
+   Return 0 if there are more than YYARGN expected tokens, yet fill
+   YYARG up to YYARGN. */
+static int
+yypcontext_expected_tokens (const yypcontext_t *yyctx,
+                            yysymbol_kind_t yyarg[], int yyargn)
+{
+  /* Actual size of YYARG. */
+  int yycount = 0;
+  int yyn = yypact[+*yyctx->yyssp];
+  if (!yypact_value_is_default (yyn))
+    {
+      /* Start YYX at -YYN if negative to avoid negative indexes in
+         YYCHECK.  In other words, skip the first -YYN actions for
+         this state because they are default actions.  */
+      int yyxbegin = yyn < 0 ? -yyn : 0;
+      /* Stay within bounds of both yycheck and yytname.  */
+      int yychecklim = YYLAST - yyn + 1;
+      int yyxend = yychecklim < YYNTOKENS ? yychecklim : YYNTOKENS;
+      int yyx;
+      for (yyx = yyxbegin; yyx < yyxend; ++yyx)
+        if (yycheck[yyx + yyn] == yyx && yyx != YYSYMBOL_YYerror
+            && !yytable_value_is_error (yytable[yyx + yyn]))
+          {
+            if (!yyarg)
+              ++yycount;
+            else if (yycount == yyargn)
+              return 0;
+            else
+              yyarg[yycount++] = YY_CAST (yysymbol_kind_t, yyx);
+          }
+    }
+  if (yyarg && yycount == 0 && 0 < yyargn)
+    yyarg[0] = YYSYMBOL_YYEMPTY;
+  return yycount;
+}
+
+
 
-# ifndef yystrlen
-#  if defined __GLIBC__ && defined _STRING_H
-#   define yystrlen strlen
-#  else
+
+#ifndef yystrlen
+# if defined __GLIBC__ && defined _STRING_H
+#  define yystrlen(S) (YY_CAST (YYPTRDIFF_T, strlen (S)))
+# else
 /* Return the length of YYSTR.  */
-static YYSIZE_T
+static YYPTRDIFF_T
 yystrlen (const char *yystr)
 {
-  YYSIZE_T yylen;
+  YYPTRDIFF_T yylen;
   for (yylen = 0; yystr[yylen]; yylen++)
     continue;
   return yylen;
 }
-#  endif
 # endif
+#endif
 
-# ifndef yystpcpy
-#  if defined __GLIBC__ && defined _STRING_H && defined _GNU_SOURCE
-#   define yystpcpy stpcpy
-#  else
+#ifndef yystpcpy
+# if defined __GLIBC__ && defined _STRING_H && defined _GNU_SOURCE
+#  define yystpcpy stpcpy
+# else
 /* Copy YYSRC to YYDEST, returning the address of the terminating '\0' in
    YYDEST.  */
 static char *
@@ -1228,10 +1348,10 @@ yystpcpy (char *yydest, const char *yysrc)
 
   return yyd - 1;
 }
-#  endif
 # endif
+#endif
 
-# ifndef yytnamerr
+#ifndef yytnamerr
 /* Copy to YYRES the contents of YYSTR after stripping away unnecessary
    quotes and backslashes, so that it's suitable for yyerror.  The
    heuristic is that double-quoting is unnecessary unless the string
@@ -1239,14 +1359,13 @@ yystpcpy (char *yydest, const char *yysrc)
    backslash-backslash).  YYSTR is taken from yytname.  If YYRES is
    null, do not copy; instead, return the length of what the result
    would have been.  */
-static YYSIZE_T
+static YYPTRDIFF_T
 yytnamerr (char *yyres, const char *yystr)
 {
   if (*yystr == '"')
     {
-      YYSIZE_T yyn = 0;
+      YYPTRDIFF_T yyn = 0;
       char const *yyp = yystr;
-
       for (;;)
         switch (*++yyp)
           {
@@ -1257,7 +1376,10 @@ yytnamerr (char *yyres, const char *yystr)
           case '\\':
             if (*++yyp != '\\')
               goto do_not_strip_quotes;
-            /* Fall through.  */
+            else
+              goto append;
+
+          append:
           default:
             if (yyres)
               yyres[yyn] = *yyp;
@@ -1272,36 +1394,20 @@ yytnamerr (char *yyres, const char *yystr)
     do_not_strip_quotes: ;
     }
 
-  if (! yyres)
+  if (yyres)
+    return yystpcpy (yyres, yystr) - yyres;
+  else
     return yystrlen (yystr);
-
-  return yystpcpy (yyres, yystr) - yyres;
 }
-# endif
+#endif
 
-/* Copy into *YYMSG, which is of size *YYMSG_ALLOC, an error message
-   about the unexpected token YYTOKEN for the state stack whose top is
-   YYSSP.
 
-   Return 0 if *YYMSG was successfully written.  Return 1 if *YYMSG is
-   not large enough to hold the message.  In that case, also set
-   *YYMSG_ALLOC to the required number of bytes.  Return 2 if the
-   required number of bytes is too large to store.  */
 static int
-yysyntax_error (YYSIZE_T *yymsg_alloc, char **yymsg,
-                yytype_int16 *yyssp, int yytoken)
+yy_syntax_error_arguments (const yypcontext_t *yyctx,
+                           yysymbol_kind_t yyarg[], int yyargn)
 {
-  YYSIZE_T yysize0 = yytnamerr (YY_NULLPTR, yytname[yytoken]);
-  YYSIZE_T yysize = yysize0;
-  enum { YYERROR_VERBOSE_ARGS_MAXIMUM = 5 };
-  /* Internationalized format string. */
-  const char *yyformat = YY_NULLPTR;
-  /* Arguments of yyformat. */
-  char const *yyarg[YYERROR_VERBOSE_ARGS_MAXIMUM];
-  /* Number of reported tokens (one for the "unexpected", one per
-     "expected"). */
+  /* Actual size of YYARG. */
   int yycount = 0;
-
   /* There are many possibilities here to consider:
      - If this state is a consistent state with a default action, then
        the only way this function was invoked is if the default action
@@ -1325,63 +1431,78 @@ yysyntax_error (YYSIZE_T *yymsg_alloc, char **yymsg,
        one exception: it will still contain any token that will not be
        accepted due to an error action in a later state.
   */
-  if (yytoken != YYEMPTY)
+  if (yyctx->yytoken != YYSYMBOL_YYEMPTY)
     {
-      int yyn = yypact[*yyssp];
-      yyarg[yycount++] = yytname[yytoken];
-      if (!yypact_value_is_default (yyn))
-        {
-          /* Start YYX at -YYN if negative to avoid negative indexes in
-             YYCHECK.  In other words, skip the first -YYN actions for
-             this state because they are default actions.  */
-          int yyxbegin = yyn < 0 ? -yyn : 0;
-          /* Stay within bounds of both yycheck and yytname.  */
-          int yychecklim = YYLAST - yyn + 1;
-          int yyxend = yychecklim < YYNTOKENS ? yychecklim : YYNTOKENS;
-          int yyx;
-
-          for (yyx = yyxbegin; yyx < yyxend; ++yyx)
-            if (yycheck[yyx + yyn] == yyx && yyx != YYTERROR
-                && !yytable_value_is_error (yytable[yyx + yyn]))
-              {
-                if (yycount == YYERROR_VERBOSE_ARGS_MAXIMUM)
-                  {
-                    yycount = 1;
-                    yysize = yysize0;
-                    break;
-                  }
-                yyarg[yycount++] = yytname[yyx];
-                {
-                  YYSIZE_T yysize1 = yysize + yytnamerr (YY_NULLPTR, yytname[yyx]);
-                  if (! (yysize <= yysize1
-                         && yysize1 <= YYSTACK_ALLOC_MAXIMUM))
-                    return 2;
-                  yysize = yysize1;
-                }
-              }
-        }
+      int yyn;
+      if (yyarg)
+        yyarg[yycount] = yyctx->yytoken;
+      ++yycount;
+      yyn = yypcontext_expected_tokens (yyctx,
+                                        yyarg ? yyarg + 1 : yyarg, yyargn - 1);
+      if (yyn == YYENOMEM)
+        return YYENOMEM;
+      else
+        yycount += yyn;
     }
+  return yycount;
+}
+
+/* Copy into *YYMSG, which is of size *YYMSG_ALLOC, an error message
+   about the unexpected token YYTOKEN for the state stack whose top is
+   YYSSP.
+
+   Return 0 if *YYMSG was successfully written.  Return -1 if *YYMSG is
+   not large enough to hold the message.  In that case, also set
+   *YYMSG_ALLOC to the required number of bytes.  Return YYENOMEM if the
+   required number of bytes is too large to store.  */
+static int
+yysyntax_error (YYPTRDIFF_T *yymsg_alloc, char **yymsg,
+                const yypcontext_t *yyctx)
+{
+  enum { YYARGS_MAX = 5 };
+  /* Internationalized format string. */
+  const char *yyformat = YY_NULLPTR;
+  /* Arguments of yyformat: reported tokens (one for the "unexpected",
+     one per "expected"). */
+  yysymbol_kind_t yyarg[YYARGS_MAX];
+  /* Cumulated lengths of YYARG.  */
+  YYPTRDIFF_T yysize = 0;
+
+  /* Actual size of YYARG. */
+  int yycount = yy_syntax_error_arguments (yyctx, yyarg, YYARGS_MAX);
+  if (yycount == YYENOMEM)
+    return YYENOMEM;
 
   switch (yycount)
     {
-# define YYCASE_(N, S)                      \
+#define YYCASE_(N, S)                       \
       case N:                               \
         yyformat = S;                       \
-      break
+        break
+    default: /* Avoid compiler warnings. */
       YYCASE_(0, YY_("syntax error"));
       YYCASE_(1, YY_("syntax error, unexpected %s"));
       YYCASE_(2, YY_("syntax error, unexpected %s, expecting %s"));
       YYCASE_(3, YY_("syntax error, unexpected %s, expecting %s or %s"));
       YYCASE_(4, YY_("syntax error, unexpected %s, expecting %s or %s or %s"));
       YYCASE_(5, YY_("syntax error, unexpected %s, expecting %s or %s or %s or %s"));
-# undef YYCASE_
+#undef YYCASE_
     }
 
+  /* Compute error message size.  Don't count the "%s"s, but reserve
+     room for the terminator.  */
+  yysize = yystrlen (yyformat) - 2 * yycount + 1;
   {
-    YYSIZE_T yysize1 = yysize + yystrlen (yyformat);
-    if (! (yysize <= yysize1 && yysize1 <= YYSTACK_ALLOC_MAXIMUM))
-      return 2;
-    yysize = yysize1;
+    int yyi;
+    for (yyi = 0; yyi < yycount; ++yyi)
+      {
+        YYPTRDIFF_T yysize1
+          = yysize + yytnamerr (YY_NULLPTR, yytname[yyarg[yyi]]);
+        if (yysize <= yysize1 && yysize1 <= YYSTACK_ALLOC_MAXIMUM)
+          yysize = yysize1;
+        else
+          return YYENOMEM;
+      }
   }
 
   if (*yymsg_alloc < yysize)
@@ -1390,7 +1511,7 @@ yysyntax_error (YYSIZE_T *yymsg_alloc, char **yymsg,
       if (! (yysize <= *yymsg_alloc
              && *yymsg_alloc <= YYSTACK_ALLOC_MAXIMUM))
         *yymsg_alloc = YYSTACK_ALLOC_MAXIMUM;
-      return 1;
+      return -1;
     }
 
   /* Avoid sprintf, as that infringes on the user's name space.
@@ -1402,279 +1523,267 @@ yysyntax_error (YYSIZE_T *yymsg_alloc, char **yymsg,
     while ((*yyp = *yyformat) != '\0')
       if (*yyp == '%' && yyformat[1] == 's' && yyi < yycount)
         {
-          yyp += yytnamerr (yyp, yyarg[yyi++]);
+          yyp += yytnamerr (yyp, yytname[yyarg[yyi++]]);
           yyformat += 2;
         }
       else
         {
-          yyp++;
-          yyformat++;
+          ++yyp;
+          ++yyformat;
         }
   }
   return 0;
 }
-#endif /* YYERROR_VERBOSE */
+
 
 /*-----------------------------------------------.
 | Release the memory associated to this symbol.  |
 `-----------------------------------------------*/
 
 static void
-yydestruct (const char *yymsg, int yytype, YYSTYPE *yyvaluep, YYLTYPE *yylocationp, yyscan_t scanner, ndt_t **ast, ndt_context_t *ctx)
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep, YYLTYPE *yylocationp, yyscan_t scanner, ndt_t **ast, ndt_context_t *ctx)
 {
-  YYUSE (yyvaluep);
-  YYUSE (yylocationp);
-  YYUSE (scanner);
-  YYUSE (ast);
-  YYUSE (ctx);
+  YY_USE (yyvaluep);
+  YY_USE (yylocationp);
+  YY_USE (scanner);
+  YY_USE (ast);
+  YY_USE (ctx);
   if (!yymsg)
     yymsg = "Deleting";
-  YY_SYMBOL_PRINT (yymsg, yytype, yyvaluep, yylocationp);
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
 
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
-  switch (yytype)
+  switch (yykind)
     {
-          case 58: /* INTEGER  */
-#line 187 "grammar.y" /* yacc.c:1257  */
-      { ndt_free(((*yyvaluep).string)); }
-#line 1441 "grammar.c" /* yacc.c:1257  */
-        break;
-
-    case 59: /* FLOATNUMBER  */
-#line 187 "grammar.y" /* yacc.c:1257  */
-      { ndt_free(((*yyvaluep).string)); }
-#line 1447 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_STRINGLIT: /* STRINGLIT  */
+#line 191 "grammar.y"
+            { ndt_free(((*yyvaluep).string)); }
+#line 1563 "grammar.c"
         break;
 
-    case 60: /* STRINGLIT  */
-#line 187 "grammar.y" /* yacc.c:1257  */
-      { ndt_free(((*yyvaluep).string)); }
-#line 1453 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_NAME_LOWER: /* NAME_LOWER  */
+#line 191 "grammar.y"
+            { ndt_free(((*yyvaluep).string)); }
+#line 1569 "grammar.c"
         break;
 
-    case 61: /* NAME_LOWER  */
-#line 187 "grammar.y" /* yacc.c:1257  */
-      { ndt_free(((*yyvaluep).string)); }
-#line 1459 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_NAME_UPPER: /* NAME_UPPER  */
+#line 191 "grammar.y"
+            { ndt_free(((*yyvaluep).string)); }
+#line 1575 "grammar.c"
         break;
 
-    case 62: /* NAME_UPPER  */
-#line 187 "grammar.y" /* yacc.c:1257  */
-      { ndt_free(((*yyvaluep).string)); }
-#line 1465 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_NAME_OTHER: /* NAME_OTHER  */
+#line 191 "grammar.y"
+            { ndt_free(((*yyvaluep).string)); }
+#line 1581 "grammar.c"
         break;
 
-    case 63: /* NAME_OTHER  */
-#line 187 "grammar.y" /* yacc.c:1257  */
-      { ndt_free(((*yyvaluep).string)); }
-#line 1471 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_input: /* input  */
+#line 180 "grammar.y"
+            { ndt_del(((*yyvaluep).ndt)); }
+#line 1587 "grammar.c"
         break;
 
-    case 65: /* input  */
-#line 176 "grammar.y" /* yacc.c:1257  */
-      { ndt_del(((*yyvaluep).ndt)); }
-#line 1477 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_datashape: /* datashape  */
+#line 180 "grammar.y"
+            { ndt_del(((*yyvaluep).ndt)); }
+#line 1593 "grammar.c"
         break;
 
-    case 66: /* datashape  */
-#line 176 "grammar.y" /* yacc.c:1257  */
-      { ndt_del(((*yyvaluep).ndt)); }
-#line 1483 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_array: /* array  */
+#line 180 "grammar.y"
+            { ndt_del(((*yyvaluep).ndt)); }
+#line 1599 "grammar.c"
         break;
 
-    case 67: /* array  */
-#line 176 "grammar.y" /* yacc.c:1257  */
-      { ndt_del(((*yyvaluep).ndt)); }
-#line 1489 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_array_nooption: /* array_nooption  */
+#line 180 "grammar.y"
+            { ndt_del(((*yyvaluep).ndt)); }
+#line 1605 "grammar.c"
         break;
 
-    case 68: /* array_nooption  */
-#line 176 "grammar.y" /* yacc.c:1257  */
-      { ndt_del(((*yyvaluep).ndt)); }
-#line 1495 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_dimension_seq: /* dimension_seq  */
+#line 182 "grammar.y"
+            { ndt_dim_seq_del(((*yyvaluep).dim_seq)); }
+#line 1611 "grammar.c"
         break;
 
-    case 69: /* dimension_seq  */
-#line 178 "grammar.y" /* yacc.c:1257  */
-      { ndt_dim_seq_del(((*yyvaluep).dim_seq)); }
-#line 1501 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_dimension: /* dimension  */
+#line 181 "grammar.y"
+            { ndt_dim_del(((*yyvaluep).dim)); }
+#line 1617 "grammar.c"
         break;
 
-    case 70: /* dimension  */
-#line 177 "grammar.y" /* yacc.c:1257  */
-      { ndt_dim_del(((*yyvaluep).dim)); }
-#line 1507 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_dtype: /* dtype  */
+#line 180 "grammar.y"
+            { ndt_del(((*yyvaluep).ndt)); }
+#line 1623 "grammar.c"
         break;
 
-    case 71: /* dtype  */
-#line 176 "grammar.y" /* yacc.c:1257  */
-      { ndt_del(((*yyvaluep).ndt)); }
-#line 1513 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_dtype_nooption: /* dtype_nooption  */
+#line 180 "grammar.y"
+            { ndt_del(((*yyvaluep).ndt)); }
+#line 1629 "grammar.c"
         break;
 
-    case 72: /* dtype_nooption  */
-#line 176 "grammar.y" /* yacc.c:1257  */
-      { ndt_del(((*yyvaluep).ndt)); }
-#line 1519 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_scalar: /* scalar  */
+#line 180 "grammar.y"
+            { ndt_del(((*yyvaluep).ndt)); }
+#line 1635 "grammar.c"
         break;
 
-    case 73: /* scalar  */
-#line 176 "grammar.y" /* yacc.c:1257  */
-      { ndt_del(((*yyvaluep).ndt)); }
-#line 1525 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_signed: /* signed  */
+#line 180 "grammar.y"
+            { ndt_del(((*yyvaluep).ndt)); }
+#line 1641 "grammar.c"
         break;
 
-    case 74: /* signed  */
-#line 176 "grammar.y" /* yacc.c:1257  */
-      { ndt_del(((*yyvaluep).ndt)); }
-#line 1531 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_unsigned: /* unsigned  */
+#line 180 "grammar.y"
+            { ndt_del(((*yyvaluep).ndt)); }
+#line 1647 "grammar.c"
         break;
 
-    case 75: /* unsigned  */
-#line 176 "grammar.y" /* yacc.c:1257  */
-      { ndt_del(((*yyvaluep).ndt)); }
-#line 1537 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_ieee_float: /* ieee_float  */
+#line 180 "grammar.y"
+            { ndt_del(((*yyvaluep).ndt)); }
+#line 1653 "grammar.c"
         break;
 
-    case 76: /* ieee_float  */
-#line 176 "grammar.y" /* yacc.c:1257  */
-      { ndt_del(((*yyvaluep).ndt)); }
-#line 1543 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_ieee_complex: /* ieee_complex  */
+#line 180 "grammar.y"
+            { ndt_del(((*yyvaluep).ndt)); }
+#line 1659 "grammar.c"
         break;
 
-    case 77: /* ieee_complex  */
-#line 176 "grammar.y" /* yacc.c:1257  */
-      { ndt_del(((*yyvaluep).ndt)); }
-#line 1549 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_alias: /* alias  */
+#line 180 "grammar.y"
+            { ndt_del(((*yyvaluep).ndt)); }
+#line 1665 "grammar.c"
         break;
 
-    case 78: /* alias  */
-#line 176 "grammar.y" /* yacc.c:1257  */
-      { ndt_del(((*yyvaluep).ndt)); }
-#line 1555 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_character: /* character  */
+#line 180 "grammar.y"
+            { ndt_del(((*yyvaluep).ndt)); }
+#line 1671 "grammar.c"
         break;
 
-    case 79: /* character  */
-#line 176 "grammar.y" /* yacc.c:1257  */
-      { ndt_del(((*yyvaluep).ndt)); }
-#line 1561 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_string: /* string  */
+#line 180 "grammar.y"
+            { ndt_del(((*yyvaluep).ndt)); }
+#line 1677 "grammar.c"
         break;
 
-    case 80: /* string  */
-#line 176 "grammar.y" /* yacc.c:1257  */
-      { ndt_del(((*yyvaluep).ndt)); }
-#line 1567 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_fixed_string: /* fixed_string  */
+#line 180 "grammar.y"
+            { ndt_del(((*yyvaluep).ndt)); }
+#line 1683 "grammar.c"
         break;
 
-    case 81: /* fixed_string  */
-#line 176 "grammar.y" /* yacc.c:1257  */
-      { ndt_del(((*yyvaluep).ndt)); }
-#line 1573 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_bytes: /* bytes  */
+#line 180 "grammar.y"
+            { ndt_del(((*yyvaluep).ndt)); }
+#line 1689 "grammar.c"
         break;
 
-    case 83: /* bytes  */
-#line 176 "grammar.y" /* yacc.c:1257  */
-      { ndt_del(((*yyvaluep).ndt)); }
-#line 1579 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_fixed_bytes: /* fixed_bytes  */
+#line 180 "grammar.y"
+            { ndt_del(((*yyvaluep).ndt)); }
+#line 1695 "grammar.c"
         break;
 
-    case 84: /* fixed_bytes  */
-#line 176 "grammar.y" /* yacc.c:1257  */
-      { ndt_del(((*yyvaluep).ndt)); }
-#line 1585 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_pointer: /* pointer  */
+#line 180 "grammar.y"
+            { ndt_del(((*yyvaluep).ndt)); }
+#line 1701 "grammar.c"
         break;
 
-    case 85: /* pointer  */
-#line 176 "grammar.y" /* yacc.c:1257  */
-      { ndt_del(((*yyvaluep).ndt)); }
-#line 1591 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_categorical: /* categorical  */
+#line 180 "grammar.y"
+            { ndt_del(((*yyvaluep).ndt)); }
+#line 1707 "grammar.c"
         break;
 
-    case 86: /* categorical  */
-#line 176 "grammar.y" /* yacc.c:1257  */
-      { ndt_del(((*yyvaluep).ndt)); }
-#line 1597 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_typed_value_seq: /* typed_value_seq  */
+#line 188 "grammar.y"
+            { ndt_memory_seq_del(((*yyvaluep).typed_value_seq)); }
+#line 1713 "grammar.c"
         break;
 
-    case 87: /* typed_value_seq  */
-#line 184 "grammar.y" /* yacc.c:1257  */
-      { ndt_memory_seq_del(((*yyvaluep).typed_value_seq)); }
-#line 1603 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_typed_value: /* typed_value  */
+#line 187 "grammar.y"
+            { ndt_memory_del(((*yyvaluep).typed_value)); }
+#line 1719 "grammar.c"
         break;
 
-    case 88: /* typed_value  */
-#line 183 "grammar.y" /* yacc.c:1257  */
-      { ndt_memory_del(((*yyvaluep).typed_value)); }
-#line 1609 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_tuple_type: /* tuple_type  */
+#line 180 "grammar.y"
+            { ndt_del(((*yyvaluep).ndt)); }
+#line 1725 "grammar.c"
         break;
 
-    case 91: /* tuple_type  */
-#line 176 "grammar.y" /* yacc.c:1257  */
-      { ndt_del(((*yyvaluep).ndt)); }
-#line 1615 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_tuple_field_seq: /* tuple_field_seq  */
+#line 184 "grammar.y"
+            { ndt_tuple_field_seq_del(((*yyvaluep).tuple_field_seq)); }
+#line 1731 "grammar.c"
         break;
 
-    case 92: /* tuple_field_seq  */
-#line 180 "grammar.y" /* yacc.c:1257  */
-      { ndt_tuple_field_seq_del(((*yyvaluep).tuple_field_seq)); }
-#line 1621 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_tuple_field: /* tuple_field  */
+#line 183 "grammar.y"
+            { ndt_tuple_field_del(((*yyvaluep).tuple_field)); }
+#line 1737 "grammar.c"
         break;
 
-    case 93: /* tuple_field  */
-#line 179 "grammar.y" /* yacc.c:1257  */
-      { ndt_tuple_field_del(((*yyvaluep).tuple_field)); }
-#line 1627 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_record_type: /* record_type  */
+#line 180 "grammar.y"
+            { ndt_del(((*yyvaluep).ndt)); }
+#line 1743 "grammar.c"
         break;
 
-    case 94: /* record_type  */
-#line 176 "grammar.y" /* yacc.c:1257  */
-      { ndt_del(((*yyvaluep).ndt)); }
-#line 1633 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_record_field_seq: /* record_field_seq  */
+#line 186 "grammar.y"
+            { ndt_record_field_seq_del(((*yyvaluep).record_field_seq)); }
+#line 1749 "grammar.c"
         break;
 
-    case 95: /* record_field_seq  */
-#line 182 "grammar.y" /* yacc.c:1257  */
-      { ndt_record_field_seq_del(((*yyvaluep).record_field_seq)); }
-#line 1639 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_record_field: /* record_field  */
+#line 185 "grammar.y"
+            { ndt_record_field_del(((*yyvaluep).record_field)); }
+#line 1755 "grammar.c"
         break;
 
-    case 96: /* record_field  */
-#line 181 "grammar.y" /* yacc.c:1257  */
-      { ndt_record_field_del(((*yyvaluep).record_field)); }
-#line 1645 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_record_field_name: /* record_field_name  */
+#line 191 "grammar.y"
+            { ndt_free(((*yyvaluep).string)); }
+#line 1761 "grammar.c"
         break;
 
-    case 97: /* record_field_name  */
-#line 187 "grammar.y" /* yacc.c:1257  */
-      { ndt_free(((*yyvaluep).string)); }
-#line 1651 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_attribute_seq_opt: /* attribute_seq_opt  */
+#line 190 "grammar.y"
+            { ndt_attr_seq_del(((*yyvaluep).attribute_seq)); }
+#line 1767 "grammar.c"
         break;
 
-    case 98: /* attribute_seq_opt  */
-#line 186 "grammar.y" /* yacc.c:1257  */
-      { ndt_attr_seq_del(((*yyvaluep).attribute_seq)); }
-#line 1657 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_attribute_seq: /* attribute_seq  */
+#line 190 "grammar.y"
+            { ndt_attr_seq_del(((*yyvaluep).attribute_seq)); }
+#line 1773 "grammar.c"
         break;
 
-    case 99: /* attribute_seq  */
-#line 186 "grammar.y" /* yacc.c:1257  */
-      { ndt_attr_seq_del(((*yyvaluep).attribute_seq)); }
-#line 1663 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_attribute: /* attribute  */
+#line 189 "grammar.y"
+            { ndt_attr_del(((*yyvaluep).attribute)); }
+#line 1779 "grammar.c"
         break;
 
-    case 100: /* attribute  */
-#line 185 "grammar.y" /* yacc.c:1257  */
-      { ndt_attr_del(((*yyvaluep).attribute)); }
-#line 1669 "grammar.c" /* yacc.c:1257  */
+    case YYSYMBOL_function_type: /* function_type  */
+#line 180 "grammar.y"
+            { ndt_del(((*yyvaluep).ndt)); }
+#line 1785 "grammar.c"
         break;
 
-    case 101: /* function_type  */
-#line 176 "grammar.y" /* yacc.c:1257  */
-      { ndt_del(((*yyvaluep).ndt)); }
-#line 1675 "grammar.c" /* yacc.c:1257  */
-        break;
-
-
       default:
         break;
     }
@@ -1684,6 +1793,8 @@ yydestruct (const char *yymsg, int yytype, YYSTYPE *yyvaluep, YYLTYPE *yylocatio
 
 
 
+
+
 /*----------.
 | yyparse.  |
 `----------*/
@@ -1691,7 +1802,7 @@ yydestruct (const char *yymsg, int yytype, YYSTYPE *yyvaluep, YYLTYPE *yylocatio
 int
 yyparse (yyscan_t scanner, ndt_t **ast, ndt_context_t *ctx)
 {
-/* The lookahead symbol.  */
+/* Lookahead token kind.  */
 int yychar;
 
 
@@ -1710,55 +1821,50 @@ static YYLTYPE yyloc_default
 YYLTYPE yylloc = yyloc_default;
 
     /* Number of syntax errors so far.  */
-    int yynerrs;
+    int yynerrs = 0;
 
-    int yystate;
+    yy_state_fast_t yystate = 0;
     /* Number of tokens to shift before error messages enabled.  */
-    int yyerrstatus;
-
-    /* The stacks and their tools:
-       'yyss': related to states.
-       'yyvs': related to semantic values.
-       'yyls': related to locations.
+    int yyerrstatus = 0;
 
-       Refer to the stacks through separate pointers, to allow yyoverflow
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
        to reallocate them elsewhere.  */
 
-    /* The state stack.  */
-    yytype_int16 yyssa[YYINITDEPTH];
-    yytype_int16 *yyss;
-    yytype_int16 *yyssp;
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
 
-    /* The semantic value stack.  */
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
+
+    /* The semantic value stack: array, bottom, top.  */
     YYSTYPE yyvsa[YYINITDEPTH];
-    YYSTYPE *yyvs;
-    YYSTYPE *yyvsp;
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
 
-    /* The location stack.  */
+    /* The location stack: array, bottom, top.  */
     YYLTYPE yylsa[YYINITDEPTH];
-    YYLTYPE *yyls;
-    YYLTYPE *yylsp;
-
-    /* The locations where the error started and ended.  */
-    YYLTYPE yyerror_range[3];
-
-    YYSIZE_T yystacksize;
+    YYLTYPE *yyls = yylsa;
+    YYLTYPE *yylsp = yyls;
 
   int yyn;
+  /* The return value of yyparse.  */
   int yyresult;
-  /* Lookahead token as an internal (translated) token number.  */
-  int yytoken = 0;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
   /* The variables used to return semantic value and location from the
      action routines.  */
   YYSTYPE yyval;
   YYLTYPE yyloc;
 
-#if YYERROR_VERBOSE
+  /* The locations where the error started and ended.  */
+  YYLTYPE yyerror_range[3];
+
   /* Buffer for error messages, and its allocated size.  */
   char yymsgbuf[128];
   char *yymsg = yymsgbuf;
-  YYSIZE_T yymsg_alloc = sizeof yymsgbuf;
-#endif
+  YYPTRDIFF_T yymsg_alloc = sizeof yymsgbuf;
 
 #define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N), yylsp -= (N))
 
@@ -1766,20 +1872,13 @@ YYLTYPE yylloc = yyloc_default;
      Keep to zero when no symbol should be popped.  */
   int yylen = 0;
 
-  yyssp = yyss = yyssa;
-  yyvsp = yyvs = yyvsa;
-  yylsp = yyls = yylsa;
-  yystacksize = YYINITDEPTH;
-
   YYDPRINTF ((stderr, "Starting parse\n"));
 
-  yystate = 0;
-  yyerrstatus = 0;
-  yynerrs = 0;
   yychar = YYEMPTY; /* Cause a token to be read.  */
 
+
 /* User initialization code.  */
-#line 71 "grammar.y" /* yacc.c:1429  */
+#line 72 "grammar.y"
 {
    yylloc.first_line = 1;
    yylloc.first_column = 1;
@@ -1787,33 +1886,47 @@ YYLTYPE yylloc = yyloc_default;
    yylloc.last_column = 1;
 }
 
-#line 1791 "grammar.c" /* yacc.c:1429  */
+#line 1890 "grammar.c"
+
   yylsp[0] = yylloc;
   goto yysetstate;
 
+
 /*------------------------------------------------------------.
-| yynewstate -- Push a new state, which is found in yystate.  |
+| yynewstate -- push a new state, which is found in yystate.  |
 `------------------------------------------------------------*/
- yynewstate:
+yynewstate:
   /* In all cases, when you get here, the value and location stacks
      have just been pushed.  So pushing a state here evens the stacks.  */
   yyssp++;
 
- yysetstate:
-  *yyssp = yystate;
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
 
   if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
     {
       /* Get the current used size of the three stacks, in elements.  */
-      YYSIZE_T yysize = yyssp - yyss + 1;
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
 
-#ifdef yyoverflow
+# if defined yyoverflow
       {
         /* Give user a chance to reallocate the stack.  Use copies of
            these so that the &'s don't force the real ones into
            memory.  */
+        yy_state_t *yyss1 = yyss;
         YYSTYPE *yyvs1 = yyvs;
-        yytype_int16 *yyss1 = yyss;
         YYLTYPE *yyls1 = yyls;
 
         /* Each stack pointer address is followed by the size of the
@@ -1821,32 +1934,29 @@ YYLTYPE yylloc = yyloc_default;
            conditional around just the two extra args, but that might
            be undefined if yyoverflow is a macro.  */
         yyoverflow (YY_("memory exhausted"),
-                    &yyss1, yysize * sizeof (*yyssp),
-                    &yyvs1, yysize * sizeof (*yyvsp),
-                    &yyls1, yysize * sizeof (*yylsp),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yyls1, yysize * YYSIZEOF (*yylsp),
                     &yystacksize);
-
-        yyls = yyls1;
         yyss = yyss1;
         yyvs = yyvs1;
+        yyls = yyls1;
       }
-#else /* no yyoverflow */
-# ifndef YYSTACK_RELOCATE
-      goto yyexhaustedlab;
-# else
+# else /* defined YYSTACK_RELOCATE */
       /* Extend the stack our own way.  */
       if (YYMAXDEPTH <= yystacksize)
-        goto yyexhaustedlab;
+        YYNOMEM;
       yystacksize *= 2;
       if (YYMAXDEPTH < yystacksize)
         yystacksize = YYMAXDEPTH;
 
       {
-        yytype_int16 *yyss1 = yyss;
+        yy_state_t *yyss1 = yyss;
         union yyalloc *yyptr =
-          (union yyalloc *) YYSTACK_ALLOC (YYSTACK_BYTES (yystacksize));
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
         if (! yyptr)
-          goto yyexhaustedlab;
+          YYNOMEM;
         YYSTACK_RELOCATE (yyss_alloc, yyss);
         YYSTACK_RELOCATE (yyvs_alloc, yyvs);
         YYSTACK_RELOCATE (yyls_alloc, yyls);
@@ -1855,31 +1965,32 @@ YYLTYPE yylloc = yyloc_default;
           YYSTACK_FREE (yyss1);
       }
 # endif
-#endif /* no yyoverflow */
 
       yyssp = yyss + yysize - 1;
       yyvsp = yyvs + yysize - 1;
       yylsp = yyls + yysize - 1;
 
-      YYDPRINTF ((stderr, "Stack size increased to %lu\n",
-                  (unsigned long int) yystacksize));
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
 
       if (yyss + yystacksize - 1 <= yyssp)
         YYABORT;
     }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
 
-  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
 
   if (yystate == YYFINAL)
     YYACCEPT;
 
   goto yybackup;
 
+
 /*-----------.
 | yybackup.  |
 `-----------*/
 yybackup:
-
   /* Do appropriate processing given the current state.  Read a
      lookahead token if we need one and don't already have one.  */
 
@@ -1890,18 +2001,30 @@ yybackup:
 
   /* Not known => get a lookahead token if don't already have one.  */
 
-  /* YYCHAR is either YYEMPTY or YYEOF or a valid lookahead symbol.  */
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
   if (yychar == YYEMPTY)
     {
-      YYDPRINTF ((stderr, "Reading a token: "));
+      YYDPRINTF ((stderr, "Reading a token\n"));
       yychar = yylex (&yylval, &yylloc, scanner, ctx);
     }
 
-  if (yychar <= YYEOF)
+  if (yychar <= ENDMARKER)
     {
-      yychar = yytoken = YYEOF;
+      yychar = ENDMARKER;
+      yytoken = YYSYMBOL_YYEOF;
       YYDPRINTF ((stderr, "Now at end of input.\n"));
     }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      yyerror_range[1] = yylloc;
+      goto yyerrlab1;
+    }
   else
     {
       yytoken = YYTRANSLATE (yychar);
@@ -1929,15 +2052,14 @@ yybackup:
 
   /* Shift the lookahead token.  */
   YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
-
-  /* Discard the shifted token.  */
-  yychar = YYEMPTY;
-
   yystate = yyn;
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
   *++yyvsp = yylval;
   YY_IGNORE_MAYBE_UNINITIALIZED_END
   *++yylsp = yylloc;
+
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
   goto yynewstate;
 
 
@@ -1952,7 +2074,7 @@ yydefault:
 
 
 /*-----------------------------.
-| yyreduce -- Do a reduction.  |
+| yyreduce -- do a reduction.  |
 `-----------------------------*/
 yyreduce:
   /* yyn is the number of a rule to reduce with.  */
@@ -1968,711 +2090,713 @@ yyreduce:
      GCC warning that YYVAL may be used uninitialized.  */
   yyval = yyvsp[1-yylen];
 
-  /* Default location.  */
+  /* Default location. */
   YYLLOC_DEFAULT (yyloc, (yylsp - yylen), yylen);
+  yyerror_range[1] = yyloc;
   YY_REDUCE_PRINT (yyn);
   switch (yyn)
     {
-        case 2:
-#line 192 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = (yyvsp[-1].ndt);  *ast = (yyval.ndt); YYACCEPT; }
-#line 1980 "grammar.c" /* yacc.c:1646  */
+  case 2: /* input: datashape "end of file"  */
+#line 196 "grammar.y"
+                      { (yyval.ndt) = (yyvsp[-1].ndt);  *ast = (yyval.ndt); YYACCEPT; }
+#line 2103 "grammar.c"
     break;
 
-  case 3:
-#line 196 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 1986 "grammar.c" /* yacc.c:1646  */
+  case 3: /* datashape: array  */
+#line 200 "grammar.y"
+        { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2109 "grammar.c"
     break;
 
-  case 4:
-#line 197 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 1992 "grammar.c" /* yacc.c:1646  */
+  case 4: /* datashape: dtype  */
+#line 201 "grammar.y"
+        { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2115 "grammar.c"
     break;
 
-  case 5:
-#line 200 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 1998 "grammar.c" /* yacc.c:1646  */
+  case 5: /* array: array_nooption  */
+#line 204 "grammar.y"
+                                      { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2121 "grammar.c"
     break;
 
-  case 6:
-#line 201 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_option((yyvsp[0].ndt), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2004 "grammar.c" /* yacc.c:1646  */
+  case 6: /* array: QUESTIONMARK array_nooption  */
+#line 205 "grammar.y"
+                                      { (yyval.ndt) = ndt_option((yyvsp[0].ndt), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2127 "grammar.c"
     break;
 
-  case 7:
-#line 202 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_option((yyvsp[-1].ndt), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2010 "grammar.c" /* yacc.c:1646  */
+  case 7: /* array: OPTION LPAREN array_nooption RPAREN  */
+#line 206 "grammar.y"
+                                      { (yyval.ndt) = ndt_option((yyvsp[-1].ndt), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2133 "grammar.c"
     break;
 
-  case 8:
-#line 205 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = mk_array((yyvsp[-2].dim_seq), (yyvsp[0].ndt), NULL, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2016 "grammar.c" /* yacc.c:1646  */
+  case 8: /* array_nooption: dimension_seq STAR dtype  */
+#line 209 "grammar.y"
+                                                           { (yyval.ndt) = mk_array((yyvsp[-2].dim_seq), (yyvsp[0].ndt), NULL, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2139 "grammar.c"
     break;
 
-  case 9:
-#line 206 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = mk_array((yyvsp[-6].dim_seq), (yyvsp[-4].ndt), (yyvsp[-1].attribute_seq), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2022 "grammar.c" /* yacc.c:1646  */
+  case 9: /* array_nooption: dimension_seq STAR dtype BAR LBRACK attribute_seq RBRACK  */
+#line 210 "grammar.y"
+                                                           { (yyval.ndt) = mk_array((yyvsp[-6].dim_seq), (yyvsp[-4].ndt), (yyvsp[-1].attribute_seq), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2145 "grammar.c"
     break;
 
-  case 10:
-#line 209 "grammar.y" /* yacc.c:1646  */
-    { (yyval.dim_seq) = ndt_dim_seq_new((yyvsp[0].dim), ctx); if ((yyval.dim_seq) == NULL) YYABORT; }
-#line 2028 "grammar.c" /* yacc.c:1646  */
+  case 10: /* dimension_seq: dimension  */
+#line 213 "grammar.y"
+                               { (yyval.dim_seq) = ndt_dim_seq_new((yyvsp[0].dim), ctx); if ((yyval.dim_seq) == NULL) YYABORT; }
+#line 2151 "grammar.c"
     break;
 
-  case 11:
-#line 210 "grammar.y" /* yacc.c:1646  */
-    { (yyval.dim_seq) = ndt_dim_seq_append((yyvsp[-2].dim_seq), (yyvsp[0].dim), ctx); if ((yyval.dim_seq) == NULL) YYABORT; }
-#line 2034 "grammar.c" /* yacc.c:1646  */
+  case 11: /* dimension_seq: dimension_seq STAR dimension  */
+#line 214 "grammar.y"
+                               { (yyval.dim_seq) = ndt_dim_seq_append((yyvsp[-2].dim_seq), (yyvsp[0].dim), ctx); if ((yyval.dim_seq) == NULL) YYABORT; }
+#line 2157 "grammar.c"
     break;
 
-  case 12:
-#line 213 "grammar.y" /* yacc.c:1646  */
-    { (yyval.dim) = ndt_fixed_dim_kind(ctx); if ((yyval.dim) == NULL) YYABORT; }
-#line 2040 "grammar.c" /* yacc.c:1646  */
+  case 12: /* dimension: FIXED_DIM_KIND  */
+#line 217 "grammar.y"
+                              { (yyval.dim) = ndt_fixed_dim_kind(ctx); if ((yyval.dim) == NULL) YYABORT; }
+#line 2163 "grammar.c"
     break;
 
-  case 13:
-#line 214 "grammar.y" /* yacc.c:1646  */
-    { (yyval.dim) = mk_fixed_dim((yyvsp[-1].string), (yyvsp[0].attribute_seq), ctx); if ((yyval.dim) == NULL) YYABORT; }
-#line 2046 "grammar.c" /* yacc.c:1646  */
+  case 13: /* dimension: INTEGER attribute_seq_opt  */
+#line 218 "grammar.y"
+                              { (yyval.dim) = mk_fixed_dim((yyvsp[-1].slice).start, (yyvsp[-1].slice).len, (yyvsp[0].attribute_seq), ctx); if ((yyval.dim) == NULL) YYABORT; }
+#line 2169 "grammar.c"
     break;
 
-  case 14:
-#line 215 "grammar.y" /* yacc.c:1646  */
-    { (yyval.dim) = mk_fixed_dim((yyvsp[-1].string), NULL, ctx); if ((yyval.dim) == NULL) YYABORT; }
-#line 2052 "grammar.c" /* yacc.c:1646  */
+  case 14: /* dimension: FIXED LPAREN INTEGER RPAREN  */
+#line 219 "grammar.y"
+                              { (yyval.dim) = mk_fixed_dim((yyvsp[-1].slice).start, (yyvsp[-1].slice).len, NULL, ctx); if ((yyval.dim) == NULL) YYABORT; }
+#line 2175 "grammar.c"
     break;
 
-  case 15:
-#line 216 "grammar.y" /* yacc.c:1646  */
-    { (yyval.dim) = ndt_symbolic_dim((yyvsp[0].string), ctx); if ((yyval.dim) == NULL) YYABORT; }
-#line 2058 "grammar.c" /* yacc.c:1646  */
+  case 15: /* dimension: NAME_UPPER  */
+#line 220 "grammar.y"
+                              { (yyval.dim) = ndt_symbolic_dim((yyvsp[0].string), ctx); if ((yyval.dim) == NULL) YYABORT; }
+#line 2181 "grammar.c"
     break;
 
-  case 16:
-#line 217 "grammar.y" /* yacc.c:1646  */
-    { (yyval.dim) = mk_var_dim((yyvsp[0].attribute_seq), ctx); if ((yyval.dim) == NULL) YYABORT; }
-#line 2064 "grammar.c" /* yacc.c:1646  */
+  case 16: /* dimension: VAR attribute_seq_opt  */
+#line 221 "grammar.y"
+                              { (yyval.dim) = mk_var_dim((yyvsp[0].attribute_seq), ctx); if ((yyval.dim) == NULL) YYABORT; }
+#line 2187 "grammar.c"
     break;
 
-  case 17:
-#line 218 "grammar.y" /* yacc.c:1646  */
-    { (yyval.dim) = ndt_ellipsis_dim(ctx); if ((yyval.dim) == NULL) YYABORT; }
-#line 2070 "grammar.c" /* yacc.c:1646  */
+  case 17: /* dimension: ELLIPSIS  */
+#line 222 "grammar.y"
+                              { (yyval.dim) = ndt_ellipsis_dim(ctx); if ((yyval.dim) == NULL) YYABORT; }
+#line 2193 "grammar.c"
     break;
 
-  case 18:
-#line 221 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 2076 "grammar.c" /* yacc.c:1646  */
+  case 18: /* dtype: dtype_nooption  */
+#line 225 "grammar.y"
+                                      { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2199 "grammar.c"
     break;
 
-  case 19:
-#line 222 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_option((yyvsp[0].ndt), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2082 "grammar.c" /* yacc.c:1646  */
+  case 19: /* dtype: QUESTIONMARK dtype_nooption  */
+#line 226 "grammar.y"
+                                      { (yyval.ndt) = ndt_option((yyvsp[0].ndt), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2205 "grammar.c"
     break;
 
-  case 20:
-#line 223 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_option((yyvsp[-1].ndt), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2088 "grammar.c" /* yacc.c:1646  */
+  case 20: /* dtype: OPTION LPAREN dtype_nooption RPAREN  */
+#line 227 "grammar.y"
+                                      { (yyval.ndt) = ndt_option((yyvsp[-1].ndt), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2211 "grammar.c"
     break;
 
-  case 21:
-#line 226 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_any_kind(ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2094 "grammar.c" /* yacc.c:1646  */
+  case 21: /* dtype_nooption: ANY_KIND  */
+#line 230 "grammar.y"
+                                         { (yyval.ndt) = ndt_any_kind(ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2217 "grammar.c"
     break;
 
-  case 22:
-#line 227 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_scalar_kind(ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2100 "grammar.c" /* yacc.c:1646  */
+  case 22: /* dtype_nooption: SCALAR_KIND  */
+#line 231 "grammar.y"
+                                         { (yyval.ndt) = ndt_scalar_kind(ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2223 "grammar.c"
     break;
 
-  case 23:
-#line 228 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 2106 "grammar.c" /* yacc.c:1646  */
+  case 23: /* dtype_nooption: scalar  */
+#line 232 "grammar.y"
+                                         { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2229 "grammar.c"
     break;
 
-  case 24:
-#line 229 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 2112 "grammar.c" /* yacc.c:1646  */
+  case 24: /* dtype_nooption: tuple_type  */
+#line 233 "grammar.y"
+                                         { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2235 "grammar.c"
     break;
 
-  case 25:
-#line 230 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 2118 "grammar.c" /* yacc.c:1646  */
+  case 25: /* dtype_nooption: record_type  */
+#line 234 "grammar.y"
+                                         { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2241 "grammar.c"
     break;
 
-  case 26:
-#line 231 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 2124 "grammar.c" /* yacc.c:1646  */
+  case 26: /* dtype_nooption: function_type  */
+#line 235 "grammar.y"
+                                         { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2247 "grammar.c"
     break;
 
-  case 27:
-#line 232 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_nominal((yyvsp[0].string), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2130 "grammar.c" /* yacc.c:1646  */
+  case 27: /* dtype_nooption: NAME_LOWER  */
+#line 236 "grammar.y"
+                                         { (yyval.ndt) = ndt_nominal((yyvsp[0].string), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2253 "grammar.c"
     break;
 
-  case 28:
-#line 233 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_constr((yyvsp[-3].string), (yyvsp[-1].ndt), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2136 "grammar.c" /* yacc.c:1646  */
+  case 28: /* dtype_nooption: NAME_UPPER LPAREN dtype RPAREN  */
+#line 237 "grammar.y"
+                                         { (yyval.ndt) = ndt_constr((yyvsp[-3].string), (yyvsp[-1].ndt), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2259 "grammar.c"
     break;
 
-  case 29:
-#line 234 "grammar.y" /* yacc.c:1646  */
-    { (void)(yyvsp[-3].string); (void)(yyvsp[-1].attribute_seq); ndt_free((yyvsp[-3].string)); ndt_attr_seq_del((yyvsp[-1].attribute_seq)); (yyval.ndt) = NULL;
+  case 29: /* dtype_nooption: NAME_UPPER LPAREN attribute_seq RPAREN  */
+#line 238 "grammar.y"
+                                         { (void)(yyvsp[-3].string); (void)(yyvsp[-1].attribute_seq); ndt_free((yyvsp[-3].string)); ndt_attr_seq_del((yyvsp[-1].attribute_seq)); (yyval.ndt) = NULL;
                                             ndt_err_format(ctx, NDT_NotImplementedError, "general attributes are not implemented");
                                             YYABORT; }
-#line 2144 "grammar.c" /* yacc.c:1646  */
+#line 2267 "grammar.c"
     break;
 
-  case 30:
-#line 237 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_typevar((yyvsp[0].string), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2150 "grammar.c" /* yacc.c:1646  */
+  case 30: /* dtype_nooption: NAME_UPPER  */
+#line 241 "grammar.y"
+                                         { (yyval.ndt) = ndt_typevar((yyvsp[0].string), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2273 "grammar.c"
     break;
 
-  case 31:
-#line 240 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_primitive(Void, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2156 "grammar.c" /* yacc.c:1646  */
+  case 31: /* scalar: VOID  */
+#line 244 "grammar.y"
+                    { (yyval.ndt) = ndt_primitive(Void, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2279 "grammar.c"
     break;
 
-  case 32:
-#line 241 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_primitive(Bool, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2162 "grammar.c" /* yacc.c:1646  */
+  case 32: /* scalar: BOOL  */
+#line 245 "grammar.y"
+                    { (yyval.ndt) = ndt_primitive(Bool, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2285 "grammar.c"
     break;
 
-  case 33:
-#line 242 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_signed_kind(ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2168 "grammar.c" /* yacc.c:1646  */
+  case 33: /* scalar: SIGNED_KIND  */
+#line 246 "grammar.y"
+                    { (yyval.ndt) = ndt_signed_kind(ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2291 "grammar.c"
     break;
 
-  case 34:
-#line 243 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 2174 "grammar.c" /* yacc.c:1646  */
+  case 34: /* scalar: signed  */
+#line 247 "grammar.y"
+                    { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2297 "grammar.c"
     break;
 
-  case 35:
-#line 244 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_unsigned_kind(ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2180 "grammar.c" /* yacc.c:1646  */
+  case 35: /* scalar: UNSIGNED_KIND  */
+#line 248 "grammar.y"
+                    { (yyval.ndt) = ndt_unsigned_kind(ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2303 "grammar.c"
     break;
 
-  case 36:
-#line 245 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 2186 "grammar.c" /* yacc.c:1646  */
+  case 36: /* scalar: unsigned  */
+#line 249 "grammar.y"
+                    { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2309 "grammar.c"
     break;
 
-  case 37:
-#line 246 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_real_kind(ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2192 "grammar.c" /* yacc.c:1646  */
+  case 37: /* scalar: REAL_KIND  */
+#line 250 "grammar.y"
+                    { (yyval.ndt) = ndt_real_kind(ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2315 "grammar.c"
     break;
 
-  case 38:
-#line 247 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 2198 "grammar.c" /* yacc.c:1646  */
+  case 38: /* scalar: ieee_float  */
+#line 251 "grammar.y"
+                    { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2321 "grammar.c"
     break;
 
-  case 39:
-#line 248 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_complex_kind(ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2204 "grammar.c" /* yacc.c:1646  */
+  case 39: /* scalar: COMPLEX_KIND  */
+#line 252 "grammar.y"
+                    { (yyval.ndt) = ndt_complex_kind(ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2327 "grammar.c"
     break;
 
-  case 40:
-#line 249 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 2210 "grammar.c" /* yacc.c:1646  */
+  case 40: /* scalar: ieee_complex  */
+#line 253 "grammar.y"
+                    { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2333 "grammar.c"
     break;
 
-  case 41:
-#line 250 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 2216 "grammar.c" /* yacc.c:1646  */
+  case 41: /* scalar: alias  */
+#line 254 "grammar.y"
+                    { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2339 "grammar.c"
     break;
 
-  case 42:
-#line 251 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 2222 "grammar.c" /* yacc.c:1646  */
+  case 42: /* scalar: character  */
+#line 255 "grammar.y"
+                    { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2345 "grammar.c"
     break;
 
-  case 43:
-#line 252 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 2228 "grammar.c" /* yacc.c:1646  */
+  case 43: /* scalar: string  */
+#line 256 "grammar.y"
+                    { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2351 "grammar.c"
     break;
 
-  case 44:
-#line 253 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_fixed_string_kind(ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2234 "grammar.c" /* yacc.c:1646  */
+  case 44: /* scalar: FIXED_STRING_KIND  */
+#line 257 "grammar.y"
+                    { (yyval.ndt) = ndt_fixed_string_kind(ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2357 "grammar.c"
     break;
 
-  case 45:
-#line 254 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 2240 "grammar.c" /* yacc.c:1646  */
+  case 45: /* scalar: fixed_string  */
+#line 258 "grammar.y"
+                    { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2363 "grammar.c"
     break;
 
-  case 46:
-#line 255 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 2246 "grammar.c" /* yacc.c:1646  */
+  case 46: /* scalar: bytes  */
+#line 259 "grammar.y"
+                    { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2369 "grammar.c"
     break;
 
-  case 47:
-#line 256 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_fixed_bytes_kind(ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2252 "grammar.c" /* yacc.c:1646  */
+  case 47: /* scalar: FIXED_BYTES_KIND  */
+#line 260 "grammar.y"
+                    { (yyval.ndt) = ndt_fixed_bytes_kind(ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2375 "grammar.c"
     break;
 
-  case 48:
-#line 257 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 2258 "grammar.c" /* yacc.c:1646  */
+  case 48: /* scalar: fixed_bytes  */
+#line 261 "grammar.y"
+                    { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2381 "grammar.c"
     break;
 
-  case 49:
-#line 258 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 2264 "grammar.c" /* yacc.c:1646  */
+  case 49: /* scalar: categorical  */
+#line 262 "grammar.y"
+                    { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2387 "grammar.c"
     break;
 
-  case 50:
-#line 259 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = (yyvsp[0].ndt); }
-#line 2270 "grammar.c" /* yacc.c:1646  */
+  case 50: /* scalar: pointer  */
+#line 263 "grammar.y"
+                    { (yyval.ndt) = (yyvsp[0].ndt); }
+#line 2393 "grammar.c"
     break;
 
-  case 51:
-#line 262 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_primitive(Int8, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2276 "grammar.c" /* yacc.c:1646  */
+  case 51: /* signed: INT8  */
+#line 266 "grammar.y"
+           { (yyval.ndt) = ndt_primitive(Int8, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2399 "grammar.c"
     break;
 
-  case 52:
-#line 263 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_primitive(Int16, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2282 "grammar.c" /* yacc.c:1646  */
+  case 52: /* signed: INT16  */
+#line 267 "grammar.y"
+           { (yyval.ndt) = ndt_primitive(Int16, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2405 "grammar.c"
     break;
 
-  case 53:
-#line 264 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_primitive(Int32, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2288 "grammar.c" /* yacc.c:1646  */
+  case 53: /* signed: INT32  */
+#line 268 "grammar.y"
+           { (yyval.ndt) = ndt_primitive(Int32, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2411 "grammar.c"
     break;
 
-  case 54:
-#line 265 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_primitive(Int64, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2294 "grammar.c" /* yacc.c:1646  */
+  case 54: /* signed: INT64  */
+#line 269 "grammar.y"
+           { (yyval.ndt) = ndt_primitive(Int64, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2417 "grammar.c"
     break;
 
-  case 55:
-#line 268 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_primitive(Uint8, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2300 "grammar.c" /* yacc.c:1646  */
+  case 55: /* unsigned: UINT8  */
+#line 272 "grammar.y"
+         { (yyval.ndt) = ndt_primitive(Uint8, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2423 "grammar.c"
     break;
 
-  case 56:
-#line 269 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_primitive(Uint16, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2306 "grammar.c" /* yacc.c:1646  */
+  case 56: /* unsigned: UINT16  */
+#line 273 "grammar.y"
+         { (yyval.ndt) = ndt_primitive(Uint16, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2429 "grammar.c"
     break;
 
-  case 57:
-#line 270 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_primitive(Uint32, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2312 "grammar.c" /* yacc.c:1646  */
+  case 57: /* unsigned: UINT32  */
+#line 274 "grammar.y"
+         { (yyval.ndt) = ndt_primitive(Uint32, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2435 "grammar.c"
     break;
 
-  case 58:
-#line 271 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_primitive(Uint64, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2318 "grammar.c" /* yacc.c:1646  */
+  case 58: /* unsigned: UINT64  */
+#line 275 "grammar.y"
+         { (yyval.ndt) = ndt_primitive(Uint64, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2441 "grammar.c"
     break;
 
-  case 59:
-#line 274 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_primitive(Float16, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2324 "grammar.c" /* yacc.c:1646  */
+  case 59: /* ieee_float: FLOAT16  */
+#line 278 "grammar.y"
+           { (yyval.ndt) = ndt_primitive(Float16, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2447 "grammar.c"
     break;
 
-  case 60:
-#line 275 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_primitive(Float32, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2330 "grammar.c" /* yacc.c:1646  */
+  case 60: /* ieee_float: FLOAT32  */
+#line 279 "grammar.y"
+           { (yyval.ndt) = ndt_primitive(Float32, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2453 "grammar.c"
     break;
 
-  case 61:
-#line 276 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_primitive(Float64, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2336 "grammar.c" /* yacc.c:1646  */
+  case 61: /* ieee_float: FLOAT64  */
+#line 280 "grammar.y"
+           { (yyval.ndt) = ndt_primitive(Float64, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2459 "grammar.c"
     break;
 
-  case 62:
-#line 279 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_primitive(Complex64, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2342 "grammar.c" /* yacc.c:1646  */
+  case 62: /* ieee_complex: COMPLEX64  */
+#line 283 "grammar.y"
+                                { (yyval.ndt) = ndt_primitive(Complex64, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2465 "grammar.c"
     break;
 
-  case 63:
-#line 280 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_primitive(Complex128, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2348 "grammar.c" /* yacc.c:1646  */
+  case 63: /* ieee_complex: COMPLEX128  */
+#line 284 "grammar.y"
+                                { (yyval.ndt) = ndt_primitive(Complex128, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2471 "grammar.c"
     break;
 
-  case 64:
-#line 281 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_primitive(Complex64, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2354 "grammar.c" /* yacc.c:1646  */
+  case 64: /* ieee_complex: COMPLEX LPAREN FLOAT32 RPAREN  */
+#line 285 "grammar.y"
+                                { (yyval.ndt) = ndt_primitive(Complex64, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2477 "grammar.c"
     break;
 
-  case 65:
-#line 282 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_primitive(Complex128, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2360 "grammar.c" /* yacc.c:1646  */
+  case 65: /* ieee_complex: COMPLEX LPAREN FLOAT64 RPAREN  */
+#line 286 "grammar.y"
+                                { (yyval.ndt) = ndt_primitive(Complex128, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2483 "grammar.c"
     break;
 
-  case 66:
-#line 283 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_primitive(Complex128, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2366 "grammar.c" /* yacc.c:1646  */
+  case 66: /* ieee_complex: COMPLEX LPAREN REAL RPAREN  */
+#line 287 "grammar.y"
+                                { (yyval.ndt) = ndt_primitive(Complex128, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2489 "grammar.c"
     break;
 
-  case 67:
-#line 287 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_primitive(Int32, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2372 "grammar.c" /* yacc.c:1646  */
+  case 67: /* alias: INT  */
+#line 291 "grammar.y"
+           { (yyval.ndt) = ndt_primitive(Int32, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2495 "grammar.c"
     break;
 
-  case 68:
-#line 288 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_primitive(Float64, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2378 "grammar.c" /* yacc.c:1646  */
+  case 68: /* alias: REAL  */
+#line 292 "grammar.y"
+           { (yyval.ndt) = ndt_primitive(Float64, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2501 "grammar.c"
     break;
 
-  case 69:
-#line 289 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_primitive(Complex128, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2384 "grammar.c" /* yacc.c:1646  */
+  case 69: /* alias: COMPLEX  */
+#line 293 "grammar.y"
+           { (yyval.ndt) = ndt_primitive(Complex128, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2507 "grammar.c"
     break;
 
-  case 70:
-#line 291 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_from_alias(Intptr, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2390 "grammar.c" /* yacc.c:1646  */
+  case 70: /* alias: INTPTR  */
+#line 295 "grammar.y"
+           { (yyval.ndt) = ndt_from_alias(Intptr, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2513 "grammar.c"
     break;
 
-  case 71:
-#line 292 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_from_alias(Uintptr, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2396 "grammar.c" /* yacc.c:1646  */
+  case 71: /* alias: UINTPTR  */
+#line 296 "grammar.y"
+           { (yyval.ndt) = ndt_from_alias(Uintptr, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2519 "grammar.c"
     break;
 
-  case 72:
-#line 293 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_from_alias(Size, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2402 "grammar.c" /* yacc.c:1646  */
+  case 72: /* alias: SIZE  */
+#line 297 "grammar.y"
+           { (yyval.ndt) = ndt_from_alias(Size, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2525 "grammar.c"
     break;
 
-  case 73:
-#line 296 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_char(Utf32, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2408 "grammar.c" /* yacc.c:1646  */
+  case 73: /* character: CHAR  */
+#line 300 "grammar.y"
+                              { (yyval.ndt) = ndt_char(Utf32, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2531 "grammar.c"
     break;
 
-  case 74:
-#line 297 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_char((yyvsp[-1].encoding), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2414 "grammar.c" /* yacc.c:1646  */
+  case 74: /* character: CHAR LPAREN encoding RPAREN  */
+#line 301 "grammar.y"
+                              { (yyval.ndt) = ndt_char((yyvsp[-1].encoding), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2537 "grammar.c"
     break;
 
-  case 75:
-#line 300 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_string(ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2420 "grammar.c" /* yacc.c:1646  */
+  case 75: /* string: STRING  */
+#line 304 "grammar.y"
+         { (yyval.ndt) = ndt_string(ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2543 "grammar.c"
     break;
 
-  case 76:
-#line 303 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = mk_fixed_string((yyvsp[-1].string), Utf8, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2426 "grammar.c" /* yacc.c:1646  */
+  case 76: /* fixed_string: FIXED_STRING LPAREN INTEGER RPAREN  */
+#line 307 "grammar.y"
+                                                    { (yyval.ndt) = mk_fixed_string((yyvsp[-1].slice).start, (yyvsp[-1].slice).len, Utf8, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2549 "grammar.c"
     break;
 
-  case 77:
-#line 304 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = mk_fixed_string((yyvsp[-3].string), (yyvsp[-1].encoding), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2432 "grammar.c" /* yacc.c:1646  */
+  case 77: /* fixed_string: FIXED_STRING LPAREN INTEGER COMMA encoding RPAREN  */
+#line 308 "grammar.y"
+                                                    { (yyval.ndt) = mk_fixed_string((yyvsp[-3].slice).start, (yyvsp[-3].slice).len, (yyvsp[-1].encoding), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2555 "grammar.c"
     break;
 
-  case 78:
-#line 307 "grammar.y" /* yacc.c:1646  */
-    { (yyval.encoding) = ndt_encoding_from_string((yyvsp[0].string), ctx); if ((yyval.encoding) == ErrorEncoding) YYABORT; }
-#line 2438 "grammar.c" /* yacc.c:1646  */
+  case 78: /* encoding: STRINGLIT  */
+#line 311 "grammar.y"
+            { (yyval.encoding) = ndt_encoding_from_string((yyvsp[0].string), ctx); if ((yyval.encoding) == ErrorEncoding) YYABORT; }
+#line 2561 "grammar.c"
     break;
 
-  case 79:
-#line 310 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = mk_bytes((yyvsp[-1].attribute_seq), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2444 "grammar.c" /* yacc.c:1646  */
+  case 79: /* bytes: BYTES LPAREN attribute_seq RPAREN  */
+#line 314 "grammar.y"
+                                    { (yyval.ndt) = mk_bytes((yyvsp[-1].attribute_seq), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2567 "grammar.c"
     break;
 
-  case 80:
-#line 313 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = mk_fixed_bytes((yyvsp[-1].attribute_seq), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2450 "grammar.c" /* yacc.c:1646  */
+  case 80: /* fixed_bytes: FIXED_BYTES LPAREN attribute_seq RPAREN  */
+#line 317 "grammar.y"
+                                          { (yyval.ndt) = mk_fixed_bytes((yyvsp[-1].attribute_seq), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2573 "grammar.c"
     break;
 
-  case 81:
-#line 316 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = ndt_pointer((yyvsp[-1].ndt), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2456 "grammar.c" /* yacc.c:1646  */
+  case 81: /* pointer: POINTER LPAREN datashape RPAREN  */
+#line 320 "grammar.y"
+                                  { (yyval.ndt) = ndt_pointer((yyvsp[-1].ndt), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2579 "grammar.c"
     break;
 
-  case 82:
-#line 319 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = mk_categorical((yyvsp[-1].typed_value_seq), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2462 "grammar.c" /* yacc.c:1646  */
+  case 82: /* categorical: CATEGORICAL LPAREN typed_value_seq RPAREN  */
+#line 323 "grammar.y"
+                                            { (yyval.ndt) = mk_categorical((yyvsp[-1].typed_value_seq), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2585 "grammar.c"
     break;
 
-  case 83:
-#line 322 "grammar.y" /* yacc.c:1646  */
-    { (yyval.typed_value_seq) = ndt_memory_seq_new((yyvsp[0].typed_value), ctx); if ((yyval.typed_value_seq) == NULL) YYABORT; }
-#line 2468 "grammar.c" /* yacc.c:1646  */
+  case 83: /* typed_value_seq: typed_value  */
+#line 326 "grammar.y"
+                                    { (yyval.typed_value_seq) = ndt_memory_seq_new((yyvsp[0].typed_value), ctx); if ((yyval.typed_value_seq) == NULL) YYABORT; }
+#line 2591 "grammar.c"
     break;
 
-  case 84:
-#line 323 "grammar.y" /* yacc.c:1646  */
-    { (yyval.typed_value_seq) = ndt_memory_seq_append((yyvsp[-2].typed_value_seq), (yyvsp[0].typed_value), ctx); if ((yyval.typed_value_seq) == NULL) YYABORT; }
-#line 2474 "grammar.c" /* yacc.c:1646  */
+  case 84: /* typed_value_seq: typed_value_seq COMMA typed_value  */
+#line 327 "grammar.y"
+                                    { (yyval.typed_value_seq) = ndt_memory_seq_append((yyvsp[-2].typed_value_seq), (yyvsp[0].typed_value), ctx); if ((yyval.typed_value_seq) == NULL) YYABORT; }
+#line 2597 "grammar.c"
     break;
 
-  case 85:
-#line 326 "grammar.y" /* yacc.c:1646  */
-    { (yyval.typed_value) = ndt_memory_from_number((yyvsp[-2].string), (yyvsp[0].ndt), ctx); if ((yyval.typed_value) == NULL) YYABORT; }
-#line 2480 "grammar.c" /* yacc.c:1646  */
+  case 85: /* typed_value: INTEGER COLON datashape  */
+#line 330 "grammar.y"
+                              { (yyval.typed_value) = mk_memory_from_number((yyvsp[-2].slice).start, (yyvsp[-2].slice).len, (yyvsp[0].ndt), ctx); if ((yyval.typed_value) == NULL) YYABORT; }
+#line 2603 "grammar.c"
     break;
 
-  case 86:
-#line 327 "grammar.y" /* yacc.c:1646  */
-    { (yyval.typed_value) = ndt_memory_from_number((yyvsp[-2].string), (yyvsp[0].ndt), ctx); if ((yyval.typed_value) == NULL) YYABORT; }
-#line 2486 "grammar.c" /* yacc.c:1646  */
+  case 86: /* typed_value: FLOATNUMBER COLON datashape  */
+#line 331 "grammar.y"
+                              { (yyval.typed_value) = mk_memory_from_number((yyvsp[-2].slice).start, (yyvsp[-2].slice).len, (yyvsp[0].ndt), ctx); if ((yyval.typed_value) == NULL) YYABORT; }
+#line 2609 "grammar.c"
     break;
 
-  case 87:
-#line 328 "grammar.y" /* yacc.c:1646  */
-    { (yyval.typed_value) = ndt_memory_from_string((yyvsp[-2].string), (yyvsp[0].ndt), ctx); if ((yyval.typed_value) == NULL) YYABORT; }
-#line 2492 "grammar.c" /* yacc.c:1646  */
+  case 87: /* typed_value: STRINGLIT COLON datashape  */
+#line 332 "grammar.y"
+                              { (yyval.typed_value) = ndt_memory_from_string((yyvsp[-2].string), (yyvsp[0].ndt), ctx); if ((yyval.typed_value) == NULL) YYABORT; }
+#line 2615 "grammar.c"
     break;
 
-  case 88:
-#line 331 "grammar.y" /* yacc.c:1646  */
-    { (yyval.variadic_flag) = Nonvariadic; }
-#line 2498 "grammar.c" /* yacc.c:1646  */
+  case 88: /* variadic_flag: %empty  */
+#line 335 "grammar.y"
+              { (yyval.variadic_flag) = Nonvariadic; }
+#line 2621 "grammar.c"
     break;
 
-  case 89:
-#line 332 "grammar.y" /* yacc.c:1646  */
-    { (yyval.variadic_flag) = Variadic; }
-#line 2504 "grammar.c" /* yacc.c:1646  */
+  case 89: /* variadic_flag: ELLIPSIS  */
+#line 336 "grammar.y"
+              { (yyval.variadic_flag) = Variadic; }
+#line 2627 "grammar.c"
     break;
 
-  case 90:
-#line 335 "grammar.y" /* yacc.c:1646  */
-    { (yyval.variadic_flag) = Nonvariadic; }
-#line 2510 "grammar.c" /* yacc.c:1646  */
+  case 90: /* comma_variadic_flag: %empty  */
+#line 339 "grammar.y"
+                 { (yyval.variadic_flag) = Nonvariadic; }
+#line 2633 "grammar.c"
     break;
 
-  case 91:
-#line 336 "grammar.y" /* yacc.c:1646  */
-    { (yyval.variadic_flag) = Nonvariadic; }
-#line 2516 "grammar.c" /* yacc.c:1646  */
+  case 91: /* comma_variadic_flag: COMMA  */
+#line 340 "grammar.y"
+                 { (yyval.variadic_flag) = Nonvariadic; }
+#line 2639 "grammar.c"
     break;
 
-  case 92:
-#line 337 "grammar.y" /* yacc.c:1646  */
-    { (yyval.variadic_flag) = Variadic; }
-#line 2522 "grammar.c" /* yacc.c:1646  */
+  case 92: /* comma_variadic_flag: COMMA ELLIPSIS  */
+#line 341 "grammar.y"
+                 { (yyval.variadic_flag) = Variadic; }
+#line 2645 "grammar.c"
     break;
 
-  case 93:
-#line 340 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = mk_tuple((yyvsp[-1].variadic_flag), NULL, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2528 "grammar.c" /* yacc.c:1646  */
+  case 93: /* tuple_type: LPAREN variadic_flag RPAREN  */
+#line 344 "grammar.y"
+                                                    { (yyval.ndt) = mk_tuple((yyvsp[-1].variadic_flag), NULL, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2651 "grammar.c"
     break;
 
-  case 94:
-#line 341 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = mk_tuple((yyvsp[-1].variadic_flag), (yyvsp[-2].tuple_field_seq), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2534 "grammar.c" /* yacc.c:1646  */
+  case 94: /* tuple_type: LPAREN tuple_field_seq comma_variadic_flag RPAREN  */
+#line 345 "grammar.y"
+                                                    { (yyval.ndt) = mk_tuple((yyvsp[-1].variadic_flag), (yyvsp[-2].tuple_field_seq), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2657 "grammar.c"
     break;
 
-  case 95:
-#line 344 "grammar.y" /* yacc.c:1646  */
-    { (yyval.tuple_field_seq) = ndt_tuple_field_seq_new((yyvsp[0].tuple_field), ctx); if ((yyval.tuple_field_seq) == NULL) YYABORT; }
-#line 2540 "grammar.c" /* yacc.c:1646  */
+  case 95: /* tuple_field_seq: tuple_field  */
+#line 348 "grammar.y"
+                                    { (yyval.tuple_field_seq) = ndt_tuple_field_seq_new((yyvsp[0].tuple_field), ctx); if ((yyval.tuple_field_seq) == NULL) YYABORT; }
+#line 2663 "grammar.c"
     break;
 
-  case 96:
-#line 345 "grammar.y" /* yacc.c:1646  */
-    { (yyval.tuple_field_seq) = ndt_tuple_field_seq_append((yyvsp[-2].tuple_field_seq), (yyvsp[0].tuple_field), ctx); if ((yyval.tuple_field_seq) == NULL) YYABORT; }
-#line 2546 "grammar.c" /* yacc.c:1646  */
+  case 96: /* tuple_field_seq: tuple_field_seq COMMA tuple_field  */
+#line 349 "grammar.y"
+                                    { (yyval.tuple_field_seq) = ndt_tuple_field_seq_append((yyvsp[-2].tuple_field_seq), (yyvsp[0].tuple_field), ctx); if ((yyval.tuple_field_seq) == NULL) YYABORT; }
+#line 2669 "grammar.c"
     break;
 
-  case 97:
-#line 348 "grammar.y" /* yacc.c:1646  */
-    { (yyval.tuple_field) = mk_tuple_field((yyvsp[-1].ndt), (yyvsp[0].attribute_seq), ctx); if ((yyval.tuple_field) == NULL) YYABORT; }
-#line 2552 "grammar.c" /* yacc.c:1646  */
+  case 97: /* tuple_field: datashape attribute_seq_opt  */
+#line 352 "grammar.y"
+                              { (yyval.tuple_field) = mk_tuple_field((yyvsp[-1].ndt), (yyvsp[0].attribute_seq), ctx); if ((yyval.tuple_field) == NULL) YYABORT; }
+#line 2675 "grammar.c"
     break;
 
-  case 98:
-#line 351 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = mk_record((yyvsp[-1].variadic_flag), NULL, ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2558 "grammar.c" /* yacc.c:1646  */
+  case 98: /* record_type: LBRACE variadic_flag RBRACE  */
+#line 355 "grammar.y"
+                                                     { (yyval.ndt) = mk_record((yyvsp[-1].variadic_flag), NULL, ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2681 "grammar.c"
     break;
 
-  case 99:
-#line 352 "grammar.y" /* yacc.c:1646  */
-    { (yyval.ndt) = mk_record((yyvsp[-1].variadic_flag), (yyvsp[-2].record_field_seq), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2564 "grammar.c" /* yacc.c:1646  */
+  case 99: /* record_type: LBRACE record_field_seq comma_variadic_flag RBRACE  */
+#line 356 "grammar.y"
+                                                     { (yyval.ndt) = mk_record((yyvsp[-1].variadic_flag), (yyvsp[-2].record_field_seq), ctx); if ((yyval.ndt) == NULL) YYABORT; }
+#line 2687 "grammar.c"
     break;
 
-  case 100:
-#line 355 "grammar.y" /* yacc.c:1646  */
-    { (yyval.record_field_seq) = ndt_record_field_seq_new((yyvsp[0].record_field), ctx); if ((yyval.record_field_seq) == NULL) YYABORT; }
-#line 2570 "grammar.c" /* yacc.c:1646  */
+  case 100: /* record_field_seq: record_field  */
+#line 359 "grammar.y"
+                                       { (yyval.record_field_seq) = ndt_record_field_seq_new((yyvsp[0].record_field), ctx); if ((yyval.record_field_seq) == NULL) YYABORT; }
+#line 2693 "grammar.c"
     break;
 
-  case 101:
-#line 356 "grammar.y" /* yacc.c:1646  */
-    { (yyval.record_field_seq) = ndt_record_field_seq_append((yyvsp[-2].record_field_seq), (yyvsp[0].record_field), ctx); if ((yyval.record_field_seq) == NULL) YYABORT; }
-#line 2576 "grammar.c" /* yacc.c:1646  */
+  case 101: /* record_field_seq: record_field_seq COMMA record_field  */
+#line 360 "grammar.y"
+                                       { (yyval.record_field_seq) = ndt_record_field_seq_append((yyvsp[-2].record_field_seq), (yyvsp[0].record_field), ctx); if ((yyval.record_field_seq) == NULL) YYABORT; }
+#line 2699 "grammar.c"
     break;
 
-  case 102:
-#line 359 "grammar.y" /* yacc.c:1646  */
-    { (yyval.record_field) = mk_record_field((yyvsp[-3].string), (yyvsp[-1].ndt), (yyvsp[0].attribute_seq), ctx); if ((yyval.record_field) == NULL) YYABORT; }
-#line 2582 "grammar.c" /* yacc.c:1646  */
+  case 102: /* record_field: record_field_name COLON datashape attribute_seq_opt  */
+#line 363 "grammar.y"
+                                                      { (yyval.record_field) = mk_record_field((yyvsp[-3].string), (yyvsp[-1].ndt), (yyvsp[0].attribute_seq), ctx); if ((yyval.record_field) == NULL) YYABORT; }
+#line 2705 "grammar.c"
     break;
 
-  case 103:
-#line 362 "grammar.y" /* yacc.c:1646  */
-    { (yyval.string) = (yyvsp[0].string); if ((yyval.string) == NULL) YYABORT; }
-#line 2588 "grammar.c" /* yacc.c:1646  */
+  case 103: /* record_field_name: NAME_LOWER  */
+#line 366 "grammar.y"
+             { (yyval.string) = (yyvsp[0].string); if ((yyval.string) == NULL) YYABORT; }
+#line 2711 "grammar.c"
     break;
 
-  case 104:
-#line 363 "grammar.y" /* yacc.c:1646  */
-    { (yyval.string) = (yyvsp[0].string); if ((yyval.string) == NULL) YYABORT; }
-#line 2594 "grammar.c" /* yacc.c:1646  */
+  case 104: /* record_field_name: NAME_UPPER  */
+#line 367 "grammar.y"
+             { (yyval.string) = (yyvsp[0].string); if ((yyval.string) == NULL) YYABORT; }
+#line 2717 "grammar.c"
     break;
 
-  case 105:
-#line 364 "grammar.y" /* yacc.c:1646  */
-    { (yyval.string) = (yyvsp[0].string); if ((yyval.string) == NULL) YYABORT; }
-#line 2600 "grammar.c" /* yacc.c:1646  */
+  case 105: /* record_field_name: NAME_OTHER  */
+#line 368 "grammar.y"
+             { (yyval.string) = (yyvsp[0].string); if ((yyval.string) == NULL) YYABORT; }
+#line 2723 "grammar.c"
     break;
 
-  case 106:
-#line 367 "grammar.y" /* yacc.c:1646  */
-    { (yyval.attribute_seq) = NULL; }
-#line 2606 "grammar.c" /* yacc.c:1646  */
+  case 106: /* attribute_seq_opt: %empty  */
+#line 371 "grammar.y"
+                              { (yyval.attribute_seq) = NULL; }
+#line 2729 "grammar.c"
     break;
 
-  case 107:
-#line 368 "grammar.y" /* yacc.c:1646  */
-    { (yyval.attribute_seq) = (yyvsp[-1].attribute_seq); if ((yyval.attribute_seq) == NULL) YYABORT; }
-#line 2612 "grammar.c" /* yacc.c:1646  */
+  case 107: /* attribute_seq_opt: LBRACK attribute_seq RBRACK  */
+#line 372 "grammar.y"
+                              { (yyval.attribute_seq) = (yyvsp[-1].attribute_seq); if ((yyval.attribute_seq) == NULL) YYABORT; }
+#line 2735 "grammar.c"
     break;
 
-  case 108:
-#line 371 "grammar.y" /* yacc.c:1646  */
-    { (yyval.attribute_seq) = ndt_attr_seq_new((yyvsp[0].attribute), ctx); if ((yyval.attribute_seq) == NULL) YYABORT; }
-#line 2618 "grammar.c" /* yacc.c:1646  */
+  case 108: /* attribute_seq: attribute  */
+#line 375 "grammar.y"
+                                { (yyval.attribute_seq) = ndt_attr_seq_new((yyvsp[0].attribute), ctx); if ((yyval.attribute_seq) == NULL) YYABORT; }
+#line 2741 "grammar.c"
     break;
 
-  case 109:
-#line 372 "grammar.y" /* yacc.c:1646  */
-    { (yyval.attribute_seq) = ndt_attr_seq_append((yyvsp[-2].attribute_seq), (yyvsp[0].attribute), ctx); if ((yyval.attribute_seq) == NULL) YYABORT; }
-#line 2624 "grammar.c" /* yacc.c:1646  */
+  case 109: /* attribute_seq: attribute_seq COMMA attribute  */
+#line 376 "grammar.y"
+                                { (yyval.attribute_seq) = ndt_attr_seq_append((yyvsp[-2].attribute_seq), (yyvsp[0].attribute), ctx); if ((yyval.attribute_seq) == NULL) YYABORT; }
+#line 2747 "grammar.c"
     break;
 
-  case 110:
-#line 375 "grammar.y" /* yacc.c:1646  */
-    { (yyval.attribute) = ndt_attr_from_number((yyvsp[-2].string), (yyvsp[0].string), ctx); if ((yyval.attribute) == NULL) YYABORT; }
-#line 2630 "grammar.c" /* yacc.c:1646  */
+  case 110: /* attribute: NAME_LOWER EQUAL INTEGER  */
+#line 379 "grammar.y"
+                             { (yyval.attribute) = mk_attr_int64((yyvsp[-2].string), (yyvsp[0].slice).start, (yyvsp[0].slice).len, ctx); if ((yyval.attribute) == NULL) YYABORT; }
+#line 2753 "grammar.c"
     break;
 
-  case 111:
-#line 376 "grammar.y" /* yacc.c:1646  */
-    { (yyval.attribute) = ndt_attr_from_string((yyvsp[-2].string), (yyvsp[0].string), ctx); if ((yyval.attribute) == NULL) YYABORT; }
-#line 2636 "grammar.c" /* yacc.c:1646  */
+  case 111: /* attribute: NAME_LOWER EQUAL STRINGLIT  */
+#line 380 "grammar.y"
+                             { (yyval.attribute) = ndt_attr_from_string((yyvsp[-2].string), (yyvsp[0].string), ctx); if ((yyval.attribute) == NULL) YYABORT; }
+#line 2759 "grammar.c"
     break;
 
-  case 112:
-#line 377 "grammar.y" /* yacc.c:1646  */
-    { (yyval.attribute) = ndt_attr_from_type((yyvsp[-2].string), (yyvsp[0].ndt), ctx); if ((yyval.attribute) == NULL) YYABORT; }
-#line 2642 "grammar.c" /* yacc.c:1646  */
+  case 112: /* attribute: NAME_LOWER EQUAL datashape  */
+#line 381 "grammar.y"
+                             { (yyval.attribute) = ndt_attr_from_type((yyvsp[-2].string), (yyvsp[0].ndt), ctx); if ((yyval.attribute) == NULL) YYABORT; }
+#line 2765 "grammar.c"
     break;
 
-  case 113:
-#line 381 "grammar.y" /* yacc.c:1646  */
+  case 113: /* function_type: tuple_type RARROW datashape  */
+#line 385 "grammar.y"
     { (yyval.ndt) = mk_function_from_tuple((yyvsp[0].ndt), (yyvsp[-2].ndt), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2648 "grammar.c" /* yacc.c:1646  */
+#line 2771 "grammar.c"
     break;
 
-  case 114:
-#line 383 "grammar.y" /* yacc.c:1646  */
+  case 114: /* function_type: LPAREN record_field_seq comma_variadic_flag RPAREN RARROW datashape  */
+#line 387 "grammar.y"
     { (yyval.ndt) = mk_function((yyvsp[0].ndt), Nonvariadic, NULL, (yyvsp[-3].variadic_flag), (yyvsp[-4].record_field_seq), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2654 "grammar.c" /* yacc.c:1646  */
+#line 2777 "grammar.c"
     break;
 
-  case 115:
-#line 385 "grammar.y" /* yacc.c:1646  */
+  case 115: /* function_type: LPAREN ELLIPSIS COMMA record_field_seq comma_variadic_flag RPAREN RARROW datashape  */
+#line 389 "grammar.y"
     { (yyval.ndt) = mk_function((yyvsp[0].ndt), Variadic, NULL, (yyvsp[-3].variadic_flag), (yyvsp[-4].record_field_seq), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2660 "grammar.c" /* yacc.c:1646  */
+#line 2783 "grammar.c"
     break;
 
-  case 116:
-#line 387 "grammar.y" /* yacc.c:1646  */
+  case 116: /* function_type: LPAREN tuple_field_seq COMMA record_field_seq comma_variadic_flag RPAREN RARROW datashape  */
+#line 391 "grammar.y"
     { (yyval.ndt) = mk_function((yyvsp[0].ndt), Nonvariadic, (yyvsp[-6].tuple_field_seq), (yyvsp[-3].variadic_flag), (yyvsp[-4].record_field_seq), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2666 "grammar.c" /* yacc.c:1646  */
+#line 2789 "grammar.c"
     break;
 
-  case 117:
-#line 389 "grammar.y" /* yacc.c:1646  */
+  case 117: /* function_type: LPAREN tuple_field_seq COMMA ELLIPSIS COMMA record_field_seq comma_variadic_flag RPAREN RARROW datashape  */
+#line 393 "grammar.y"
     { (yyval.ndt) = mk_function((yyvsp[0].ndt), Variadic, (yyvsp[-8].tuple_field_seq), (yyvsp[-3].variadic_flag), (yyvsp[-4].record_field_seq), ctx); if ((yyval.ndt) == NULL) YYABORT; }
-#line 2672 "grammar.c" /* yacc.c:1646  */
+#line 2795 "grammar.c"
     break;
 
 
-#line 2676 "grammar.c" /* yacc.c:1646  */
+#line 2799 "grammar.c"
+
       default: break;
     }
   /* User semantic actions sometimes alter yychar, and that requires
@@ -2686,11 +2810,10 @@ yyreduce:
      case of YYERROR or YYBACKUP, subsequent parser actions might lead
      to an incorrect destructor call or verbose syntax error message
      before the lookahead is translated.  */
-  YY_SYMBOL_PRINT ("-> $$ =", yyr1[yyn], &yyval, &yyloc);
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
 
   YYPOPSTACK (yylen);
   yylen = 0;
-  YY_STACK_PRINT (yyss, yyssp);
 
   *++yyvsp = yyval;
   *++yylsp = yyloc;
@@ -2698,14 +2821,13 @@ yyreduce:
   /* Now 'shift' the result of the reduction.  Determine what state
      that goes to, based on the state we popped back to and the rule
      number reduced by.  */
-
-  yyn = yyr1[yyn];
-
-  yystate = yypgoto[yyn - YYNTOKENS] + *yyssp;
-  if (0 <= yystate && yystate <= YYLAST && yycheck[yystate] == *yyssp)
-    yystate = yytable[yystate];
-  else
-    yystate = yydefgoto[yyn - YYNTOKENS];
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
 
   goto yynewstate;
 
@@ -2716,59 +2838,54 @@ yyreduce:
 yyerrlab:
   /* Make sure we have latest lookahead translation.  See comments at
      user semantic actions for why this is necessary.  */
-  yytoken = yychar == YYEMPTY ? YYEMPTY : YYTRANSLATE (yychar);
-
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
   /* If not already recovering from an error, report this error.  */
   if (!yyerrstatus)
     {
       ++yynerrs;
-#if ! YYERROR_VERBOSE
-      yyerror (&yylloc, scanner, ast, ctx, YY_("syntax error"));
-#else
-# define YYSYNTAX_ERROR yysyntax_error (&yymsg_alloc, &yymsg, \
-                                        yyssp, yytoken)
       {
+        yypcontext_t yyctx
+          = {yyssp, yytoken, &yylloc};
         char const *yymsgp = YY_("syntax error");
         int yysyntax_error_status;
-        yysyntax_error_status = YYSYNTAX_ERROR;
+        yysyntax_error_status = yysyntax_error (&yymsg_alloc, &yymsg, &yyctx);
         if (yysyntax_error_status == 0)
           yymsgp = yymsg;
-        else if (yysyntax_error_status == 1)
+        else if (yysyntax_error_status == -1)
           {
             if (yymsg != yymsgbuf)
               YYSTACK_FREE (yymsg);
-            yymsg = (char *) YYSTACK_ALLOC (yymsg_alloc);
-            if (!yymsg)
+            yymsg = YY_CAST (char *,
+                             YYSTACK_ALLOC (YY_CAST (YYSIZE_T, yymsg_alloc)));
+            if (yymsg)
               {
-                yymsg = yymsgbuf;
-                yymsg_alloc = sizeof yymsgbuf;
-                yysyntax_error_status = 2;
+                yysyntax_error_status
+                  = yysyntax_error (&yymsg_alloc, &yymsg, &yyctx);
+                yymsgp = yymsg;
               }
             else
               {
-                yysyntax_error_status = YYSYNTAX_ERROR;
-                yymsgp = yymsg;
+                yymsg = yymsgbuf;
+                yymsg_alloc = sizeof yymsgbuf;
+                yysyntax_error_status = YYENOMEM;
               }
           }
         yyerror (&yylloc, scanner, ast, ctx, yymsgp);
-        if (yysyntax_error_status == 2)
-          goto yyexhaustedlab;
+        if (yysyntax_error_status == YYENOMEM)
+          YYNOMEM;
       }
-# undef YYSYNTAX_ERROR
-#endif
     }
 
   yyerror_range[1] = yylloc;
-
   if (yyerrstatus == 3)
     {
       /* If just tried and failed to reuse lookahead token after an
          error, discard it.  */
 
-      if (yychar <= YYEOF)
+      if (yychar <= ENDMARKER)
         {
           /* Return failure if at end of input.  */
-          if (yychar == YYEOF)
+          if (yychar == ENDMARKER)
             YYABORT;
         }
       else
@@ -2788,14 +2905,12 @@ yyerrlab:
 | yyerrorlab -- error raised explicitly by YYERROR.  |
 `---------------------------------------------------*/
 yyerrorlab:
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
 
-  /* Pacify compilers like GCC when the user code never invokes
-     YYERROR and the label yyerrorlab therefore never appears in user
-     code.  */
-  if (/*CONSTCOND*/ 0)
-     goto yyerrorlab;
-
-  yyerror_range[1] = yylsp[1-yylen];
   /* Do not reclaim the symbols of the rule whose action triggered
      this YYERROR.  */
   YYPOPSTACK (yylen);
@@ -2811,13 +2926,14 @@ yyerrorlab:
 yyerrlab1:
   yyerrstatus = 3;      /* Each real token shifted decrements this.  */
 
+  /* Pop stack until we find a state that shifts the error token.  */
   for (;;)
     {
       yyn = yypact[yystate];
       if (!yypact_value_is_default (yyn))
         {
-          yyn += YYTERROR;
-          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYTERROR)
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
             {
               yyn = yytable[yyn];
               if (0 < yyn)
@@ -2831,7 +2947,7 @@ yyerrlab1:
 
       yyerror_range[1] = *yylsp;
       yydestruct ("Error: popping",
-                  yystos[yystate], yyvsp, yylsp, scanner, ast, ctx);
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp, yylsp, scanner, ast, ctx);
       YYPOPSTACK (1);
       yystate = *yyssp;
       YY_STACK_PRINT (yyss, yyssp);
@@ -2842,13 +2958,11 @@ yyerrlab1:
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 
   yyerror_range[2] = yylloc;
-  /* Using YYLLOC is tempting, but would change the location of
-     the lookahead.  YYLOC is available though.  */
-  YYLLOC_DEFAULT (yyloc, yyerror_range, 2);
-  *++yylsp = yyloc;
+  ++yylsp;
+  YYLLOC_DEFAULT (*yylsp, yyerror_range, 2);
 
   /* Shift the error token.  */
-  YY_SYMBOL_PRINT ("Shifting", yystos[yyn], yyvsp, yylsp);
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
 
   yystate = yyn;
   goto yynewstate;
@@ -2859,26 +2973,30 @@ yyerrlab1:
 `-------------------------------------*/
 yyacceptlab:
   yyresult = 0;
-  goto yyreturn;
+  goto yyreturnlab;
+
 
 /*-----------------------------------.
 | yyabortlab -- YYABORT comes here.  |
 `-----------------------------------*/
 yyabortlab:
   yyresult = 1;
-  goto yyreturn;
+  goto yyreturnlab;
+
 
-#if !defined yyoverflow || YYERROR_VERBOSE
-/*-------------------------------------------------.
-| yyexhaustedlab -- memory exhaustion comes here.  |
-`-------------------------------------------------*/
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
 yyexhaustedlab:
   yyerror (&yylloc, scanner, ast, ctx, YY_("memory exhausted"));
   yyresult = 2;
-  /* Fall through.  */
-#endif
+  goto yyreturnlab;
 
-yyreturn:
+
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
   if (yychar != YYEMPTY)
     {
       /* Make sure we have latest lookahead translation.  See comments at
@@ -2894,16 +3012,15 @@ yyreturn:
   while (yyssp != yyss)
     {
       yydestruct ("Cleanup: popping",
-                  yystos[*yyssp], yyvsp, yylsp, scanner, ast, ctx);
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp, yylsp, scanner, ast, ctx);
       YYPOPSTACK (1);
     }
 #ifndef yyoverflow
   if (yyss != yyssa)
     YYSTACK_FREE (yyss);
 #endif
-#if YYERROR_VERBOSE
   if (yymsg != yymsgbuf)
     YYSTACK_FREE (yymsg);
-#endif
   return yyresult;
 }
+
@@ -1,8 +1,9 @@
-/* A Bison parser, made by GNU Bison 3.0.2.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
 /* Bison interface for Yacc-like parsers in C
 
-   Copyright (C) 1984, 1989-1990, 2000-2013 Free Software Foundation, Inc.
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
 
    This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
@@ -15,7 +16,7 @@
    GNU General Public License for more details.
 
    You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -30,6 +31,10 @@
    This special exception was added by the Free Software Foundation in
    version 2.2 of Bison.  */
 
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
 #ifndef YY_YY_GRAMMAR_H_INCLUDED
 # define YY_YY_GRAMMAR_H_INCLUDED
 /* Debug traces.  */
@@ -40,7 +45,7 @@
 extern int yydebug;
 #endif
 /* "%code requires" blocks.  */
-#line 53 "grammar.y" /* yacc.c:1909  */
+#line 54 "grammar.y"
 
   #include "ndtypes.h"
   #include "seq.h"
@@ -48,84 +53,87 @@ extern int yydebug;
   #define YY_TYPEDEF_YY_SCANNER_T
   typedef void * yyscan_t;
 
-#line 52 "grammar.h" /* yacc.c:1909  */
+#line 57 "grammar.h"
 
-/* Token type.  */
+/* Token kinds.  */
 #ifndef YYTOKENTYPE
 # define YYTOKENTYPE
   enum yytokentype
   {
-    ENDMARKER = 0,
-    ANY_KIND = 258,
-    OPTION = 259,
-    SCALAR_KIND = 260,
-    VOID = 261,
-    BOOL = 262,
-    SIGNED_KIND = 263,
-    INT8 = 264,
-    INT16 = 265,
-    INT32 = 266,
-    INT64 = 267,
-    UNSIGNED_KIND = 268,
-    UINT8 = 269,
-    UINT16 = 270,
-    UINT32 = 271,
-    UINT64 = 272,
-    REAL_KIND = 273,
-    FLOAT16 = 274,
-    FLOAT32 = 275,
-    FLOAT64 = 276,
-    COMPLEX_KIND = 277,
-    COMPLEX64 = 278,
-    COMPLEX128 = 279,
-    CATEGORICAL = 280,
-    REAL = 281,
-    COMPLEX = 282,
-    INT = 283,
-    INTPTR = 284,
-    UINTPTR = 285,
-    SIZE = 286,
-    CHAR = 287,
-    STRING = 288,
-    FIXED_STRING_KIND = 289,
-    FIXED_STRING = 290,
-    BYTES = 291,
-    FIXED_BYTES_KIND = 292,
-    FIXED_BYTES = 293,
-    POINTER = 294,
-    FIXED_DIM_KIND = 295,
-    FIXED = 296,
-    VAR = 297,
-    COMMA = 298,
-    COLON = 299,
-    LPAREN = 300,
-    RPAREN = 301,
-    LBRACE = 302,
-    RBRACE = 303,
-    LBRACK = 304,
-    RBRACK = 305,
-    STAR = 306,
-    ELLIPSIS = 307,
-    RARROW = 308,
-    EQUAL = 309,
-    QUESTIONMARK = 310,
-    BAR = 311,
-    ERRTOKEN = 312,
-    INTEGER = 313,
-    FLOATNUMBER = 314,
-    STRINGLIT = 315,
-    NAME_LOWER = 316,
-    NAME_UPPER = 317,
-    NAME_OTHER = 318
+    YYEMPTY = -2,
+    ENDMARKER = 0,                 /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    ANY_KIND = 258,                /* ANY_KIND  */
+    OPTION = 259,                  /* OPTION  */
+    SCALAR_KIND = 260,             /* SCALAR_KIND  */
+    VOID = 261,                    /* VOID  */
+    BOOL = 262,                    /* BOOL  */
+    SIGNED_KIND = 263,             /* SIGNED_KIND  */
+    INT8 = 264,                    /* INT8  */
+    INT16 = 265,                   /* INT16  */
+    INT32 = 266,                   /* INT32  */
+    INT64 = 267,                   /* INT64  */
+    UNSIGNED_KIND = 268,           /* UNSIGNED_KIND  */
+    UINT8 = 269,                   /* UINT8  */
+    UINT16 = 270,                  /* UINT16  */
+    UINT32 = 271,                  /* UINT32  */
+    UINT64 = 272,                  /* UINT64  */
+    REAL_KIND = 273,               /* REAL_KIND  */
+    FLOAT16 = 274,                 /* FLOAT16  */
+    FLOAT32 = 275,                 /* FLOAT32  */
+    FLOAT64 = 276,                 /* FLOAT64  */
+    COMPLEX_KIND = 277,            /* COMPLEX_KIND  */
+    COMPLEX64 = 278,               /* COMPLEX64  */
+    COMPLEX128 = 279,              /* COMPLEX128  */
+    CATEGORICAL = 280,             /* CATEGORICAL  */
+    REAL = 281,                    /* REAL  */
+    COMPLEX = 282,                 /* COMPLEX  */
+    INT = 283,                     /* INT  */
+    INTPTR = 284,                  /* INTPTR  */
+    UINTPTR = 285,                 /* UINTPTR  */
+    SIZE = 286,                    /* SIZE  */
+    CHAR = 287,                    /* CHAR  */
+    STRING = 288,                  /* STRING  */
+    FIXED_STRING_KIND = 289,       /* FIXED_STRING_KIND  */
+    FIXED_STRING = 290,            /* FIXED_STRING  */
+    BYTES = 291,                   /* BYTES  */
+    FIXED_BYTES_KIND = 292,        /* FIXED_BYTES_KIND  */
+    FIXED_BYTES = 293,             /* FIXED_BYTES  */
+    POINTER = 294,                 /* POINTER  */
+    FIXED_DIM_KIND = 295,          /* FIXED_DIM_KIND  */
+    FIXED = 296,                   /* FIXED  */
+    VAR = 297,                     /* VAR  */
+    COMMA = 298,                   /* COMMA  */
+    COLON = 299,                   /* COLON  */
+    LPAREN = 300,                  /* LPAREN  */
+    RPAREN = 301,                  /* RPAREN  */
+    LBRACE = 302,                  /* LBRACE  */
+    RBRACE = 303,                  /* RBRACE  */
+    LBRACK = 304,                  /* LBRACK  */
+    RBRACK = 305,                  /* RBRACK  */
+    STAR = 306,                    /* STAR  */
+    ELLIPSIS = 307,                /* ELLIPSIS  */
+    RARROW = 308,                  /* RARROW  */
+    EQUAL = 309,                   /* EQUAL  */
+    QUESTIONMARK = 310,            /* QUESTIONMARK  */
+    BAR = 311,                     /* BAR  */
+    ERRTOKEN = 312,                /* ERRTOKEN  */
+    INTEGER = 313,                 /* INTEGER  */
+    FLOATNUMBER = 314,             /* FLOATNUMBER  */
+    STRINGLIT = 315,               /* STRINGLIT  */
+    NAME_LOWER = 316,              /* NAME_LOWER  */
+    NAME_UPPER = 317,              /* NAME_UPPER  */
+    NAME_OTHER = 318               /* NAME_OTHER  */
   };
+  typedef enum yytokentype yytoken_kind_t;
 #endif
 
 /* Value type.  */
 #if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
-typedef union YYSTYPE YYSTYPE;
 union YYSTYPE
 {
-#line 81 "grammar.y" /* yacc.c:1909  */
+#line 82 "grammar.y"
 
     ndt_t *ndt;
     ndt_dim_t *dim;
@@ -141,9 +149,12 @@ union YYSTYPE
     enum ndt_variadic_flag variadic_flag;
     enum ndt_encoding encoding;
     char *string;
+    slice_t slice;
+
+#line 155 "grammar.h"
 
-#line 146 "grammar.h" /* yacc.c:1909  */
 };
+typedef union YYSTYPE YYSTYPE;
 # define YYSTYPE_IS_TRIVIAL 1
 # define YYSTYPE_IS_DECLARED 1
 #endif
@@ -164,14 +175,16 @@ struct YYLTYPE
 
 
 
+
 int yyparse (yyscan_t scanner, ndt_t **ast, ndt_context_t *ctx);
+
 /* "%code provides" blocks.  */
-#line 61 "grammar.y" /* yacc.c:1909  */
+#line 62 "grammar.y"
 
   #define YY_DECL extern int lexfunc(YYSTYPE *yylval_param, YYLTYPE *yylloc_param, yyscan_t yyscanner, ndt_context_t *ctx)
   extern int lexfunc(YYSTYPE *, YYLTYPE *, yyscan_t, ndt_context_t *);
   void yyerror(YYLTYPE *loc, yyscan_t scanner, ndt_t **ast, ndt_context_t *ctx, const char *msg);
 
-#line 176 "grammar.h" /* yacc.c:1909  */
+#line 189 "grammar.h"
 
 #endif /* !YY_YY_GRAMMAR_H_INCLUDED  */
@@ -27,6 +27,7 @@
  */
 
 
+#include <setjmp.h>
 #include "grammar.h"
 #include "lexer.h"
 
@@ -64,8 +65,8 @@ yylex(YYSTYPE *val, YYLTYPE *loc, yyscan_t scanner, ndt_context_t *ctx)
   void yyerror(YYLTYPE *loc, yyscan_t scanner, ndt_t **ast, ndt_context_t *ctx, const char *msg);
 }
 
-%pure-parser
-%error-verbose
+%define api.pure
+%define parse.error verbose
 
 %locations
 %initial-action {
@@ -93,6 +94,7 @@ yylex(YYSTYPE *val, YYLTYPE *loc, yyscan_t scanner, ndt_context_t *ctx)
     enum ndt_variadic_flag variadic_flag;
     enum ndt_encoding encoding;
     char *string;
+    slice_t slice;
 }
 
 %start input
@@ -164,9 +166,11 @@ COMMA COLON LPAREN RPAREN LBRACE RBRACE LBRACK RBRACK STAR ELLIPSIS
 RARROW EQUAL QUESTIONMARK BAR
 ERRTOKEN
 
+%token <slice>
+  INTEGER FLOATNUMBER
+
 %token <string>
-  INTEGER FLOATNUMBER STRINGLIT
-  NAME_LOWER NAME_UPPER NAME_OTHER
+  STRINGLIT NAME_LOWER NAME_UPPER NAME_OTHER
 
 %token ENDMARKER 0 "end of file"
 
@@ -211,8 +215,8 @@ dimension_seq:
 
 dimension:
   FIXED_DIM_KIND              { $$ = ndt_fixed_dim_kind(ctx); if ($$ == NULL) YYABORT; }
-| INTEGER attribute_seq_opt   { $$ = mk_fixed_dim($1, $2, ctx); if ($$ == NULL) YYABORT; }
-| FIXED LPAREN INTEGER RPAREN { $$ = mk_fixed_dim($3, NULL, ctx); if ($$ == NULL) YYABORT; }
+| INTEGER attribute_seq_opt   { $$ = mk_fixed_dim($1.start, $1.len, $2, ctx); if ($$ == NULL) YYABORT; }
+| FIXED LPAREN INTEGER RPAREN { $$ = mk_fixed_dim($3.start, $3.len, NULL, ctx); if ($$ == NULL) YYABORT; }
 | NAME_UPPER                  { $$ = ndt_symbolic_dim($1, ctx); if ($$ == NULL) YYABORT; }
 | VAR attribute_seq_opt       { $$ = mk_var_dim($2, ctx); if ($$ == NULL) YYABORT; }
 | ELLIPSIS                    { $$ = ndt_ellipsis_dim(ctx); if ($$ == NULL) YYABORT; }
@@ -300,8 +304,8 @@ string:
   STRING { $$ = ndt_string(ctx); if ($$ == NULL) YYABORT; }
 
 fixed_string:
-  FIXED_STRING LPAREN INTEGER RPAREN                { $$ = mk_fixed_string($3, Utf8, ctx); if ($$ == NULL) YYABORT; }
-| FIXED_STRING LPAREN INTEGER COMMA encoding RPAREN { $$ = mk_fixed_string($3, $5, ctx); if ($$ == NULL) YYABORT; }
+  FIXED_STRING LPAREN INTEGER RPAREN                { $$ = mk_fixed_string($3.start, $3.len, Utf8, ctx); if ($$ == NULL) YYABORT; }
+| FIXED_STRING LPAREN INTEGER COMMA encoding RPAREN { $$ = mk_fixed_string($3.start, $3.len, $5, ctx); if ($$ == NULL) YYABORT; }
 
 encoding:
   STRINGLIT { $$ = ndt_encoding_from_string($1, ctx); if ($$ == ErrorEncoding) YYABORT; }
@@ -323,8 +327,8 @@ typed_value_seq:
 | typed_value_seq COMMA typed_value { $$ = ndt_memory_seq_append($1, $3, ctx); if ($$ == NULL) YYABORT; }
 
 typed_value:
-  INTEGER COLON datashape     { $$ = ndt_memory_from_number($1, $3, ctx); if ($$ == NULL) YYABORT; }
-| FLOATNUMBER COLON datashape { $$ = ndt_memory_from_number($1, $3, ctx); if ($$ == NULL) YYABORT; }
+  INTEGER COLON datashape     { $$ = mk_memory_from_number($1.start, $1.len, $3, ctx); if ($$ == NULL) YYABORT; }
+| FLOATNUMBER COLON datashape { $$ = mk_memory_from_number($1.start, $1.len, $3, ctx); if ($$ == NULL) YYABORT; }
 | STRINGLIT COLON datashape   { $$ = ndt_memory_from_string($1, $3, ctx); if ($$ == NULL) YYABORT; }
 
 variadic_flag:
@@ -372,7 +376,7 @@ attribute_seq:
 | attribute_seq COMMA attribute { $$ = ndt_attr_seq_append($1, $3, ctx); if ($$ == NULL) YYABORT; }
 
 attribute:
-  NAME_LOWER EQUAL INTEGER   { $$ = ndt_attr_from_number($1, $3, ctx); if ($$ == NULL) YYABORT; }
+  NAME_LOWER EQUAL INTEGER   { $$ = mk_attr_int64($1, $3.start, $3.len, ctx); if ($$ == NULL) YYABORT; }
 | NAME_LOWER EQUAL STRINGLIT { $$ = ndt_attr_from_string($1, $3, ctx); if ($$ == NULL) YYABORT; }
 | NAME_LOWER EQUAL datashape { $$ = ndt_attr_from_type($1, $3, ctx); if ($$ == NULL) YYABORT; }
 
@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2016, Continuum Analytics, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * Redistributions of source code must retain the above copyright notice,
+ * 
+ * this list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "ndtypes.h"
+#include "hash.h"
+
+
+/*****************************************************************************/
+/*                            Structural hashing                             */
+/*****************************************************************************/
+
+/* FNV-1a, 64 bit.  The hash is consistent with ndt_equal(): fields that are
+   ignored by ndt_equal() (offsets, padding, strides, order) are not hashed.
+   It does not depend on addresses, so it is stable across processes. */
+#define FNV_OFFSET_BASIS 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+static uint64_t
+hash_bytes(uint64_t h, const void *data, size_t len)
+{
+    const unsigned char *cp = (const unsigned char *)data;
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        h ^= cp[i];
+        h *= FNV_PRIME;
+    }
+
+    return h;
+}
+
+uint64_t
+hash_data(const void *data, size_t len)
+{
+    return hash_bytes(FNV_OFFSET_BASIS, data, len);
+}
+
+static uint64_t
+hash_uint64(uint64_t h, uint64_t v)
+{
+    return hash_bytes(h, &v, sizeof v);
+}
+
+static uint64_t
+hash_string(uint64_t h, const char *s)
+{
+    /* include the terminating NUL to separate adjacent strings */
+    return hash_bytes(h, s, strlen(s)+1);
+}
+
+static uint64_t
+hash_double(uint64_t h, double d)
+{
+    /* 0.0 == -0.0 must hash to the same value */
+    if (d == 0) {
+        d = 0;
+    }
+    return hash_bytes(h, &d, sizeof d);
+}
+
+static uint64_t
+hash_memory(uint64_t h, const ndt_memory_t *mem)
+{
+    h = hash_uint64(h, mem->t->tag);
+
+    switch (mem->t->tag) {
+    case Bool: return hash_uint64(h, mem->v.Bool);
+    case Int8: return hash_uint64(h, (uint64_t)mem->v.Int8);
+    case Int16: return hash_uint64(h, (uint64_t)mem->v.Int16);
+    case Int32: return hash_uint64(h, (uint64_t)mem->v.Int32);
+    case Int64: return hash_uint64(h, (uint64_t)mem->v.Int64);
+    case Uint8: return hash_uint64(h, mem->v.Uint8);
+    case Uint16: return hash_uint64(h, mem->v.Uint16);
+    case Uint32: return hash_uint64(h, mem->v.Uint32);
+    case Uint64: return hash_uint64(h, mem->v.Uint64);
+    case Float32: return hash_double(h, mem->v.Float32);
+    case Float64: return hash_double(h, mem->v.Float64);
+    case String: return hash_string(h, mem->v.String);
+    default: return h;
+    }
+}
+
+uint64_t
+hash_tag(enum ndt tag)
+{
+    return hash_uint64(FNV_OFFSET_BASIS, tag);
+}
+
+/*
+ * Hash of a single node.  The children are represented by their cached
+ * hashes, so the cost does not depend on the size of the subtree.
+ */
+uint64_t
+hash_node(const ndt_t *t)
+{
+    uint64_t h = hash_tag(t->tag);
+    size_t i;
+
+    switch (t->tag) {
+    case FixedString:
+        h = hash_uint64(h, t->FixedString.size);
+        return hash_uint64(h, t->FixedString.encoding);
+    case FixedBytes:
+        h = hash_uint64(h, t->FixedBytes.size);
+        return hash_uint64(h, t->FixedBytes.align);
+    case Char:
+        return hash_uint64(h, t->Char.encoding);
+    case Bytes:
+        return hash_uint64(h, t->Bytes.target_align);
+    case Categorical:
+        h = hash_uint64(h, t->Categorical.ntypes);
+        for (i = 0; i < t->Categorical.ntypes; i++) {
+            h = hash_memory(h, &t->Categorical.types[i]);
+        }
+        return h;
+    case Pointer:
+        return hash_uint64(h, t->Pointer.type->hash);
+    case Tuple:
+        h = hash_uint64(h, t->Tuple.flag);
+        h = hash_uint64(h, t->Tuple.shape);
+        for (i = 0; i < t->Tuple.shape; i++) {
+            h = hash_uint64(h, t->Tuple.fields[i].type->hash);
+        }
+        return h;
+    case Record:
+        h = hash_uint64(h, t->Record.flag);
+        h = hash_uint64(h, t->Record.shape);
+        for (i = 0; i < t->Record.shape; i++) {
+            h = hash_string(h, t->Record.fields[i].name);
+            h = hash_uint64(h, t->Record.fields[i].type->hash);
+        }
+        return h;
+    case Function:
+        h = hash_uint64(h, t->Function.ret->hash);
+        h = hash_uint64(h, t->Function.pos->hash);
+        return hash_uint64(h, t->Function.kwds->hash);
+    case Typevar:
+        return hash_string(h, t->Typevar.name);
+    case Option:
+        return hash_uint64(h, t->Option.type->hash);
+    case Nominal:
+        return hash_string(h, t->Nominal.name);
+    case Constr:
+        h = hash_string(h, t->Constr.name);
+        return hash_uint64(h, t->Constr.type->hash);
+    case Array:
+        h = hash_uint64(h, t->Array.ndim);
+        for (i = 0; i < t->Array.ndim; i++) {
+            const ndt_dim_t *dim = &t->Array.dim[i];
+            h = hash_uint64(h, dim->tag);
+            if (dim->tag == FixedDim) {
+                h = hash_uint64(h, dim->FixedDim.shape);
+            }
+            else if (dim->tag == SymbolicDim) {
+                h = hash_string(h, dim->SymbolicDim.name);
+            }
+        }
+        return hash_uint64(h, t->Array.dtype->hash);
+    default:
+        return h;
+    }
+}
+
+
+
+/* Structural fingerprint of 't', computed when the type was constructed. */
+uint64_t
+ndt_hash(const ndt_t *t)
+{
+    return t->hash;
+}
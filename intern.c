@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2016, Continuum Analytics, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * Redistributions of source code must retain the above copyright notice,
+ * 
+ * this list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "ndtypes.h"
+#include "intern.h"
+#include "sync.h"
+
+
+/*****************************************************************************/
+/*                             Global intern table                           */
+/*****************************************************************************/
+
+/* Open addressing with linear probing.  The table owns the interned types,
+   which stay alive until ndt_finalize().  ndt_intern() is called from the
+   worker threads of the batch functions, so the table is guarded by
+   intern_lock. */
+typedef struct {
+    uint64_t hash;
+    ndt_t *type;
+} intern_entry_t;
+
+typedef struct {
+    size_t size;  /* power of two */
+    size_t used;
+    intern_entry_t *entries;
+} intern_table_t;
+
+#define INTERN_MINSIZE 64
+
+static intern_table_t intern_table = {0, 0, NULL};
+static ndt_mutex_t intern_lock = NDT_MUTEX_INIT;
+
+static int
+intern_table_resize(intern_table_t *tbl, size_t size, ndt_context_t *ctx)
+{
+    intern_entry_t *entries;
+    size_t i, k;
+
+    entries = ndt_alloc(size, sizeof *entries);
+    if (entries == NULL) {
+        ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+        return -1;
+    }
+
+    for (i = 0; i < size; i++) {
+        entries[i].hash = 0;
+        entries[i].type = NULL;
+    }
+
+    for (i = 0; i < tbl->size; i++) {
+        if (tbl->entries[i].type == NULL) {
+            continue;
+        }
+        k = tbl->entries[i].hash & (size-1);
+        while (entries[k].type != NULL) {
+            k = (k+1) & (size-1);
+        }
+        entries[k] = tbl->entries[i];
+    }
+
+    ndt_free(tbl->entries);
+    tbl->entries = entries;
+    tbl->size = size;
+
+    return 0;
+}
+
+const ndt_t *
+ndt_intern(ndt_t *t, ndt_context_t *ctx)
+{
+    intern_table_t *tbl = &intern_table;
+    const ndt_t *u;
+    uint64_t hash;
+    size_t size, k;
+
+    /* An interned type is immutable, and it was published under the lock.
+       The table holds its own reference, so the caller's can be dropped. */
+    if (t->interned) {
+        ndt_del(t);
+        return t;
+    }
+
+    ndt_mutex_lock(&intern_lock);
+
+    if (tbl->used >= tbl->size / 2) {
+        if (tbl->size > SIZE_MAX / 2) {
+            ndt_mutex_unlock(&intern_lock);
+            ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+            ndt_del(t);
+            return NULL;
+        }
+        size = tbl->size == 0 ? INTERN_MINSIZE : 2 * tbl->size;
+        if (intern_table_resize(tbl, size, ctx) < 0) {
+            ndt_mutex_unlock(&intern_lock);
+            ndt_del(t);
+            return NULL;
+        }
+    }
+
+    hash = t->hash;
+
+    for (k = hash & (tbl->size-1); tbl->entries[k].type != NULL;
+         k = (k+1) & (tbl->size-1)) {
+        if (tbl->entries[k].hash == hash && ndt_equal(tbl->entries[k].type, t)) {
+            u = tbl->entries[k].type;
+            ndt_mutex_unlock(&intern_lock);
+            ndt_del(t);
+            return u;
+        }
+    }
+
+    t->interned = 1;
+    tbl->entries[k].hash = hash;
+    tbl->entries[k].type = t;
+    tbl->used++;
+
+    ndt_mutex_unlock(&intern_lock);
+
+    return t;
+}
+
+void
+intern_table_del(void)
+{
+    intern_table_t *tbl = &intern_table;
+    size_t i;
+
+    ndt_mutex_lock(&intern_lock);
+
+    for (i = 0; i < tbl->size; i++) {
+        if (tbl->entries[i].type != NULL) {
+            tbl->entries[i].type->interned = 0;
+            ndt_del(tbl->entries[i].type);
+        }
+    }
+
+    ndt_free(tbl->entries);
+    tbl->size = 0;
+    tbl->used = 0;
+    tbl->entries = NULL;
+
+    ndt_mutex_unlock(&intern_lock);
+}
@@ -678,16 +678,19 @@ static yyconst flex_int32_t yy_rule_can_match_eol[67] =
 #undef fprintf
 #define fprintf(file, fmt, msg) fprintf_to_longjmp(fmt, msg, yyscanner)
 
-extern jmp_buf ndt_lexerror;
+/* The extra data of each scanner is the jmp_buf of the parse that owns it,
+   so concurrent parses in different threads do not share any state. */
+jmp_buf *yyget_extra(yyscan_t yyscanner);
+
 static void
 fprintf_to_longjmp(const char *fmt, const char *msg, yyscan_t yyscanner)
 {
-    (void)fmt; (void)msg; (void)yyscanner;
+    (void)fmt; (void)msg;
 
     /* We don't have access to the parse context here:  discard the error
        message, which is always either an allocation failure or an internal
        flex error. */
-    longjmp(ndt_lexerror, 1);
+    longjmp(*yyget_extra(yyscanner), 1);
 }
 
 #undef yyalloc
@@ -719,7 +722,7 @@ yyfree(void *ptr,yyscan_t yyscanner)
 }
 
 #define YY_NO_INPUT 1
-#line 723 "lexer.c"
+#line 726 "lexer.c"
 
 #define INITIAL 0
 
@@ -731,7 +734,7 @@ yyfree(void *ptr,yyscan_t yyscanner)
 #include <unistd.h>
 #endif
 
-#define YY_EXTRA_TYPE ndt_context_t *
+#define YY_EXTRA_TYPE jmp_buf *
 
 /* Holds the entire state of the reentrant scanner. */
 struct yyguts_t
@@ -961,10 +964,10 @@ YY_DECL
 	register int yy_act;
     struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
 
-#line 126 "lexer.l"
+#line 129 "lexer.l"
 
 
-#line 968 "lexer.c"
+#line 971 "lexer.c"
 
     yylval = yylval_param;
 
@@ -1061,7 +1064,7 @@ do_action:	/* This label is used only to access EOF actions. */
 
 case 1:
 YY_RULE_SETUP
-#line 128 "lexer.l"
+#line 131 "lexer.l"
 {
 yycolumn = 1;
 
@@ -1076,331 +1079,331 @@ yycolumn = 1;
 	YY_BREAK
 case 2:
 YY_RULE_SETUP
-#line 140 "lexer.l"
+#line 143 "lexer.l"
 { return ANY_KIND; }
 	YY_BREAK
 case 3:
 YY_RULE_SETUP
-#line 141 "lexer.l"
+#line 144 "lexer.l"
 { return SCALAR_KIND; }
 	YY_BREAK
 case 4:
 YY_RULE_SETUP
-#line 143 "lexer.l"
+#line 146 "lexer.l"
 { return VOID; }
 	YY_BREAK
 case 5:
 YY_RULE_SETUP
-#line 144 "lexer.l"
+#line 147 "lexer.l"
 { return BOOL; }
 	YY_BREAK
 case 6:
 YY_RULE_SETUP
-#line 146 "lexer.l"
+#line 149 "lexer.l"
 { return SIGNED_KIND; }
 	YY_BREAK
 case 7:
 YY_RULE_SETUP
-#line 147 "lexer.l"
+#line 150 "lexer.l"
 { return INT8; }
 	YY_BREAK
 case 8:
 YY_RULE_SETUP
-#line 148 "lexer.l"
+#line 151 "lexer.l"
 { return INT16; }
 	YY_BREAK
 case 9:
 YY_RULE_SETUP
-#line 149 "lexer.l"
+#line 152 "lexer.l"
 { return INT32; }
 	YY_BREAK
 case 10:
 YY_RULE_SETUP
-#line 150 "lexer.l"
+#line 153 "lexer.l"
 { return INT64; }
 	YY_BREAK
 case 11:
 YY_RULE_SETUP
-#line 152 "lexer.l"
+#line 155 "lexer.l"
 { return UNSIGNED_KIND; }
 	YY_BREAK
 case 12:
 YY_RULE_SETUP
-#line 153 "lexer.l"
+#line 156 "lexer.l"
 { return UINT8; }
 	YY_BREAK
 case 13:
 YY_RULE_SETUP
-#line 154 "lexer.l"
+#line 157 "lexer.l"
 { return UINT16; }
 	YY_BREAK
 case 14:
 YY_RULE_SETUP
-#line 155 "lexer.l"
+#line 158 "lexer.l"
 { return UINT32; }
 	YY_BREAK
 case 15:
 YY_RULE_SETUP
-#line 156 "lexer.l"
+#line 159 "lexer.l"
 { return UINT64; }
 	YY_BREAK
 case 16:
 YY_RULE_SETUP
-#line 158 "lexer.l"
+#line 161 "lexer.l"
 { return REAL_KIND; }
 	YY_BREAK
 case 17:
 YY_RULE_SETUP
-#line 159 "lexer.l"
+#line 162 "lexer.l"
 { return FLOAT16; }
 	YY_BREAK
 case 18:
 YY_RULE_SETUP
-#line 160 "lexer.l"
+#line 163 "lexer.l"
 { return FLOAT32; }
 	YY_BREAK
 case 19:
 YY_RULE_SETUP
-#line 161 "lexer.l"
+#line 164 "lexer.l"
 { return FLOAT64; }
 	YY_BREAK
 case 20:
 YY_RULE_SETUP
-#line 163 "lexer.l"
+#line 166 "lexer.l"
 { return COMPLEX_KIND; }
 	YY_BREAK
 case 21:
 YY_RULE_SETUP
-#line 164 "lexer.l"
+#line 167 "lexer.l"
 { return COMPLEX64; }
 	YY_BREAK
 case 22:
 YY_RULE_SETUP
-#line 165 "lexer.l"
+#line 168 "lexer.l"
 { return COMPLEX128; }
 	YY_BREAK
 case 23:
 YY_RULE_SETUP
-#line 167 "lexer.l"
+#line 170 "lexer.l"
 { return INTPTR; }
 	YY_BREAK
 case 24:
 YY_RULE_SETUP
-#line 168 "lexer.l"
+#line 171 "lexer.l"
 { return UINTPTR; }
 	YY_BREAK
 case 25:
 YY_RULE_SETUP
-#line 169 "lexer.l"
+#line 172 "lexer.l"
 { return SIZE; }
 	YY_BREAK
 case 26:
 YY_RULE_SETUP
-#line 170 "lexer.l"
+#line 173 "lexer.l"
 { return REAL; }
 	YY_BREAK
 case 27:
 YY_RULE_SETUP
-#line 171 "lexer.l"
+#line 174 "lexer.l"
 { return COMPLEX; }
 	YY_BREAK
 case 28:
 YY_RULE_SETUP
-#line 172 "lexer.l"
+#line 175 "lexer.l"
 { return INT; }
 	YY_BREAK
 case 29:
 YY_RULE_SETUP
-#line 173 "lexer.l"
+#line 176 "lexer.l"
 { return CHAR; }
 	YY_BREAK
 case 30:
 YY_RULE_SETUP
-#line 174 "lexer.l"
+#line 177 "lexer.l"
 { return STRING; }
 	YY_BREAK
 case 31:
 YY_RULE_SETUP
-#line 175 "lexer.l"
+#line 178 "lexer.l"
 { return BYTES; }
 	YY_BREAK
 case 32:
 YY_RULE_SETUP
-#line 177 "lexer.l"
+#line 180 "lexer.l"
 { return FIXED_STRING_KIND; }
 	YY_BREAK
 case 33:
 YY_RULE_SETUP
-#line 178 "lexer.l"
+#line 181 "lexer.l"
 { return FIXED_STRING; }
 	YY_BREAK
 case 34:
 YY_RULE_SETUP
-#line 180 "lexer.l"
+#line 183 "lexer.l"
 { return FIXED_BYTES_KIND; }
 	YY_BREAK
 case 35:
 YY_RULE_SETUP
-#line 181 "lexer.l"
+#line 184 "lexer.l"
 { return FIXED_BYTES; }
 	YY_BREAK
 case 36:
 YY_RULE_SETUP
-#line 183 "lexer.l"
+#line 186 "lexer.l"
 { return CATEGORICAL; }
 	YY_BREAK
 case 37:
 YY_RULE_SETUP
-#line 185 "lexer.l"
+#line 188 "lexer.l"
 { return POINTER; }
 	YY_BREAK
 case 38:
 YY_RULE_SETUP
-#line 187 "lexer.l"
+#line 190 "lexer.l"
 { return OPTION; }
 	YY_BREAK
 case 39:
 YY_RULE_SETUP
-#line 189 "lexer.l"
+#line 192 "lexer.l"
 { return FIXED_DIM_KIND; }
 	YY_BREAK
 case 40:
 YY_RULE_SETUP
-#line 190 "lexer.l"
+#line 193 "lexer.l"
 { return FIXED; }
 	YY_BREAK
 case 41:
 YY_RULE_SETUP
-#line 191 "lexer.l"
+#line 194 "lexer.l"
 { return VAR; }
 	YY_BREAK
 case 42:
 YY_RULE_SETUP
-#line 193 "lexer.l"
+#line 196 "lexer.l"
 { return ELLIPSIS; }
 	YY_BREAK
 case 43:
 YY_RULE_SETUP
-#line 194 "lexer.l"
+#line 197 "lexer.l"
 { return RARROW; }
 	YY_BREAK
 case 44:
 YY_RULE_SETUP
-#line 195 "lexer.l"
+#line 198 "lexer.l"
 { return COMMA; }
 	YY_BREAK
 case 45:
 YY_RULE_SETUP
-#line 196 "lexer.l"
+#line 199 "lexer.l"
 { return COLON; }
 	YY_BREAK
 case 46:
 YY_RULE_SETUP
-#line 197 "lexer.l"
+#line 200 "lexer.l"
 { return LPAREN; }
 	YY_BREAK
 case 47:
 YY_RULE_SETUP
-#line 198 "lexer.l"
+#line 201 "lexer.l"
 { return RPAREN; }
 	YY_BREAK
 case 48:
 YY_RULE_SETUP
-#line 199 "lexer.l"
+#line 202 "lexer.l"
 { return LBRACE; }
 	YY_BREAK
 case 49:
 YY_RULE_SETUP
-#line 200 "lexer.l"
+#line 203 "lexer.l"
 { return RBRACE; }
 	YY_BREAK
 case 50:
 YY_RULE_SETUP
-#line 201 "lexer.l"
+#line 204 "lexer.l"
 { return LBRACK; }
 	YY_BREAK
 case 51:
 YY_RULE_SETUP
-#line 202 "lexer.l"
+#line 205 "lexer.l"
 { return RBRACK; }
 	YY_BREAK
 case 52:
 YY_RULE_SETUP
-#line 203 "lexer.l"
+#line 206 "lexer.l"
 { return STAR; }
 	YY_BREAK
 case 53:
 YY_RULE_SETUP
-#line 204 "lexer.l"
+#line 207 "lexer.l"
 { return EQUAL; }
 	YY_BREAK
 case 54:
 YY_RULE_SETUP
-#line 205 "lexer.l"
+#line 208 "lexer.l"
 { return QUESTIONMARK; }
 	YY_BREAK
 case 55:
 YY_RULE_SETUP
-#line 206 "lexer.l"
+#line 209 "lexer.l"
 { return BAR; }
 	YY_BREAK
 case 56:
 YY_RULE_SETUP
-#line 208 "lexer.l"
+#line 211 "lexer.l"
 { yylval->string = ndt_strdup(yytext, ctx); if (yylval->string == NULL) return ERRTOKEN; return NAME_LOWER; }
 	YY_BREAK
 case 57:
 YY_RULE_SETUP
-#line 209 "lexer.l"
+#line 212 "lexer.l"
 { yylval->string = ndt_strdup(yytext, ctx); if (yylval->string == NULL) return ERRTOKEN; return NAME_UPPER; }
 	YY_BREAK
 case 58:
 YY_RULE_SETUP
-#line 210 "lexer.l"
+#line 213 "lexer.l"
 { yylval->string = ndt_strdup(yytext, ctx); if (yylval->string == NULL) return ERRTOKEN; return NAME_OTHER; }
 	YY_BREAK
 case 59:
 YY_RULE_SETUP
-#line 212 "lexer.l"
+#line 215 "lexer.l"
 { yylval->string = mk_stringlit(yytext, ctx); if (yylval->string == NULL) return ERRTOKEN; return STRINGLIT; }
 	YY_BREAK
 case 60:
 YY_RULE_SETUP
-#line 213 "lexer.l"
-{ yylval->string = ndt_strdup(yytext, ctx); if (yylval->string == NULL) return ERRTOKEN; return INTEGER; }
+#line 216 "lexer.l"
+{ yylval->slice.start = yytext; yylval->slice.len = (size_t)yyleng; return INTEGER; }
 	YY_BREAK
 case 61:
 YY_RULE_SETUP
-#line 214 "lexer.l"
-{ yylval->string = ndt_strdup(yytext, ctx); if (yylval->string == NULL) return ERRTOKEN; return FLOATNUMBER; }
+#line 217 "lexer.l"
+{ yylval->slice.start = yytext; yylval->slice.len = (size_t)yyleng; return FLOATNUMBER; }
 	YY_BREAK
 case 62:
 /* rule 62 can match eol */
 YY_RULE_SETUP
-#line 216 "lexer.l"
+#line 219 "lexer.l"
 { yycolumn = 1; }
 	YY_BREAK
 case 63:
 YY_RULE_SETUP
-#line 217 "lexer.l"
+#line 220 "lexer.l"
 {} /* ignore */
 	YY_BREAK
 case 64:
 YY_RULE_SETUP
-#line 218 "lexer.l"
+#line 221 "lexer.l"
 {} /* ignore */
 	YY_BREAK
 case 65:
 YY_RULE_SETUP
-#line 219 "lexer.l"
+#line 222 "lexer.l"
 { return ERRTOKEN; }
 	YY_BREAK
 case 66:
 YY_RULE_SETUP
-#line 221 "lexer.l"
+#line 224 "lexer.l"
 YY_FATAL_ERROR( "flex scanner jammed" );
 	YY_BREAK
-#line 1404 "lexer.c"
+#line 1407 "lexer.c"
 case YY_STATE_EOF(INITIAL):
 	yyterminate();
 
@@ -2523,7 +2526,7 @@ static int yy_flex_strlen (yyconst char * s , yyscan_t yyscanner)
 
 #define YYTABLES_NAME "yytables"
 
-#line 221 "lexer.l"
+#line 224 "lexer.l"
 
 
 
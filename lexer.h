@@ -240,7 +240,7 @@ void yyfree (void * ,yyscan_t yyscanner );
 #include <unistd.h>
 #endif
 
-#define YY_EXTRA_TYPE ndt_context_t *
+#define YY_EXTRA_TYPE jmp_buf *
 
 int yylex_init (yyscan_t* scanner);
 
@@ -33,6 +33,7 @@
 #include <string.h>
 #include <stdarg.h>
 #include "ndtypes.h"
+#include "pool.h"
 #include "symtable.h"
 
 
@@ -197,13 +198,10 @@ match_categorical(ndt_memory_t *p, size_t plen,
     return 1;
 }
 
+/* Match nodes that do not contain type variables. */
 static int
-match_datashape(const ndt_t *p, const ndt_t *c,
-                symtable_t *tbl,
-                ndt_context_t *ctx)
+match_leaf(const ndt_t *p, const ndt_t *c)
 {
-    int n;
-
     switch (p->tag) {
     case AnyKind:
         return 1;
@@ -244,6 +242,27 @@ match_datashape(const ndt_t *p, const ndt_t *c,
         return c->tag == Categorical &&
                match_categorical(p->Categorical.types, p->Categorical.ntypes,
                                  c->Categorical.types, c->Categorical.ntypes);
+    case Nominal:
+        /* Assume that the type has been created through ndt_nominal(), in
+           which case the name is guaranteed to be unique and present in the
+           typedef table. */
+        return c->tag == Nominal && strcmp(p->Nominal.name, c->Nominal.name) == 0;
+    case Constr:
+        return c->tag == Constr && strcmp(p->Constr.name, c->Constr.name) == 0 &&
+               ndt_equal(p->Constr.type, c->Constr.type);
+    default: /* NOT REACHED */
+        abort();
+    }
+}
+
+static int
+match_datashape(const ndt_t *p, const ndt_t *c,
+                symtable_t *tbl,
+                ndt_context_t *ctx)
+{
+    int n;
+
+    switch (p->tag) {
     case Pointer:
         if (c->tag != Pointer) return 0;
         return match_datashape(p->Pointer.type, c->Pointer.type, tbl, ctx);
@@ -280,14 +299,6 @@ match_datashape(const ndt_t *p, const ndt_t *c,
     case Option:
         if (c->tag != Option) return 0;
         return match_datashape(p->Option.type, c->Option.type, tbl, ctx);
-    case Nominal:
-        /* Assume that the type has been created through ndt_nominal(), in
-           which case the name is guaranteed to be unique and present in the
-           typedef table. */
-        return c->tag == Nominal && strcmp(p->Nominal.name, c->Nominal.name) == 0;
-    case Constr:
-        return c->tag == Constr && strcmp(p->Constr.name, c->Constr.name) == 0 &&
-               ndt_equal(p->Constr.type, c->Constr.type);
     case Array:
         if (c->tag != Array) return 0;
         n = match_dimensions(p->Array.dim, p->Array.ndim,
@@ -295,25 +306,1373 @@ match_datashape(const ndt_t *p, const ndt_t *c,
                              tbl, ctx);
         if (n <= 0) return n;
         return match_datashape(p->Array.dtype, c->Array.dtype, tbl, ctx);
-    default: /* NOT REACHED */
-        abort();
+    default:
+        return match_leaf(p, c);
     }
 }
 
 int
 ndt_match(const ndt_t *p, const ndt_t *c, ndt_context_t *ctx)
 {
-    symtable_t *tbl;
+    symtable_t tbl;
     int ret;
 
-    tbl = symtable_new(ctx);
-    if (tbl == NULL) {
-        return -1;
+    symtable_init(&tbl);
+    ret = match_datashape(p, c, &tbl, ctx);
+    symtable_clear(&tbl);
+
+    return ret;
+}
+
+
+
+
+/*****************************************************************************/
+/*                                Unification                                */
+/*****************************************************************************/
+
+/*
+ * ndt_unify() is ndt_match() that keeps the bindings.  The bindings borrow
+ * the names of the pattern and the types of the candidate, so both must
+ * stay alive while the bindings are used.
+ */
+struct ndt_bindings {
+    symtable_t tbl;
+};
+
+ndt_bindings_t *
+ndt_bindings_new(ndt_context_t *ctx)
+{
+    ndt_bindings_t *b;
+
+    b = ndt_alloc(1, sizeof *b);
+    if (b == NULL) {
+        ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+        return NULL;
+    }
+    symtable_init(&b->tbl);
+
+    return b;
+}
+
+void
+ndt_bindings_del(ndt_bindings_t *b)
+{
+    if (b == NULL) {
+        return;
+    }
+
+    symtable_clear(&b->tbl);
+    ndt_free(b);
+}
+
+/* Return the type that is bound to the type variable 'name' or NULL. */
+const ndt_t *
+ndt_bindings_type(const ndt_bindings_t *b, const char *name)
+{
+    symtable_entry_t v = symtable_find(&b->tbl, name);
+
+    return v.tag == TypeEntry ? v.TypeEntry : NULL;
+}
+
+/* Return the shape that is bound to the symbolic dimension 'name' or -1. */
+int64_t
+ndt_bindings_shape(const ndt_bindings_t *b, const char *name)
+{
+    symtable_entry_t v = symtable_find(&b->tbl, name);
+
+    return v.tag == SizeEntry ? (int64_t)v.SizeEntry : -1;
+}
+
+/*
+ * Match 'p' against 'c' and store the bindings in 'b'.  Return 1 if 'c'
+ * matches, 0 if it does not and -1 on error.  The previous bindings are
+ * discarded, and 'b' is empty unless the return value is 1.
+ */
+int
+ndt_unify(const ndt_t *p, const ndt_t *c, ndt_bindings_t *b, ndt_context_t *ctx)
+{
+    int ret;
+
+    symtable_clear(&b->tbl);
+    symtable_init(&b->tbl);
+
+    ret = match_datashape(p, c, &b->tbl, ctx);
+    if (ret != 1) {
+        symtable_clear(&b->tbl);
+        symtable_init(&b->tbl);
     }
 
-    ret = match_datashape(p, c, tbl, ctx);
-    symtable_del(tbl);
     return ret;
 }
 
+static ndt_t *substitute(const ndt_t *t, const ndt_bindings_t *b, ndt_context_t *ctx);
+
+#undef max
+static uint8_t
+max(uint8_t x, uint8_t y)
+{
+    return x >= y ? x : y;
+}
+
+/*
+ * Return 1 if the stride of 'dim' is the one that init_dimensions() computes
+ * from the item size.  An explicit stride that happens to be equal to the
+ * default is indistinguishable and is recomputed as well.
+ */
+static int
+default_stride(const ndt_dim_t *dim)
+{
+    switch (dim->tag) {
+    case FixedDim:
+        return dim->FixedDim.stride ==
+               (dim->FixedDim.shape <= 1 ? 0 : dim->itemsize);
+    case VarDim:
+        return dim->VarDim.stride == dim->itemsize;
+    default:
+        return 0;
+    }
+}
+
+static ndt_dim_t *
+substitute_dimensions(const ndt_dim_t *dim, size_t ndim, const ndt_bindings_t *b,
+                      ndt_context_t *ctx)
+{
+    symtable_entry_t v = { .tag=Unbound };
+    ndt_dim_t *u;
+    size_t i;
+
+    u = ndt_alloc(ndim, sizeof *u);
+    if (u == NULL) {
+        ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+        return NULL;
+    }
+
+    for (i = 0; i < ndim; i++) {
+        u[i] = dim[i];
+
+        switch (dim[i].tag) {
+        case FixedDim:
+            if (default_stride(&dim[i])) {
+                u[i].FixedDim.stride = INT64_MAX;
+            }
+            break;
+        case VarDim:
+            if (default_stride(&dim[i])) {
+                u[i].VarDim.stride = INT64_MAX;
+            }
+            break;
+        case SymbolicDim:
+            if (b != NULL) {
+                v = symtable_find(&b->tbl, dim[i].SymbolicDim.name);
+            }
+            if (v.tag == SizeEntry) {
+                u[i].tag = FixedDim;
+                u[i].FixedDim.shape = v.SizeEntry;
+                u[i].FixedDim.stride = INT64_MAX;
+                break;
+            }
+            u[i].SymbolicDim.name = ndt_strdup(
+                v.tag == SymbolEntry ? v.SymbolEntry : dim[i].SymbolicDim.name,
+                ctx);
+            if (u[i].SymbolicDim.name == NULL) {
+                ndt_dim_array_del(u, i);
+                return NULL;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    return u;
+}
+
+static ndt_t *
+substitute_categorical(const ndt_t *t, ndt_context_t *ctx)
+{
+    ndt_memory_t *types;
+    size_t i;
+
+    types = ndt_alloc(t->Categorical.ntypes, sizeof *types);
+    if (types == NULL) {
+        ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+        return NULL;
+    }
+
+    for (i = 0; i < t->Categorical.ntypes; i++) {
+        types[i] = t->Categorical.types[i];
+        types[i].t = substitute(types[i].t, NULL, ctx);
+        if (types[i].t == NULL) {
+            ndt_memory_array_del(types, i);
+            return NULL;
+        }
+        if (types[i].t->tag == String) {
+            types[i].v.String = ndt_strdup(types[i].v.String, ctx);
+            if (types[i].v.String == NULL) {
+                ndt_del(types[i].t);
+                ndt_memory_array_del(types, i);
+                return NULL;
+            }
+        }
+    }
+
+    return ndt_categorical(types, t->Categorical.ntypes, ctx);
+}
+
+/*
+ * Copy of 't' with the bindings in 'b' (if not NULL) applied.  Bound types
+ * are shared, everything else is copied.
+ */
+static ndt_t *
+substitute(const ndt_t *t, const ndt_bindings_t *b, ndt_context_t *ctx)
+{
+    symtable_entry_t v = { .tag=Unbound };
+    ndt_tuple_field_t *tfields;
+    ndt_record_field_t *rfields;
+    ndt_dim_t *dim;
+    ndt_t *u, *w, *x;
+    char *name;
+    size_t i;
+
+    switch (t->tag) {
+    case Array:
+        dim = substitute_dimensions(t->Array.dim, t->Array.ndim, b, ctx);
+        if (dim == NULL) {
+            return NULL;
+        }
+        u = substitute(t->Array.dtype, b, ctx);
+        if (u == NULL) {
+            ndt_dim_array_del(dim, t->Array.ndim);
+            return NULL;
+        }
+        return ndt_array(t->Array.order, dim, t->Array.ndim, u, ctx);
+
+    case Option:
+        u = substitute(t->Option.type, b, ctx);
+        return u == NULL ? NULL : ndt_option(u, ctx);
+
+    case Pointer:
+        u = substitute(t->Pointer.type, b, ctx);
+        return u == NULL ? NULL : ndt_pointer(u, ctx);
+
+    case Tuple:
+        tfields = NULL;
+        if (t->Tuple.shape > 0) {
+            tfields = ndt_alloc(t->Tuple.shape, sizeof *tfields);
+            if (tfields == NULL) {
+                ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+                return NULL;
+            }
+        }
+        for (i = 0; i < t->Tuple.shape; i++) {
+            u = substitute(t->Tuple.fields[i].type, b, ctx);
+            if (u == NULL) {
+                ndt_tuple_field_array_del(tfields, i);
+                return NULL;
+            }
+            tfields[i].type = u;
+            tfields[i].offset = 0;
+            tfields[i].align = max(u->align, t->Tuple.fields[i].align);
+            tfields[i].pad = 0;
+        }
+        return ndt_tuple(t->Tuple.flag, tfields, t->Tuple.shape, ctx);
+
+    case Record:
+        rfields = NULL;
+        if (t->Record.shape > 0) {
+            rfields = ndt_alloc(t->Record.shape, sizeof *rfields);
+            if (rfields == NULL) {
+                ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+                return NULL;
+            }
+        }
+        for (i = 0; i < t->Record.shape; i++) {
+            name = ndt_strdup(t->Record.fields[i].name, ctx);
+            if (name == NULL) {
+                ndt_record_field_array_del(rfields, i);
+                return NULL;
+            }
+            u = substitute(t->Record.fields[i].type, b, ctx);
+            if (u == NULL) {
+                ndt_free(name);
+                ndt_record_field_array_del(rfields, i);
+                return NULL;
+            }
+            rfields[i].name = name;
+            rfields[i].type = u;
+            rfields[i].offset = 0;
+            rfields[i].align = max(u->align, t->Record.fields[i].align);
+            rfields[i].pad = 0;
+        }
+        return ndt_record(t->Record.flag, rfields, t->Record.shape, ctx);
+
+    case Function:
+        u = substitute(t->Function.ret, b, ctx);
+        if (u == NULL) {
+            return NULL;
+        }
+        w = substitute(t->Function.pos, b, ctx);
+        if (w == NULL) {
+            ndt_del(u);
+            return NULL;
+        }
+        x = substitute(t->Function.kwds, b, ctx);
+        if (x == NULL) {
+            ndt_del(u);
+            ndt_del(w);
+            return NULL;
+        }
+        return ndt_function(u, w, x, ctx);
+
+    case Typevar:
+        if (b != NULL) {
+            v = symtable_find(&b->tbl, t->Typevar.name);
+        }
+        if (v.tag == TypeEntry) {
+            /* Inner nodes of arena types do not keep their arena alive. */
+            if (v.TypeEntry->arena_interior) {
+                return substitute(v.TypeEntry, NULL, ctx);
+            }
+            return ndt_incref(v.TypeEntry);
+        }
+        name = ndt_strdup(
+            v.tag == SymbolEntry ? v.SymbolEntry : t->Typevar.name, ctx);
+        return name == NULL ? NULL : ndt_typevar(name, ctx);
+
+    case Nominal:
+        name = ndt_strdup(t->Nominal.name, ctx);
+        return name == NULL ? NULL : ndt_nominal(name, ctx);
+
+    case Constr:
+        name = ndt_strdup(t->Constr.name, ctx);
+        if (name == NULL) {
+            return NULL;
+        }
+        u = substitute(t->Constr.type, b, ctx);
+        if (u == NULL) {
+            ndt_free(name);
+            return NULL;
+        }
+        return ndt_constr(name, u, ctx);
+
+    case Categorical:
+        return substitute_categorical(t, ctx);
+
+    case Char:
+        return ndt_char(t->Char.encoding, ctx);
+    case Bytes:
+        return ndt_bytes(t->Bytes.target_align, ctx);
+    case FixedString:
+        return ndt_fixed_string(t->FixedString.size, t->FixedString.encoding, ctx);
+    case FixedBytes:
+        return ndt_fixed_bytes(t->FixedBytes.size, t->FixedBytes.align, ctx);
+    case String:
+        return ndt_string(ctx);
+
+    case Void: case Bool:
+    case Int8: case Int16: case Int32: case Int64:
+    case Uint8: case Uint16: case Uint32: case Uint64:
+    case Float16: case Float32: case Float64:
+    case Complex64: case Complex128:
+        return ndt_primitive(t->tag, ctx);
+
+    default: /* kinds */
+        return ndt_new(t->tag, ctx);
+    }
+}
+
+/*
+ * Return a new type that is 't' with the bound type variables and symbolic
+ * dimensions of 'b' replaced by their values.  Unbound variables and
+ * ellipsis dimensions are kept, so the result is abstract if 't' contains
+ * any of them.  Explicit strides in 't' are kept, default strides are
+ * recomputed for the new item sizes.
+ */
+ndt_t *
+ndt_substitute(const ndt_t *t, const ndt_bindings_t *b, ndt_context_t *ctx)
+{
+    return substitute(t, b, ctx);
+}
+
+
+/*****************************************************************************/
+/*                                Broadcasting                               */
+/*****************************************************************************/
+
+/*
+ * Shape resolution for the array arguments of a kernel.  The iteration space
+ * consists of the broadcast dimensions that are matched by a leading ellipsis
+ * (outermost, aligned to the right as in NumPy), followed by one dimension
+ * for every distinct symbolic dimension in order of first appearance.  The
+ * occurrences of a symbol must have the same shape or the shape 1.  If a
+ * symbol occurs more than once in one argument, the stride of its axis is the
+ * sum of the strides of these dimensions.  Fixed dimensions in the patterns
+ * are checked but are not part of the iteration space.
+ */
+typedef struct {
+    int nouter;
+    int nsyms;
+    int64_t outer[NDT_MAX_DIM];         /* outer[0] is the innermost */
+    const char *names[NDT_MAX_DIM];
+    int64_t sizes[NDT_MAX_DIM];
+} broadcast_state_t;
+
+static int
+broadcast_size(int64_t *size, int64_t shape)
+{
+    if (*size == 1) {
+        *size = shape;
+        return 1;
+    }
+
+    return shape == 1 || shape == *size;
+}
+
+static int
+symbol_axis(const broadcast_state_t *s, const char *name)
+{
+    int i;
+
+    for (i = 0; i < s->nsyms; i++) {
+        if (strcmp(s->names[i], name) == 0) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/* Check the dimensions of one argument and update the iteration space. */
+static int
+broadcast_arg(broadcast_state_t *s, const ndt_t *p, const ndt_t *c,
+              symtable_t *tbl, ndt_context_t *ctx)
+{
+    const ndt_dim_t *pdim, *cdim;
+    int64_t shape;
+    int ellipsis, nouter, i, k, a;
+
+    if (p->tag != Array) {
+        return match_datashape(p, c, tbl, ctx);
+    }
+    if (c->tag != Array) {
+        return 0;
+    }
+
+    pdim = p->Array.dim;
+    cdim = c->Array.dim;
+    ellipsis = p->Array.ndim > 0 && pdim[0].tag == EllipsisDim;
+    nouter = (int)c->Array.ndim - ((int)p->Array.ndim - ellipsis);
+
+    for (i = ellipsis; i < (int)p->Array.ndim; i++) {
+        if (pdim[i].tag == EllipsisDim) {
+            ndt_err_format(ctx, NDT_ValueError,
+                "broadcasting requires the ellipsis to be the outermost dimension");
+            return -1;
+        }
+    }
+    for (k = 0; k < (int)c->Array.ndim; k++) {
+        if (cdim[k].tag != FixedDim) {
+            ndt_err_format(ctx, NDT_ValueError,
+                "broadcasting requires fixed dimensions");
+            return -1;
+        }
+    }
+    if (nouter < 0 || (!ellipsis && nouter != 0)) {
+        return 0;
+    }
+    if (nouter > NDT_MAX_DIM) {
+        ndt_err_format(ctx, NDT_ValueError,
+            "too many dimensions in the iteration space");
+        return -1;
+    }
+
+    for (a = 0; a < nouter; a++) {
+        k = nouter-1-a;
+        shape = (int64_t)cdim[k].FixedDim.shape;
+        if (a >= s->nouter) {
+            s->outer[a] = shape;
+            s->nouter = a+1;
+        }
+        else if (!broadcast_size(&s->outer[a], shape)) {
+            return 0;
+        }
+    }
+
+    for (i = ellipsis, k = nouter; k < (int)c->Array.ndim; i++, k++) {
+        shape = (int64_t)cdim[k].FixedDim.shape;
+        switch (pdim[i].tag) {
+        case FixedDimKind:
+            break;
+        case FixedDim:
+            if ((int64_t)pdim[i].FixedDim.shape != shape) {
+                return 0;
+            }
+            break;
+        case SymbolicDim:
+            a = symbol_axis(s, pdim[i].SymbolicDim.name);
+            if (a < 0) {
+                if (s->nsyms == NDT_MAX_DIM) {
+                    ndt_err_format(ctx, NDT_ValueError,
+                        "too many dimensions in the iteration space");
+                    return -1;
+                }
+                a = s->nsyms++;
+                s->names[a] = pdim[i].SymbolicDim.name;
+                s->sizes[a] = shape;
+            }
+            else if (!broadcast_size(&s->sizes[a], shape)) {
+                return 0;
+            }
+            break;
+        default:
+            return 0;
+        }
+    }
+
+    return match_datashape(p->Array.dtype, c->Array.dtype, tbl, ctx);
+}
+
+/* Set the strides of one (already checked) argument. */
+static void
+broadcast_strides(ndt_broadcast_t *out, const broadcast_state_t *s, int arg,
+                  const ndt_t *p, const ndt_t *c)
+{
+    const ndt_dim_t *pdim, *cdim;
+    int64_t *strides = out->strides[arg];
+    int ellipsis, nouter, i, k, a;
+
+    for (a = 0; a < out->ndim; a++) {
+        strides[a] = 0;
+    }
+
+    if (p->tag != Array) {
+        return;
+    }
+
+    pdim = p->Array.dim;
+    cdim = c->Array.dim;
+    ellipsis = p->Array.ndim > 0 && pdim[0].tag == EllipsisDim;
+    nouter = (int)c->Array.ndim - ((int)p->Array.ndim - ellipsis);
 
+    for (k = 0; k < (int)c->Array.ndim; k++) {
+        if (cdim[k].FixedDim.shape == 1) {
+            continue;
+        }
+        if (k < nouter) {
+            a = s->nouter - nouter + k;
+        }
+        else {
+            i = ellipsis + k - nouter;
+            if (pdim[i].tag != SymbolicDim) {
+                continue;
+            }
+            a = s->nouter + symbol_axis(s, pdim[i].SymbolicDim.name);
+        }
+        /* a symbol that occurs more than once walks the diagonal */
+        strides[a] += (int64_t)cdim[k].FixedDim.stride;
+    }
+}
+
+/*
+ * Match the argument patterns 'p' against the arguments 'c' with NumPy
+ * broadcasting of the dimensions.  Return 1 if the arguments broadcast, 0
+ * if they do not and -1 on error.  On success, 'out' contains the shape of
+ * the iteration space and the byte strides of each argument (0 for broadcast
+ * dimensions), and 'b' contains the bindings with the broadcast shapes of
+ * the symbolic dimensions, which can be used to compute the result type
+ * with ndt_substitute().
+ */
+int
+ndt_broadcast(ndt_broadcast_t *out, const ndt_t * const *p, const ndt_t * const *c,
+              int nargs, ndt_bindings_t *b, ndt_context_t *ctx)
+{
+    broadcast_state_t s;
+    symtable_entry_t v;
+    int i, n;
+
+    if (nargs < 0 || nargs > NDT_MAX_ARGS) {
+        ndt_err_format(ctx, NDT_ValueError,
+            "number of arguments must be in [0, %d]", NDT_MAX_ARGS);
+        return -1;
+    }
+
+    symtable_clear(&b->tbl);
+    symtable_init(&b->tbl);
+    s.nouter = 0;
+    s.nsyms = 0;
+
+    for (i = 0; i < nargs; i++) {
+        n = broadcast_arg(&s, p[i], c[i], &b->tbl, ctx);
+        if (n <= 0) {
+            goto fail;
+        }
+    }
+
+    if (s.nouter + s.nsyms > NDT_MAX_DIM) {
+        ndt_err_format(ctx, NDT_ValueError,
+            "too many dimensions in the iteration space");
+        n = -1;
+        goto fail;
+    }
+
+    for (i = 0; i < s.nsyms; i++) {
+        v = symtable_find(&b->tbl, s.names[i]);
+        if (v.tag != Unbound) {
+            /* the symbol also occurs inside a dtype */
+            if (v.tag != SizeEntry || (int64_t)v.SizeEntry != s.sizes[i]) {
+                n = 0;
+                goto fail;
+            }
+            continue;
+        }
+        v.tag = SizeEntry;
+        v.SizeEntry = (size_t)s.sizes[i];
+        if (symtable_add(&b->tbl, s.names[i], v, ctx) < 0) {
+            n = -1;
+            goto fail;
+        }
+    }
+
+    out->nargs = nargs;
+    out->ndim = s.nouter + s.nsyms;
+    for (i = 0; i < s.nouter; i++) {
+        out->shape[i] = s.outer[s.nouter-1-i];
+    }
+    for (i = 0; i < s.nsyms; i++) {
+        out->shape[s.nouter+i] = s.sizes[i];
+    }
+    for (i = 0; i < nargs; i++) {
+        broadcast_strides(out, &s, i, p[i], c[i]);
+    }
+
+    return 1;
+
+fail:
+    symtable_clear(&b->tbl);
+    symtable_init(&b->tbl);
+    return n;
+}
+
+
+/*****************************************************************************/
+/*                          Compiled match patterns                          */
+/*****************************************************************************/
+
+/*
+ * A compiled pattern is a flat program with one instruction per pattern node
+ * in the order in which match_datashape() visits the nodes.  Every distinct
+ * symbol (dimension or type variable) has a fixed slot, so matching binds
+ * variables by index instead of by name.  The position of the ellipsis in
+ * each array is computed at compile time.
+ *
+ * The program keeps a reference to the pattern, which owns the names and
+ * the subtrees that are compared by match_leaf().
+ */
+
+enum match_opcode {
+  OpLeaf,
+  OpArray,
+  OpOption,
+  OpPointer,
+  OpTuple,
+  OpRecord,
+  OpFunction,
+  OpTypevar
+};
+
+typedef struct {
+    enum match_opcode code;
+    const ndt_t *node;  /* pattern node */
+    size_t arg;         /* OpTypevar: slot, OpArray: index of the first dimension */
+    size_t prefix;      /* OpArray: number of dimensions before the ellipsis */
+} match_op_t;
+
+typedef struct {
+    enum ndt_dim tag;
+    size_t arg;         /* FixedDim: shape, SymbolicDim: slot */
+} match_dim_t;
+
+struct ndt_pattern {
+    ndt_t *pattern;
+    size_t nvars;
+    size_t nops;
+    size_t ndims;
+    const char **names; /* slot -> symbol name (owned by 'pattern') */
+    match_op_t *ops;
+    match_dim_t *dims;
+};
+
+typedef struct {
+    const char **names; /* NULL for the count phase */
+    match_op_t *ops;
+    match_dim_t *dims;
+    size_t nops;
+    size_t ndims;
+    size_t nvars;
+    symtable_t slots;   /* symbol name -> slot */
+} compiler_t;
+
+
+static int
+compile_slot(compiler_t *cc, const char *name, size_t *slot, ndt_context_t *ctx)
+{
+    symtable_entry_t v;
+
+    v = symtable_find(&cc->slots, name);
+    if (v.tag == Unbound) {
+        v.tag = SizeEntry;
+        v.SizeEntry = cc->nvars;
+        if (symtable_add(&cc->slots, name, v, ctx) < 0) {
+            return -1;
+        }
+        if (cc->names) cc->names[cc->nvars] = name;
+        cc->nvars++;
+    }
+
+    *slot = v.SizeEntry;
+    return 0;
+}
+
+static int
+compile_datashape(compiler_t *cc, const ndt_t *p, ndt_context_t *ctx)
+{
+    match_op_t op = { OpLeaf, p, 0, 0 };
+    size_t pc = cc->nops++;
+    size_t i;
+
+    switch (p->tag) {
+    case Array:
+        op.code = OpArray;
+        op.arg = cc->ndims;
+        op.prefix = p->Array.ndim;
+        for (i = 0; i < p->Array.ndim; i++) {
+            match_dim_t dim = { p->Array.dim[i].tag, 0 };
+            switch (dim.tag) {
+            case FixedDim:
+                dim.arg = p->Array.dim[i].FixedDim.shape;
+                break;
+            case SymbolicDim:
+                if (compile_slot(cc, p->Array.dim[i].SymbolicDim.name,
+                                 &dim.arg, ctx) < 0) {
+                    return -1;
+                }
+                break;
+            case EllipsisDim:
+                op.prefix = i;
+                break;
+            default:
+                break;
+            }
+            if (cc->dims) cc->dims[cc->ndims] = dim;
+            cc->ndims++;
+        }
+        if (compile_datashape(cc, p->Array.dtype, ctx) < 0) {
+            return -1;
+        }
+        break;
+    case Option:
+        op.code = OpOption;
+        if (compile_datashape(cc, p->Option.type, ctx) < 0) {
+            return -1;
+        }
+        break;
+    case Pointer:
+        op.code = OpPointer;
+        if (compile_datashape(cc, p->Pointer.type, ctx) < 0) {
+            return -1;
+        }
+        break;
+    case Tuple:
+        op.code = OpTuple;
+        for (i = 0; i < p->Tuple.shape; i++) {
+            if (compile_datashape(cc, p->Tuple.fields[i].type, ctx) < 0) {
+                return -1;
+            }
+        }
+        break;
+    case Record:
+        op.code = OpRecord;
+        for (i = 0; i < p->Record.shape; i++) {
+            if (compile_datashape(cc, p->Record.fields[i].type, ctx) < 0) {
+                return -1;
+            }
+        }
+        break;
+    case Function:
+        op.code = OpFunction;
+        if (compile_datashape(cc, p->Function.ret, ctx) < 0 ||
+            compile_datashape(cc, p->Function.pos, ctx) < 0 ||
+            compile_datashape(cc, p->Function.kwds, ctx) < 0) {
+            return -1;
+        }
+        break;
+    case Typevar:
+        op.code = OpTypevar;
+        if (compile_slot(cc, p->Typevar.name, &op.arg, ctx) < 0) {
+            return -1;
+        }
+        break;
+    default:
+        break;
+    }
+
+    if (cc->ops) cc->ops[pc] = op;
+    return 0;
+}
+
+static int
+compile_pass(compiler_t *cc, const ndt_t *p, ndt_context_t *ctx)
+{
+    int ret;
+
+    cc->nops = cc->ndims = cc->nvars = 0;
+    symtable_init(&cc->slots);
+    ret = compile_datashape(cc, p, ctx);
+    symtable_clear(&cc->slots);
+
+    return ret;
+}
+
+/* Compile the pattern 'p' for repeated matching with ndt_pattern_match(). */
+ndt_pattern_t *
+ndt_pattern_compile(const ndt_t *p, ndt_context_t *ctx)
+{
+    compiler_t cc = { NULL, NULL, NULL, 0, 0, 0, {0} };
+    ndt_pattern_t *pat;
+    char *ptr;
+
+    /* count phase */
+    if (compile_pass(&cc, p, ctx) < 0) {
+        return NULL;
+    }
+
+    ptr = ndt_alloc(1, sizeof *pat + cc.nvars * sizeof(const char *) +
+                       cc.nops * sizeof(match_op_t) +
+                       cc.ndims * sizeof(match_dim_t));
+    if (ptr == NULL) {
+        ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+        return NULL;
+    }
+
+    pat = (ndt_pattern_t *)ptr;
+    cc.names = (const char **)(ptr + sizeof *pat);
+    cc.ops = (match_op_t *)((char *)cc.names + cc.nvars * sizeof(const char *));
+    cc.dims = (match_dim_t *)((char *)cc.ops + cc.nops * sizeof(match_op_t));
+
+    if (compile_pass(&cc, p, ctx) < 0) {
+        ndt_free(ptr);
+        return NULL;
+    }
+
+    pat->pattern = ndt_incref(p);
+    pat->nvars = cc.nvars;
+    pat->nops = cc.nops;
+    pat->ndims = cc.ndims;
+    pat->names = cc.names;
+    pat->ops = cc.ops;
+    pat->dims = cc.dims;
+
+    return pat;
+}
+
+void
+ndt_pattern_del(ndt_pattern_t *pat)
+{
+    if (pat == NULL) {
+        return;
+    }
+
+    ndt_del(pat->pattern);
+    ndt_free(pat);
+}
+
+static int
+bind_slot(symtable_entry_t *vars, size_t slot, symtable_entry_t w)
+{
+    if (vars[slot].tag == Unbound) {
+        vars[slot] = w;
+        return 1;
+    }
+
+    return symtable_entry_equal(&vars[slot], &w);
+}
+
+static int
+run_dim(const match_dim_t *p, const ndt_dim_t *c, symtable_entry_t *vars)
+{
+    symtable_entry_t v;
+
+    switch (p->tag) {
+    case FixedDimKind:
+        return c->tag == FixedDimKind || c->tag == FixedDim;
+    case FixedDim:
+        return c->tag == FixedDim && p->arg == c->FixedDim.shape;
+    case VarDim:
+        return c->tag == VarDim;
+    case SymbolicDim:
+        switch (c->tag) {
+        case FixedDim:
+            v.tag = SizeEntry;
+            v.SizeEntry = c->FixedDim.shape;
+            break;
+        case SymbolicDim:
+            v.tag = SymbolEntry;
+            v.SymbolEntry = c->SymbolicDim.name; /* borrowed */
+            break;
+        default:
+            return 0;
+        }
+        return bind_slot(vars, p->arg, v);
+    default: /* NOT REACHED */
+        abort();
+    }
+}
+
+/* Dimensions before the ellipsis are matched from the left, dimensions after
+   the ellipsis from the right.  The ellipsis matches at least one dimension. */
+static int
+run_dimensions(const ndt_pattern_t *pat, const match_op_t *op,
+               const ndt_t *c, symtable_entry_t *vars)
+{
+    const match_dim_t *p = pat->dims + op->arg;
+    size_t pshape = op->node->Array.ndim;
+    size_t cshape = c->Array.ndim;
+    size_t i, suffix;
+    int n;
+
+    if (op->prefix == pshape) {
+        if (cshape != pshape) {
+            return 0;
+        }
+        suffix = 0;
+    }
+    else {
+        suffix = pshape - op->prefix - 1;
+        if (cshape < op->prefix + suffix + 1) {
+            return 0;
+        }
+    }
+
+    for (i = 0; i < op->prefix; i++) {
+        n = run_dim(&p[i], &c->Array.dim[i], vars);
+        if (n <= 0) return n;
+    }
+
+    for (i = 1; i <= suffix; i++) {
+        n = run_dim(&p[pshape-i], &c->Array.dim[cshape-i], vars);
+        if (n <= 0) return n;
+    }
+
+    return 1;
+}
+
+static int
+run_datashape(const ndt_pattern_t *pat, size_t *pc, const ndt_t *c,
+              symtable_entry_t *vars)
+{
+    const match_op_t *op = &pat->ops[(*pc)++];
+    const ndt_t *p = op->node;
+    size_t i;
+    int n;
+
+    switch (op->code) {
+    case OpLeaf:
+        return match_leaf(p, c);
+    case OpArray:
+        if (c->tag != Array) return 0;
+        n = run_dimensions(pat, op, c, vars);
+        if (n <= 0) return n;
+        return run_datashape(pat, pc, c->Array.dtype, vars);
+    case OpOption:
+        if (c->tag != Option) return 0;
+        return run_datashape(pat, pc, c->Option.type, vars);
+    case OpPointer:
+        if (c->tag != Pointer) return 0;
+        return run_datashape(pat, pc, c->Pointer.type, vars);
+    case OpTuple:
+        if (c->tag != Tuple || p->Tuple.flag != c->Tuple.flag ||
+            p->Tuple.shape != c->Tuple.shape) {
+            return 0;
+        }
+        for (i = 0; i < p->Tuple.shape; i++) {
+            n = run_datashape(pat, pc, c->Tuple.fields[i].type, vars);
+            if (n <= 0) return n;
+        }
+        return 1;
+    case OpRecord:
+        if (c->tag != Record || p->Record.flag != c->Record.flag ||
+            p->Record.shape != c->Record.shape) {
+            return 0;
+        }
+        for (i = 0; i < p->Record.shape; i++) {
+            if (strcmp(p->Record.fields[i].name, c->Record.fields[i].name) != 0) {
+                return 0;
+            }
+            n = run_datashape(pat, pc, c->Record.fields[i].type, vars);
+            if (n <= 0) return n;
+        }
+        return 1;
+    case OpFunction:
+        if (c->tag != Function) return 0;
+        n = run_datashape(pat, pc, c->Function.ret, vars);
+        if (n <= 0) return n;
+
+        n = run_datashape(pat, pc, c->Function.pos, vars);
+        if (n <= 0) return n;
+
+        return run_datashape(pat, pc, c->Function.kwds, vars);
+    case OpTypevar:
+        if (c->tag == Typevar) {
+            symtable_entry_t entry = { .tag = SymbolEntry,
+                                       .SymbolEntry = c->Typevar.name };
+            return bind_slot(vars, op->arg, entry);
+        }
+        else {
+            symtable_entry_t entry = { .tag = TypeEntry,
+                                       .TypeEntry = c };
+            return bind_slot(vars, op->arg, entry);
+        }
+    default: /* NOT REACHED */
+        abort();
+    }
+}
+
+/* Run the program with the scratch space 'vars' (pat->nvars entries). */
+static int
+pattern_run(const ndt_pattern_t *pat, const ndt_t *c, symtable_entry_t *vars)
+{
+    size_t pc = 0;
+    size_t i;
+
+    for (i = 0; i < pat->nvars; i++) {
+        vars[i].tag = Unbound;
+    }
+
+    return run_datashape(pat, &pc, c, vars);
+}
+
+/* Same result as ndt_match(pattern, c, ctx). */
+int
+ndt_pattern_match(const ndt_pattern_t *pat, const ndt_t *c, ndt_context_t *ctx)
+{
+    symtable_entry_t inline_vars[SYMTABLE_INLINE];
+    symtable_entry_t *vars = inline_vars;
+    int ret;
+
+    if (pat->nvars > SYMTABLE_INLINE) {
+        vars = ndt_alloc(pat->nvars, sizeof *vars);
+        if (vars == NULL) {
+            ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+            return -1;
+        }
+    }
+
+    ret = pattern_run(pat, c, vars);
+
+    if (vars != inline_vars) {
+        ndt_free(vars);
+    }
+
+    return ret;
+}
+
+/*
+ * Same result as ndt_unify(pattern, c, b, ctx).  The program binds the slots,
+ * which are then copied to 'b' under the names of the symbols.
+ */
+int
+ndt_pattern_unify(const ndt_pattern_t *pat, const ndt_t *c, ndt_bindings_t *b,
+                  ndt_context_t *ctx)
+{
+    symtable_entry_t inline_vars[SYMTABLE_INLINE];
+    symtable_entry_t *vars = inline_vars;
+    size_t i;
+    int ret;
+
+    symtable_clear(&b->tbl);
+    symtable_init(&b->tbl);
+
+    if (pat->nvars > SYMTABLE_INLINE) {
+        vars = ndt_alloc(pat->nvars, sizeof *vars);
+        if (vars == NULL) {
+            ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+            return -1;
+        }
+    }
+
+    ret = pattern_run(pat, c, vars);
+
+    for (i = 0; ret == 1 && i < pat->nvars; i++) {
+        if (vars[i].tag != Unbound &&
+            symtable_add(&b->tbl, pat->names[i], vars[i], ctx) < 0) {
+            symtable_clear(&b->tbl);
+            symtable_init(&b->tbl);
+            ret = -1;
+        }
+    }
+
+    if (vars != inline_vars) {
+        ndt_free(vars);
+    }
+
+    return ret;
+}
+
+
+
+/*****************************************************************************/
+/*                               Batch matching                              */
+/*****************************************************************************/
+
+/* Candidates per task.  A multiple of 64, so that tasks write disjoint words
+   of the bitmap. */
+#define BATCH_TASK 1024
+
+typedef struct {
+    ndt_pattern_t *pat;
+    const ndt_t * const *c;
+    size_t n;
+    uint64_t *bitmap;
+    symtable_entry_t *scratch;  /* pat->nvars entries per worker */
+} batch_t;
+
+static void
+batch_task(void *arg, size_t task, int worker)
+{
+    const batch_t *b = arg;
+    symtable_entry_t *vars = b->scratch + (size_t)worker * b->pat->nvars;
+    size_t start = task * BATCH_TASK;
+    size_t end = b->n - start < BATCH_TASK ? b->n : start + BATCH_TASK;
+    uint64_t word;
+    size_t i, k;
+
+    for (i = start; i < end; i += 64) {
+        word = 0;
+        for (k = 0; k < 64 && i+k < end; k++) {
+            if (pattern_run(b->pat, b->c[i+k], vars) == 1) {
+                word |= (uint64_t)1 << k;
+            }
+        }
+        b->bitmap[i/64] = word;
+    }
+}
+
+static int
+popcount(uint64_t x)
+{
+    int n = 0;
+
+    for (; x != 0; x &= x-1) {
+        n++;
+    }
+
+    return n;
+}
+
+/*
+ * Match 'p' against the candidates c[0], ..., c[n-1].  Bit (i % 64) of
+ * bitmap[i / 64] is set if c[i] matches, so 'bitmap' must have (n+63)/64
+ * words.  The pattern is compiled once, and the scratch space is allocated
+ * once per worker.  If 'pool' is not NULL, the candidates are distributed
+ * over its threads.  Return the number of matches or -1 on error.
+ */
+int64_t
+ndt_match_batch(const ndt_t *p, const ndt_t * const *c, size_t n,
+                uint64_t *bitmap, ndt_pool_t *pool, ndt_context_t *ctx)
+{
+    batch_t b;
+    size_t nwords = n / 64 + (n % 64 != 0);
+    size_t i;
+    int64_t count = 0;
+
+    b.pat = ndt_pattern_compile(p, ctx);
+    if (b.pat == NULL) {
+        return -1;
+    }
+
+    b.scratch = NULL;
+    if (b.pat->nvars > 0) {
+        b.scratch = ndt_alloc((size_t)ndt_pool_workers(pool) * b.pat->nvars,
+                              sizeof *b.scratch);
+        if (b.scratch == NULL) {
+            ndt_pattern_del(b.pat);
+            ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+            return -1;
+        }
+    }
+
+    b.c = c;
+    b.n = n;
+    b.bitmap = bitmap;
+
+    pool_run(pool, batch_task, &b, n / BATCH_TASK + (n % BATCH_TASK != 0));
+
+    for (i = 0; i < nwords; i++) {
+        count += popcount(bitmap[i]);
+    }
+
+    ndt_free(b.scratch);
+    ndt_pattern_del(b.pat);
+
+    return count;
+}
+
+
+/*****************************************************************************/
+/*                                Match caches                               */
+/*****************************************************************************/
+
+/*
+ * Bounded memo table for ndt_match() results.  The table is direct mapped:
+ * a pair (p, c) can only live in the slot selected by the fingerprints of
+ * p and c, and a new pair replaces the previous occupant.  A lookup hits if
+ * the slot holds the same pair of objects, or a pair with the same
+ * fingerprints that is structurally equal.
+ *
+ * An entry holds references to both types.  A cached type is therefore never
+ * freed, and a freed and reused address cannot cause a false hit.  The
+ * references are released when the entry is evicted, by ndt_matchcache_clear()
+ * and by ndt_matchcache_del().  Inner nodes of arena types cannot be pinned
+ * by a reference, so pairs that contain them are looked up but not stored.
+ *
+ * A match cache is not thread safe.
+ */
+
+typedef struct {
+    const ndt_t *p;         /* NULL for an empty entry */
+    const ndt_t *c;
+    int result;
+} matchcache_entry_t;
+
+struct ndt_matchcache {
+    size_t mask;
+    ndt_cache_stats_t stats;
+    matchcache_entry_t entries[];
+};
+
+ndt_matchcache_t *
+ndt_matchcache_new(size_t size, ndt_context_t *ctx)
+{
+    ndt_matchcache_t *mc;
+    size_t n, i;
+
+    if (size == 0 || size > NDT_MATCHCACHE_MAX) {
+        ndt_err_format(ctx, NDT_ValueError,
+            "match cache size must be in [1, %d]", NDT_MATCHCACHE_MAX);
+        return NULL;
+    }
+
+    for (n = 1; n < size; n <<= 1)
+        ;
+
+    mc = ndt_alloc(1, sizeof *mc + n * sizeof mc->entries[0]);
+    if (mc == NULL) {
+        ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+        return NULL;
+    }
+
+    mc->mask = n-1;
+    mc->stats.hits = 0;
+    mc->stats.misses = 0;
+    mc->stats.evictions = 0;
+
+    for (i = 0; i < n; i++) {
+        mc->entries[i].p = NULL;
+        mc->entries[i].c = NULL;
+        mc->entries[i].result = 0;
+    }
+
+    return mc;
+}
+
+/* Release all entries.  The statistics are kept. */
+void
+ndt_matchcache_clear(ndt_matchcache_t *mc)
+{
+    matchcache_entry_t *e;
+    size_t i;
+
+    for (i = 0; i <= mc->mask; i++) {
+        e = &mc->entries[i];
+        if (e->p != NULL) {
+            ndt_del((ndt_t *)e->p);
+            ndt_del((ndt_t *)e->c);
+            e->p = NULL;
+            e->c = NULL;
+        }
+    }
+}
+
+void
+ndt_matchcache_del(ndt_matchcache_t *mc)
+{
+    if (mc == NULL) {
+        return;
+    }
+
+    ndt_matchcache_clear(mc);
+    ndt_free(mc);
+}
+
+static size_t
+matchcache_slot(const ndt_matchcache_t *mc, const ndt_t *p, const ndt_t *c)
+{
+    uint64_t h = p->hash ^ (c->hash * 0x9e3779b97f4a7c15ULL);
+
+    return (size_t)(h ^ (h >> 32)) & mc->mask;
+}
+
+/*
+ * Same as ndt_match(), but look up the result in 'mc' first and store it
+ * there after a miss.  Errors are not cached.
+ */
+int
+ndt_match_cached(ndt_matchcache_t *mc, const ndt_t *p, const ndt_t *c,
+                 ndt_context_t *ctx)
+{
+    matchcache_entry_t *e = &mc->entries[matchcache_slot(mc, p, c)];
+    int ret;
+
+    if (e->p == p && e->c == c) {
+        mc->stats.hits++;
+        return e->result;
+    }
+
+    /* Structurally equal types are usually distinct objects. */
+    if (e->p != NULL &&
+        e->p->hash == p->hash && e->c->hash == c->hash &&
+        ndt_equal(e->p, p) && ndt_equal(e->c, c)) {
+        mc->stats.hits++;
+        return e->result;
+    }
+
+    ret = ndt_match(p, c, ctx);
+    if (ret < 0) {
+        return ret;
+    }
+
+    mc->stats.misses++;
+
+    if (p->arena_interior || c->arena_interior) {
+        return ret;
+    }
+
+    if (e->p != NULL) {
+        mc->stats.evictions++;
+        ndt_del((ndt_t *)e->p);
+        ndt_del((ndt_t *)e->c);
+    }
+
+    e->p = ndt_incref(p);
+    e->c = ndt_incref(c);
+    e->result = ret;
+
+    return ret;
+}
+
+void
+ndt_matchcache_stats(const ndt_matchcache_t *mc, ndt_cache_stats_t *stats)
+{
+    *stats = mc->stats;
+}
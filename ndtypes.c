@@ -39,6 +39,8 @@
 #include <errno.h>
 #include <assert.h>
 #include "ndtypes.h"
+#include "hash.h"
+#include "sync.h"
 
 
 #undef max
@@ -547,17 +549,50 @@ ndt_new(enum ndt tag, ndt_context_t *ctx)
     }
 
     t->tag = tag;
+    t->refcnt = 1;
     t->size = 0;
     t->align = 1;
     t->abstract = 1;
+    t->interned = 0;
+    t->arena = 0;
+    t->arena_interior = 0;
+    t->hash = hash_tag(tag);
 
     return t;
 }
 
+ndt_t *
+ndt_incref(const ndt_t *t)
+{
+    ndt_t *u = (ndt_t *)t;
+
+    if (!u->arena_interior) {
+        ndt_refcnt_inc(&u->refcnt);
+    }
+    return u;
+}
+
+void
+ndt_decref(ndt_t *t)
+{
+    ndt_del(t);
+}
+
 void
 ndt_del(ndt_t *t)
 {
-    if (t == NULL) {
+    if (t == NULL || t->arena_interior) {
+        return;
+    }
+
+    assert(t->refcnt > 0);
+    if (ndt_refcnt_dec(&t->refcnt) > 0) {
+        return;
+    }
+
+    /* The root of an arena type is the start of the arena block. */
+    if (t->arena) {
+        ndt_free(t);
         return;
     }
 
@@ -686,6 +721,7 @@ ndt_array(char order, ndt_dim_t *dim, size_t ndim, ndt_t *dtype, ndt_context_t *
     t->size = size;
     t->align = align;
     t->abstract = abstract;
+    t->hash = hash_node(t);
 
     return t;
 }
@@ -704,6 +740,7 @@ ndt_option(ndt_t *type, ndt_context_t *ctx)
     t->size = type->size;
     t->align = type->align;
     t->abstract = type->abstract;
+    t->hash = hash_node(t);
 
     return t;
 }
@@ -723,7 +760,6 @@ ndt_t *
 ndt_nominal(char *name, ndt_context_t *ctx)
 {
     const ndt_t *type;
-    ndt_t *t;
 
     type = ndt_typedef_find(name, ctx);
     if (type == NULL) {
@@ -731,6 +767,15 @@ ndt_nominal(char *name, ndt_context_t *ctx)
         return NULL;
     }
 
+    return ndt_nominal_from_type(name, type, ctx);
+}
+
+/* Nominal type for the typedef 'type', which need not be registered yet. */
+ndt_t *
+ndt_nominal_from_type(char *name, const ndt_t *type, ndt_context_t *ctx)
+{
+    ndt_t *t;
+
     t = ndt_new(Nominal, ctx);
     if (t == NULL) {
         ndt_free(name);
@@ -740,6 +785,7 @@ ndt_nominal(char *name, ndt_context_t *ctx)
     t->size = type->size;
     t->align = type->align;
     t->abstract = type->abstract;
+    t->hash = hash_node(t);
 
     return t;
 }
@@ -760,6 +806,7 @@ ndt_constr(char *name, ndt_t *type, ndt_context_t *ctx)
     t->size = type->size;
     t->align = type->align;
     t->abstract = type->abstract;
+    t->hash = hash_node(t);
 
     return t;
 }
@@ -817,6 +864,7 @@ init_tuple(ndt_t *t, enum ndt_variadic_flag flag, ndt_tuple_field_t *fields,
     t->size = size;
     t->align = maxalign;
     t->abstract = abstract || flag == Variadic;
+    t->hash = hash_node(t);
 
     return ret;
 }
@@ -896,6 +944,7 @@ init_record(ndt_t *t, enum ndt_variadic_flag flag, ndt_record_field_t *fields,
     t->size = size;
     t->align = maxalign;
     t->abstract = abstract || flag == Variadic;
+    t->hash = hash_node(t);
 
     return ret;
 }
@@ -938,6 +987,7 @@ ndt_function(ndt_t *ret, ndt_t *pos, ndt_t *kwds, ndt_context_t *ctx)
     t->size = sizeof(void *);
     t->align = alignof(void *);
     t->abstract = ret->abstract || pos->abstract || kwds->abstract;
+    t->hash = hash_node(t);
 
     return t;
 }
@@ -956,6 +1006,7 @@ ndt_typevar(char *name, ndt_context_t *ctx)
     t->size = 0;
     t->align = 1;
     t->abstract = 1;
+    t->hash = hash_node(t);
 
     return t;
 }
@@ -1140,6 +1191,7 @@ ndt_char(enum ndt_encoding encoding, ndt_context_t *ctx)
     t->size = ndt_sizeof_encoding(encoding);
     t->align = ndt_alignof_encoding(encoding);
     t->abstract = 0;
+    t->hash = hash_node(t);
 
     return t;
 }
@@ -1174,6 +1226,7 @@ ndt_fixed_string(size_t size, enum ndt_encoding encoding, ndt_context_t *ctx)
     t->size = ndt_sizeof_encoding(encoding) * size;
     t->align = ndt_alignof_encoding(encoding);
     t->abstract = 0;
+    t->hash = hash_node(t);
 
     return t;
 }
@@ -1191,6 +1244,7 @@ ndt_bytes(uint8_t target_align, ndt_context_t *ctx)
     t->size = sizeof(ndt_bytes_t);
     t->align = alignof(ndt_bytes_t);
     t->abstract = 0;
+    t->hash = hash_node(t);
 
     return t;
 }
@@ -1209,6 +1263,7 @@ ndt_fixed_bytes(size_t size, uint8_t align, ndt_context_t *ctx)
     t->size = size;
     t->align = align;
     t->abstract = 0;
+    t->hash = hash_node(t);
 
     return t;
 }
@@ -1253,6 +1308,7 @@ ndt_categorical(ndt_memory_t *types, size_t ntypes, ndt_context_t *ctx)
     t->size = sizeof(ndt_memory_t);
     t->align = alignof(ndt_memory_t);
     t->abstract = 0;
+    t->hash = hash_node(t);
 
     return t;
 }
@@ -1271,6 +1327,7 @@ ndt_pointer(ndt_t *type, ndt_context_t *ctx)
     t->size = sizeof(void *);
     t->align = alignof(void *);
     t->abstract = type->abstract;
+    t->hash = hash_node(t);
 
     return t;
 }
@@ -1801,7 +1858,8 @@ ndt_err_format(ndt_context_t *ctx, enum ndt_error err, const char *fmt, ...)
         return;
     }
 
-    s = ndt_alloc(1, n+1);
+    /* The message may outlive an allocation region, see arena.h. */
+    s = ndt_mallocfunc((size_t)n+1);
     if (s == NULL) {
         va_end(aq);
         ctx->err = NDT_MemoryError;
@@ -309,9 +309,14 @@ struct _ndt {
         } Pointer;
     };
 
+    int64_t refcnt;
+    uint64_t hash;
     size_t size;
     uint8_t align;
     bool abstract;
+    bool interned;
+    bool arena;             /* root of an arena type: owns the memory block */
+    bool arena_interior;    /* inner node of an arena type: not counted */
 };
 
 
@@ -369,6 +374,8 @@ char *ndt_asprintf(ndt_context_t *ctx, const char *fmt, ...);
 const char *ndt_tag_as_string(enum ndt tag);
 enum ndt_encoding ndt_encoding_from_string(char *s, ndt_context_t *ctx);
 const char *ndt_encoding_as_string(enum ndt_encoding encoding);
+size_t ndt_sizeof_encoding(enum ndt_encoding encoding);
+uint8_t ndt_alignof_encoding(enum ndt_encoding encoding);
 
 int ndt_is_signed(const ndt_t *t);
 int ndt_is_unsigned(const ndt_t *t);
@@ -376,8 +383,82 @@ int ndt_is_real(const ndt_t *t);
 int ndt_is_complex(const ndt_t *t);
 int ndt_is_scalar(const ndt_t *t);
 int ndt_equal(const ndt_t *p, const ndt_t *c);
+uint64_t ndt_hash(const ndt_t *t);
 int ndt_match(const ndt_t *p, const ndt_t *c, ndt_context_t *ctx);
 
+/* Bindings of the type variables and symbolic dimensions of a pattern */
+typedef struct ndt_bindings ndt_bindings_t;
+ndt_bindings_t *ndt_bindings_new(ndt_context_t *ctx);
+void ndt_bindings_del(ndt_bindings_t *b);
+const ndt_t *ndt_bindings_type(const ndt_bindings_t *b, const char *name);
+int64_t ndt_bindings_shape(const ndt_bindings_t *b, const char *name);
+int ndt_unify(const ndt_t *p, const ndt_t *c, ndt_bindings_t *b, ndt_context_t *ctx);
+ndt_t *ndt_substitute(const ndt_t *t, const ndt_bindings_t *b, ndt_context_t *ctx);
+
+/* Broadcasting of array arguments */
+#define NDT_MAX_DIM 64
+#define NDT_MAX_ARGS 32
+typedef struct {
+    int nargs;
+    int ndim;
+    int64_t shape[NDT_MAX_DIM];
+    int64_t strides[NDT_MAX_ARGS][NDT_MAX_DIM];
+} ndt_broadcast_t;
+int ndt_broadcast(ndt_broadcast_t *out, const ndt_t * const *p, const ndt_t * const *c,
+                  int nargs, ndt_bindings_t *b, ndt_context_t *ctx);
+
+/* Worker pool for batch operations */
+#define NDT_POOL_MAX 1024
+typedef struct ndt_pool ndt_pool_t;
+ndt_pool_t *ndt_pool_new(int nworkers, ndt_context_t *ctx);
+void ndt_pool_del(ndt_pool_t *pool);
+int ndt_pool_workers(const ndt_pool_t *pool);
+
+/* Match a pattern against many candidates */
+int64_t ndt_match_batch(const ndt_t *p, const ndt_t * const *c, size_t n,
+                        uint64_t *bitmap, ndt_pool_t *pool, ndt_context_t *ctx);
+
+/* Statistics of the parse, match and call site caches */
+typedef struct {
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+} ndt_cache_stats_t;
+
+/* Memo table for match results */
+#define NDT_MATCHCACHE_MAX (1<<20)
+typedef struct ndt_matchcache ndt_matchcache_t;
+ndt_matchcache_t *ndt_matchcache_new(size_t size, ndt_context_t *ctx);
+void ndt_matchcache_del(ndt_matchcache_t *mc);
+void ndt_matchcache_clear(ndt_matchcache_t *mc);
+int ndt_match_cached(ndt_matchcache_t *mc, const ndt_t *p, const ndt_t *c, ndt_context_t *ctx);
+void ndt_matchcache_stats(const ndt_matchcache_t *mc, ndt_cache_stats_t *stats);
+
+/* Compiled match patterns */
+typedef struct ndt_pattern ndt_pattern_t;
+ndt_pattern_t *ndt_pattern_compile(const ndt_t *p, ndt_context_t *ctx);
+void ndt_pattern_del(ndt_pattern_t *pat);
+int ndt_pattern_match(const ndt_pattern_t *pat, const ndt_t *c, ndt_context_t *ctx);
+int ndt_pattern_unify(const ndt_pattern_t *pat, const ndt_t *c, ndt_bindings_t *b,
+                      ndt_context_t *ctx);
+
+/* Index of match patterns for dispatch */
+typedef struct ndt_sigindex ndt_sigindex_t;
+ndt_sigindex_t *ndt_sigindex_new(ndt_context_t *ctx);
+void ndt_sigindex_del(ndt_sigindex_t *index);
+int64_t ndt_sigindex_add(ndt_sigindex_t *index, const ndt_t *p, ndt_context_t *ctx);
+int64_t ndt_sigindex_find(const ndt_sigindex_t *index, const ndt_t *c,
+                          size_t *ids, size_t n, ndt_context_t *ctx);
+
+/* Dispatch cache for a single call site */
+#define NDT_CALLSITE_MAX 64
+typedef struct ndt_callsite ndt_callsite_t;
+ndt_callsite_t *ndt_callsite_new(const ndt_sigindex_t *index, size_t size, ndt_context_t *ctx);
+void ndt_callsite_del(ndt_callsite_t *cs);
+int ndt_callsite_lookup(ndt_callsite_t *cs, const ndt_t *c, int64_t *id,
+                        const ndt_bindings_t **b, ndt_context_t *ctx);
+void ndt_callsite_stats(const ndt_callsite_t *cs, ndt_cache_stats_t *stats);
+
 
 /*** String conversion ***/
 bool ndt_strtobool(const char *v, ndt_context_t *ctx);
@@ -421,6 +502,24 @@ ndt_dim_t *ndt_ellipsis_dim(ndt_context_t *ctx);
 ndt_t *ndt_new(enum ndt tag, ndt_context_t *ctx);
 void ndt_del(ndt_t *t);
 
+/* Reference counting.  Constructors return a new reference and steal the
+   references to their ndt_t arguments.  ndt_del() is the same as ndt_decref().
+   The count is updated atomically, so a type may be shared by several threads
+   as long as none of them mutates it.  Inner nodes of arena types are not
+   counted: they live as long as the root. */
+ndt_t *ndt_incref(const ndt_t *t);
+void ndt_decref(ndt_t *t);
+
+/* Copy a type into a single memory block that is released with the root.  The
+   copy is an extra allocation on top of the source type, which pays off for
+   long lived types that are traversed often.  ndt_from_string_arena() and
+   ndt_deserialize() create such a block without the intermediate type. */
+ndt_t *ndt_arena_copy(const ndt_t *t, ndt_context_t *ctx);
+
+/* Binary serialization (position independent, loads into an arena type) */
+char *ndt_serialize(const ndt_t *t, size_t *len, ndt_context_t *ctx);
+ndt_t *ndt_deserialize(const char *buf, size_t len, ndt_context_t *ctx);
+
 /* Typedef for nominal types */
 int ndt_typedef(const char *name, ndt_t *type, ndt_context_t *ctx);
 
@@ -429,6 +528,7 @@ ndt_t *ndt_any_kind(ndt_context_t *ctx);
 ndt_t *ndt_array(char order, ndt_dim_t *dim, size_t ndim, ndt_t *dtype, ndt_context_t *ctx);
 ndt_t *ndt_option(ndt_t *type, ndt_context_t *ctx);
 ndt_t *ndt_nominal(char *name, ndt_context_t *ctx);
+ndt_t *ndt_nominal_from_type(char *name, const ndt_t *type, ndt_context_t *ctx);
 ndt_t *ndt_constr(char *name, ndt_t *type, ndt_context_t *ctx);
 
 
@@ -485,8 +585,35 @@ ndt_attr_t *ndt_attr_from_type(char *name, ndt_t *t, ndt_context_t *ctx);
 /*                                  Parsing                                   */
 /******************************************************************************/
 
+/* Parser backends */
+enum ndt_parser {
+  NDT_ParserBison,
+  NDT_ParserDescent
+};
+
+/* The ndt_from_*() functions use the selected backend, except that inputs
+   longer than INT_MAX/2 always go to the recursive descent parser.  Modules
+   are always parsed by the recursive descent parser. */
+void ndt_set_parser(enum ndt_parser parser);
+enum ndt_parser ndt_get_parser(void);
+
 ndt_t *ndt_from_file(const char *name, ndt_context_t *ctx);
 ndt_t *ndt_from_string(const char *input, ndt_context_t *ctx);
+ndt_t *ndt_from_buffer(const char *input, size_t len, ndt_context_t *ctx);
+ndt_t *ndt_from_string_arena(const char *input, ndt_context_t *ctx);
+int ndt_module_from_string(const char *input, ndt_context_t *ctx);
+int ndt_module_from_buffer(const char *input, size_t len, ndt_context_t *ctx);
+int ndt_module_from_file(const char *name, ndt_context_t *ctx);
+size_t ndt_from_string_batch(ndt_t **types, ndt_context_t *errors,
+                             const char * const *inputs, size_t n, ndt_pool_t *pool);
+
+/* Bounded cache for parse results */
+typedef struct ndt_parse_cache ndt_parse_cache_t;
+ndt_parse_cache_t *ndt_parse_cache_new(size_t capacity, ndt_context_t *ctx);
+void ndt_parse_cache_del(ndt_parse_cache_t *cache);
+void ndt_parse_cache_stats(const ndt_parse_cache_t *cache, ndt_cache_stats_t *stats);
+ndt_t *ndt_from_string_cached(ndt_parse_cache_t *cache, const char *input,
+                              ndt_context_t *ctx);
 
 
 /******************************************************************************/
@@ -496,8 +623,16 @@ ndt_t *ndt_from_string(const char *input, ndt_context_t *ctx);
 int ndt_init(ndt_context_t *ctx);
 void ndt_finalize(void);
 int ndt_typedef_add(const char *name, const ndt_t *type, ndt_context_t *ctx);
+int ndt_typedef_add_all(const char * const *names, const ndt_t * const *types,
+                        size_t n, ndt_context_t *ctx);
 const ndt_t *ndt_typedef_find(const char *name, ndt_context_t *ctx);
 
+/* Hash consing: structurally equal interned types are the same object.
+   The reference to 't' is always consumed, also if 't' is already interned
+   or on error.  The result is borrowed from the intern table and remains
+   valid until ndt_finalize().  Thread safe. */
+const ndt_t *ndt_intern(ndt_t *t, ndt_context_t *ctx);
+
 
 /******************************************************************************/
 /*                                 Printing                                   */
@@ -514,10 +649,11 @@ char *ndt_indent(ndt_t *t, ndt_context_t *ctx);
 
 extern void *(* ndt_mallocfunc)(size_t size);
 extern void *(* ndt_reallocfunc)(void *ptr, size_t size);
-extern void (* ndt_free)(void *ptr);
+extern void (* ndt_freefunc)(void *ptr);
 
 void *ndt_alloc(size_t nmemb, size_t size);
 void *ndt_realloc(void *ptr, size_t nmemb, size_t size);
+void ndt_free(void *ptr);
 
 
 /******************************************************************************/
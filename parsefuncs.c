@@ -31,6 +31,7 @@
 #include <limits.h>
 #include "ndtypes.h"
 #include "seq.h"
+#include "parsefuncs.h"
 
 
 /*****************************************************************************/
@@ -67,22 +68,27 @@ mk_stringlit(const char *lexeme, ndt_context_t *ctx)
 /*****************************************************************************/
 
 ndt_dim_t *
-mk_fixed_dim(char *v, ndt_attr_seq_t *seq, ndt_context_t *ctx)
+mk_fixed_dim(const char *v, size_t len, ndt_attr_seq_t *seq, ndt_context_t *ctx)
 {
     size_t shape;
-    int64_t stride = INT64_MAX;
-
-    if (seq) {
-        seq = ndt_attr_seq_finalize(seq);
-    }
 
-    shape = (size_t)ndt_strtoull(v, SIZE_MAX, ctx);
-    ndt_free(v);
+    shape = mk_size(v, len, ctx);
     if (ctx->err != NDT_Success) {
+        ndt_attr_seq_del(seq);
         return NULL;
     }
 
+    return mk_fixed_dim_from_shape(shape, seq, ctx);
+}
+
+ndt_dim_t *
+mk_fixed_dim_from_shape(size_t shape, ndt_attr_seq_t *seq, ndt_context_t *ctx)
+{
+    int64_t stride = INT64_MAX;
+
     if (seq) {
+        seq = ndt_attr_seq_finalize(seq);
+
         if (seq->len != 1 || strcmp(seq->ptr[0].name, "stride") != 0) {
             ndt_err_format(ctx, NDT_InvalidArgumentError, "invalid keyword");
             ndt_attr_array_del(seq->ptr, seq->len);
@@ -120,17 +126,16 @@ mk_var_dim(ndt_attr_seq_t *seq, ndt_context_t *ctx)
 }
 
 ndt_t *
-mk_fixed_string(char *v, enum ndt_encoding encoding, ndt_context_t *ctx)
+mk_fixed_string(const char *v, size_t len, enum ndt_encoding encoding,
+                ndt_context_t *ctx)
 {
     size_t size;
 
-    size = (size_t)ndt_strtoull(v, SIZE_MAX, ctx);
+    size = mk_size(v, len, ctx);
     if (ctx->err != NDT_Success) {
-        ndt_free(v);
         return NULL;
     }
 
-    ndt_free(v);
     return ndt_fixed_string(size, encoding, ctx);
 }
  
@@ -187,7 +192,7 @@ mk_fixed_bytes(ndt_attr_seq_t *seq, ndt_context_t *ctx)
             have_size = 1;
         }
         else if (strcmp(seq->ptr[i].name, "align") == 0) {
-            if (have_target_align || seq->ptr[i].AttrInt64 < 0 || UINT8_MAX < seq->ptr[i].AttrInt64) {
+            if (have_target_align || seq->ptr[i].AttrInt64 < 1 || UINT8_MAX < seq->ptr[i].AttrInt64) {
                 goto error;
             }
             target_align = seq->ptr[i].AttrInt64;
@@ -449,3 +454,123 @@ mk_categorical(ndt_memory_seq_t *seq, ndt_context_t *ctx)
     ndt_free(seq);
     return t;
 }
+
+
+/*****************************************************************************/
+/*                               Token slices                                */
+/*****************************************************************************/
+
+/*
+ * Both parsers pass number tokens as slices of the input.  Only strings that
+ * become part of the AST are copied to the heap.  Numbers are short, so they
+ * are converted from a NUL-terminated copy on the stack.
+ */
+
+#define NUMBER_BUFSIZE 64
+
+char *
+mk_name(const char *s, size_t len, ndt_context_t *ctx)
+{
+    char *v;
+
+    v = ndt_alloc(1, len+1);
+    if (v == NULL) {
+        ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+        return NULL;
+    }
+
+    memcpy(v, s, len);
+    v[len] = '\0';
+
+    return v;
+}
+
+static char *
+number_cstring(char *buf, const char *v, size_t len, ndt_context_t *ctx)
+{
+    if (len >= NUMBER_BUFSIZE) {
+        return mk_name(v, len, ctx);
+    }
+
+    memcpy(buf, v, len);
+    buf[len] = '\0';
+
+    return buf;
+}
+
+size_t
+mk_size(const char *v, size_t len, ndt_context_t *ctx)
+{
+    char buf[NUMBER_BUFSIZE];
+    size_t size;
+    char *s;
+
+    s = number_cstring(buf, v, len, ctx);
+    if (s == NULL) {
+        return 0;
+    }
+
+    size = (size_t)ndt_strtoull(s, SIZE_MAX, ctx);
+
+    if (s != buf) {
+        ndt_free(s);
+    }
+
+    return size;
+}
+
+ndt_attr_t *
+mk_attr_int64(char *name, const char *v, size_t len, ndt_context_t *ctx)
+{
+    char buf[NUMBER_BUFSIZE];
+    ndt_attr_t *attr;
+    char *s;
+
+    s = number_cstring(buf, v, len, ctx);
+    if (s == NULL) {
+        ndt_free(name);
+        return NULL;
+    }
+
+    attr = ndt_alloc(1, sizeof *attr);
+    if (attr == NULL) {
+        ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+        goto error;
+    }
+
+    attr->AttrInt64 = (int64_t)ndt_strtoll(s, INT64_MIN, INT64_MAX, ctx);
+    if (ctx->err != NDT_Success) {
+        ndt_free(attr);
+        goto error;
+    }
+
+    if (s != buf) {
+        ndt_free(s);
+    }
+
+    attr->tag = AttrInt64;
+    attr->name = name;
+
+    return attr;
+
+error:
+    if (s != buf) {
+        ndt_free(s);
+    }
+    ndt_free(name);
+    return NULL;
+}
+
+ndt_memory_t *
+mk_memory_from_number(const char *v, size_t len, ndt_t *type, ndt_context_t *ctx)
+{
+    char *s;
+
+    s = mk_name(v, len, ctx);
+    if (s == NULL) {
+        ndt_del(type);
+        return NULL;
+    }
+
+    return ndt_memory_from_number(s, type, ctx);
+}
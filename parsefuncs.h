@@ -38,16 +38,27 @@
 /*                        Functions used in the lexer                        */
 /*****************************************************************************/
 
+/* Token that refers to the input buffer of the lexer */
+typedef struct {
+    const char *start;
+    size_t len;
+} slice_t;
+
 char *mk_stringlit(const char *src, ndt_context_t *ctx);
 
 
 /*****************************************************************************/
-/*                        Functions used in the parser                       */
+/*                        Functions used in the parsers                      */
 /*****************************************************************************/
 
-ndt_dim_t *mk_fixed_dim(const char *v, ndt_attr_seq_t *seq, ndt_context_t *ctx);
+char *mk_name(const char *s, size_t len, ndt_context_t *ctx);
+size_t mk_size(const char *v, size_t len, ndt_context_t *ctx);
+ndt_attr_t *mk_attr_int64(char *name, const char *v, size_t len, ndt_context_t *ctx);
+ndt_memory_t *mk_memory_from_number(const char *v, size_t len, ndt_t *type, ndt_context_t *ctx);
+ndt_dim_t *mk_fixed_dim(const char *v, size_t len, ndt_attr_seq_t *seq, ndt_context_t *ctx);
+ndt_dim_t *mk_fixed_dim_from_shape(size_t shape, ndt_attr_seq_t *seq, ndt_context_t *ctx);
 ndt_dim_t *mk_var_dim(ndt_attr_seq_t *seq, ndt_context_t *ctx);
-ndt_t *mk_fixed_string(const char *v, enum ndt_encoding encoding, ndt_context_t *ctx);
+ndt_t *mk_fixed_string(const char *v, size_t len, enum ndt_encoding encoding, ndt_context_t *ctx);
 ndt_t *mk_bytes(ndt_attr_seq_t *seq, ndt_context_t *ctx);
 ndt_t *mk_fixed_bytes(ndt_attr_seq_t *seq, ndt_context_t *ctx);
 ndt_t *mk_array(ndt_dim_seq_t *dims, ndt_t *dtype, ndt_attr_seq_t *attrs, ndt_context_t *ctx);
@@ -26,13 +26,29 @@
  */
 
 
+#if !defined(_MSC_VER) && !defined(_POSIX_C_SOURCE)
+  #define _POSIX_C_SOURCE 200809L /* fileno() */
+#endif
+
 #include <stdio.h>
+#include <stdint.h>
 #include <assert.h>
 #include <setjmp.h>
+#if defined(_MSC_VER)
+  #include <io.h>
+  #include <windows.h>
+#else
+  #include <sys/types.h>
+  #include <sys/stat.h>
+  #include <sys/mman.h>
+#endif
 #include "ndtypes.h"
+#include "arena.h"
 #include "seq.h"
 #include "grammar.h"
 #include "lexer.h"
+#include "pool.h"
+#include "rdparser.h"
 
 
 #ifdef YYDEBUG
@@ -40,6 +56,23 @@ int yydebug = 1;
 #endif
 
 
+/* The backend is a global setting, like the allocation functions.  It is not
+   synchronized and should be set before other threads start parsing. */
+static enum ndt_parser parser_backend = NDT_ParserBison;
+
+void
+ndt_set_parser(enum ndt_parser parser)
+{
+    parser_backend = parser;
+}
+
+enum ndt_parser
+ndt_get_parser(void)
+{
+    return parser_backend;
+}
+
+
 static FILE *
 ndt_fopen(const char *name, const char *mode)
 {
@@ -53,29 +86,75 @@ ndt_fopen(const char *name, const char *mode)
 #endif
 }
 
-/* The yy_fatal_error() function of flex calls exit(). We intercept the function
-   and do a longjmp() for proper error handling. */ 
-jmp_buf ndt_lexerror;
+/*
+ * Read the remaining input of 'fp'.  The buffer has two NUL bytes after the
+ * input, as required by yy_scan_buffer().
+ */
+static char *
+read_stream(size_t *size, FILE *fp, ndt_context_t *ctx)
+{
+    char *buffer = NULL, *tmp;
+    size_t reserved = 0, n;
+
+    *size = 0;
+
+    do {
+        if (reserved - *size <= 2) {
+            reserved = reserved == 0 ? 4096 : 2 * reserved;
+            tmp = ndt_realloc(buffer, reserved, 1);
+            if (tmp == NULL) {
+                ndt_free(buffer);
+                ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+                return NULL;
+            }
+            buffer = tmp;
+        }
+
+        n = fread(buffer + *size, 1, reserved - *size - 2, fp);
+        *size += n;
+    } while (n > 0);
 
+    if (ferror(fp)) {
+        ndt_free(buffer);
+        ndt_err_format(ctx, NDT_OSError, "could not read input");
+        return NULL;
+    }
+
+    buffer[*size] = '\0';
+    buffer[*size+1] = '\0';
+
+    return buffer;
+}
 
+/* The yy_fatal_error() function of flex calls exit(). We intercept the function
+   and do a longjmp() for proper error handling.  Each parse has its own jmp_buf,
+   which is passed to the scanner as the extra data, so that parsing is reentrant
+   and safe to run concurrently in several threads.
+
+   The scanner works on the complete input in 'buffer', which must be followed
+   by two NUL bytes.  Flex never refills or moves the buffer, so the INTEGER and
+   FLOATNUMBER tokens can refer to it until the end of the parse. */
 static ndt_t *
-_ndt_from_file(FILE *fp, ndt_context_t *ctx)
+bison_parse(char *buffer, size_t size, ndt_context_t *ctx)
 {
-    volatile yyscan_t scanner;
+    volatile yyscan_t scanner = NULL;
+    volatile YY_BUFFER_STATE state = NULL;
+    jmp_buf lexerror;
     ndt_t *ast = NULL;
     int ret;
 
-    if (setjmp(ndt_lexerror) == 0) {
-        if (yylex_init_extra(ctx, (yyscan_t *)&scanner) != 0) {
+    if (setjmp(lexerror) == 0) {
+        if (yylex_init_extra(&lexerror, (yyscan_t *)&scanner) != 0) {
             ndt_err_format(ctx, NDT_LexError, "lexer initialization failed");
             return NULL;
         }
 
-        if (fp != stdin) {
-            yyset_in(fp, scanner);
-        }
+        state = yy_scan_buffer(buffer, size+2, scanner);
+        state->yy_bs_lineno = 1;
+        state->yy_bs_column = 1;
 
         ret = yyparse(scanner, &ast, ctx);
+        yy_delete_buffer(state, scanner);
         yylex_destroy(scanner);
 
         if (ret == 2) {
@@ -84,20 +163,153 @@ _ndt_from_file(FILE *fp, ndt_context_t *ctx)
 
         return ast;
     }
-    else {
+    else { /* fatal lexer error */
+        if (state) {
+            ndt_free(state);
+        }
         if (scanner) {
             yylex_destroy(scanner);
         }
-        ndt_err_format(ctx, NDT_MemoryError,
-            "out of memory (most likely) or internal lexer error");
+        ndt_err_format(ctx, NDT_MemoryError, "flex: internal lexer error");
+        return NULL;
+    }
+}
+
+/*
+ * Parse the first 'size' bytes of 'input' with the selected backend.  The
+ * recursive descent parser works in place, flex gets a copy of the input
+ * with two trailing NUL bytes.
+ */
+static ndt_t *
+parse_input(const char *input, size_t size, ndt_context_t *ctx)
+{
+    char *buffer;
+    ndt_t *t;
+
+    /* The code generated by flex truncates size_t in several places, so
+       long inputs always go to the recursive descent parser. */
+    if (parser_backend == NDT_ParserDescent || size > INT_MAX / 2) {
+        return rd_parse(input, size, ctx);
+    }
+
+    buffer = ndt_alloc(1, size+2);
+    if (buffer == NULL) {
+        ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+        return NULL;
+    }
+    memcpy(buffer, input, size);
+    buffer[size] = '\0';
+    buffer[size+1] = '\0';
+
+    t = bison_parse(buffer, size, ctx);
+    ndt_free(buffer);
+
+    return t;
+}
+
+static ndt_t *
+_ndt_from_file(FILE *fp, ndt_context_t *ctx)
+{
+    char *buffer;
+    size_t size;
+    ndt_t *t;
+
+    buffer = read_stream(&size, fp, ctx);
+    if (buffer == NULL) {
         return NULL;
     }
+
+    /* The code generated by flex truncates size_t in several places, so
+       long inputs always go to the recursive descent parser. */
+    if (parser_backend == NDT_ParserDescent || size > INT_MAX / 2) {
+        t = rd_parse(buffer, size, ctx);
+    }
+    else {
+        t = bison_parse(buffer, size, ctx);
+    }
+
+    ndt_free(buffer);
+
+    return t;
+}
+
+/*
+ * Map a regular file into memory.  Return 1 on success, 0 if 'fp' is not a
+ * regular file or cannot be mapped.  Like any reader of a mapped file, the
+ * parser is not protected against the file being truncated concurrently.
+ */
+static int
+map_file(const char **data, size_t *size, FILE *fp)
+{
+#if defined(_MSC_VER)
+    HANDLE file = (HANDLE)_get_osfhandle(_fileno(fp));
+    HANDLE mapping;
+    LARGE_INTEGER n;
+    void *addr;
+
+    if (file == INVALID_HANDLE_VALUE || GetFileType(file) != FILE_TYPE_DISK ||
+        !GetFileSizeEx(file, &n) || n.QuadPart <= 0 ||
+        (uint64_t)n.QuadPart > SIZE_MAX) {
+        return 0;
+    }
+
+    mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping == NULL) {
+        return 0;
+    }
+
+    /* The view keeps the mapping alive. */
+    addr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (addr == NULL) {
+        return 0;
+    }
+
+    *data = addr;
+    *size = (size_t)n.QuadPart;
+    return 1;
+#else
+    struct stat st;
+    void *addr;
+
+    if (fstat(fileno(fp), &st) < 0 || !S_ISREG(st.st_mode) ||
+        st.st_size <= 0 || (uintmax_t)st.st_size > SIZE_MAX) {
+        return 0;
+    }
+
+    addr = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fileno(fp), 0);
+    if (addr == MAP_FAILED) {
+        return 0;
+    }
+
+    *data = addr;
+    *size = (size_t)st.st_size;
+    return 1;
+#endif
 }
 
+static void
+unmap_file(const char *data, size_t size)
+{
+#if defined(_MSC_VER)
+    (void)size;
+    UnmapViewOfFile(data);
+#else
+    munmap((void *)data, size);
+#endif
+}
+
+/*
+ * Regular files are mapped into memory, standard input, pipes and other
+ * streams are read into a buffer.  The input is parsed with the selected
+ * backend.
+ */
 ndt_t *
 ndt_from_file(const char *name, ndt_context_t *ctx)
 {
     FILE *fp;
+    const char *data;
+    size_t size;
     ndt_t *t;
 
     if (strcmp(name, "-") == 0) {
@@ -109,73 +321,187 @@ ndt_from_file(const char *name, ndt_context_t *ctx)
             ndt_err_format(ctx, NDT_OSError, "could not open %s", name);
             return NULL;
         }
+
+        if (map_file(&data, &size, fp)) {
+            fclose(fp);
+            t = parse_input(data, size, ctx);
+            unmap_file(data, size);
+            return t;
+        }
     }
 
     t = _ndt_from_file(fp, ctx);
-    fclose(fp);
- 
+
+    if (fp != stdin) {
+        fclose(fp);
+    }
+
     return t;
 }
 
-
 ndt_t *
 ndt_from_string(const char *input, ndt_context_t *ctx)
 {
-    volatile yyscan_t scanner = NULL;
-    volatile YY_BUFFER_STATE state = NULL;
+    return parse_input(input, strlen(input), ctx);
+}
+
+/*
+ * Parse the first 'len' bytes of 'input', which does not have to be
+ * NUL-terminated.
+ */
+ndt_t *
+ndt_from_buffer(const char *input, size_t len, ndt_context_t *ctx)
+{
+    return parse_input(input, len, ctx);
+}
+
+/*
+ * Parse 'input' and return the result as an arena type.  The parser runs in
+ * an allocation region, so the intermediate tree costs a few chunk
+ * allocations instead of one allocation per node, and it is discarded as a
+ * whole after it has been copied into the arena.
+ */
+ndt_t *
+ndt_from_string_arena(const char *input, ndt_context_t *ctx)
+{
+    region_t region;
+    ndt_t *t, *u = NULL;
+
+    region_begin(&region);
+    t = parse_input(input, strlen(input), ctx);
+    region_end(&region);
+
+    if (t != NULL) {
+        u = ndt_arena_copy(t, ctx);
+    }
+
+    region_free(&region);
+    return u;
+}
+
+/*
+ * A module is a sequence of declarations "typedef name = datashape".  The
+ * declarations may refer to each other in any order, as long as there are
+ * no cycles.  Either all typedefs of the module are registered or, on error,
+ * none of them.  Modules are always parsed by the recursive descent parser.
+ */
+int
+ndt_module_from_buffer(const char *input, size_t len, ndt_context_t *ctx)
+{
+    return rd_parse_module(input, len, ctx);
+}
+
+int
+ndt_module_from_string(const char *input, ndt_context_t *ctx)
+{
+    return rd_parse_module(input, strlen(input), ctx);
+}
+
+int
+ndt_module_from_file(const char *name, ndt_context_t *ctx)
+{
+    FILE *fp;
+    const char *data;
     char *buffer;
     size_t size;
-    ndt_t *ast = NULL;
     int ret;
 
-    size = strlen(input);
-    if (size > INT_MAX / 2) {
-        /* The code generated by flex truncates size_t in several places. */
-        ndt_err_format(ctx, NDT_LexError, "maximum input length: %s", INT_MAX/2);
-        return NULL;
+    if (strcmp(name, "-") == 0) {
+        fp = stdin;
+    }
+    else {
+        fp = ndt_fopen(name, "rb");
+        if (fp == NULL) {
+            ndt_err_format(ctx, NDT_OSError, "could not open %s", name);
+            return -1;
+        }
+
+        if (map_file(&data, &size, fp)) {
+            fclose(fp);
+            ret = rd_parse_module(data, size, ctx);
+            unmap_file(data, size);
+            return ret;
+        }
     }
 
-    buffer = ndt_alloc(1, size+2);
+    buffer = read_stream(&size, fp, ctx);
+    if (fp != stdin) {
+        fclose(fp);
+    }
     if (buffer == NULL) {
-        ndt_err_format(ctx, NDT_MemoryError, "out of memory");
-        return NULL;
+        return -1;
     }
-    memcpy(buffer, input, size);
-    buffer[size] = '\0';
-    buffer[size+1] = '\0';
 
-    if (setjmp(ndt_lexerror) == 0) {
-        if (yylex_init_extra(ctx, (yyscan_t *)&scanner) != 0) {
-            ndt_err_format(ctx, NDT_LexError, "lexer initialization failed");
-            ndt_free(buffer);
-            return NULL;
-        }
+    ret = rd_parse_module(buffer, size, ctx);
+    ndt_free(buffer);
 
-        state = yy_scan_buffer(buffer, size+2, scanner);
-        state->yy_bs_lineno = 1;
-        state->yy_bs_column = 1;
+    return ret;
+}
 
-        ret = yyparse(scanner, &ast, ctx);
-        yy_delete_buffer(state, scanner);
-        yylex_destroy(scanner);
-        ndt_free(buffer);
 
-        if (ret == 2) {
-            ndt_err_format(ctx, NDT_MemoryError, "out of memory");
-        }
+/* Inputs per task. */
+#define PARSE_BATCH_TASK 16
 
-        return ast;
-    }
-    else { /* fatal lexer error */
-        if (state) {
-            ndt_free(state);
-        }
-        if (scanner) {
-            yylex_destroy(scanner);
+typedef struct {
+    ndt_t **types;
+    ndt_context_t *errors;
+    const char * const *inputs;
+    size_t n;
+} parse_batch_t;
+
+static void
+parse_batch_task(void *arg, size_t task, int worker)
+{
+    const parse_batch_t *b = arg;
+    size_t start = task * PARSE_BATCH_TASK;
+    size_t end = b->n - start < PARSE_BATCH_TASK ? b->n : start + PARSE_BATCH_TASK;
+    ndt_context_t local;
+    ndt_context_t *ctx;
+    size_t i;
+
+    (void)worker;
+
+    for (i = start; i < end; i++) {
+        ctx = b->errors ? &b->errors[i] : &local;
+        ctx->err = NDT_Success;
+        ctx->msg = ConstMsg;
+        ctx->ConstMsg = "Success";
+
+        b->types[i] = ndt_from_string(b->inputs[i], ctx);
+        if (ctx == &local) {
+            ndt_err_clear(ctx);
         }
-        ndt_free(buffer);
-        ndt_err_format(ctx, NDT_MemoryError, "flex: internal lexer error");
-        return NULL;
     }
 }
 
+/*
+ * Parse inputs[0], ..., inputs[n-1] with the selected backend.  types[i] is
+ * the result for inputs[i] or NULL on error.  If 'errors' is not NULL, it
+ * must have n entries and errors[i] is overwritten with the status of
+ * inputs[i]; the caller releases the messages with ndt_err_clear().  If
+ * 'pool' is not NULL, the inputs are distributed over its threads.  Every
+ * input is parsed with its own scanner and context.  Return the number of
+ * failures.
+ */
+size_t
+ndt_from_string_batch(ndt_t **types, ndt_context_t *errors,
+                      const char * const *inputs, size_t n, ndt_pool_t *pool)
+{
+    parse_batch_t b;
+    size_t nfail = 0;
+    size_t i;
+
+    b.types = types;
+    b.errors = errors;
+    b.inputs = inputs;
+    b.n = n;
+
+    pool_run(pool, parse_batch_task, &b,
+             n / PARSE_BATCH_TASK + (n % PARSE_BATCH_TASK != 0));
+
+    for (i = 0; i < n; i++) {
+        nfail += types[i] == NULL;
+    }
+
+    return nfail;
+}
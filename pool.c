@@ -0,0 +1,300 @@
+/*
+ * Copyright (c) 2016, Continuum Analytics, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * Redistributions of source code must retain the above copyright notice,
+ * 
+ * this list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <limits.h>
+#include <stdbool.h>
+#include "ndtypes.h"
+#include "pool.h"
+#include "sync.h"
+
+#if defined(_MSC_VER)
+  #include <process.h>
+  typedef HANDLE thread_t;
+  #define THREAD_FUNC unsigned __stdcall
+  #define THREAD_RETURN 0
+#else
+  #include <unistd.h>
+  typedef pthread_t thread_t;
+  #define THREAD_FUNC void *
+  #define THREAD_RETURN NULL
+#endif
+
+
+/*****************************************************************************/
+/*                                Worker pool                                */
+/*****************************************************************************/
+
+/*
+ * Fixed set of threads that run the tasks of one job at a time.  Tasks are
+ * handed out through a shared counter, so threads that finish early take
+ * over the remaining tasks.  Concurrent calls to pool_run() are serialized.
+ */
+
+typedef struct {
+    ndt_pool_t *pool;
+    int worker;
+} worker_arg_t;
+
+struct ndt_pool {
+    int nthreads;               /* threads in addition to the caller */
+    ndt_mutex_t run_lock;       /* serializes jobs */
+    ndt_mutex_t lock;
+    ndt_cond_t start;
+    ndt_cond_t finished;
+    uint64_t generation;        /* incremented for every job */
+    int active;                 /* threads that are running the current job */
+    bool shutdown;
+
+    pool_func_t func;
+    void *arg;
+    size_t ntasks;
+    size_t next;                /* next task to run */
+
+    thread_t *threads;
+    worker_arg_t *args;
+};
+
+static int
+cpu_count(void)
+{
+#if defined(_MSC_VER)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n < 1 ? 1 : n > INT_MAX ? INT_MAX : (int)n;
+#endif
+}
+
+static void
+run_tasks(ndt_pool_t *pool, int worker)
+{
+    size_t i;
+
+    while ((i = ndt_atomic_fetch_add(&pool->next, 1)) < pool->ntasks) {
+        pool->func(pool->arg, i, worker);
+    }
+}
+
+static THREAD_FUNC
+worker_main(void *arg)
+{
+    worker_arg_t *w = arg;
+    ndt_pool_t *pool = w->pool;
+    uint64_t seen = 0;
+
+    ndt_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->shutdown && pool->generation == seen) {
+            ndt_cond_wait(&pool->start, &pool->lock);
+        }
+        if (pool->shutdown) {
+            break;
+        }
+        seen = pool->generation;
+        ndt_mutex_unlock(&pool->lock);
+
+        run_tasks(pool, w->worker);
+
+        ndt_mutex_lock(&pool->lock);
+        if (--pool->active == 0) {
+            ndt_cond_signal(&pool->finished);
+        }
+    }
+    ndt_mutex_unlock(&pool->lock);
+
+    return THREAD_RETURN;
+}
+
+static int
+thread_start(thread_t *tid, THREAD_FUNC (*func)(void *), void *arg)
+{
+#if defined(_MSC_VER)
+    *tid = (HANDLE)_beginthreadex(NULL, 0, func, arg, 0, NULL);
+    return *tid == 0 ? -1 : 0;
+#else
+    return pthread_create(tid, NULL, func, arg) != 0 ? -1 : 0;
+#endif
+}
+
+static void
+thread_join(thread_t tid)
+{
+#if defined(_MSC_VER)
+    WaitForSingleObject(tid, INFINITE);
+    CloseHandle(tid);
+#else
+    pthread_join(tid, NULL);
+#endif
+}
+
+static void
+pool_stop(ndt_pool_t *pool, int nstarted)
+{
+    int i;
+
+    ndt_mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    ndt_cond_broadcast(&pool->start);
+    ndt_mutex_unlock(&pool->lock);
+
+    for (i = 0; i < nstarted; i++) {
+        thread_join(pool->threads[i]);
+    }
+}
+
+static void
+pool_free(ndt_pool_t *pool)
+{
+    ndt_cond_destroy(&pool->finished);
+    ndt_cond_destroy(&pool->start);
+    ndt_mutex_destroy(&pool->lock);
+    ndt_mutex_destroy(&pool->run_lock);
+    ndt_free(pool->args);
+    ndt_free(pool->threads);
+    ndt_free(pool);
+}
+
+/*
+ * Create a pool with 'nworkers' threads, including the thread that submits
+ * the work.  If 'nworkers' is 0, use the number of online processors.
+ */
+ndt_pool_t *
+ndt_pool_new(int nworkers, ndt_context_t *ctx)
+{
+    ndt_pool_t *pool;
+    int i;
+
+    if (nworkers < 0 || nworkers > NDT_POOL_MAX) {
+        ndt_err_format(ctx, NDT_ValueError,
+            "number of workers must be in [0, %d]", NDT_POOL_MAX);
+        return NULL;
+    }
+    if (nworkers == 0) {
+        nworkers = cpu_count();
+        if (nworkers > NDT_POOL_MAX) {
+            nworkers = NDT_POOL_MAX;
+        }
+    }
+
+    pool = ndt_alloc(1, sizeof *pool);
+    if (pool == NULL) {
+        ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+        return NULL;
+    }
+
+    pool->nthreads = nworkers-1;
+    pool->generation = 0;
+    pool->active = 0;
+    pool->shutdown = 0;
+    pool->func = NULL;
+    pool->arg = NULL;
+    pool->ntasks = 0;
+    pool->next = 0;
+    ndt_mutex_init(&pool->run_lock);
+    ndt_mutex_init(&pool->lock);
+    ndt_cond_init(&pool->start);
+    ndt_cond_init(&pool->finished);
+
+    pool->threads = ndt_alloc(nworkers, sizeof *pool->threads);
+    pool->args = ndt_alloc(nworkers, sizeof *pool->args);
+    if (pool->threads == NULL || pool->args == NULL) {
+        pool_free(pool);
+        ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+        return NULL;
+    }
+
+    for (i = 0; i < pool->nthreads; i++) {
+        pool->args[i].pool = pool;
+        pool->args[i].worker = i+1;
+        if (thread_start(&pool->threads[i], worker_main, &pool->args[i]) < 0) {
+            pool_stop(pool, i);
+            pool_free(pool);
+            ndt_err_format(ctx, NDT_RuntimeError, "could not start thread");
+            return NULL;
+        }
+    }
+
+    return pool;
+}
+
+void
+ndt_pool_del(ndt_pool_t *pool)
+{
+    if (pool == NULL) {
+        return;
+    }
+
+    pool_stop(pool, pool->nthreads);
+    pool_free(pool);
+}
+
+/* Number of threads that run tasks, including the caller. */
+int
+ndt_pool_workers(const ndt_pool_t *pool)
+{
+    return pool == NULL ? 1 : pool->nthreads+1;
+}
+
+void
+pool_run(ndt_pool_t *pool, pool_func_t func, void *arg, size_t ntasks)
+{
+    size_t i;
+
+    if (pool == NULL || pool->nthreads == 0 || ntasks <= 1) {
+        for (i = 0; i < ntasks; i++) {
+            func(arg, i, 0);
+        }
+        return;
+    }
+
+    ndt_mutex_lock(&pool->run_lock);
+
+    ndt_mutex_lock(&pool->lock);
+    pool->func = func;
+    pool->arg = arg;
+    pool->ntasks = ntasks;
+    pool->next = 0;
+    pool->active = pool->nthreads;
+    pool->generation++;
+    ndt_cond_broadcast(&pool->start);
+    ndt_mutex_unlock(&pool->lock);
+
+    run_tasks(pool, 0);
+
+    ndt_mutex_lock(&pool->lock);
+    while (pool->active > 0) {
+        ndt_cond_wait(&pool->finished, &pool->lock);
+    }
+    ndt_mutex_unlock(&pool->lock);
+
+    ndt_mutex_unlock(&pool->run_lock);
+}
@@ -0,0 +1,687 @@
+/*
+ * Copyright (c) 2016, Continuum Analytics, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * Redistributions of source code must retain the above copyright notice,
+ * 
+ * this list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include "rdlexer.h"
+
+
+/*****************************************************************************/
+/*                  Lexer for the recursive descent parser                   */
+/*****************************************************************************/
+
+/*
+ * Hand-written version of lexer.l.  The lexer works on a buffer with an
+ * explicit end and never allocates:  a token is a slice of the input.
+ * Where the patterns of lexer.l overlap, the longest match wins, and for
+ * matches of the same length the earlier rule wins, as in flex.
+ */
+
+typedef struct {
+    const char *name;
+    size_t len;
+    enum rd_token tag;
+} keyword_t;
+
+#define KW(s, tag) { s, sizeof s - 1, tag }
+
+/*
+ * Keywords are found with a perfect hash.  The hash combines the length
+ * with the first two and the last two characters of an identifier.  The
+ * definitions and the table below are generated from the keyword rules of
+ * lexer.l by tools/kwhash.c (make kwhash && ./kwhash lexer.l), which
+ * searches a multiplier so that no two keywords share a slot.  test_keywords
+ * in tests/runtest.c checks that the table matches lexer.l.
+ */
+#define KW_MINLEN 3
+#define KW_MAXLEN 12
+#define KW_HASHBITS 7
+#define KW_MULT 0x45a0b8e3U
+
+static const keyword_t keywords[1<<KW_HASHBITS] = {
+  [0] = KW("categorical", TOK_CATEGORICAL),
+  [1] = KW("complex128", TOK_COMPLEX128),
+  [10] = KW("pointer", TOK_POINTER),
+  [14] = KW("intptr", TOK_INTPTR),
+  [17] = KW("int8", TOK_INT8),
+  [24] = KW("int", TOK_INT),
+  [25] = KW("void", TOK_VOID),
+  [27] = KW("size_t", TOK_SIZE),
+  [30] = KW("complex", TOK_COMPLEX),
+  [37] = KW("float64", TOK_FLOAT64),
+  [39] = KW("uint64", TOK_UINT64),
+  [41] = KW("real", TOK_REAL),
+  [45] = KW("float32", TOK_FLOAT32),
+  [46] = KW("bool", TOK_BOOL),
+  [47] = KW("uint32", TOK_UINT32),
+  [52] = KW("Scalar", TOK_SCALAR_KIND),
+  [54] = KW("string", TOK_STRING),
+  [57] = KW("char", TOK_CHAR),
+  [58] = KW("float16", TOK_FLOAT16),
+  [59] = KW("fixed", TOK_FIXED),
+  [60] = KW("uint16", TOK_UINT16),
+  [61] = KW("fixed_bytes", TOK_FIXED_BYTES),
+  [65] = KW("FixedBytes", TOK_FIXED_BYTES_KIND),
+  [67] = KW("fixed_string", TOK_FIXED_STRING),
+  [68] = KW("Complex", TOK_COMPLEX_KIND),
+  [69] = KW("int64", TOK_INT64),
+  [74] = KW("option", TOK_OPTION),
+  [77] = KW("int32", TOK_INT32),
+  [79] = KW("Real", TOK_REAL_KIND),
+  [80] = KW("complex64", TOK_COMPLEX64),
+  [81] = KW("FixedString", TOK_FIXED_STRING_KIND),
+  [83] = KW("Signed", TOK_SIGNED_KIND),
+  [90] = KW("int16", TOK_INT16),
+  [95] = KW("Any", TOK_ANY_KIND),
+  [97] = KW("Fixed", TOK_FIXED_DIM_KIND),
+  [101] = KW("uintptr", TOK_UINTPTR),
+  [104] = KW("uint8", TOK_UINT8),
+  [110] = KW("var", TOK_VAR),
+  [114] = KW("bytes", TOK_BYTES),
+  [124] = KW("Unsigned", TOK_UNSIGNED_KIND),
+};
+
+static uint32_t
+keyword_hash(const unsigned char *s, size_t len)
+{
+    uint32_t k = (uint32_t)s[0] | (uint32_t)s[1] << 8 |
+                 (uint32_t)s[len-2] << 16 | (uint32_t)s[len-1] << 24;
+
+    k ^= (uint32_t)len;
+
+    return (uint32_t)(k * KW_MULT) >> (32-KW_HASHBITS);
+}
+
+static enum rd_token
+identifier(const char *s, size_t len)
+{
+    const keyword_t *kw;
+
+    if (KW_MINLEN <= len && len <= KW_MAXLEN) {
+        kw = &keywords[keyword_hash((const unsigned char *)s, len)];
+        if (kw->len == len && memcmp(s, kw->name, len) == 0) {
+            return kw->tag;
+        }
+    }
+
+    if ('a' <= s[0] && s[0] <= 'z') {
+        return TOK_NAME_LOWER;
+    }
+    if ('A' <= s[0] && s[0] <= 'Z') {
+        return TOK_NAME_UPPER;
+    }
+    return TOK_NAME_OTHER;
+}
+
+
+/*****************************************************************************/
+/*                              Character classes                            */
+/*****************************************************************************/
+
+static int
+is_digit(int c)
+{
+    return '0' <= c && c <= '9';
+}
+
+static int
+is_octdigit(int c)
+{
+    return '0' <= c && c <= '7';
+}
+
+static int
+is_hexdigit(int c)
+{
+    return is_digit(c) || ('a' <= c && c <= 'f') || ('A' <= c && c <= 'F');
+}
+
+static int
+is_name_start(int c)
+{
+    return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') || c == '_';
+}
+
+static int
+is_name_char(int c)
+{
+    return is_name_start(c) || is_digit(c);
+}
+
+
+/*****************************************************************************/
+/*                                  Scanning                                 */
+/*****************************************************************************/
+
+/*
+ * Runs of identifier characters, digits, blanks and comment text are
+ * scanned 16 bytes at a time with SSE2, or 32 bytes at a time if the
+ * compiler targets AVX2.  The vector loop only runs while a whole vector
+ * fits before 'end', the rest is scanned by the scalar loop.  Defining
+ * NDT_NO_SIMD selects the scalar loops everywhere.
+ */
+
+#if !defined(NDT_NO_SIMD) && defined(__AVX2__)
+  #include <immintrin.h>
+  #define RD_SIMD
+  #define VEC_WIDTH 32
+  #define VEC_FULL 0xffffffffU
+  typedef __m256i vec_t;
+  #define vec_load(p) _mm256_loadu_si256((const __m256i *)(p))
+  #define vec_set1(c) _mm256_set1_epi8((char)(c))
+  #define vec_add(a, b) _mm256_add_epi8(a, b)
+  #define vec_or(a, b) _mm256_or_si256(a, b)
+  #define vec_eq(a, b) _mm256_cmpeq_epi8(a, b)
+  #define vec_lt(a, b) _mm256_cmpgt_epi8(b, a)
+  #define vec_mask(a) ((uint32_t)_mm256_movemask_epi8(a))
+#elif !defined(NDT_NO_SIMD) && \
+      (defined(__SSE2__) || defined(_M_X64) || \
+       (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+  #include <emmintrin.h>
+  #define RD_SIMD
+  #define VEC_WIDTH 16
+  #define VEC_FULL 0xffffU
+  typedef __m128i vec_t;
+  #define vec_load(p) _mm_loadu_si128((const __m128i *)(p))
+  #define vec_set1(c) _mm_set1_epi8((char)(c))
+  #define vec_add(a, b) _mm_add_epi8(a, b)
+  #define vec_or(a, b) _mm_or_si128(a, b)
+  #define vec_eq(a, b) _mm_cmpeq_epi8(a, b)
+  #define vec_lt(a, b) _mm_cmplt_epi8(a, b)
+  #define vec_mask(a) ((uint32_t)_mm_movemask_epi8(a))
+#endif
+
+#ifdef RD_SIMD
+#ifdef _MSC_VER
+#include <intrin.h>
+static int
+first_bit(uint32_t m)
+{
+    unsigned long i;
+    _BitScanForward(&i, m);
+    return (int)i;
+}
+#else
+static int
+first_bit(uint32_t m)
+{
+    return __builtin_ctz(m);
+}
+#endif
+
+/* Bytes of 'v' in the range [lo, hi].  SSE2 only has signed comparisons,
+   so the range is shifted to start at -128. */
+static vec_t
+vec_in_range(vec_t v, int lo, int hi)
+{
+    vec_t t = vec_add(v, vec_set1(0x80 - lo));
+    return vec_lt(t, vec_set1(0x80 + (hi-lo+1)));
+}
+
+static vec_t
+vec_name_char(vec_t v)
+{
+    vec_t letter = vec_in_range(vec_or(v, vec_set1(0x20)), 'a', 'z');
+    vec_t digit = vec_in_range(v, '0', '9');
+    return vec_or(vec_or(letter, digit), vec_eq(v, vec_set1('_')));
+}
+
+static vec_t
+vec_blank(vec_t v)
+{
+    vec_t space = vec_eq(v, vec_set1(' '));
+    vec_t tab = vec_eq(v, vec_set1('\t'));
+    return vec_or(vec_or(space, tab), vec_eq(v, vec_set1('\f')));
+}
+
+static vec_t
+vec_newline(vec_t v)
+{
+    return vec_or(vec_eq(v, vec_set1('\n')), vec_eq(v, vec_set1('\r')));
+}
+#endif
+
+/* End of the run of [a-zA-Z0-9_] at 'p'. */
+static const char *
+scan_name(const char *p, const char *end)
+{
+#ifdef RD_SIMD
+    uint32_t m;
+
+    while (end-p >= VEC_WIDTH) {
+        m = ~vec_mask(vec_name_char(vec_load(p))) & VEC_FULL;
+        if (m != 0) {
+            return p + first_bit(m);
+        }
+        p += VEC_WIDTH;
+    }
+#endif
+
+    while (p < end && is_name_char(*p)) {
+        p++;
+    }
+
+    return p;
+}
+
+/* End of the run of [0-9] at 'p'. */
+static const char *
+scan_digits(const char *p, const char *end)
+{
+#ifdef RD_SIMD
+    uint32_t m;
+
+    while (end-p >= VEC_WIDTH) {
+        m = ~vec_mask(vec_in_range(vec_load(p), '0', '9')) & VEC_FULL;
+        if (m != 0) {
+            return p + first_bit(m);
+        }
+        p += VEC_WIDTH;
+    }
+#endif
+
+    while (p < end && is_digit(*p)) {
+        p++;
+    }
+
+    return p;
+}
+
+/* End of the run of [ \t\f] at 'p'. */
+static const char *
+scan_blank(const char *p, const char *end)
+{
+#ifdef RD_SIMD
+    uint32_t m;
+
+    while (end-p >= VEC_WIDTH) {
+        m = ~vec_mask(vec_blank(vec_load(p))) & VEC_FULL;
+        if (m != 0) {
+            return p + first_bit(m);
+        }
+        p += VEC_WIDTH;
+    }
+#endif
+
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\f')) {
+        p++;
+    }
+
+    return p;
+}
+
+/* First '\n' or '\r' at or after 'p', 'end' if there is none. */
+static const char *
+scan_line(const char *p, const char *end)
+{
+#ifdef RD_SIMD
+    uint32_t m;
+
+    while (end-p >= VEC_WIDTH) {
+        m = vec_mask(vec_newline(vec_load(p)));
+        if (m != 0) {
+            return p + first_bit(m);
+        }
+        p += VEC_WIDTH;
+    }
+#endif
+
+    while (p < end && *p != '\n' && *p != '\r') {
+        p++;
+    }
+
+    return p;
+}
+
+
+/*****************************************************************************/
+/*                                   Numbers                                 */
+/*****************************************************************************/
+
+/* Length of the 'integer' pattern of lexer.l at 's', 0 if it does not match. */
+static size_t
+match_integer(const char *s, const char *end)
+{
+    const char *p = s;
+    const char *q;
+
+    if (p < end && *p == '-') {
+        p++;
+    }
+    if (p == end || !is_digit(*p)) {
+        return 0;
+    }
+
+    if (*p == '0' && end-p > 2) {
+        if ((p[1] == 'o' || p[1] == 'O') && is_octdigit(p[2])) {
+            for (q = p+2; q < end && is_octdigit(*q); q++);
+            return q-s;
+        }
+        if ((p[1] == 'x' || p[1] == 'X') && is_hexdigit(p[2])) {
+            for (q = p+2; q < end && is_hexdigit(*q); q++);
+            return q-s;
+        }
+    }
+
+    if (*p == '0') {
+        for (q = p; q < end && *q == '0'; q++);
+    }
+    else {
+        q = scan_digits(p, end);
+    }
+
+    return q-s;
+}
+
+/* Length of the 'floatnumber' pattern of lexer.l at 's', 0 if it does not
+   match. */
+static size_t
+match_float(const char *s, const char *end)
+{
+    const char *p = s;
+    const char *q;
+    size_t ndigits, nfrac;
+    int valid = 0;
+
+    if (p < end && *p == '-') {
+        p++;
+    }
+
+    q = scan_digits(p, end);
+    ndigits = q-p;
+    p = q;
+
+    /* pointfloat */
+    if (p < end && *p == '.') {
+        q = scan_digits(p+1, end);
+        nfrac = q-(p+1);
+        if (ndigits > 0 || nfrac > 0) {
+            p = q;
+            valid = 1;
+        }
+    }
+
+    if (!valid && ndigits == 0) {
+        return 0;
+    }
+
+    /* exponent */
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        q = p+1;
+        if (q < end && (*q == '+' || *q == '-')) {
+            q++;
+        }
+        if (q < end && is_digit(*q)) {
+            p = scan_digits(q, end);
+            valid = 1;
+        }
+    }
+
+    return valid ? (size_t)(p-s) : 0;
+}
+
+
+/*****************************************************************************/
+/*                                   Strings                                 */
+/*****************************************************************************/
+
+/* Length of a string literal at 's', 0 if it does not match. */
+static size_t
+match_string(const char *s, const char *end)
+{
+    const char quote = *s;
+    const char *p;
+
+    for (p = s+1; p < end; p++) {
+        if (*p == quote) {
+            return p+1-s;
+        }
+        if (*p == '\n' || *p == '\0') {
+            return 0;
+        }
+        if (*p == '\\') {
+            p++;
+            if (p == end || *p == '\n' || *p == '\0') {
+                return 0;
+            }
+        }
+    }
+
+    return 0;
+}
+
+
+/*****************************************************************************/
+/*                                    Lexer                                  */
+/*****************************************************************************/
+
+void
+rd_lexer_init(rd_lexer_t *lex, const char *input, size_t len)
+{
+    lex->cur = input;
+    lex->end = input + len;
+    lex->linestart = input;
+    lex->line = 1;
+}
+
+static void
+skip_space(rd_lexer_t *lex)
+{
+    const char *p = lex->cur;
+    const char *end = lex->end;
+
+    while (p < end) {
+        switch (*p) {
+        case ' ': case '\t': case '\f':
+            p++;
+            /* Most blanks are single spaces between tokens. */
+            if (p < end && (*p == ' ' || *p == '\t' || *p == '\f')) {
+                p = scan_blank(p+1, end);
+            }
+            break;
+        case '\n':
+            if (lex->line < INT_MAX) {
+                lex->line++;
+            }
+            /* fall through */
+        case '\r':
+            p++;
+            lex->linestart = p;
+            break;
+        case '#':
+            p = scan_line(p+1, end);
+            break;
+        default:
+            lex->cur = p;
+            return;
+        }
+    }
+
+    lex->cur = p;
+}
+
+void
+rd_lex(rd_lexer_t *lex, rd_token_t *tok)
+{
+    const char *p;
+    const char *end = lex->end;
+    size_t n, m;
+
+    skip_space(lex);
+
+    p = lex->cur;
+    tok->start = p;
+    tok->line = lex->line;
+    n = p - lex->linestart;
+    tok->column = n < INT_MAX ? (int)n + 1 : INT_MAX;
+
+    if (p == end) {
+        tok->tag = TOK_EOF;
+        tok->len = 0;
+        return;
+    }
+
+    n = 1;
+
+    switch (*p) {
+    case ',': tok->tag = TOK_COMMA; break;
+    case ':': tok->tag = TOK_COLON; break;
+    case '(': tok->tag = TOK_LPAREN; break;
+    case ')': tok->tag = TOK_RPAREN; break;
+    case '{': tok->tag = TOK_LBRACE; break;
+    case '}': tok->tag = TOK_RBRACE; break;
+    case '[': tok->tag = TOK_LBRACK; break;
+    case ']': tok->tag = TOK_RBRACK; break;
+    case '*': tok->tag = TOK_STAR; break;
+    case '=': tok->tag = TOK_EQUAL; break;
+    case '?': tok->tag = TOK_QUESTIONMARK; break;
+    case '|': tok->tag = TOK_BAR; break;
+
+    case '\'': case '"':
+        n = match_string(p, end);
+        if (n == 0) {
+            n = 1;
+            tok->tag = TOK_ERROR;
+        }
+        else {
+            tok->tag = TOK_STRINGLIT;
+        }
+        break;
+
+    case '-': case '.':
+    case '0': case '1': case '2': case '3': case '4':
+    case '5': case '6': case '7': case '8': case '9':
+        n = match_integer(p, end);
+        m = match_float(p, end);
+        if (n > 0 && n >= m) {
+            tok->tag = TOK_INTEGER;
+        }
+        else if (m > 0) {
+            n = m;
+            tok->tag = TOK_FLOATNUMBER;
+        }
+        else if (end-p >= 2 && p[0] == '-' && p[1] == '>') {
+            n = 2;
+            tok->tag = TOK_RARROW;
+        }
+        else if (end-p >= 3 && p[0] == '.' && p[1] == '.' && p[2] == '.') {
+            n = 3;
+            tok->tag = TOK_ELLIPSIS;
+        }
+        else {
+            n = 1;
+            tok->tag = TOK_ERROR;
+        }
+        break;
+
+    default:
+        if (is_name_start(*p)) {
+            n = scan_name(p+1, end) - p;
+            tok->tag = identifier(p, n);
+        }
+        else {
+            tok->tag = TOK_ERROR;
+        }
+        break;
+    }
+
+    tok->len = n;
+    lex->cur = p + n;
+}
+
+const char *
+rd_token_name(enum rd_token tag)
+{
+    switch (tag) {
+    case TOK_EOF: return "end of file";
+    case TOK_ERROR: return "ERRTOKEN";
+    case TOK_ANY_KIND: return "ANY_KIND";
+    case TOK_OPTION: return "OPTION";
+    case TOK_SCALAR_KIND: return "SCALAR_KIND";
+    case TOK_VOID: return "VOID";
+    case TOK_BOOL: return "BOOL";
+    case TOK_SIGNED_KIND: return "SIGNED_KIND";
+    case TOK_INT8: return "INT8";
+    case TOK_INT16: return "INT16";
+    case TOK_INT32: return "INT32";
+    case TOK_INT64: return "INT64";
+    case TOK_UNSIGNED_KIND: return "UNSIGNED_KIND";
+    case TOK_UINT8: return "UINT8";
+    case TOK_UINT16: return "UINT16";
+    case TOK_UINT32: return "UINT32";
+    case TOK_UINT64: return "UINT64";
+    case TOK_REAL_KIND: return "REAL_KIND";
+    case TOK_FLOAT16: return "FLOAT16";
+    case TOK_FLOAT32: return "FLOAT32";
+    case TOK_FLOAT64: return "FLOAT64";
+    case TOK_COMPLEX_KIND: return "COMPLEX_KIND";
+    case TOK_COMPLEX64: return "COMPLEX64";
+    case TOK_COMPLEX128: return "COMPLEX128";
+    case TOK_CATEGORICAL: return "CATEGORICAL";
+    case TOK_REAL: return "REAL";
+    case TOK_COMPLEX: return "COMPLEX";
+    case TOK_INT: return "INT";
+    case TOK_INTPTR: return "INTPTR";
+    case TOK_UINTPTR: return "UINTPTR";
+    case TOK_SIZE: return "SIZE";
+    case TOK_CHAR: return "CHAR";
+    case TOK_STRING: return "STRING";
+    case TOK_FIXED_STRING_KIND: return "FIXED_STRING_KIND";
+    case TOK_FIXED_STRING: return "FIXED_STRING";
+    case TOK_BYTES: return "BYTES";
+    case TOK_FIXED_BYTES_KIND: return "FIXED_BYTES_KIND";
+    case TOK_FIXED_BYTES: return "FIXED_BYTES";
+    case TOK_POINTER: return "POINTER";
+    case TOK_FIXED_DIM_KIND: return "FIXED_DIM_KIND";
+    case TOK_FIXED: return "FIXED";
+    case TOK_VAR: return "VAR";
+    case TOK_ELLIPSIS: return "ELLIPSIS";
+    case TOK_RARROW: return "RARROW";
+    case TOK_COMMA: return "COMMA";
+    case TOK_COLON: return "COLON";
+    case TOK_LPAREN: return "LPAREN";
+    case TOK_RPAREN: return "RPAREN";
+    case TOK_LBRACE: return "LBRACE";
+    case TOK_RBRACE: return "RBRACE";
+    case TOK_LBRACK: return "LBRACK";
+    case TOK_RBRACK: return "RBRACK";
+    case TOK_STAR: return "STAR";
+    case TOK_EQUAL: return "EQUAL";
+    case TOK_QUESTIONMARK: return "QUESTIONMARK";
+    case TOK_BAR: return "BAR";
+    case TOK_INTEGER: return "INTEGER";
+    case TOK_FLOATNUMBER: return "FLOATNUMBER";
+    case TOK_STRINGLIT: return "STRINGLIT";
+    case TOK_NAME_LOWER: return "NAME_LOWER";
+    case TOK_NAME_UPPER: return "NAME_UPPER";
+    case TOK_NAME_OTHER: return "NAME_OTHER";
+    default: return "unknown token";
+    }
+}
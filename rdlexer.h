@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2016, Continuum Analytics, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * Redistributions of source code must retain the above copyright notice,
+ * 
+ * this list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef RDLEXER_H
+#define RDLEXER_H
+
+
+#include <stddef.h>
+
+
+/*****************************************************************************/
+/*                  Lexer for the recursive descent parser                   */
+/*****************************************************************************/
+
+/* The tokens are the same as in grammar.y. */
+enum rd_token {
+  TOK_EOF,
+  TOK_ERROR,
+
+  /* keywords */
+  TOK_ANY_KIND,
+  TOK_OPTION,
+  TOK_SCALAR_KIND,
+  TOK_VOID,
+  TOK_BOOL,
+  TOK_SIGNED_KIND, TOK_INT8, TOK_INT16, TOK_INT32, TOK_INT64,
+  TOK_UNSIGNED_KIND, TOK_UINT8, TOK_UINT16, TOK_UINT32, TOK_UINT64,
+  TOK_REAL_KIND, TOK_FLOAT16, TOK_FLOAT32, TOK_FLOAT64,
+  TOK_COMPLEX_KIND, TOK_COMPLEX64, TOK_COMPLEX128,
+  TOK_CATEGORICAL,
+  TOK_REAL, TOK_COMPLEX, TOK_INT,
+  TOK_INTPTR, TOK_UINTPTR, TOK_SIZE,
+  TOK_CHAR,
+  TOK_STRING, TOK_FIXED_STRING_KIND, TOK_FIXED_STRING,
+  TOK_BYTES, TOK_FIXED_BYTES_KIND, TOK_FIXED_BYTES,
+  TOK_POINTER,
+  TOK_FIXED_DIM_KIND, TOK_FIXED, TOK_VAR,
+
+  /* punctuation */
+  TOK_ELLIPSIS, TOK_RARROW, TOK_COMMA, TOK_COLON, TOK_LPAREN, TOK_RPAREN,
+  TOK_LBRACE, TOK_RBRACE, TOK_LBRACK, TOK_RBRACK, TOK_STAR, TOK_EQUAL,
+  TOK_QUESTIONMARK, TOK_BAR,
+
+  /* tokens with a value */
+  TOK_INTEGER, TOK_FLOATNUMBER, TOK_STRINGLIT,
+  TOK_NAME_LOWER, TOK_NAME_UPPER, TOK_NAME_OTHER
+};
+
+/* A token refers to its lexeme in the input buffer. */
+typedef struct {
+    enum rd_token tag;
+    const char *start;
+    size_t len;
+    int line;
+    int column;
+} rd_token_t;
+
+typedef struct {
+    const char *cur;
+    const char *end;
+    const char *linestart;
+    int line;
+} rd_lexer_t;
+
+void rd_lexer_init(rd_lexer_t *lex, const char *input, size_t len);
+void rd_lex(rd_lexer_t *lex, rd_token_t *tok);
+const char *rd_token_name(enum rd_token tag);
+
+
+#endif /* RDLEXER_H */
@@ -0,0 +1,1619 @@
+/*
+ * Copyright (c) 2016, Continuum Analytics, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * Redistributions of source code must retain the above copyright notice,
+ * 
+ * this list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include "ndtypes.h"
+#include "hash.h"
+#include "parsefuncs.h"
+#include "seq.h"
+#include "rdlexer.h"
+#include "rdparser.h"
+
+
+/*****************************************************************************/
+/*                         Recursive descent parser                          */
+/*****************************************************************************/
+
+/*
+ * Hand-written parser for the grammar in grammar.y.  The parser builds the
+ * same AST with the same functions as the bison actions, so the two backends
+ * differ only in speed and in the wording of syntax errors.
+ *
+ * The grammar needs two tokens of lookahead in a few places, for example to
+ * distinguish the symbolic dimension in "N * int64" from the type variable
+ * in "N", or a record field from a tuple field in function arguments.
+ */
+
+/* Maximum nesting of types.  Deeper input is rejected instead of exhausting
+   the C stack. */
+#define MAX_DEPTH 1000
+
+typedef struct module module_t;
+
+typedef struct {
+    rd_lexer_t lex;
+    rd_token_t tok;         /* current token */
+    rd_token_t next;        /* lookahead, valid if have_next is set */
+    int have_next;
+    int depth;
+    const module_t *module; /* typedefs of a module that is being loaded */
+    ndt_context_t *ctx;
+} parser_t;
+
+static ndt_t *datashape(parser_t *p);
+static ndt_t *dtype(parser_t *p);
+static ndt_attr_seq_t *attribute_seq(parser_t *p);
+static const ndt_t *module_find(const module_t *m, const char *name, size_t len);
+
+
+static void
+advance(parser_t *p)
+{
+    if (p->have_next) {
+        p->tok = p->next;
+        p->have_next = 0;
+    }
+    else {
+        rd_lex(&p->lex, &p->tok);
+    }
+}
+
+static enum rd_token
+peek(parser_t *p)
+{
+    if (!p->have_next) {
+        rd_lex(&p->lex, &p->next);
+        p->have_next = 1;
+    }
+
+    return p->next.tag;
+}
+
+static void
+syntax_error(parser_t *p)
+{
+    ndt_err_format(p->ctx, NDT_ParseError, "%d:%d: syntax error, unexpected %s\n",
+                   p->tok.line, p->tok.column, rd_token_name(p->tok.tag));
+}
+
+static int
+expect(parser_t *p, enum rd_token tag)
+{
+    if (p->tok.tag != tag) {
+        syntax_error(p);
+        return -1;
+    }
+
+    advance(p);
+    return 0;
+}
+
+/* Copy of the current lexeme, for names that become part of the AST */
+static char *
+lexeme(parser_t *p)
+{
+    return mk_name(p->tok.start, p->tok.len, p->ctx);
+}
+
+/* Contents of the current string literal without the quotes */
+static char *
+stringlit(parser_t *p)
+{
+    return mk_name(p->tok.start+1, p->tok.len-2, p->ctx);
+}
+
+static int
+enter(parser_t *p)
+{
+    if (++p->depth > MAX_DEPTH) {
+        ndt_err_format(p->ctx, NDT_ParseError,
+            "%d:%d: maximum nesting depth exceeded\n", p->tok.line, p->tok.column);
+        p->depth--;
+        return -1;
+    }
+
+    return 0;
+}
+
+static int
+starts_dimension(parser_t *p)
+{
+    switch (p->tok.tag) {
+    case TOK_FIXED_DIM_KIND: case TOK_INTEGER: case TOK_FIXED: case TOK_VAR:
+    case TOK_ELLIPSIS:
+        return 1;
+    case TOK_NAME_UPPER:
+        return peek(p) == TOK_STAR;
+    default:
+        return 0;
+    }
+}
+
+static int
+starts_record_field(parser_t *p)
+{
+    switch (p->tok.tag) {
+    case TOK_NAME_LOWER: case TOK_NAME_UPPER: case TOK_NAME_OTHER:
+        return peek(p) == TOK_COLON;
+    default:
+        return 0;
+    }
+}
+
+
+/*****************************************************************************/
+/*                                 Attributes                                */
+/*****************************************************************************/
+
+static ndt_attr_t *
+attribute(parser_t *p)
+{
+    rd_token_t number;
+    char *name, *v;
+    ndt_t *t;
+
+    if (p->tok.tag != TOK_NAME_LOWER) {
+        syntax_error(p);
+        return NULL;
+    }
+
+    name = lexeme(p);
+    if (name == NULL) {
+        return NULL;
+    }
+    advance(p);
+
+    if (expect(p, TOK_EQUAL) < 0) {
+        ndt_free(name);
+        return NULL;
+    }
+
+    switch (p->tok.tag) {
+    case TOK_INTEGER:
+        switch (peek(p)) {
+        case TOK_COMMA: case TOK_RBRACK: case TOK_RPAREN:
+            number = p->tok;
+            advance(p);
+            return mk_attr_int64(name, number.start, number.len, p->ctx);
+        default:
+            break;
+        }
+        break;
+    case TOK_STRINGLIT:
+        v = stringlit(p);
+        if (v == NULL) {
+            ndt_free(name);
+            return NULL;
+        }
+        advance(p);
+        return ndt_attr_from_string(name, v, p->ctx);
+    default:
+        break;
+    }
+
+    t = datashape(p);
+    if (t == NULL) {
+        ndt_free(name);
+        return NULL;
+    }
+
+    return ndt_attr_from_type(name, t, p->ctx);
+}
+
+static ndt_attr_seq_t *
+attribute_seq(parser_t *p)
+{
+    ndt_attr_seq_t *seq;
+    ndt_attr_t *attr;
+
+    attr = attribute(p);
+    if (attr == NULL) {
+        return NULL;
+    }
+
+    seq = ndt_attr_seq_new(attr, p->ctx);
+    if (seq == NULL) {
+        return NULL;
+    }
+
+    while (p->tok.tag == TOK_COMMA) {
+        advance(p);
+
+        attr = attribute(p);
+        if (attr == NULL) {
+            ndt_attr_seq_del(seq);
+            return NULL;
+        }
+
+        seq = ndt_attr_seq_append(seq, attr, p->ctx);
+        if (seq == NULL) {
+            return NULL;
+        }
+    }
+
+    return seq;
+}
+
+/* Parse "[attribute_seq]" if present.  '*seq' is NULL if it is absent. */
+static int
+attribute_seq_opt(parser_t *p, ndt_attr_seq_t **seq)
+{
+    *seq = NULL;
+
+    if (p->tok.tag != TOK_LBRACK) {
+        return 0;
+    }
+    advance(p);
+
+    *seq = attribute_seq(p);
+    if (*seq == NULL) {
+        return -1;
+    }
+
+    if (expect(p, TOK_RBRACK) < 0) {
+        ndt_attr_seq_del(*seq);
+        *seq = NULL;
+        return -1;
+    }
+
+    return 0;
+}
+
+
+/*****************************************************************************/
+/*                                   Arrays                                  */
+/*****************************************************************************/
+
+static ndt_dim_t *
+dimension(parser_t *p)
+{
+    ndt_attr_seq_t *attrs;
+    rd_token_t number;
+    char *v;
+
+    switch (p->tok.tag) {
+    case TOK_FIXED_DIM_KIND:
+        advance(p);
+        return ndt_fixed_dim_kind(p->ctx);
+
+    case TOK_INTEGER:
+        number = p->tok;
+        advance(p);
+        if (attribute_seq_opt(p, &attrs) < 0) {
+            return NULL;
+        }
+        goto fixed_dim;
+
+    case TOK_FIXED:
+        advance(p);
+        if (expect(p, TOK_LPAREN) < 0) {
+            return NULL;
+        }
+        if (p->tok.tag != TOK_INTEGER) {
+            syntax_error(p);
+            return NULL;
+        }
+        number = p->tok;
+        advance(p);
+        if (expect(p, TOK_RPAREN) < 0) {
+            return NULL;
+        }
+        attrs = NULL;
+        goto fixed_dim;
+
+    case TOK_NAME_UPPER:
+        v = lexeme(p);
+        if (v == NULL) {
+            return NULL;
+        }
+        advance(p);
+        return ndt_symbolic_dim(v, p->ctx);
+
+    case TOK_VAR:
+        advance(p);
+        if (attribute_seq_opt(p, &attrs) < 0) {
+            return NULL;
+        }
+        return mk_var_dim(attrs, p->ctx);
+
+    case TOK_ELLIPSIS:
+        advance(p);
+        return ndt_ellipsis_dim(p->ctx);
+
+    default:
+        syntax_error(p);
+        return NULL;
+    }
+
+fixed_dim:
+    return mk_fixed_dim(number.start, number.len, attrs, p->ctx);
+}
+
+static ndt_t *
+array_nooption(parser_t *p)
+{
+    ndt_dim_seq_t *dims;
+    ndt_dim_t *dim;
+    ndt_attr_seq_t *attrs = NULL;
+    ndt_t *type;
+
+    dim = dimension(p);
+    if (dim == NULL) {
+        return NULL;
+    }
+
+    dims = ndt_dim_seq_new(dim, p->ctx);
+    if (dims == NULL) {
+        return NULL;
+    }
+
+    while (1) {
+        if (expect(p, TOK_STAR) < 0) {
+            ndt_dim_seq_del(dims);
+            return NULL;
+        }
+
+        if (!starts_dimension(p)) {
+            break;
+        }
+
+        dim = dimension(p);
+        if (dim == NULL) {
+            ndt_dim_seq_del(dims);
+            return NULL;
+        }
+
+        dims = ndt_dim_seq_append(dims, dim, p->ctx);
+        if (dims == NULL) {
+            return NULL;
+        }
+    }
+
+    type = dtype(p);
+    if (type == NULL) {
+        ndt_dim_seq_del(dims);
+        return NULL;
+    }
+
+    if (p->tok.tag == TOK_BAR) {
+        advance(p);
+        if (expect(p, TOK_LBRACK) < 0) {
+            goto error;
+        }
+        attrs = attribute_seq(p);
+        if (attrs == NULL) {
+            goto error;
+        }
+        if (expect(p, TOK_RBRACK) < 0) {
+            ndt_attr_seq_del(attrs);
+            goto error;
+        }
+    }
+
+    return mk_array(dims, type, attrs, p->ctx);
+
+error:
+    ndt_dim_seq_del(dims);
+    ndt_del(type);
+    return NULL;
+}
+
+
+/*****************************************************************************/
+/*                             Tuples and records                            */
+/*****************************************************************************/
+
+static ndt_tuple_field_t *
+tuple_field(parser_t *p)
+{
+    ndt_attr_seq_t *attrs;
+    ndt_t *t;
+
+    t = datashape(p);
+    if (t == NULL) {
+        return NULL;
+    }
+
+    if (attribute_seq_opt(p, &attrs) < 0) {
+        ndt_del(t);
+        return NULL;
+    }
+
+    return mk_tuple_field(t, attrs, p->ctx);
+}
+
+static ndt_record_field_t *
+record_field(parser_t *p)
+{
+    ndt_attr_seq_t *attrs;
+    char *name;
+    ndt_t *t;
+
+    switch (p->tok.tag) {
+    case TOK_NAME_LOWER: case TOK_NAME_UPPER: case TOK_NAME_OTHER:
+        break;
+    default:
+        syntax_error(p);
+        return NULL;
+    }
+
+    name = lexeme(p);
+    if (name == NULL) {
+        return NULL;
+    }
+    advance(p);
+
+    if (expect(p, TOK_COLON) < 0) {
+        ndt_free(name);
+        return NULL;
+    }
+
+    t = datashape(p);
+    if (t == NULL) {
+        ndt_free(name);
+        return NULL;
+    }
+
+    if (attribute_seq_opt(p, &attrs) < 0) {
+        ndt_free(name);
+        ndt_del(t);
+        return NULL;
+    }
+
+    return mk_record_field(name, t, attrs, p->ctx);
+}
+
+/* Parse record fields, followed by an optional ", ..." or trailing comma. */
+static ndt_record_field_seq_t *
+record_field_seq(parser_t *p, enum ndt_variadic_flag *flag)
+{
+    ndt_record_field_seq_t *seq;
+    ndt_record_field_t *field;
+
+    *flag = Nonvariadic;
+
+    field = record_field(p);
+    if (field == NULL) {
+        return NULL;
+    }
+
+    seq = ndt_record_field_seq_new(field, p->ctx);
+    if (seq == NULL) {
+        return NULL;
+    }
+
+    while (p->tok.tag == TOK_COMMA) {
+        advance(p);
+
+        switch (p->tok.tag) {
+        case TOK_ELLIPSIS:
+            advance(p);
+            *flag = Variadic;
+            return seq;
+        case TOK_RPAREN: case TOK_RBRACE:
+            return seq;
+        default:
+            break;
+        }
+
+        field = record_field(p);
+        if (field == NULL) {
+            ndt_record_field_seq_del(seq);
+            return NULL;
+        }
+
+        seq = ndt_record_field_seq_append(seq, field, p->ctx);
+        if (seq == NULL) {
+            return NULL;
+        }
+    }
+
+    return seq;
+}
+
+static ndt_t *
+record_type(parser_t *p)
+{
+    ndt_record_field_seq_t *seq;
+    enum ndt_variadic_flag flag;
+
+    advance(p);
+
+    if (p->tok.tag == TOK_RBRACE) {
+        advance(p);
+        return mk_record(Nonvariadic, NULL, p->ctx);
+    }
+
+    if (p->tok.tag == TOK_ELLIPSIS && peek(p) == TOK_RBRACE) {
+        advance(p);
+        advance(p);
+        return mk_record(Variadic, NULL, p->ctx);
+    }
+
+    seq = record_field_seq(p, &flag);
+    if (seq == NULL) {
+        return NULL;
+    }
+
+    if (expect(p, TOK_RBRACE) < 0) {
+        ndt_record_field_seq_del(seq);
+        return NULL;
+    }
+
+    return mk_record(flag, seq, p->ctx);
+}
+
+/*
+ * Parse a tuple or a function type.  The positional arguments of a function
+ * are a tuple, which is followed by keyword arguments or by "->".
+ */
+static ndt_t *
+tuple_or_function(parser_t *p)
+{
+    ndt_tuple_field_seq_t *tseq = NULL;
+    ndt_record_field_seq_t *rseq;
+    enum ndt_variadic_flag tflag = Nonvariadic;
+    enum ndt_variadic_flag rflag;
+    ndt_tuple_field_t *field;
+    ndt_t *t, *ret;
+
+    advance(p);
+
+    if (p->tok.tag == TOK_RPAREN) {
+        advance(p);
+        goto tuple;
+    }
+
+    if (p->tok.tag == TOK_ELLIPSIS) {
+        switch (peek(p)) {
+        case TOK_RPAREN:
+            advance(p);
+            advance(p);
+            tflag = Variadic;
+            goto tuple;
+        case TOK_COMMA:
+            advance(p);
+            advance(p);
+            tflag = Variadic;
+            goto keywords;
+        default:
+            break;
+        }
+    }
+
+    if (starts_record_field(p)) {
+        goto keywords;
+    }
+
+    field = tuple_field(p);
+    if (field == NULL) {
+        return NULL;
+    }
+
+    tseq = ndt_tuple_field_seq_new(field, p->ctx);
+    if (tseq == NULL) {
+        return NULL;
+    }
+
+    while (p->tok.tag == TOK_COMMA) {
+        advance(p);
+
+        if (p->tok.tag == TOK_RPAREN) {
+            break;
+        }
+
+        if (p->tok.tag == TOK_ELLIPSIS) {
+            switch (peek(p)) {
+            case TOK_RPAREN:
+                advance(p);
+                tflag = Variadic;
+                goto end_tuple;
+            case TOK_COMMA:
+                advance(p);
+                advance(p);
+                tflag = Variadic;
+                goto keywords;
+            default:
+                break;
+            }
+        }
+
+        if (starts_record_field(p)) {
+            goto keywords;
+        }
+
+        field = tuple_field(p);
+        if (field == NULL) {
+            ndt_tuple_field_seq_del(tseq);
+            return NULL;
+        }
+
+        tseq = ndt_tuple_field_seq_append(tseq, field, p->ctx);
+        if (tseq == NULL) {
+            return NULL;
+        }
+    }
+
+end_tuple:
+    if (expect(p, TOK_RPAREN) < 0) {
+        ndt_tuple_field_seq_del(tseq);
+        return NULL;
+    }
+
+tuple:
+    t = mk_tuple(tflag, tseq, p->ctx);
+    if (t == NULL || p->tok.tag != TOK_RARROW) {
+        return t;
+    }
+    advance(p);
+
+    ret = datashape(p);
+    if (ret == NULL) {
+        ndt_del(t);
+        return NULL;
+    }
+
+    return mk_function_from_tuple(ret, t, p->ctx);
+
+keywords:
+    rseq = record_field_seq(p, &rflag);
+    if (rseq == NULL) {
+        ndt_tuple_field_seq_del(tseq);
+        return NULL;
+    }
+
+    if (expect(p, TOK_RPAREN) < 0 || expect(p, TOK_RARROW) < 0) {
+        ndt_tuple_field_seq_del(tseq);
+        ndt_record_field_seq_del(rseq);
+        return NULL;
+    }
+
+    ret = datashape(p);
+    if (ret == NULL) {
+        ndt_tuple_field_seq_del(tseq);
+        ndt_record_field_seq_del(rseq);
+        return NULL;
+    }
+
+    return mk_function(ret, tflag, tseq, rflag, rseq, p->ctx);
+}
+
+
+/*****************************************************************************/
+/*                                  Scalars                                  */
+/*****************************************************************************/
+
+static enum ndt_encoding
+encoding(parser_t *p)
+{
+    char *s;
+
+    if (p->tok.tag != TOK_STRINGLIT) {
+        syntax_error(p);
+        return ErrorEncoding;
+    }
+
+    s = stringlit(p);
+    if (s == NULL) {
+        return ErrorEncoding;
+    }
+    advance(p);
+
+    return ndt_encoding_from_string(s, p->ctx);
+}
+
+static ndt_t *
+complex_type(parser_t *p)
+{
+    enum ndt tag;
+
+    advance(p);
+
+    if (p->tok.tag != TOK_LPAREN) {
+        return ndt_primitive(Complex128, p->ctx);
+    }
+    advance(p);
+
+    switch (p->tok.tag) {
+    case TOK_FLOAT32: tag = Complex64; break;
+    case TOK_FLOAT64: case TOK_REAL: tag = Complex128; break;
+    default: syntax_error(p); return NULL;
+    }
+    advance(p);
+
+    if (expect(p, TOK_RPAREN) < 0) {
+        return NULL;
+    }
+
+    return ndt_primitive(tag, p->ctx);
+}
+
+static ndt_t *
+character(parser_t *p)
+{
+    enum ndt_encoding enc;
+
+    advance(p);
+
+    if (p->tok.tag != TOK_LPAREN) {
+        return ndt_char(Utf32, p->ctx);
+    }
+    advance(p);
+
+    enc = encoding(p);
+    if (enc == ErrorEncoding) {
+        return NULL;
+    }
+
+    if (expect(p, TOK_RPAREN) < 0) {
+        return NULL;
+    }
+
+    return ndt_char(enc, p->ctx);
+}
+
+static ndt_t *
+fixed_string(parser_t *p)
+{
+    enum ndt_encoding enc = Utf8;
+    rd_token_t number;
+
+    advance(p);
+
+    if (expect(p, TOK_LPAREN) < 0) {
+        return NULL;
+    }
+
+    if (p->tok.tag != TOK_INTEGER) {
+        syntax_error(p);
+        return NULL;
+    }
+    number = p->tok;
+    advance(p);
+
+    if (p->tok.tag == TOK_COMMA) {
+        advance(p);
+        enc = encoding(p);
+        if (enc == ErrorEncoding) {
+            return NULL;
+        }
+    }
+
+    if (expect(p, TOK_RPAREN) < 0) {
+        return NULL;
+    }
+
+    return mk_fixed_string(number.start, number.len, enc, p->ctx);
+}
+
+static ndt_t *
+bytes(parser_t *p)
+{
+    enum rd_token tag = p->tok.tag;
+    ndt_attr_seq_t *attrs;
+
+    advance(p);
+
+    if (expect(p, TOK_LPAREN) < 0) {
+        return NULL;
+    }
+
+    attrs = attribute_seq(p);
+    if (attrs == NULL) {
+        return NULL;
+    }
+
+    if (expect(p, TOK_RPAREN) < 0) {
+        ndt_attr_seq_del(attrs);
+        return NULL;
+    }
+
+    if (tag == TOK_BYTES) {
+        return mk_bytes(attrs, p->ctx);
+    }
+
+    return mk_fixed_bytes(attrs, p->ctx);
+}
+
+static ndt_t *
+pointer(parser_t *p)
+{
+    ndt_t *t;
+
+    advance(p);
+
+    if (expect(p, TOK_LPAREN) < 0) {
+        return NULL;
+    }
+
+    t = datashape(p);
+    if (t == NULL) {
+        return NULL;
+    }
+
+    if (expect(p, TOK_RPAREN) < 0) {
+        ndt_del(t);
+        return NULL;
+    }
+
+    return ndt_pointer(t, p->ctx);
+}
+
+static ndt_memory_t *
+typed_value(parser_t *p)
+{
+    enum rd_token tag = p->tok.tag;
+    char *v;
+    ndt_t *t;
+
+    switch (tag) {
+    case TOK_INTEGER: case TOK_FLOATNUMBER:
+        v = lexeme(p);
+        break;
+    case TOK_STRINGLIT:
+        v = stringlit(p);
+        break;
+    default:
+        syntax_error(p);
+        return NULL;
+    }
+
+    if (v == NULL) {
+        return NULL;
+    }
+    advance(p);
+
+    if (expect(p, TOK_COLON) < 0) {
+        ndt_free(v);
+        return NULL;
+    }
+
+    t = datashape(p);
+    if (t == NULL) {
+        ndt_free(v);
+        return NULL;
+    }
+
+    if (tag == TOK_STRINGLIT) {
+        return ndt_memory_from_string(v, t, p->ctx);
+    }
+
+    return ndt_memory_from_number(v, t, p->ctx);
+}
+
+static ndt_t *
+categorical(parser_t *p)
+{
+    ndt_memory_seq_t *seq;
+    ndt_memory_t *mem;
+
+    advance(p);
+
+    if (expect(p, TOK_LPAREN) < 0) {
+        return NULL;
+    }
+
+    mem = typed_value(p);
+    if (mem == NULL) {
+        return NULL;
+    }
+
+    seq = ndt_memory_seq_new(mem, p->ctx);
+    if (seq == NULL) {
+        return NULL;
+    }
+
+    while (p->tok.tag == TOK_COMMA) {
+        advance(p);
+
+        mem = typed_value(p);
+        if (mem == NULL) {
+            ndt_memory_seq_del(seq);
+            return NULL;
+        }
+
+        seq = ndt_memory_seq_append(seq, mem, p->ctx);
+        if (seq == NULL) {
+            return NULL;
+        }
+    }
+
+    if (expect(p, TOK_RPAREN) < 0) {
+        ndt_memory_seq_del(seq);
+        return NULL;
+    }
+
+    return mk_categorical(seq, p->ctx);
+}
+
+
+/*****************************************************************************/
+/*                                   Types                                   */
+/*****************************************************************************/
+
+/* NAME_UPPER LPAREN dtype RPAREN */
+static ndt_t *
+constr(parser_t *p)
+{
+    ndt_attr_seq_t *attrs;
+    char *name;
+    ndt_t *t;
+
+    name = lexeme(p);
+    if (name == NULL) {
+        return NULL;
+    }
+    advance(p);
+    advance(p);
+
+    if (p->tok.tag == TOK_NAME_LOWER && peek(p) == TOK_EQUAL) {
+        ndt_free(name);
+        attrs = attribute_seq(p);
+        if (attrs == NULL) {
+            return NULL;
+        }
+        if (expect(p, TOK_RPAREN) < 0) {
+            ndt_attr_seq_del(attrs);
+            return NULL;
+        }
+        ndt_attr_seq_del(attrs);
+        ndt_err_format(p->ctx, NDT_NotImplementedError,
+                       "general attributes are not implemented");
+        return NULL;
+    }
+
+    t = dtype(p);
+    if (t == NULL) {
+        ndt_free(name);
+        return NULL;
+    }
+
+    if (expect(p, TOK_RPAREN) < 0) {
+        ndt_free(name);
+        ndt_del(t);
+        return NULL;
+    }
+
+    return ndt_constr(name, t, p->ctx);
+}
+
+static ndt_t *
+dtype_nooption(parser_t *p)
+{
+    ndt_context_t *ctx = p->ctx;
+    const ndt_t *type;
+    char *name;
+
+    switch (p->tok.tag) {
+    case TOK_LPAREN: return tuple_or_function(p);
+    case TOK_LBRACE: return record_type(p);
+    case TOK_COMPLEX: return complex_type(p);
+    case TOK_CHAR: return character(p);
+    case TOK_FIXED_STRING: return fixed_string(p);
+    case TOK_BYTES: case TOK_FIXED_BYTES: return bytes(p);
+    case TOK_POINTER: return pointer(p);
+    case TOK_CATEGORICAL: return categorical(p);
+
+    case TOK_NAME_LOWER:
+        type = module_find(p->module, p->tok.start, p->tok.len);
+        name = lexeme(p);
+        if (name == NULL) {
+            return NULL;
+        }
+        advance(p);
+        if (type != NULL) {
+            return ndt_nominal_from_type(name, type, ctx);
+        }
+        return ndt_nominal(name, ctx);
+
+    case TOK_NAME_UPPER:
+        if (peek(p) == TOK_LPAREN) {
+            return constr(p);
+        }
+        name = lexeme(p);
+        if (name == NULL) {
+            return NULL;
+        }
+        advance(p);
+        return ndt_typevar(name, ctx);
+
+    default:
+        break;
+    }
+
+    /* types without arguments */
+    switch (p->tok.tag) {
+    case TOK_ANY_KIND: advance(p); return ndt_any_kind(ctx);
+    case TOK_SCALAR_KIND: advance(p); return ndt_scalar_kind(ctx);
+    case TOK_VOID: advance(p); return ndt_primitive(Void, ctx);
+    case TOK_BOOL: advance(p); return ndt_primitive(Bool, ctx);
+    case TOK_SIGNED_KIND: advance(p); return ndt_signed_kind(ctx);
+    case TOK_INT8: advance(p); return ndt_primitive(Int8, ctx);
+    case TOK_INT16: advance(p); return ndt_primitive(Int16, ctx);
+    case TOK_INT32: advance(p); return ndt_primitive(Int32, ctx);
+    case TOK_INT64: advance(p); return ndt_primitive(Int64, ctx);
+    case TOK_UNSIGNED_KIND: advance(p); return ndt_unsigned_kind(ctx);
+    case TOK_UINT8: advance(p); return ndt_primitive(Uint8, ctx);
+    case TOK_UINT16: advance(p); return ndt_primitive(Uint16, ctx);
+    case TOK_UINT32: advance(p); return ndt_primitive(Uint32, ctx);
+    case TOK_UINT64: advance(p); return ndt_primitive(Uint64, ctx);
+    case TOK_REAL_KIND: advance(p); return ndt_real_kind(ctx);
+    case TOK_FLOAT16: advance(p); return ndt_primitive(Float16, ctx);
+    case TOK_FLOAT32: advance(p); return ndt_primitive(Float32, ctx);
+    case TOK_FLOAT64: advance(p); return ndt_primitive(Float64, ctx);
+    case TOK_COMPLEX_KIND: advance(p); return ndt_complex_kind(ctx);
+    case TOK_COMPLEX64: advance(p); return ndt_primitive(Complex64, ctx);
+    case TOK_COMPLEX128: advance(p); return ndt_primitive(Complex128, ctx);
+    case TOK_INT: advance(p); return ndt_primitive(Int32, ctx);
+    case TOK_REAL: advance(p); return ndt_primitive(Float64, ctx);
+    case TOK_INTPTR: advance(p); return ndt_from_alias(Intptr, ctx);
+    case TOK_UINTPTR: advance(p); return ndt_from_alias(Uintptr, ctx);
+    case TOK_SIZE: advance(p); return ndt_from_alias(Size, ctx);
+    case TOK_STRING: advance(p); return ndt_string(ctx);
+    case TOK_FIXED_STRING_KIND: advance(p); return ndt_fixed_string_kind(ctx);
+    case TOK_FIXED_BYTES_KIND: advance(p); return ndt_fixed_bytes_kind(ctx);
+    default: syntax_error(p); return NULL;
+    }
+}
+
+/* An optional "?" or "option(...)" around 'array_nooption' or 'dtype_nooption'. */
+static ndt_t *
+option(parser_t *p, int allow_array)
+{
+    ndt_t *t;
+    int paren = 0;
+
+    switch (p->tok.tag) {
+    case TOK_QUESTIONMARK:
+        advance(p);
+        break;
+    case TOK_OPTION:
+        advance(p);
+        if (expect(p, TOK_LPAREN) < 0) {
+            return NULL;
+        }
+        paren = 1;
+        break;
+    default:
+        if (allow_array && starts_dimension(p)) {
+            return array_nooption(p);
+        }
+        return dtype_nooption(p);
+    }
+
+    if (allow_array && starts_dimension(p)) {
+        t = array_nooption(p);
+    }
+    else {
+        t = dtype_nooption(p);
+    }
+    if (t == NULL) {
+        return NULL;
+    }
+
+    if (paren && expect(p, TOK_RPAREN) < 0) {
+        ndt_del(t);
+        return NULL;
+    }
+
+    return ndt_option(t, p->ctx);
+}
+
+static ndt_t *
+datashape(parser_t *p)
+{
+    ndt_t *t;
+
+    if (enter(p) < 0) {
+        return NULL;
+    }
+
+    t = option(p, 1);
+    p->depth--;
+
+    return t;
+}
+
+static ndt_t *
+dtype(parser_t *p)
+{
+    ndt_t *t;
+
+    if (enter(p) < 0) {
+        return NULL;
+    }
+
+    t = option(p, 0);
+    p->depth--;
+
+    return t;
+}
+
+ndt_t *
+rd_parse(const char *input, size_t len, ndt_context_t *ctx)
+{
+    parser_t p;
+    ndt_t *t;
+
+    rd_lexer_init(&p.lex, input, len);
+    p.have_next = 0;
+    p.depth = 0;
+    p.module = NULL;
+    p.ctx = ctx;
+
+    rd_lex(&p.lex, &p.tok);
+
+    t = datashape(&p);
+    if (t == NULL) {
+        return NULL;
+    }
+
+    if (p.tok.tag != TOK_EOF) {
+        syntax_error(&p);
+        ndt_del(t);
+        return NULL;
+    }
+
+    return t;
+}
+
+
+/*****************************************************************************/
+/*                                  Modules                                  */
+/*****************************************************************************/
+
+/*
+ * A module is a sequence of declarations:
+ *
+ *   module: ("typedef" NAME_LOWER "=" datashape)*
+ *
+ * "typedef" is not a keyword of the datashape grammar, so it is recognized
+ * only where a declaration can start:  at the beginning of the input and
+ * outside of brackets after a datashape.
+ *
+ * The input is scanned once to split it into declarations and to collect
+ * the names that each body refers to.  A name followed by ':' or '=' is a
+ * field or attribute name and not a reference.  The declarations are then
+ * parsed in dependency order, so that a body may refer to a typedef that
+ * is declared further down, and finally registered in one operation.
+ */
+
+typedef struct {
+    const char *name;       /* slice of the input */
+    size_t len;
+    uint64_t hash;
+    rd_lexer_t body;        /* lexer positioned at the body */
+    size_t indegree;        /* references to unparsed declarations */
+    ndt_t *type;
+} decl_t;
+
+typedef struct {
+    size_t decl;            /* declaration that contains the reference */
+    const char *name;
+    size_t len;
+} ref_t;
+
+struct module {
+    decl_t *decls;
+    size_t ndecls;
+    size_t *index;          /* hash table of the declarations, entries are i+1 */
+    size_t mask;
+};
+
+/* Index of the declaration 'name' or -1. */
+static int64_t
+module_index(const module_t *m, const char *name, size_t len, uint64_t hash)
+{
+    const decl_t *d;
+    size_t i;
+
+    for (i = hash & m->mask; m->index[i] != 0; i = (i+1) & m->mask) {
+        d = &m->decls[m->index[i]-1];
+        if (d->hash == hash && d->len == len && memcmp(d->name, name, len) == 0) {
+            return (int64_t)m->index[i]-1;
+        }
+    }
+
+    return -1;
+}
+
+/* Type of the declaration 'name' if it has been parsed. */
+static const ndt_t *
+module_find(const module_t *m, const char *name, size_t len)
+{
+    int64_t i;
+
+    if (m == NULL) {
+        return NULL;
+    }
+
+    i = module_index(m, name, len, hash_data(name, len));
+    return i < 0 ? NULL : m->decls[i].type;
+}
+
+/* Make room for one more element in the array '*ptr'. */
+static int
+reserve(void *ptr, size_t *reserved, size_t used, size_t size, ndt_context_t *ctx)
+{
+    void **p = ptr;
+    void *tmp;
+    size_t n;
+
+    if (used < *reserved) {
+        return 0;
+    }
+
+    n = *reserved == 0 ? 64 : 2 * *reserved;
+    tmp = ndt_realloc(*p, n, size);
+    if (tmp == NULL) {
+        ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+        return -1;
+    }
+
+    *p = tmp;
+    *reserved = n;
+    return 0;
+}
+
+static void
+module_error(const rd_token_t *tok, ndt_context_t *ctx)
+{
+    ndt_err_format(ctx, NDT_ParseError, "%d:%d: syntax error, unexpected %s\n",
+                   tok->line, tok->column, rd_token_name(tok->tag));
+}
+
+static int
+is_typedef(const rd_token_t *tok)
+{
+    return tok->tag == TOK_NAME_LOWER && tok->len == 7 &&
+           memcmp(tok->start, "typedef", 7) == 0;
+}
+
+/* Split the module into declarations and collect the references. */
+static int
+module_scan(module_t *m, ref_t **refs, size_t *nrefs, const char *input,
+            size_t len, ndt_context_t *ctx)
+{
+    rd_lexer_t lex;
+    rd_token_t tok, prev;
+    size_t reserved = 0, refs_reserved = 0;
+    decl_t *d = NULL;
+    int pending = 0;
+    int depth = 0;
+
+    rd_lexer_init(&lex, input, len);
+
+    for (;;) {
+        rd_lex(&lex, &tok);
+
+        if (pending && tok.tag != TOK_COLON && tok.tag != TOK_EQUAL) {
+            if (reserve(refs, &refs_reserved, *nrefs, sizeof **refs, ctx) < 0) {
+                return -1;
+            }
+            (*refs)[*nrefs].decl = m->ndecls-1;
+            (*refs)[*nrefs].name = prev.start;
+            (*refs)[*nrefs].len = prev.len;
+            (*nrefs)++;
+        }
+        pending = 0;
+
+        if (tok.tag == TOK_EOF) {
+            break;
+        }
+
+        if (depth == 0 && is_typedef(&tok)) {
+            if (d != NULL) {
+                d->body.end = tok.start;
+            }
+
+            rd_lex(&lex, &tok);
+            if (tok.tag != TOK_NAME_LOWER) {
+                module_error(&tok, ctx);
+                return -1;
+            }
+            prev = tok;
+
+            rd_lex(&lex, &tok);
+            if (tok.tag != TOK_EQUAL) {
+                module_error(&tok, ctx);
+                return -1;
+            }
+
+            if (reserve(&m->decls, &reserved, m->ndecls, sizeof *m->decls, ctx) < 0) {
+                return -1;
+            }
+            d = &m->decls[m->ndecls++];
+            d->name = prev.start;
+            d->len = prev.len;
+            d->hash = hash_data(prev.start, prev.len);
+            d->body = lex;
+            d->indegree = 0;
+            d->type = NULL;
+            continue;
+        }
+
+        switch (tok.tag) {
+        case TOK_ERROR:
+            module_error(&tok, ctx);
+            return -1;
+        case TOK_LPAREN: case TOK_LBRACK: case TOK_LBRACE:
+            depth++;
+            break;
+        case TOK_RPAREN: case TOK_RBRACK: case TOK_RBRACE:
+            if (depth > 0) {
+                depth--;
+            }
+            break;
+        case TOK_NAME_LOWER:
+            prev = tok;
+            pending = 1;
+            break;
+        default:
+            break;
+        }
+
+        if (d == NULL) {
+            module_error(&tok, ctx);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/* Hash table of the declaration names, which must be unique. */
+static int
+module_index_init(module_t *m, ndt_context_t *ctx)
+{
+    size_t size, i, k;
+    decl_t *d;
+
+    for (size = 64; size < 2 * m->ndecls; size *= 2);
+
+    m->index = ndt_alloc(size, sizeof *m->index);
+    if (m->index == NULL) {
+        ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+        return -1;
+    }
+    m->mask = size-1;
+
+    for (i = 0; i < size; i++) {
+        m->index[i] = 0;
+    }
+
+    for (k = 0; k < m->ndecls; k++) {
+        d = &m->decls[k];
+        if (module_index(m, d->name, d->len, d->hash) >= 0) {
+            ndt_err_format(ctx, NDT_ValueError, "duplicate typedef '%.*s'",
+                           d->len > INT_MAX ? INT_MAX : (int)d->len, d->name);
+            return -1;
+        }
+        for (i = d->hash & m->mask; m->index[i] != 0; i = (i+1) & m->mask);
+        m->index[i] = k+1;
+    }
+
+    return 0;
+}
+
+/*
+ * Topological sort of the declarations (Kahn's algorithm).  'order' receives
+ * the indices of the declarations, each after the ones it refers to.
+ */
+static int
+module_sort(module_t *m, size_t *order, const ref_t *refs, size_t nrefs,
+            ndt_context_t *ctx)
+{
+    size_t *edges = NULL;   /* references grouped by the declaration they name */
+    size_t *start = NULL;
+    size_t *target = NULL;
+    size_t head, tail, i, k;
+    int64_t j;
+    int ret = -1;
+
+    start = ndt_alloc(m->ndecls+1, sizeof *start);
+    target = ndt_alloc(nrefs+1, sizeof *target);
+    edges = ndt_alloc(nrefs+1, sizeof *edges);
+    if (start == NULL || target == NULL || edges == NULL) {
+        ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+        goto out;
+    }
+
+    for (i = 0; i <= m->ndecls; i++) {
+        start[i] = 0;
+    }
+
+    for (k = 0; k < nrefs; k++) {
+        j = module_index(m, refs[k].name, refs[k].len,
+                         hash_data(refs[k].name, refs[k].len));
+        target[k] = j < 0 ? SIZE_MAX : (size_t)j;
+        if (j >= 0) {
+            start[j+1]++;
+            m->decls[refs[k].decl].indegree++;
+        }
+    }
+
+    for (i = 0; i < m->ndecls; i++) {
+        start[i+1] += start[i];
+    }
+
+    for (k = 0; k < nrefs; k++) {
+        if (target[k] != SIZE_MAX) {
+            edges[start[target[k]]++] = refs[k].decl;
+        }
+    }
+
+    /* start[i] is now the end of the group i */
+    for (i = m->ndecls; i > 0; i--) {
+        start[i] = start[i-1];
+    }
+    start[0] = 0;
+
+    tail = 0;
+    for (i = 0; i < m->ndecls; i++) {
+        if (m->decls[i].indegree == 0) {
+            order[tail++] = i;
+        }
+    }
+
+    for (head = 0; head < tail; head++) {
+        i = order[head];
+        for (k = start[i]; k < start[i+1]; k++) {
+            if (--m->decls[edges[k]].indegree == 0) {
+                order[tail++] = edges[k];
+            }
+        }
+    }
+
+    if (tail < m->ndecls) {
+        for (i = 0; m->decls[i].indegree == 0; i++);
+        ndt_err_format(ctx, NDT_ValueError, "cyclic typedef '%.*s'",
+            m->decls[i].len > INT_MAX ? INT_MAX : (int)m->decls[i].len,
+            m->decls[i].name);
+        goto out;
+    }
+
+    ret = 0;
+
+out:
+    ndt_free(start);
+    ndt_free(target);
+    ndt_free(edges);
+    return ret;
+}
+
+static ndt_t *
+module_parse_decl(const module_t *m, const decl_t *d, ndt_context_t *ctx)
+{
+    parser_t p;
+    ndt_t *t;
+
+    p.lex = d->body;
+    p.have_next = 0;
+    p.depth = 0;
+    p.module = m;
+    p.ctx = ctx;
+
+    rd_lex(&p.lex, &p.tok);
+
+    t = datashape(&p);
+    if (t == NULL) {
+        return NULL;
+    }
+
+    if (p.tok.tag != TOK_EOF) {
+        syntax_error(&p);
+        ndt_del(t);
+        return NULL;
+    }
+
+    return t;
+}
+
+int
+rd_parse_module(const char *input, size_t len, ndt_context_t *ctx)
+{
+    module_t m = {NULL, 0, NULL, 0};
+    ref_t *refs = NULL;
+    size_t nrefs = 0;
+    size_t *order = NULL;
+    char **names = NULL;
+    const ndt_t **types = NULL;
+    size_t i;
+    int ret = -1;
+
+    if (module_scan(&m, &refs, &nrefs, input, len, ctx) < 0 ||
+        module_index_init(&m, ctx) < 0) {
+        goto out;
+    }
+
+    names = ndt_alloc(m.ndecls+1, sizeof *names);
+    if (names == NULL) {
+        ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+        goto out;
+    }
+    for (i = 0; i < m.ndecls; i++) {
+        names[i] = NULL;
+    }
+
+    order = ndt_alloc(m.ndecls+1, sizeof *order);
+    types = ndt_alloc(m.ndecls+1, sizeof *types);
+    if (order == NULL || types == NULL) {
+        ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+        goto out;
+    }
+
+    if (module_sort(&m, order, refs, nrefs, ctx) < 0) {
+        goto out;
+    }
+
+    for (i = 0; i < m.ndecls; i++) {
+        m.decls[order[i]].type = module_parse_decl(&m, &m.decls[order[i]], ctx);
+        if (m.decls[order[i]].type == NULL) {
+            goto out;
+        }
+    }
+
+    for (i = 0; i < m.ndecls; i++) {
+        names[i] = mk_name(m.decls[i].name, m.decls[i].len, ctx);
+        if (names[i] == NULL) {
+            goto out;
+        }
+        types[i] = m.decls[i].type;
+    }
+
+    if (ndt_typedef_add_all((const char * const *)names, types, m.ndecls, ctx) < 0) {
+        goto out;
+    }
+
+    /* The typedef table owns the types now. */
+    for (i = 0; i < m.ndecls; i++) {
+        m.decls[i].type = NULL;
+    }
+    ret = 0;
+
+out:
+    for (i = 0; i < m.ndecls; i++) {
+        ndt_del(m.decls[i].type);
+    }
+    if (names != NULL) {
+        for (i = 0; i < m.ndecls; i++) {
+            ndt_free(names[i]);
+        }
+    }
+    ndt_free(names);
+    ndt_free(types);
+    ndt_free(order);
+    ndt_free(refs);
+    ndt_free(m.index);
+    ndt_free(m.decls);
+    return ret;
+}
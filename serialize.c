@@ -0,0 +1,1174 @@
+/*
+ * Copyright (c) 2016, Continuum Analytics, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * Redistributions of source code must retain the above copyright notice,
+ * 
+ * this list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "ndtypes.h"
+#include "arena.h"
+#include "hash.h"
+#include "overflow.h"
+
+
+/*****************************************************************************/
+/*                          Serialized types                                 */
+/*****************************************************************************/
+
+/*
+ * Binary encoding of a type tree.  The encoding contains no pointers and can
+ * be stored next to the data, memory-mapped and loaded without parsing.
+ *
+ * Layout (all integers are 64-bit words in native byte order):
+ *
+ *   header:   magic "NDTB", uint16 version, uint16 byte order mark,
+ *             total length, offset of the root node
+ *
+ *   node:     tag, size, align | abstract << 8, payload...
+ *
+ * References to child nodes and strings are stored relative to the start
+ * of the referring node.  Children and strings are laid out in depth-first
+ * order directly after their parent, so every reference points forward and
+ * the reader can verify that no part of the buffer is shared or skipped.
+ * Strings are NUL terminated and padded to a multiple of the word size.
+ *
+ * Node payloads:
+ *
+ *   Array:       ndim, order, dtype, ndim * (tag, a, b, itemsize,
+ *                itemalign | abstract << 8), where (a, b) are (shape, stride)
+ *                for FixedDim, (stride, 0) for VarDim and (name, 0) for
+ *                SymbolicDim
+ *   Option:      type
+ *   Nominal:     name
+ *   Constr:      name, type
+ *   Tuple:       flag, shape, shape * (type, offset, align | pad << 8)
+ *   Record:      flag, shape, shape * (name, type, offset, align | pad << 8)
+ *   Function:    ret, pos, kwds
+ *   Typevar:     name
+ *   Char:        encoding
+ *   Bytes:       target_align
+ *   FixedString: size, encoding
+ *   FixedBytes:  size, align
+ *   Categorical: ntypes, ntypes * (type, value), where value is a string
+ *                reference for String, a sign or zero extended integer or
+ *                the bits of a double
+ *   Pointer:     type
+ */
+
+#define SERIAL_VERSION 1
+#define SERIAL_BOM 0x0102
+#define SERIAL_MAX_DEPTH 1024
+#define WORD (sizeof(uint64_t))
+
+typedef struct {
+    char magic[4];
+    uint16_t version;
+    uint16_t bom;
+    uint64_t length;
+    uint64_t root;
+} serial_header_t;
+
+
+static void
+put_word(char *rec, size_t i, uint64_t w)
+{
+    if (rec) {
+        memcpy(rec + i * WORD, &w, WORD);
+    }
+}
+
+static uint64_t
+get_word(const char *rec, size_t i)
+{
+    uint64_t w;
+
+    memcpy(&w, rec + i * WORD, WORD);
+    return w;
+}
+
+static uint64_t
+pack_flags(uint8_t align, uint8_t flag)
+{
+    return (uint64_t)align | ((uint64_t)flag << 8);
+}
+
+/* Categorical values are stored in a canonical 64-bit representation. */
+static uint64_t
+value_to_word(const ndt_memory_t *mem)
+{
+    uint64_t w;
+    double d;
+
+    switch (mem->t->tag) {
+    case Bool: return mem->v.Bool;
+    case Int8: return (uint64_t)(int64_t)mem->v.Int8;
+    case Int16: return (uint64_t)(int64_t)mem->v.Int16;
+    case Int32: return (uint64_t)(int64_t)mem->v.Int32;
+    case Int64: return (uint64_t)mem->v.Int64;
+    case Uint8: return mem->v.Uint8;
+    case Uint16: return mem->v.Uint16;
+    case Uint32: return mem->v.Uint32;
+    case Uint64: return mem->v.Uint64;
+    case Float32: case Float64:
+        d = mem->t->tag == Float32 ? mem->v.Float32 : mem->v.Float64;
+        memcpy(&w, &d, sizeof w);
+        return w;
+    default: return 0;
+    }
+}
+
+/* Return -1 if 'w' is out of range for the value type 'tag'. */
+static int
+word_to_value(ndt_value_t *v, uint64_t tag, uint64_t w)
+{
+    int64_t i = (int64_t)w;
+    double d;
+
+    switch (tag) {
+    case Bool: v->Bool = w != 0; return w > 1 ? -1 : 0;
+    case Int8: v->Int8 = (int8_t)i; return i < INT8_MIN || i > INT8_MAX ? -1 : 0;
+    case Int16: v->Int16 = (int16_t)i; return i < INT16_MIN || i > INT16_MAX ? -1 : 0;
+    case Int32: v->Int32 = (int32_t)i; return i < INT32_MIN || i > INT32_MAX ? -1 : 0;
+    case Int64: v->Int64 = i; return 0;
+    case Uint8: v->Uint8 = (uint8_t)w; return w > UINT8_MAX ? -1 : 0;
+    case Uint16: v->Uint16 = (uint16_t)w; return w > UINT16_MAX ? -1 : 0;
+    case Uint32: v->Uint32 = (uint32_t)w; return w > UINT32_MAX ? -1 : 0;
+    case Uint64: v->Uint64 = w; return 0;
+    case Float32:
+        memcpy(&d, &w, sizeof d);
+        v->Float32 = (float)d;
+        return 0;
+    case Float64:
+        memcpy(&d, &w, sizeof d);
+        v->Float64 = d;
+        return 0;
+    default:
+        return -1;
+    }
+}
+
+/* Number of words in the node record for 't' (excluding children). */
+static size_t
+node_words(const ndt_t *t)
+{
+    switch (t->tag) {
+    case Array: return 3 + 3 + 5 * t->Array.ndim;
+    case Option: case Nominal: case Typevar: case Pointer: return 3 + 1;
+    case Constr: return 3 + 2;
+    case Tuple: return 3 + 2 + 3 * t->Tuple.shape;
+    case Record: return 3 + 2 + 4 * t->Record.shape;
+    case Function: return 3 + 3;
+    case Char: case Bytes: return 3 + 1;
+    case FixedString: case FixedBytes: return 3 + 2;
+    case Categorical: return 3 + 1 + 2 * t->Categorical.ntypes;
+    default: return 3;
+    }
+}
+
+
+/*****************************************************************************/
+/*                                 Layout                                    */
+/*****************************************************************************/
+
+/*
+ * Both the writer and the reader check that the layout of every node is
+ * the one computed from the type's structure, so a serialized type never
+ * carries an inconsistent layout.
+ */
+
+static int
+bad_layout(ndt_context_t *ctx, const char *msg)
+{
+    ndt_err_format(ctx, NDT_ValueError, "invalid type layout: %s", msg);
+    return -1;
+}
+
+/* Check a tuple or record field and advance 'offset' past its padding. */
+static int
+check_field(size_t *offset, uint8_t *maxalign, bool *abstract,
+            const ndt_t *type, size_t field_offset, uint8_t field_align,
+            uint8_t pad, ndt_context_t *ctx)
+{
+    if (type->align == 0 || field_offset != *offset ||
+        field_offset % type->align != 0 || field_align < type->align ||
+        add_size(offset, field_offset, type->size) < 0 ||
+        add_size(offset, *offset, pad) < 0) {
+        return bad_layout(ctx, "invalid field layout");
+    }
+
+    if (type->align > *maxalign) {
+        *maxalign = type->align;
+    }
+    if (type->abstract) {
+        *abstract = 1;
+    }
+
+    return 0;
+}
+
+static int
+check_dimensions(size_t *size, uint8_t *align, bool *abstract,
+                 const ndt_t *t, ndt_context_t *ctx)
+{
+    const ndt_dim_t *dim = t->Array.dim;
+    int ellipsis_count = 0;
+    size_t i;
+
+    *size = t->Array.dtype->size;
+    *align = t->Array.dtype->align;
+    *abstract = t->Array.dtype->abstract;
+
+    for (i = t->Array.ndim-1; i != SIZE_MAX; i--) {
+        switch (dim[i].tag) {
+        case FixedDim:
+            if (dim[i].itemsize != *size || dim[i].itemalign != *align ||
+                dim[i].abstract) {
+                return bad_layout(ctx, "invalid dimension layout");
+            }
+            /* same as the constructor: abstract arrays have no size */
+            if (mul_size(size, *size, dim[i].FixedDim.shape) < 0 && !*abstract) {
+                return bad_layout(ctx, "array size overflow");
+            }
+            break;
+        case VarDim:
+            if (dim[i].itemsize != *size || dim[i].itemalign == 0 ||
+                dim[i].abstract) {
+                return bad_layout(ctx, "invalid dimension layout");
+            }
+            *align = dim[i].itemalign;
+            break;
+        case EllipsisDim:
+            if (++ellipsis_count > 1) {
+                return bad_layout(ctx, "more than one ellipsis dimension");
+            }
+            /* fall through */
+        default:
+            if (!dim[i].abstract) {
+                return bad_layout(ctx, "invalid dimension layout");
+            }
+            *abstract = 1;
+            break;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Check a node whose children have already been checked.  The size,
+ * alignment and offsets must be those that the constructors compute from
+ * the type's structure, and categorical values must be in the canonical
+ * order of ndt_categorical().
+ */
+static int
+check_node(const ndt_t *t, ndt_context_t *ctx)
+{
+    const ndt_tuple_field_t *tf;
+    const ndt_record_field_t *rf;
+    const ndt_memory_t *p, *q;
+    const ndt_t *type;
+    size_t size = 0;
+    uint8_t align = 1;
+    bool abstract = 1;
+    size_t i;
+
+    switch (t->tag) {
+    case Array:
+        if (check_dimensions(&size, &align, &abstract, t, ctx) < 0) {
+            return -1;
+        }
+        break;
+
+    case Option: case Nominal: case Constr:
+        if (t->tag == Nominal) {
+            type = ndt_typedef_find(t->Nominal.name, ctx);
+            if (type == NULL) {
+                return -1;
+            }
+        }
+        else {
+            type = t->tag == Option ? t->Option.type : t->Constr.type;
+        }
+        size = type->size;
+        align = type->align;
+        abstract = type->abstract;
+        break;
+
+    case Tuple:
+        abstract = t->Tuple.flag == Variadic;
+        for (i = 0; i < t->Tuple.shape; i++) {
+            tf = &t->Tuple.fields[i];
+            if (check_field(&size, &align, &abstract, tf->type, tf->offset,
+                            tf->align, tf->pad, ctx) < 0) {
+                return -1;
+            }
+        }
+        if (size % align != 0) {
+            return bad_layout(ctx, "invalid field layout");
+        }
+        break;
+
+    case Record:
+        abstract = t->Record.flag == Variadic;
+        for (i = 0; i < t->Record.shape; i++) {
+            rf = &t->Record.fields[i];
+            if (check_field(&size, &align, &abstract, rf->type, rf->offset,
+                            rf->align, rf->pad, ctx) < 0) {
+                return -1;
+            }
+        }
+        if (size % align != 0) {
+            return bad_layout(ctx, "invalid field layout");
+        }
+        break;
+
+    case Function:
+        size = sizeof(void *);
+        align = alignof(void *);
+        abstract = t->Function.ret->abstract || t->Function.pos->abstract ||
+                   t->Function.kwds->abstract;
+        break;
+
+    case Pointer:
+        size = sizeof(void *);
+        align = alignof(void *);
+        abstract = t->Pointer.type->abstract;
+        break;
+
+    case Void: abstract = 0; break;
+    case Bool: size = sizeof(bool); align = alignof(bool); abstract = 0; break;
+    case Int8: size = sizeof(int8_t); align = alignof(int8_t); abstract = 0; break;
+    case Int16: size = sizeof(int16_t); align = alignof(int16_t); abstract = 0; break;
+    case Int32: size = sizeof(int32_t); align = alignof(int32_t); abstract = 0; break;
+    case Int64: size = sizeof(int64_t); align = alignof(int64_t); abstract = 0; break;
+    case Uint8: size = sizeof(uint8_t); align = alignof(uint8_t); abstract = 0; break;
+    case Uint16: size = sizeof(uint16_t); align = alignof(uint16_t); abstract = 0; break;
+    case Uint32: size = sizeof(uint32_t); align = alignof(uint32_t); abstract = 0; break;
+    case Uint64: size = sizeof(uint64_t); align = alignof(uint64_t); abstract = 0; break;
+    case Float32: size = sizeof(float); align = alignof(float); abstract = 0; break;
+    case Float64: size = sizeof(double); align = alignof(double); abstract = 0; break;
+    case Complex64:
+        size = sizeof(ndt_complex64_t);
+        align = alignof(ndt_complex64_t);
+        abstract = 0;
+        break;
+    case Complex128:
+        size = sizeof(ndt_complex128_t);
+        align = alignof(ndt_complex128_t);
+        abstract = 0;
+        break;
+
+    case Float16:
+        return bad_layout(ctx, "invalid tag");
+
+    case Char:
+        size = ndt_sizeof_encoding(t->Char.encoding);
+        align = ndt_alignof_encoding(t->Char.encoding);
+        abstract = 0;
+        break;
+
+    case String:
+        size = sizeof(ndt_sized_string_t);
+        align = alignof(ndt_sized_string_t);
+        abstract = 0;
+        break;
+
+    case Bytes:
+        size = sizeof(ndt_bytes_t);
+        align = alignof(ndt_bytes_t);
+        abstract = 0;
+        break;
+
+    case FixedString:
+        if (mul_size(&size, ndt_sizeof_encoding(t->FixedString.encoding),
+                     t->FixedString.size) < 0) {
+            return bad_layout(ctx, "fixed string size overflow");
+        }
+        align = ndt_alignof_encoding(t->FixedString.encoding);
+        abstract = 0;
+        break;
+
+    case FixedBytes:
+        size = t->FixedBytes.size;
+        align = t->FixedBytes.align;
+        abstract = 0;
+        break;
+
+    case Categorical:
+        for (i = 0; i+1 < t->Categorical.ntypes; i++) {
+            p = &t->Categorical.types[i];
+            q = &t->Categorical.types[i+1];
+            if (p->t->tag > q->t->tag ||
+                (p->t->tag == q->t->tag && ndt_memory_compare(p, q) >= 0)) {
+                return bad_layout(ctx, "categorical values are not sorted");
+            }
+        }
+        size = sizeof(ndt_memory_t);
+        align = alignof(ndt_memory_t);
+        abstract = 0;
+        break;
+
+    default: /* kinds and type variables */
+        break;
+    }
+
+    if (t->size != size || t->align != align || t->abstract != abstract) {
+        return bad_layout(ctx, "layout does not match the type");
+    }
+    if (align == 0) {
+        return bad_layout(ctx, "invalid alignment");
+    }
+
+    return 0;
+}
+
+/* Check all nodes of 't', children first. */
+static int
+check_type(const ndt_t *t, int depth, ndt_context_t *ctx)
+{
+    size_t i;
+
+    if (depth > SERIAL_MAX_DEPTH) {
+        return bad_layout(ctx, "maximum nesting depth exceeded");
+    }
+
+    switch (t->tag) {
+    case Array:
+        if (check_type(t->Array.dtype, depth+1, ctx) < 0) {
+            return -1;
+        }
+        break;
+    case Option:
+        if (check_type(t->Option.type, depth+1, ctx) < 0) {
+            return -1;
+        }
+        break;
+    case Constr:
+        if (check_type(t->Constr.type, depth+1, ctx) < 0) {
+            return -1;
+        }
+        break;
+    case Pointer:
+        if (check_type(t->Pointer.type, depth+1, ctx) < 0) {
+            return -1;
+        }
+        break;
+    case Tuple:
+        for (i = 0; i < t->Tuple.shape; i++) {
+            if (check_type(t->Tuple.fields[i].type, depth+1, ctx) < 0) {
+                return -1;
+            }
+        }
+        break;
+    case Record:
+        for (i = 0; i < t->Record.shape; i++) {
+            if (check_type(t->Record.fields[i].type, depth+1, ctx) < 0) {
+                return -1;
+            }
+        }
+        break;
+    case Function:
+        if (check_type(t->Function.ret, depth+1, ctx) < 0 ||
+            check_type(t->Function.pos, depth+1, ctx) < 0 ||
+            check_type(t->Function.kwds, depth+1, ctx) < 0) {
+            return -1;
+        }
+        break;
+    case Categorical:
+        for (i = 0; i < t->Categorical.ntypes; i++) {
+            if (check_type(t->Categorical.types[i].t, depth+1, ctx) < 0) {
+                return -1;
+            }
+        }
+        break;
+    default:
+        break;
+    }
+
+    return check_node(t, ctx);
+}
+
+
+/*****************************************************************************/
+/*                                 Writer                                    */
+/*****************************************************************************/
+
+static size_t
+write_string(arena_t *buf, const char *s)
+{
+    size_t len = strlen(s) + 1;
+    size_t n = (len + WORD - 1) / WORD;
+    size_t pos = buf->used;
+    char *p;
+
+    p = arena_alloc(buf, n, WORD, 1);
+    if (p) {
+        memset(p, 0, n * WORD);
+        memcpy(p, s, len);
+    }
+
+    return pos;
+}
+
+static size_t
+write_datashape(arena_t *buf, const ndt_t *t)
+{
+    const ndt_dim_t *dim;
+    const ndt_memory_t *mem;
+    uint64_t value;
+    size_t pos = buf->used;
+    size_t i, k;
+    char *r;
+
+    r = arena_alloc(buf, node_words(t), WORD, 1);
+    put_word(r, 0, t->tag);
+    put_word(r, 1, t->size);
+    put_word(r, 2, pack_flags(t->align, t->abstract));
+
+    switch (t->tag) {
+    case Array:
+        put_word(r, 3, t->Array.ndim);
+        put_word(r, 4, (uint8_t)t->Array.order);
+        for (i = 0; i < t->Array.ndim; i++) {
+            dim = &t->Array.dim[i];
+            k = 6 + 5 * i;
+            put_word(r, k, dim->tag);
+            switch (dim->tag) {
+            case FixedDim:
+                put_word(r, k+1, dim->FixedDim.shape);
+                put_word(r, k+2, dim->FixedDim.stride);
+                break;
+            case VarDim:
+                put_word(r, k+1, dim->VarDim.stride);
+                put_word(r, k+2, 0);
+                break;
+            case SymbolicDim:
+                put_word(r, k+1, write_string(buf, dim->SymbolicDim.name) - pos);
+                put_word(r, k+2, 0);
+                break;
+            default:
+                put_word(r, k+1, 0);
+                put_word(r, k+2, 0);
+                break;
+            }
+            put_word(r, k+3, dim->itemsize);
+            put_word(r, k+4, pack_flags(dim->itemalign, dim->abstract));
+        }
+        put_word(r, 5, write_datashape(buf, t->Array.dtype) - pos);
+        break;
+    case Option:
+        put_word(r, 3, write_datashape(buf, t->Option.type) - pos);
+        break;
+    case Nominal:
+        put_word(r, 3, write_string(buf, t->Nominal.name) - pos);
+        break;
+    case Constr:
+        put_word(r, 3, write_string(buf, t->Constr.name) - pos);
+        put_word(r, 4, write_datashape(buf, t->Constr.type) - pos);
+        break;
+    case Tuple:
+        put_word(r, 3, t->Tuple.flag);
+        put_word(r, 4, t->Tuple.shape);
+        for (i = 0; i < t->Tuple.shape; i++) {
+            k = 5 + 3 * i;
+            put_word(r, k, write_datashape(buf, t->Tuple.fields[i].type) - pos);
+            put_word(r, k+1, t->Tuple.fields[i].offset);
+            put_word(r, k+2, pack_flags(t->Tuple.fields[i].align,
+                                        t->Tuple.fields[i].pad));
+        }
+        break;
+    case Record:
+        put_word(r, 3, t->Record.flag);
+        put_word(r, 4, t->Record.shape);
+        for (i = 0; i < t->Record.shape; i++) {
+            k = 5 + 4 * i;
+            put_word(r, k, write_string(buf, t->Record.fields[i].name) - pos);
+            put_word(r, k+1, write_datashape(buf, t->Record.fields[i].type) - pos);
+            put_word(r, k+2, t->Record.fields[i].offset);
+            put_word(r, k+3, pack_flags(t->Record.fields[i].align,
+                                        t->Record.fields[i].pad));
+        }
+        break;
+    case Function:
+        put_word(r, 3, write_datashape(buf, t->Function.ret) - pos);
+        put_word(r, 4, write_datashape(buf, t->Function.pos) - pos);
+        put_word(r, 5, write_datashape(buf, t->Function.kwds) - pos);
+        break;
+    case Typevar:
+        put_word(r, 3, write_string(buf, t->Typevar.name) - pos);
+        break;
+    case Char:
+        put_word(r, 3, t->Char.encoding);
+        break;
+    case Bytes:
+        put_word(r, 3, t->Bytes.target_align);
+        break;
+    case FixedString:
+        put_word(r, 3, t->FixedString.size);
+        put_word(r, 4, t->FixedString.encoding);
+        break;
+    case FixedBytes:
+        put_word(r, 3, t->FixedBytes.size);
+        put_word(r, 4, t->FixedBytes.align);
+        break;
+    case Categorical:
+        put_word(r, 3, t->Categorical.ntypes);
+        for (i = 0; i < t->Categorical.ntypes; i++) {
+            mem = &t->Categorical.types[i];
+            k = 4 + 2 * i;
+            put_word(r, k, write_datashape(buf, mem->t) - pos);
+            if (mem->t->tag == String) {
+                value = write_string(buf, mem->v.String) - pos;
+            }
+            else {
+                value = value_to_word(mem);
+            }
+            put_word(r, k+1, value);
+        }
+        break;
+    case Pointer:
+        put_word(r, 3, write_datashape(buf, t->Pointer.type) - pos);
+        break;
+    default:
+        break;
+    }
+
+    return pos;
+}
+
+/*
+ * Return the serialized representation of 't' in a newly allocated buffer
+ * and store its length in 'len'.  The buffer is released with ndt_free().
+ * Concrete types whose size overflows size_t cannot be serialized.
+ */
+char *
+ndt_serialize(const ndt_t *t, size_t *len, ndt_context_t *ctx)
+{
+    arena_t buf = { NULL, sizeof(serial_header_t) };
+    serial_header_t header;
+
+    if (check_type(t, 0, ctx) < 0) {
+        return NULL;
+    }
+
+    /* count phase */
+    (void)write_datashape(&buf, t);
+
+    buf.ptr = ndt_alloc(1, buf.used);
+    if (buf.ptr == NULL) {
+        ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+        return NULL;
+    }
+
+    memcpy(header.magic, "NDTB", 4);
+    header.version = SERIAL_VERSION;
+    header.bom = SERIAL_BOM;
+    header.length = buf.used;
+    header.root = sizeof header;
+    memcpy(buf.ptr, &header, sizeof header);
+
+    buf.used = sizeof header;
+    (void)write_datashape(&buf, t);
+
+    *len = buf.used;
+    return buf.ptr;
+}
+
+
+/*****************************************************************************/
+/*                                 Reader                                    */
+/*****************************************************************************/
+
+typedef struct {
+    const char *buf;
+    size_t len;
+    size_t next;    /* expected position of the next node or string */
+} reader_t;
+
+
+static int
+invalid(ndt_context_t *ctx, const char *msg)
+{
+    ndt_err_format(ctx, NDT_ValueError, "invalid serialized type: %s", msg);
+    return -1;
+}
+
+/* Start a node or string at relative offset 'rel' from the node at 'pos'. */
+static const char *
+claim(reader_t *rd, size_t pos, uint64_t rel, ndt_context_t *ctx)
+{
+    if (rel == 0 || rel > rd->len - pos || pos + rel != rd->next) {
+        (void)invalid(ctx, "reference out of order");
+        return NULL;
+    }
+
+    return rd->buf + rd->next;
+}
+
+/* Extend the current node or string by 'n' words. */
+static int
+extend(reader_t *rd, uint64_t n, ndt_context_t *ctx)
+{
+    if (n > (rd->len - rd->next) / WORD) {
+        return invalid(ctx, "truncated buffer");
+    }
+
+    rd->next += (size_t)n * WORD;
+    return 0;
+}
+
+static int
+read_string(char **out, arena_t *arena, reader_t *rd, size_t pos,
+            uint64_t rel, ndt_context_t *ctx)
+{
+    const char *s, *end;
+
+    s = claim(rd, pos, rel, ctx);
+    if (s == NULL) {
+        return -1;
+    }
+
+    end = memchr(s, '\0', rd->len - rd->next);
+    if (end == NULL) {
+        return invalid(ctx, "unterminated string");
+    }
+    if (extend(rd, (uint64_t)(end - s) / WORD + 1, ctx) < 0) {
+        return -1;
+    }
+
+    *out = arena_strdup(arena, s);
+    return 0;
+}
+
+static int
+check_flags(uint64_t w, ndt_context_t *ctx)
+{
+    if ((w >> 8) > 1) {
+        return invalid(ctx, "invalid flags");
+    }
+    return 0;
+}
+
+static int
+check_encoding(uint64_t w, ndt_context_t *ctx)
+{
+    if (w >= ErrorEncoding) {
+        return invalid(ctx, "invalid encoding");
+    }
+    return 0;
+}
+
+/*
+ * Read the node at relative offset 'rel' from 'parent'.  In the count phase
+ * the buffer is validated and the result is NULL, in the copy phase the
+ * (already validated) node is copied into the arena and checked against
+ * the type's structure.
+ */
+static int
+read_datashape(ndt_t **out, arena_t *arena, reader_t *rd, size_t parent,
+               uint64_t rel, int depth, ndt_context_t *ctx)
+{
+    ndt_tuple_field_t *tfields = NULL;
+    ndt_record_field_t *rfields = NULL;
+    ndt_memory_t *types = NULL;
+    ndt_dim_t *dim = NULL;
+    ndt_value_t value;
+    ndt_t *u, *type;
+    const char *r;
+    char *name;
+    uint64_t tag, w, n;
+    size_t pos, i, k;
+
+    *out = NULL;
+
+    if (depth > SERIAL_MAX_DEPTH) {
+        return invalid(ctx, "maximum nesting depth exceeded");
+    }
+
+    pos = rd->next;
+    r = claim(rd, parent, rel, ctx);
+    if (r == NULL || extend(rd, 3, ctx) < 0) {
+        return -1;
+    }
+
+    tag = get_word(r, 0);
+    if (tag > Pointer) {
+        return invalid(ctx, "invalid tag");
+    }
+    if (check_flags(get_word(r, 2), ctx) < 0) {
+        return -1;
+    }
+
+    u = arena_alloc(arena, 1, sizeof *u, alignof(ndt_t));
+    if (u) {
+        memset(u, 0, sizeof *u);
+        u->tag = (enum ndt)tag;
+        u->refcnt = 1;
+        u->arena_interior = 1;
+        u->size = (size_t)get_word(r, 1);
+        u->align = (uint8_t)get_word(r, 2);
+        u->abstract = (get_word(r, 2) >> 8) != 0;
+    }
+
+    switch (tag) {
+    case Array:
+        if (extend(rd, 3, ctx) < 0) {
+            return -1;
+        }
+        n = get_word(r, 3);
+        if (n == 0 || n > rd->len / WORD || extend(rd, 5 * n, ctx) < 0) {
+            return invalid(ctx, "invalid number of dimensions");
+        }
+        w = get_word(r, 4);
+        if (w != 'C' && w != 'F') {
+            return invalid(ctx, "invalid array order");
+        }
+        dim = arena_alloc(arena, n, sizeof *dim, alignof(ndt_dim_t));
+        for (i = 0; i < n; i++) {
+            k = 6 + 5 * i;
+            if (get_word(r, k) > EllipsisDim ||
+                check_flags(get_word(r, k+4), ctx) < 0) {
+                return invalid(ctx, "invalid dimension");
+            }
+            name = NULL;
+            if (get_word(r, k) == SymbolicDim &&
+                read_string(&name, arena, rd, pos, get_word(r, k+1), ctx) < 0) {
+                return -1;
+            }
+            if (dim) {
+                dim[i].tag = (enum ndt_dim)get_word(r, k);
+                switch (dim[i].tag) {
+                case FixedDim:
+                    dim[i].FixedDim.shape = (size_t)get_word(r, k+1);
+                    dim[i].FixedDim.stride = (size_t)get_word(r, k+2);
+                    break;
+                case VarDim:
+                    dim[i].VarDim.stride = (size_t)get_word(r, k+1);
+                    break;
+                case SymbolicDim:
+                    dim[i].SymbolicDim.name = name;
+                    break;
+                default:
+                    break;
+                }
+                dim[i].itemsize = (size_t)get_word(r, k+3);
+                dim[i].itemalign = (uint8_t)get_word(r, k+4);
+                dim[i].abstract = (get_word(r, k+4) >> 8) != 0;
+            }
+        }
+        if (read_datashape(&type, arena, rd, pos, get_word(r, 5), depth+1, ctx) < 0) {
+            return -1;
+        }
+        if (u) {
+            u->Array.ndim = (size_t)n;
+            u->Array.dim = dim;
+            u->Array.dtype = type;
+            u->Array.order = (char)w;
+        }
+        break;
+
+    case Option: case Pointer:
+        if (extend(rd, 1, ctx) < 0 ||
+            read_datashape(&type, arena, rd, pos, get_word(r, 3), depth+1, ctx) < 0) {
+            return -1;
+        }
+        if (u) {
+            if (tag == Option) u->Option.type = type;
+            else u->Pointer.type = type;
+        }
+        break;
+
+    case Nominal: case Typevar:
+        if (extend(rd, 1, ctx) < 0 ||
+            read_string(&name, arena, rd, pos, get_word(r, 3), ctx) < 0) {
+            return -1;
+        }
+        if (u) {
+            if (tag == Nominal) u->Nominal.name = name;
+            else u->Typevar.name = name;
+        }
+        break;
+
+    case Constr:
+        if (extend(rd, 2, ctx) < 0 ||
+            read_string(&name, arena, rd, pos, get_word(r, 3), ctx) < 0 ||
+            read_datashape(&type, arena, rd, pos, get_word(r, 4), depth+1, ctx) < 0) {
+            return -1;
+        }
+        if (u) {
+            u->Constr.name = name;
+            u->Constr.type = type;
+        }
+        break;
+
+    case Tuple:
+        if (extend(rd, 2, ctx) < 0) {
+            return -1;
+        }
+        if (get_word(r, 3) > Variadic) {
+            return invalid(ctx, "invalid variadic flag");
+        }
+        n = get_word(r, 4);
+        if (n > rd->len / WORD || extend(rd, 3 * n, ctx) < 0) {
+            return invalid(ctx, "invalid number of fields");
+        }
+        if (n > 0) {
+            tfields = arena_alloc(arena, n, sizeof *tfields,
+                                  alignof(ndt_tuple_field_t));
+        }
+        for (i = 0; i < n; i++) {
+            k = 5 + 3 * i;
+            if (read_datashape(&type, arena, rd, pos, get_word(r, k), depth+1, ctx) < 0) {
+                return -1;
+            }
+            if (tfields) {
+                tfields[i].type = type;
+                tfields[i].offset = (size_t)get_word(r, k+1);
+                tfields[i].align = (uint8_t)get_word(r, k+2);
+                tfields[i].pad = (uint8_t)(get_word(r, k+2) >> 8);
+            }
+        }
+        if (u) {
+            u->Tuple.flag = (enum ndt_variadic_flag)get_word(r, 3);
+            u->Tuple.shape = (size_t)n;
+            u->Tuple.fields = tfields;
+        }
+        break;
+
+    case Record:
+        if (extend(rd, 2, ctx) < 0) {
+            return -1;
+        }
+        if (get_word(r, 3) > Variadic) {
+            return invalid(ctx, "invalid variadic flag");
+        }
+        n = get_word(r, 4);
+        if (n > rd->len / WORD || extend(rd, 4 * n, ctx) < 0) {
+            return invalid(ctx, "invalid number of fields");
+        }
+        if (n > 0) {
+            rfields = arena_alloc(arena, n, sizeof *rfields,
+                                  alignof(ndt_record_field_t));
+        }
+        for (i = 0; i < n; i++) {
+            k = 5 + 4 * i;
+            if (read_string(&name, arena, rd, pos, get_word(r, k), ctx) < 0 ||
+                read_datashape(&type, arena, rd, pos, get_word(r, k+1), depth+1, ctx) < 0) {
+                return -1;
+            }
+            if (rfields) {
+                rfields[i].name = name;
+                rfields[i].type = type;
+                rfields[i].offset = (size_t)get_word(r, k+2);
+                rfields[i].align = (uint8_t)get_word(r, k+3);
+                rfields[i].pad = (uint8_t)(get_word(r, k+3) >> 8);
+            }
+        }
+        if (u) {
+            u->Record.flag = (enum ndt_variadic_flag)get_word(r, 3);
+            u->Record.shape = (size_t)n;
+            u->Record.fields = rfields;
+        }
+        break;
+
+    case Function:
+        if (extend(rd, 3, ctx) < 0) {
+            return -1;
+        }
+        for (i = 0; i < 3; i++) {
+            if (read_datashape(&type, arena, rd, pos, get_word(r, 3+i), depth+1, ctx) < 0) {
+                return -1;
+            }
+            if (u) {
+                if (i == 0) u->Function.ret = type;
+                else if (i == 1) u->Function.pos = type;
+                else u->Function.kwds = type;
+            }
+        }
+        break;
+
+    case Char:
+        if (extend(rd, 1, ctx) < 0 || check_encoding(get_word(r, 3), ctx) < 0) {
+            return -1;
+        }
+        if (u) u->Char.encoding = (enum ndt_encoding)get_word(r, 3);
+        break;
+
+    case Bytes:
+        if (extend(rd, 1, ctx) < 0) {
+            return -1;
+        }
+        if (u) u->Bytes.target_align = (uint8_t)get_word(r, 3);
+        break;
+
+    case FixedString:
+        if (extend(rd, 2, ctx) < 0 || check_encoding(get_word(r, 4), ctx) < 0) {
+            return -1;
+        }
+        if (u) {
+            u->FixedString.size = (size_t)get_word(r, 3);
+            u->FixedString.encoding = (enum ndt_encoding)get_word(r, 4);
+        }
+        break;
+
+    case FixedBytes:
+        if (extend(rd, 2, ctx) < 0) {
+            return -1;
+        }
+        if (u) {
+            u->FixedBytes.size = (size_t)get_word(r, 3);
+            u->FixedBytes.align = (uint8_t)get_word(r, 4);
+        }
+        break;
+
+    case Categorical:
+        if (extend(rd, 1, ctx) < 0) {
+            return -1;
+        }
+        n = get_word(r, 3);
+        if (n > rd->len / WORD || extend(rd, 2 * n, ctx) < 0) {
+            return invalid(ctx, "invalid number of categories");
+        }
+        types = arena_alloc(arena, n, sizeof *types, alignof(ndt_memory_t));
+        for (i = 0; i < n; i++) {
+            k = 4 + 2 * i;
+            if (read_datashape(&type, arena, rd, pos, get_word(r, k), depth+1, ctx) < 0) {
+                return -1;
+            }
+            /* the child was read successfully, so the tag word is valid */
+            tag = get_word(rd->buf + pos + get_word(r, k), 0);
+            name = NULL;
+            if (tag == String) {
+                if (read_string(&name, arena, rd, pos, get_word(r, k+1), ctx) < 0) {
+                    return -1;
+                }
+                if (types) {
+                    types[i].v.String = name;
+                }
+            }
+            else if (word_to_value(&value, tag, get_word(r, k+1)) < 0) {
+                return invalid(ctx, "invalid categorical value");
+            }
+            else if (types) {
+                types[i].v = value;
+            }
+            if (types) {
+                types[i].t = type;
+            }
+        }
+        if (u) {
+            u->Categorical.ntypes = (size_t)n;
+            u->Categorical.types = types;
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    if (u) {
+        if (check_node(u, ctx) < 0) {
+            return -1;
+        }
+        u->hash = hash_node(u);
+    }
+
+    *out = u;
+    return 0;
+}
+
+/*
+ * Load a type from its serialized representation.  'buf' need not be
+ * aligned and is not referenced after the call, so it can point into a
+ * memory-mapped file.  The buffer is validated, the stored layout must match
+ * the layout computed from the type's structure and categorical values must
+ * be sorted.  The result is an arena type (a single allocation that is
+ * released with ndt_del()).
+ */
+ndt_t *
+ndt_deserialize(const char *buf, size_t len, ndt_context_t *ctx)
+{
+    arena_t arena = { NULL, 0 };
+    serial_header_t header;
+    reader_t rd;
+    ndt_t *u;
+
+    if (len < sizeof header) {
+        (void)invalid(ctx, "truncated buffer");
+        return NULL;
+    }
+
+    memcpy(&header, buf, sizeof header);
+    if (memcmp(header.magic, "NDTB", 4) != 0) {
+        (void)invalid(ctx, "bad magic number");
+        return NULL;
+    }
+    if (header.bom != SERIAL_BOM) {
+        (void)invalid(ctx, "byte order mismatch");
+        return NULL;
+    }
+    if (header.version != SERIAL_VERSION) {
+        ndt_err_format(ctx, NDT_NotImplementedError,
+            "unsupported serialization version: %d", (int)header.version);
+        return NULL;
+    }
+    if (header.length > len || header.root != sizeof header) {
+        (void)invalid(ctx, "truncated buffer");
+        return NULL;
+    }
+
+    rd.buf = buf;
+    rd.len = (size_t)header.length;
+
+    /* count phase, also validates the input */
+    rd.next = sizeof header;
+    if (read_datashape(&u, &arena, &rd, 0, header.root, 0, ctx) < 0) {
+        return NULL;
+    }
+    if (rd.next != rd.len) {
+        (void)invalid(ctx, "trailing data");
+        return NULL;
+    }
+
+    arena.ptr = ndt_alloc(1, arena.used);
+    if (arena.ptr == NULL) {
+        ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+        return NULL;
+    }
+    arena.used = 0;
+
+    rd.next = sizeof header;
+    if (read_datashape(&u, &arena, &rd, 0, header.root, 0, ctx) < 0) {
+        ndt_free(arena.ptr);
+        return NULL;
+    }
+    u->arena_interior = 0;
+    u->arena = 1;
+
+    return u;
+}
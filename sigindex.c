@@ -0,0 +1,709 @@
+/*
+ * Copyright (c) 2016, Continuum Analytics, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * Redistributions of source code must retain the above copyright notice,
+ * 
+ * this list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "ndtypes.h"
+
+
+/*****************************************************************************/
+/*                         Signature dispatch index                          */
+/*****************************************************************************/
+
+/*
+ * Discrimination tree over match patterns.  Each pattern is flattened into
+ * the preorder sequence of its node tokens, where a token encodes the facts
+ * that every matching candidate must share with the pattern node:
+ *
+ *   - the tag of the node,
+ *   - the number of dimensions of an array without ellipsis,
+ *   - the variadic flag and the number of fields of a tuple or record.
+ *
+ * Type variables, AnyKind and the other kinds become wildcards that skip the
+ * entire corresponding subtree of the candidate.  Array dimensions, field
+ * names and parameters of leaf types are not part of the token sequence.
+ *
+ * A lookup flattens the candidate and walks the tree, following the exact
+ * edge and the wildcard edge at each step.  The patterns that are reached are
+ * a superset of the matches: each of them is verified with its compiled
+ * match program.
+ */
+
+#define TOKEN_WILD UINT64_MAX
+#define NDIM_ANY (UINT64_MAX >> 8)
+#define INDEX_STACK 64
+
+typedef struct index_node index_node_t;
+
+typedef struct {
+    uint64_t token;
+    index_node_t *child;
+} index_edge_t;
+
+struct index_node {
+    size_t nedges;
+    index_edge_t *edges;
+    index_node_t *wild;
+    size_t nleaves;
+    size_t *leaves;         /* ids of the patterns that end here */
+};
+
+struct ndt_sigindex {
+    index_node_t *root;
+    size_t npatterns;
+    ndt_pattern_t **patterns;
+};
+
+typedef struct {
+    uint64_t token;
+    size_t end;             /* position after the subtree of this node */
+} query_token_t;
+
+
+static uint64_t
+make_token(enum ndt tag, uint64_t arg)
+{
+    return (uint64_t)tag | (arg << 8);
+}
+
+static uint64_t
+pattern_token(const ndt_t *p)
+{
+    size_t i;
+
+    switch (p->tag) {
+    case AnyKind: case Typevar:
+    case ScalarKind: case SignedKind: case UnsignedKind: case RealKind:
+    case ComplexKind: case FixedStringKind: case FixedBytesKind:
+        return TOKEN_WILD;
+    case Array:
+        for (i = 0; i < p->Array.ndim; i++) {
+            if (p->Array.dim[i].tag == EllipsisDim) {
+                return make_token(Array, NDIM_ANY);
+            }
+        }
+        return make_token(Array, p->Array.ndim);
+    case Tuple:
+        return make_token(Tuple, p->Tuple.flag | (p->Tuple.shape << 1));
+    case Record:
+        return make_token(Record, p->Record.flag | (p->Record.shape << 1));
+    default:
+        return make_token(p->tag, 0);
+    }
+}
+
+static uint64_t
+candidate_token(const ndt_t *c)
+{
+    switch (c->tag) {
+    case Array:
+        return make_token(Array, c->Array.ndim);
+    case Tuple:
+        return make_token(Tuple, c->Tuple.flag | (c->Tuple.shape << 1));
+    case Record:
+        return make_token(Record, c->Record.flag | (c->Record.shape << 1));
+    default:
+        return make_token(c->tag, 0);
+    }
+}
+
+/* Return the i-th child of 't' in the order of match_datashape(), or NULL. */
+static const ndt_t *
+child(const ndt_t *t, size_t i)
+{
+    switch (t->tag) {
+    case Array:
+        return i == 0 ? t->Array.dtype : NULL;
+    case Option:
+        return i == 0 ? t->Option.type : NULL;
+    case Pointer:
+        return i == 0 ? t->Pointer.type : NULL;
+    case Tuple:
+        return i < t->Tuple.shape ? t->Tuple.fields[i].type : NULL;
+    case Record:
+        return i < t->Record.shape ? t->Record.fields[i].type : NULL;
+    case Function:
+        return i == 0 ? t->Function.ret : i == 1 ? t->Function.pos :
+               i == 2 ? t->Function.kwds : NULL;
+    default:
+        return NULL;
+    }
+}
+
+
+/*****************************************************************************/
+/*                                 Tree nodes                                */
+/*****************************************************************************/
+
+static index_node_t *
+index_node_new(ndt_context_t *ctx)
+{
+    index_node_t *node;
+
+    node = ndt_alloc(1, sizeof *node);
+    if (node == NULL) {
+        ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+        return NULL;
+    }
+
+    node->nedges = 0;
+    node->edges = NULL;
+    node->wild = NULL;
+    node->nleaves = 0;
+    node->leaves = NULL;
+
+    return node;
+}
+
+static void
+index_node_del(index_node_t *node)
+{
+    size_t i;
+
+    if (node == NULL) {
+        return;
+    }
+
+    for (i = 0; i < node->nedges; i++) {
+        index_node_del(node->edges[i].child);
+    }
+    index_node_del(node->wild);
+
+    ndt_free(node->edges);
+    ndt_free(node->leaves);
+    ndt_free(node);
+}
+
+static index_node_t *
+index_node_find(const index_node_t *node, uint64_t token)
+{
+    size_t i;
+
+    for (i = 0; i < node->nedges; i++) {
+        if (node->edges[i].token == token) {
+            return node->edges[i].child;
+        }
+    }
+
+    return NULL;
+}
+
+/* Return the child for 'token', creating it if necessary. */
+static index_node_t *
+index_node_child(index_node_t *node, uint64_t token, ndt_context_t *ctx)
+{
+    index_edge_t *edges;
+    index_node_t *u;
+
+    if (token == TOKEN_WILD) {
+        if (node->wild == NULL) {
+            node->wild = index_node_new(ctx);
+        }
+        return node->wild;
+    }
+
+    u = index_node_find(node, token);
+    if (u != NULL) {
+        return u;
+    }
+
+    u = index_node_new(ctx);
+    if (u == NULL) {
+        return NULL;
+    }
+
+    edges = ndt_realloc(node->edges, node->nedges+1, sizeof *edges);
+    if (edges == NULL) {
+        ndt_free(u);
+        ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+        return NULL;
+    }
+
+    edges[node->nedges].token = token;
+    edges[node->nedges].child = u;
+    node->edges = edges;
+    node->nedges++;
+
+    return u;
+}
+
+static index_node_t *
+index_insert(index_node_t *node, const ndt_t *p, ndt_context_t *ctx)
+{
+    uint64_t token = pattern_token(p);
+    const ndt_t *t;
+    size_t i;
+
+    node = index_node_child(node, token, ctx);
+    if (node == NULL || token == TOKEN_WILD) {
+        return node;
+    }
+
+    for (i = 0; (t = child(p, i)) != NULL; i++) {
+        node = index_insert(node, t, ctx);
+        if (node == NULL) {
+            return NULL;
+        }
+    }
+
+    return node;
+}
+
+
+/*****************************************************************************/
+/*                                   API                                     */
+/*****************************************************************************/
+
+ndt_sigindex_t *
+ndt_sigindex_new(ndt_context_t *ctx)
+{
+    ndt_sigindex_t *index;
+
+    index = ndt_alloc(1, sizeof *index);
+    if (index == NULL) {
+        ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+        return NULL;
+    }
+
+    index->root = index_node_new(ctx);
+    if (index->root == NULL) {
+        ndt_free(index);
+        return NULL;
+    }
+    index->npatterns = 0;
+    index->patterns = NULL;
+
+    return index;
+}
+
+void
+ndt_sigindex_del(ndt_sigindex_t *index)
+{
+    size_t i;
+
+    if (index == NULL) {
+        return;
+    }
+
+    for (i = 0; i < index->npatterns; i++) {
+        ndt_pattern_del(index->patterns[i]);
+    }
+
+    ndt_free(index->patterns);
+    index_node_del(index->root);
+    ndt_free(index);
+}
+
+/*
+ * Add the pattern 'p' to the index.  Return the id of the pattern (the
+ * number of patterns that were added before it) or -1 on error.
+ */
+int64_t
+ndt_sigindex_add(ndt_sigindex_t *index, const ndt_t *p, ndt_context_t *ctx)
+{
+    ndt_pattern_t **patterns;
+    ndt_pattern_t *pat;
+    index_node_t *node;
+    size_t *leaves;
+    size_t id = index->npatterns;
+
+    pat = ndt_pattern_compile(p, ctx);
+    if (pat == NULL) {
+        return -1;
+    }
+
+    /* Nodes that are created before an error are left empty. */
+    node = index_insert(index->root, p, ctx);
+    if (node == NULL) {
+        ndt_pattern_del(pat);
+        return -1;
+    }
+
+    patterns = ndt_realloc(index->patterns, id+1, sizeof *patterns);
+    if (patterns == NULL) {
+        ndt_pattern_del(pat);
+        ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+        return -1;
+    }
+    index->patterns = patterns;
+
+    leaves = ndt_realloc(node->leaves, node->nleaves+1, sizeof *leaves);
+    if (leaves == NULL) {
+        ndt_pattern_del(pat);
+        ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+        return -1;
+    }
+    node->leaves = leaves;
+
+    node->leaves[node->nleaves++] = id;
+    index->patterns[index->npatterns++] = pat;
+
+    return (int64_t)id;
+}
+
+typedef struct {
+    const ndt_sigindex_t *index;
+    const ndt_t *c;
+    const query_token_t *query;
+    size_t len;
+    size_t *ids;
+    size_t n;
+    size_t found;
+    size_t first;           /* smallest matching id */
+} query_t;
+
+static size_t
+flatten(query_token_t *query, size_t pos, const ndt_t *c)
+{
+    const ndt_t *t;
+    size_t start = pos;
+    size_t i;
+
+    query[start].token = candidate_token(c);
+    pos++;
+
+    for (i = 0; (t = child(c, i)) != NULL; i++) {
+        pos = flatten(query, pos, t);
+    }
+
+    query[start].end = pos;
+    return pos;
+}
+
+static size_t
+count_nodes(const ndt_t *c)
+{
+    const ndt_t *t;
+    size_t n = 1;
+    size_t i;
+
+    for (i = 0; (t = child(c, i)) != NULL; i++) {
+        n += count_nodes(t);
+    }
+
+    return n;
+}
+
+static int
+lookup(query_t *q, const index_node_t *node, size_t pos, ndt_context_t *ctx)
+{
+    const index_node_t *u;
+    uint64_t token;
+    size_t i, id;
+    int n;
+
+    if (pos == q->len) {
+        for (i = 0; i < node->nleaves; i++) {
+            id = node->leaves[i];
+            n = ndt_pattern_match(q->index->patterns[id], q->c, ctx);
+            if (n < 0) {
+                return -1;
+            }
+            if (n == 1) {
+                if (q->found < q->n) {
+                    q->ids[q->found] = id;
+                }
+                if (q->found == 0 || id < q->first) {
+                    q->first = id;
+                }
+                q->found++;
+            }
+        }
+        return 0;
+    }
+
+    token = q->query[pos].token;
+
+    u = index_node_find(node, token);
+    if (u != NULL && lookup(q, u, pos+1, ctx) < 0) {
+        return -1;
+    }
+
+    if ((token & 0xff) == Array) {
+        u = index_node_find(node, make_token(Array, NDIM_ANY));
+        if (u != NULL && lookup(q, u, pos+1, ctx) < 0) {
+            return -1;
+        }
+    }
+
+    if (node->wild != NULL && lookup(q, node->wild, q->query[pos].end, ctx) < 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+static int
+cmp_id(const void *x, const void *y)
+{
+    size_t a = *(const size_t *)x;
+    size_t b = *(const size_t *)y;
+
+    return a < b ? -1 : a != b;
+}
+
+static int64_t
+index_query(query_t *q, ndt_context_t *ctx)
+{
+    query_token_t stack[INDEX_STACK];
+    query_token_t *query = stack;
+    int ret;
+
+    q->len = count_nodes(q->c);
+    if (q->len > INDEX_STACK) {
+        query = ndt_alloc(q->len, sizeof *query);
+        if (query == NULL) {
+            ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+            return -1;
+        }
+    }
+
+    (void)flatten(query, 0, q->c);
+    q->query = query;
+    ret = lookup(q, q->index->root, 0, ctx);
+
+    if (query != stack) {
+        ndt_free(query);
+    }
+
+    return ret < 0 ? -1 : (int64_t)q->found;
+}
+
+/*
+ * Find the patterns that match 'c'.  Return the number of matches or -1 on
+ * error.  If the number of matches is at most 'n', their ids are stored in
+ * 'ids' in ascending order.  Otherwise only 'n' of them are stored and the
+ * caller should retry with a larger array.
+ */
+int64_t
+ndt_sigindex_find(const ndt_sigindex_t *index, const ndt_t *c,
+                  size_t *ids, size_t n, ndt_context_t *ctx)
+{
+    query_t q = { index, c, NULL, 0, ids, n, 0, 0 };
+    int64_t found;
+
+    found = index_query(&q, ctx);
+    if (found < 0) {
+        return -1;
+    }
+
+    qsort(ids, q.found < n ? q.found : n, sizeof *ids, cmp_id);
+    return found;
+}
+
+
+/*****************************************************************************/
+/*                             Call site caches                              */
+/*****************************************************************************/
+
+/*
+ * Polymorphic inline cache for a single call site.  The cache remembers the
+ * dispatch result and the bindings of the matching pattern for the last
+ * 'size' candidate types.  A lookup hits if the candidate is one of the
+ * cached types, or if it has the same fingerprint and is structurally equal.
+ * An entry holds a reference to its type, so a freed and reused address
+ * cannot cause a false hit.  Inner nodes of arena types cannot be pinned by
+ * a reference and are not stored.  Entries are replaced in round-robin order.
+ *
+ * A call site cache is not thread safe.  The index must not be changed while
+ * a cache refers to it.
+ */
+
+typedef struct {
+    const ndt_t *type;      /* NULL for an empty entry */
+    int64_t id;             /* -1 if no pattern matches */
+    ndt_bindings_t *bindings;
+} callsite_entry_t;
+
+struct ndt_callsite {
+    const ndt_sigindex_t *index;
+    size_t size;
+    size_t next;            /* entry that is replaced next */
+    ndt_bindings_t *scratch;    /* bindings for types that are not stored */
+    ndt_cache_stats_t stats;
+    callsite_entry_t entries[];
+};
+
+ndt_callsite_t *
+ndt_callsite_new(const ndt_sigindex_t *index, size_t size, ndt_context_t *ctx)
+{
+    ndt_callsite_t *cs;
+    size_t i;
+
+    if (size == 0 || size > NDT_CALLSITE_MAX) {
+        ndt_err_format(ctx, NDT_ValueError,
+            "call site cache size must be in [1, %d]", NDT_CALLSITE_MAX);
+        return NULL;
+    }
+
+    cs = ndt_alloc(1, sizeof *cs + size * sizeof cs->entries[0]);
+    if (cs == NULL) {
+        ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+        return NULL;
+    }
+
+    cs->index = index;
+    cs->size = size;
+    cs->next = 0;
+    cs->stats.hits = 0;
+    cs->stats.misses = 0;
+    cs->stats.evictions = 0;
+
+    for (i = 0; i < size; i++) {
+        cs->entries[i].type = NULL;
+        cs->entries[i].id = -1;
+        cs->entries[i].bindings = NULL;
+    }
+
+    cs->scratch = ndt_bindings_new(ctx);
+    if (cs->scratch == NULL) {
+        ndt_callsite_del(cs);
+        return NULL;
+    }
+
+    for (i = 0; i < size; i++) {
+        cs->entries[i].bindings = ndt_bindings_new(ctx);
+        if (cs->entries[i].bindings == NULL) {
+            ndt_callsite_del(cs);
+            return NULL;
+        }
+    }
+
+    return cs;
+}
+
+void
+ndt_callsite_del(ndt_callsite_t *cs)
+{
+    size_t i;
+
+    if (cs == NULL) {
+        return;
+    }
+
+    for (i = 0; i < cs->size; i++) {
+        ndt_del((ndt_t *)cs->entries[i].type);
+        ndt_bindings_del(cs->entries[i].bindings);
+    }
+
+    ndt_bindings_del(cs->scratch);
+    ndt_free(cs);
+}
+
+static int
+callsite_hit(ndt_callsite_t *cs, const callsite_entry_t *e, int64_t *id,
+             const ndt_bindings_t **b)
+{
+    cs->stats.hits++;
+    *id = e->id;
+    if (b != NULL) {
+        *b = e->id >= 0 ? e->bindings : NULL;
+    }
+
+    return e->id >= 0;
+}
+
+/*
+ * Dispatch 'c' to the first registered pattern that matches it.  Return 1
+ * and store the id of the pattern in 'id' if there is a match, 0 if no
+ * pattern matches and -1 on error.
+ *
+ * If 'b' is not NULL, it is set to the bindings of the pattern on a match
+ * and to NULL otherwise.  The bindings are owned by the cache, refer to 'c'
+ * or to a structurally equal type, and are valid until the next lookup.
+ */
+int
+ndt_callsite_lookup(ndt_callsite_t *cs, const ndt_t *c, int64_t *id,
+                    const ndt_bindings_t **b, ndt_context_t *ctx)
+{
+    query_t q = { cs->index, c, NULL, 0, NULL, 0, 0, 0 };
+    callsite_entry_t *e;
+    ndt_bindings_t *bindings;
+    int64_t found;
+    size_t i;
+
+    for (i = 0; i < cs->size; i++) {
+        e = &cs->entries[i];
+        if (e->type == c) {
+            return callsite_hit(cs, e, id, b);
+        }
+    }
+
+    /* Structurally equal types are usually distinct objects. */
+    for (i = 0; i < cs->size; i++) {
+        e = &cs->entries[i];
+        if (e->type != NULL && e->type->hash == c->hash && ndt_equal(e->type, c)) {
+            return callsite_hit(cs, e, id, b);
+        }
+    }
+
+    found = index_query(&q, ctx);
+    if (found < 0) {
+        return -1;
+    }
+
+    cs->stats.misses++;
+
+    e = NULL;
+    bindings = cs->scratch;
+    if (!c->arena_interior) {
+        e = &cs->entries[cs->next];
+        if (e->type != NULL) {
+            cs->stats.evictions++;
+            ndt_del((ndt_t *)e->type);
+            e->type = NULL;
+        }
+        bindings = e->bindings;
+    }
+
+    if (found > 0 &&
+        ndt_pattern_unify(cs->index->patterns[q.first], c, bindings, ctx) < 0) {
+        return -1;
+    }
+
+    *id = found > 0 ? (int64_t)q.first : -1;
+    if (b != NULL) {
+        *b = found > 0 ? bindings : NULL;
+    }
+
+    if (e != NULL) {
+        e->type = ndt_incref(c);
+        e->id = *id;
+        cs->next = (cs->next + 1) % cs->size;
+    }
+
+    return found > 0;
+}
+
+void
+ndt_callsite_stats(const ndt_callsite_t *cs, ndt_cache_stats_t *stats)
+{
+    *stats = cs->stats;
+}
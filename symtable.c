@@ -27,10 +27,16 @@
 
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <limits.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <string.h>
 #include "ndtypes.h"
+#include "hash.h"
 #include "symtable.h"
+#include "intern.h"
+#include "sync.h"
 
 
 /*****************************************************************************/
@@ -57,124 +63,347 @@ init_charmap(void)
     }
 }
 
+/* Return the first character of 'key' that is not in the alphabet. */
+static const unsigned char *
+invalid_char(const char *key)
+{
+    const unsigned char *cp;
+
+    for (cp = (const unsigned char *)key; *cp != '\0'; cp++) {
+        if (code[*cp] == UCHAR_MAX) {
+            return cp;
+        }
+    }
+
+    return NULL;
+}
+
 
 /*****************************************************************************/
 /*                            Global typedef map                             */
 /*****************************************************************************/
 
-typedef struct typedef_trie {
-    const ndt_t *value;
-    struct typedef_trie *next[];
-} typedef_trie_t;
+/*
+ * The typedef map is an open addressing hash table of immutable entries.
+ * Lookups do not take a lock:
+ *
+ *   - An entry is initialized before it is published in a slot with a
+ *     release store.  Slots are never cleared.
+ *
+ *   - Each entry has the generation of the operation that added it.  The
+ *     writer stores the new generation after all entries of an operation
+ *     are in the table, and readers skip entries with a larger generation.
+ *     Several typedefs can therefore be published as one operation.
+ *
+ *   - When the table grows, the entries are linked into a new table that
+ *     replaces the old one with a release store.  Readers may still probe
+ *     the old table, which is retired and freed in ndt_finalize().  Since
+ *     the size doubles, the retired tables use less memory than the live
+ *     one.
+ *
+ * Writers are serialized by typedef_lock.
+ */
 
-static typedef_trie_t *typedef_map = NULL;
+#define TYPEDEF_MINSIZE 64
 
-static typedef_trie_t *
-typedef_trie_new(ndt_context_t *ctx)
+typedef struct {
+    uint64_t hash;
+    size_t gen;
+    const ndt_t *value;
+    char key[];
+} typedef_entry_t;
+
+typedef struct typedef_table {
+    size_t mask;
+    size_t used;
+    struct typedef_table *retired;
+    typedef_entry_t *slots[];
+} typedef_table_t;
+
+static typedef_table_t *typedef_map = NULL;
+static size_t typedef_gen = 0;
+static ndt_mutex_t typedef_lock = NDT_MUTEX_INIT;
+
+static typedef_table_t *
+typedef_table_new(size_t size, ndt_context_t *ctx)
 {
-    typedef_trie_t *t;
-    int i;
+    typedef_table_t *t;
+    size_t i;
 
-    t = ndt_alloc(1, offsetof(typedef_trie_t, next) + ALPHABET_LEN * (sizeof t));
+    if (size > (SIZE_MAX - offsetof(typedef_table_t, slots)) / sizeof t->slots[0]) {
+        ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+        return NULL;
+    }
+
+    t = ndt_alloc(1, offsetof(typedef_table_t, slots) + size * sizeof t->slots[0]);
     if (t == NULL) {
         ndt_err_format(ctx, NDT_MemoryError, "out of memory");
         return NULL;
     }
 
-    t->value = NULL;
+    t->mask = size-1;
+    t->used = 0;
+    t->retired = NULL;
 
-    for (i = 0; i < ALPHABET_LEN; i++) {
-        t->next[i] = NULL;
+    for (i = 0; i < size; i++) {
+        t->slots[i] = NULL;
     }
 
     return t;
 }
 
 static void
-typedef_trie_del(typedef_trie_t *t)
+typedef_table_del(typedef_table_t *t)
 {
-    int i;
+    typedef_table_t *next;
+    size_t i;
 
     if (t == NULL) {
         return;
     }
 
-    ndt_del((ndt_t *)t->value);
+    /* The entries are shared with the retired tables. */
+    for (i = 0; i <= t->mask; i++) {
+        if (t->slots[i] != NULL) {
+            ndt_del((ndt_t *)t->slots[i]->value);
+            ndt_free(t->slots[i]);
+        }
+    }
 
-    for (i = 0; i < ALPHABET_LEN; i++) {
-        typedef_trie_del(t->next[i]);
+    for (; t != NULL; t = next) {
+        next = t->retired;
+        ndt_free(t);
     }
+}
 
-    ndt_free(t);
+/* Only called by the writer. */
+static void
+typedef_table_insert(typedef_table_t *t, typedef_entry_t *entry)
+{
+    size_t i;
+
+    for (i = entry->hash & t->mask; t->slots[i] != NULL; i = (i+1) & t->mask);
+
+    ndt_atomic_store(&t->slots[i], entry);
+    t->used++;
+}
+
+/* Only called by the writer.  Make room for 'n' more entries. */
+static int
+typedef_table_reserve(size_t n, ndt_context_t *ctx)
+{
+    typedef_table_t *t = typedef_map;
+    typedef_table_t *u;
+    size_t size, i;
+
+    if (n > SIZE_MAX / 2 - t->used) {
+        ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+        return -1;
+    }
+
+    for (size = t->mask+1; 2 * (t->used+n) > size; size *= 2) {
+        if (size > SIZE_MAX / 2) {
+            ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+            return -1;
+        }
+    }
+
+    if (size == t->mask+1) {
+        return 0;
+    }
+
+    u = typedef_table_new(size, ctx);
+    if (u == NULL) {
+        return -1;
+    }
+
+    for (i = 0; i <= t->mask; i++) {
+        if (t->slots[i] != NULL) {
+            typedef_table_insert(u, t->slots[i]);
+        }
+    }
+
+    u->retired = t;
+    ndt_atomic_store(&typedef_map, u);
+
+    return 0;
+}
+
+/* Find 'key' among the entries of generation 'gen' or older. */
+static const typedef_entry_t *
+typedef_table_find(const typedef_table_t *t, const char *key, uint64_t hash,
+                   size_t gen)
+{
+    const typedef_entry_t *entry;
+    size_t i;
+
+    for (i = hash & t->mask; ; i = (i+1) & t->mask) {
+        entry = ndt_atomic_load(&t->slots[i]);
+        if (entry == NULL) {
+            return NULL;
+        }
+        if (entry->hash == hash && entry->gen <= gen &&
+            strcmp(entry->key, key) == 0) {
+            return entry;
+        }
+    }
+}
+
+static typedef_entry_t *
+typedef_entry_new(const char *key, const ndt_t *value, ndt_context_t *ctx)
+{
+    typedef_entry_t *entry;
+    const unsigned char *cp;
+    size_t len;
+
+    cp = invalid_char(key);
+    if (cp != NULL) {
+        ndt_err_format(ctx, NDT_ValueError,
+                       "invalid character in typedef: '%c'", *cp);
+        return NULL;
+    }
+
+    len = strlen(key);
+    entry = ndt_alloc(1, offsetof(typedef_entry_t, key) + len + 1);
+    if (entry == NULL) {
+        ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+        return NULL;
+    }
+    entry->hash = hash_data(key, strlen(key));
+    entry->gen = 0;
+    entry->value = value;
+    memcpy(entry->key, key, len+1);
+
+    return entry;
 }
 
 int
 ndt_typedef_add(const char *key, const ndt_t *value, ndt_context_t *ctx)
 {
-    typedef_trie_t *t = typedef_map;
-    const unsigned char *cp;
-    int i;
+    return ndt_typedef_add_all(&key, &value, 1, ctx);
+}
 
-    for (cp = (const unsigned char *)key; *cp != '\0'; cp++) {
-        i = code[*cp];
-        if (i == UCHAR_MAX) {
-            ndt_err_format(ctx, NDT_ValueError,
-                           "invalid character in typedef: '%c'", *cp);
+static int
+cmp_entry(const void *x, const void *y)
+{
+    const typedef_entry_t *a = *(const typedef_entry_t * const *)x;
+    const typedef_entry_t *b = *(const typedef_entry_t * const *)y;
+
+    if (a->hash != b->hash) {
+        return a->hash < b->hash ? -1 : 1;
+    }
+
+    return strcmp(a->key, b->key);
+}
+
+/*
+ * Add the typedefs keys[i] -> values[i] for i in [0, n) as one operation.
+ * The entries are inserted into the live table and published together by
+ * the generation store:  readers see either none or all of the new typedefs,
+ * and on error the table is unchanged.  The table is only copied when it
+ * has to grow.
+ */
+int
+ndt_typedef_add_all(const char * const *keys, const ndt_t * const *values,
+                    size_t n, ndt_context_t *ctx)
+{
+    typedef_entry_t *inline_entries[1];
+    typedef_entry_t **entries = inline_entries;
+    size_t gen, i, k;
+
+    if (n == 0) {
+        return 0;
+    }
+
+    if (n > 1) {
+        entries = ndt_alloc(n, sizeof *entries);
+        if (entries == NULL) {
+            ndt_err_format(ctx, NDT_MemoryError, "out of memory");
             return -1;
         }
+    }
 
-        if (t->next[i] == NULL) {
-            typedef_trie_t *u = typedef_trie_new(ctx);
-            if (u == NULL) {
-                return -1;
-            }
-            t->next[i] = u;
-            t = u;
+    for (i = 0; i < n; i++) {
+        entries[i] = typedef_entry_new(keys[i], values[i], ctx);
+        if (entries[i] == NULL) {
+            goto error;
         }
-        else {
-            t = t->next[i];
+    }
+
+    /* Duplicates within the batch are adjacent after sorting. */
+    qsort(entries, n, sizeof *entries, cmp_entry);
+    for (k = 1; k < n; k++) {
+        if (cmp_entry(&entries[k-1], &entries[k]) == 0) {
+            ndt_err_format(ctx, NDT_ValueError, "duplicate typedef '%s'",
+                           entries[k]->key);
+            goto error;
         }
     }
 
-    if (t->value) {
-        ndt_err_format(ctx, NDT_ValueError, "duplicate typedef '%s'", key);
-        return -1;
+    ndt_mutex_lock(&typedef_lock);
+
+    for (k = 0; k < n; k++) {
+        if (typedef_table_find(typedef_map, entries[k]->key, entries[k]->hash,
+                               SIZE_MAX) != NULL) {
+            ndt_mutex_unlock(&typedef_lock);
+            ndt_err_format(ctx, NDT_ValueError, "duplicate typedef '%s'",
+                           entries[k]->key);
+            goto error;
+        }
+    }
+
+    if (typedef_table_reserve(n, ctx) < 0) {
+        ndt_mutex_unlock(&typedef_lock);
+        goto error;
+    }
+
+    gen = typedef_gen + 1;
+    for (k = 0; k < n; k++) {
+        entries[k]->gen = gen;
+        typedef_table_insert(typedef_map, entries[k]);
     }
 
-    t->value = value;
+    ndt_atomic_store(&typedef_gen, gen);
+    ndt_mutex_unlock(&typedef_lock);
+
+    if (entries != inline_entries) {
+        ndt_free(entries);
+    }
     return 0;
+
+error:
+    for (k = 0; k < i; k++) {
+        ndt_free(entries[k]);
+    }
+    if (entries != inline_entries) {
+        ndt_free(entries);
+    }
+    return -1;
 }
 
 const ndt_t *
 ndt_typedef_find(const char *key, ndt_context_t *ctx)
 {
-    typedef_trie_t *t = typedef_map;
+    const typedef_entry_t *entry;
     const unsigned char *cp;
-    int i;
-
-    for (cp = (const unsigned char *)key; *cp != '\0'; cp++) {
-        i = code[*cp];
-        if (i == UCHAR_MAX) {
+    size_t gen;
+
+    gen = (size_t)ndt_atomic_load(&typedef_gen);
+    entry = typedef_table_find(ndt_atomic_load(&typedef_map), key,
+                               hash_data(key, strlen(key)), gen);
+    if (entry == NULL) {
+        cp = invalid_char(key);
+        if (cp != NULL) {
             ndt_err_format(ctx, NDT_ValueError,
                            "invalid character in typedef: '%c'", *cp);
             return NULL;
         }
-
-        if (t->next[i] == NULL) {
-            ndt_err_format(ctx, NDT_ValueError,
-                           "missing typedef for key '%s'", key);
-            return NULL;
-        }
-        t = t->next[i];
-    }
-
-    if (t->value == NULL) {
-        ndt_err_format(ctx, NDT_RuntimeError,
+        ndt_err_format(ctx, NDT_ValueError,
                        "missing typedef for key '%s'", key);
         return NULL;
     }
 
-    return t->value;
+    return entry->value;
 }
 
 
@@ -187,7 +416,7 @@ ndt_init(ndt_context_t *ctx)
 {
     init_charmap();
 
-    typedef_map = typedef_trie_new(ctx);
+    typedef_map = typedef_table_new(TYPEDEF_MINSIZE, ctx);
     if (typedef_map == NULL) {
         return -1;
     }
@@ -198,8 +427,9 @@ ndt_init(ndt_context_t *ctx)
 void
 ndt_finalize(void)
 {
-    typedef_trie_del(typedef_map);
+    typedef_table_del(typedef_map);
     typedef_map = NULL;
+    intern_table_del();
 }
 
 
@@ -207,41 +437,106 @@ ndt_finalize(void)
 /*                        Symbol tables for matching                         */
 /*****************************************************************************/
 
-symtable_t *
-symtable_new(ndt_context_t *ctx)
+/* The keys are borrowed from the types that are matched and must outlive
+   the table.  Inline bindings are searched linearly by hash, spilled bindings
+   are kept in an open addressing hash table. */
+
+#define SYMTABLE_MINSIZE (4 * SYMTABLE_INLINE)
+
+void
+symtable_init(symtable_t *t)
 {
-    symtable_t *t;
-    int i;
+    t->used = 0;
+    t->mask = 0;
+    t->slots = NULL;
+}
 
-    t = ndt_alloc(1, offsetof(symtable_t, next) + ALPHABET_LEN * (sizeof t));
-    if (t == NULL) {
+/* Release the spilled bindings (if any) and reset the table. */
+void
+symtable_clear(symtable_t *t)
+{
+    ndt_free(t->slots);
+    symtable_init(t);
+}
+
+static symtable_slot_t *
+symtable_slots_new(size_t size, ndt_context_t *ctx)
+{
+    symtable_slot_t *slots;
+    size_t i;
+
+    slots = ndt_alloc(size, sizeof *slots);
+    if (slots == NULL) {
         ndt_err_format(ctx, NDT_MemoryError, "out of memory");
         return NULL;
     }
 
-    t->entry.tag = Unbound;
+    for (i = 0; i < size; i++) {
+        slots[i].key = NULL;
+    }
 
-    for (i = 0; i < ALPHABET_LEN; i++) {
-        t->next[i] = NULL;
+    return slots;
+}
+
+static symtable_slot_t *
+symtable_lookup(const symtable_t *t, const char *key, uint64_t hash)
+{
+    symtable_slot_t *slot;
+    size_t i;
+
+    for (i = hash & t->mask; ; i = (i+1) & t->mask) {
+        slot = &t->slots[i];
+        if (slot->key == NULL ||
+            (slot->hash == hash && strcmp(slot->key, key) == 0)) {
+            return slot;
+        }
     }
+}
 
-    return t;
+static const symtable_slot_t *
+symtable_lookup_inline(const symtable_t *t, const char *key, uint64_t hash)
+{
+    const symtable_slot_t *slot;
+    size_t i;
+
+    for (i = 0; i < t->used; i++) {
+        slot = &t->inline_slots[i];
+        if (slot->hash == hash && strcmp(slot->key, key) == 0) {
+            return slot;
+        }
+    }
+
+    return NULL;
 }
 
-void
-symtable_del(symtable_t *t)
+/* Move all bindings to a new hash table with 'size' slots. */
+static int
+symtable_resize(symtable_t *t, size_t size, ndt_context_t *ctx)
 {
-    int i;
+    symtable_slot_t *old = t->slots ? t->slots : t->inline_slots;
+    size_t n = t->slots ? t->mask+1 : t->used;
+    symtable_slot_t *slots;
+    size_t i;
 
-    if (t == NULL) {
-        return;
+    slots = symtable_slots_new(size, ctx);
+    if (slots == NULL) {
+        return -1;
     }
 
-    for (i = 0; i < ALPHABET_LEN; i++) {
-        symtable_del(t->next[i]);
+    t->slots = slots;
+    t->mask = size-1;
+
+    for (i = 0; i < n; i++) {
+        if (old[i].key != NULL) {
+            *symtable_lookup(t, old[i].key, old[i].hash) = old[i];
+        }
     }
 
-    ndt_free(t);
+    if (old != t->inline_slots) {
+        ndt_free(old);
+    }
+
+    return 0;
 }
 
 int
@@ -249,57 +544,78 @@ symtable_add(symtable_t *t, const char *key, const symtable_entry_t entry,
                  ndt_context_t *ctx)
 {
     const unsigned char *cp;
-    int i;
+    symtable_slot_t *slot;
+    uint64_t hash;
 
-    for (cp = (const unsigned char *)key; *cp != '\0'; cp++) {
-        i = code[*cp];
-        if (i == UCHAR_MAX) {
-            ndt_err_format(ctx, NDT_ValueError,
-                           "invalid character in symbol: '%c'", *cp);
+    cp = invalid_char(key);
+    if (cp != NULL) {
+        ndt_err_format(ctx, NDT_ValueError,
+                       "invalid character in symbol: '%c'", *cp);
+        return -1;
+    }
+
+    hash = hash_data(key, strlen(key));
+
+    if (t->slots == NULL) {
+        if (symtable_lookup_inline(t, key, hash) != NULL) {
+            goto duplicate;
+        }
+        if (t->used < SYMTABLE_INLINE) {
+            slot = &t->inline_slots[t->used++];
+            slot->key = key;
+            slot->hash = hash;
+            slot->entry = entry;
+            return 0;
+        }
+        if (symtable_resize(t, SYMTABLE_MINSIZE, ctx) < 0) {
             return -1;
         }
+    }
 
-        if (t->next[i] == NULL) {
-            symtable_t *u = symtable_new(ctx);
-            if (u == NULL) {
-                return -1;
-            }
-            t->next[i] = u;
-            t = u;
+    slot = symtable_lookup(t, key, hash);
+    if (slot->key != NULL) {
+        goto duplicate;
+    }
+
+    if (2 * (t->used+1) > t->mask+1) {
+        if (t->mask+1 > SIZE_MAX / 2) {
+            ndt_err_format(ctx, NDT_MemoryError, "out of memory");
+            return -1;
         }
-        else {
-            t = t->next[i];
+        if (symtable_resize(t, 2 * (t->mask+1), ctx) < 0) {
+            return -1;
         }
+        slot = symtable_lookup(t, key, hash);
     }
 
-    if (t->entry.tag != Unbound) {
-        ndt_err_format(ctx, NDT_ValueError, "duplicate binding for '%s'", key);
-        return -1;
-    }
+    slot->key = key;
+    slot->hash = hash;
+    slot->entry = entry;
+    t->used++;
 
-    t->entry = entry;
     return 0;
+
+duplicate:
+    ndt_err_format(ctx, NDT_ValueError, "duplicate binding for '%s'", key);
+    return -1;
 }
 
 symtable_entry_t
 symtable_find(const symtable_t *t, const char *key)
 {
     symtable_entry_t unbound = { .tag=Unbound };
-    const unsigned char *cp;
-    int i;
+    const symtable_slot_t *slot;
+    uint64_t hash = hash_data(key, strlen(key));
 
-    for (cp = (const unsigned char *)key; *cp != '\0'; cp++) {
-        i = code[*cp];
-        if (i == UCHAR_MAX) {
-            return unbound; /* NOT REACHED */
-        }
+    if (t->slots == NULL) {
+        slot = symtable_lookup_inline(t, key, hash);
+        return slot ? slot->entry : unbound;
+    }
 
-        if (t->next[i] == NULL) {
-            return unbound;
-        }
-        t = t->next[i];
+    slot = symtable_lookup(t, key, hash);
+    if (slot->key == NULL) {
+        return unbound;
     }
 
-    return t->entry;
+    return slot->entry;
 }
-
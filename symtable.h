@@ -22,13 +22,30 @@ typedef struct {
   };
 } symtable_entry_t;
 
-typedef struct symtable {
+/* Number of bindings that are stored without allocating. */
+#define SYMTABLE_INLINE 8
+
+typedef struct {
+    const char *key;    /* NULL for an empty slot */
+    uint64_t hash;
     symtable_entry_t entry;
-    struct symtable *next[];
+} symtable_slot_t;
+
+/*
+ * Symbol table for ndt_match().  The table is usually on the stack: the
+ * first SYMTABLE_INLINE bindings are stored in 'inline_slots' and are
+ * searched linearly.  Beyond that, all bindings move to a heap allocated
+ * hash table.
+ */
+typedef struct symtable {
+    size_t used;
+    size_t mask;
+    symtable_slot_t *slots;     /* NULL while the bindings are inline */
+    symtable_slot_t inline_slots[SYMTABLE_INLINE];
 } symtable_t;
 
-symtable_t *symtable_new(ndt_context_t *ctx);
-void symtable_del(symtable_t *t);
+void symtable_init(symtable_t *t);
+void symtable_clear(symtable_t *t);
 int symtable_add(symtable_t *t, const char *key, const symtable_entry_t entry,
                  ndt_context_t *ctx);
 symtable_entry_t symtable_find(const symtable_t *t, const char *key);
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2016, Continuum Analytics, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * Redistributions of source code must retain the above copyright notice,
+ * 
+ * this list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef SYNC_H
+#define SYNC_H
+
+
+/*
+ * Minimal portability layer for the global tables and the worker pool: a
+ * mutex for writers, acquire/release accessors for pointers that readers
+ * load without taking the lock, condition variables, a counter that can be
+ * incremented concurrently, atomic reference count updates and thread local
+ * variables.
+ *
+ * A pointer that is published with ndt_atomic_store() must point to fully
+ * initialized memory, which readers may access after ndt_atomic_load().
+ */
+
+#if defined(_MSC_VER)
+  #include <windows.h>
+
+  typedef SRWLOCK ndt_mutex_t;
+  #define NDT_MUTEX_INIT SRWLOCK_INIT
+  #define ndt_mutex_lock(m) AcquireSRWLockExclusive(m)
+  #define ndt_mutex_unlock(m) ReleaseSRWLockExclusive(m)
+  #define ndt_mutex_init(m) InitializeSRWLock(m)
+  #define ndt_mutex_destroy(m) ((void)(m))
+
+  typedef CONDITION_VARIABLE ndt_cond_t;
+  #define ndt_cond_init(c) InitializeConditionVariable(c)
+  #define ndt_cond_destroy(c) ((void)(c))
+  #define ndt_cond_wait(c, m) (void)SleepConditionVariableSRW(c, m, INFINITE, 0)
+  #define ndt_cond_signal(c) WakeConditionVariable(c)
+  #define ndt_cond_broadcast(c) WakeAllConditionVariable(c)
+
+  /* The interlocked functions are full barriers. */
+  #define ndt_atomic_load(p) \
+      InterlockedCompareExchangePointer((PVOID volatile *)(p), NULL, NULL)
+  #define ndt_atomic_store(p, v) \
+      (void)InterlockedExchangePointer((PVOID volatile *)(p), (PVOID)(v))
+
+  /* Return the previous value of the size_t counter '*p'. */
+  #if defined(_WIN64)
+    #define ndt_atomic_fetch_add(p, v) \
+        (size_t)InterlockedExchangeAdd64((LONG64 volatile *)(p), (LONG64)(v))
+  #else
+    #define ndt_atomic_fetch_add(p, v) \
+        (size_t)InterlockedExchangeAdd((LONG volatile *)(p), (LONG)(v))
+  #endif
+
+  /* Reference counts (int64_t).  The decrement returns the new value. */
+  #define ndt_refcnt_inc(p) (void)InterlockedIncrement64((LONG64 volatile *)(p))
+  #define ndt_refcnt_dec(p) InterlockedDecrement64((LONG64 volatile *)(p))
+  #define ndt_refcnt_load(p) \
+      InterlockedCompareExchange64((LONG64 volatile *)(p), 0, 0)
+
+  #define NDT_THREAD_LOCAL __declspec(thread)
+#else
+  #include <pthread.h>
+
+  typedef pthread_mutex_t ndt_mutex_t;
+  #define NDT_MUTEX_INIT PTHREAD_MUTEX_INITIALIZER
+  #define ndt_mutex_lock(m) (void)pthread_mutex_lock(m)
+  #define ndt_mutex_unlock(m) (void)pthread_mutex_unlock(m)
+  #define ndt_mutex_init(m) (void)pthread_mutex_init(m, NULL)
+  #define ndt_mutex_destroy(m) (void)pthread_mutex_destroy(m)
+
+  typedef pthread_cond_t ndt_cond_t;
+  #define ndt_cond_init(c) (void)pthread_cond_init(c, NULL)
+  #define ndt_cond_destroy(c) (void)pthread_cond_destroy(c)
+  #define ndt_cond_wait(c, m) (void)pthread_cond_wait(c, m)
+  #define ndt_cond_signal(c) (void)pthread_cond_signal(c)
+  #define ndt_cond_broadcast(c) (void)pthread_cond_broadcast(c)
+
+  #define ndt_atomic_load(p) __atomic_load_n(p, __ATOMIC_ACQUIRE)
+  #define ndt_atomic_store(p, v) __atomic_store_n(p, v, __ATOMIC_RELEASE)
+
+  /* Return the previous value of the size_t counter '*p'. */
+  #define ndt_atomic_fetch_add(p, v) __atomic_fetch_add(p, v, __ATOMIC_RELAXED)
+
+  /* Reference counts (int64_t).  The decrement returns the new value and
+     orders all prior accesses before the deallocation of the last owner. */
+  #define ndt_refcnt_inc(p) (void)__atomic_fetch_add(p, 1, __ATOMIC_RELAXED)
+  #define ndt_refcnt_dec(p) __atomic_sub_fetch(p, 1, __ATOMIC_ACQ_REL)
+  #define ndt_refcnt_load(p) __atomic_load_n(p, __ATOMIC_RELAXED)
+
+  #define NDT_THREAD_LOCAL _Thread_local
+#endif
+
+
+#endif /* SYNC_H */
@@ -31,9 +31,17 @@
 #include <string.h>
 #include <assert.h>
 #include "ndtypes.h"
+#include "rdlexer.h"
 #include "test.h"
 #include "alloc_fail.h"
 
+#ifdef _WIN32
+  #include <windows.h>
+  #include <process.h>
+#else
+  #include <pthread.h>
+#endif
+
 
 static int
 init_tests(void)
@@ -273,14 +281,86 @@ test_parse_error(void)
 }
 
 static int
-test_indent(void)
+parse_compare(const char *input, ndt_context_t *ctx)
 {
-    const indent_testcase_t *tc;
+    ndt_t *t, *u;
+    enum ndt_error err;
+
+    ndt_err_clear(ctx);
+    ndt_set_parser(NDT_ParserBison);
+    t = ndt_from_string(input, ctx);
+    err = ctx->err;
+
+    ndt_err_clear(ctx);
+    ndt_set_parser(NDT_ParserDescent);
+    u = ndt_from_string(input, ctx);
+
+    ndt_set_parser(NDT_ParserBison);
+
+    if (t == NULL || u == NULL) {
+        ndt_del(t);
+        ndt_del(u);
+        if (t != u || err != ctx->err) {
+            fprintf(stderr, "test_parse_backends: FAIL: \"%s\": %s, %s\n",
+                    input, ndt_err_as_string(err), ndt_err_as_string(ctx->err));
+            return -1;
+        }
+        return 0;
+    }
+
+    if (!ndt_equal(t, u)) {
+        fprintf(stderr, "test_parse_backends: FAIL: different types for \"%s\"\n", input);
+        ndt_del(t);
+        ndt_del(u);
+        return -1;
+    }
+
+    ndt_del(t);
+    ndt_del(u);
+    return 0;
+}
+
+static int
+test_parse_backends(void)
+{
+    const char **tests[] = {parse_tests, parse_roundtrip_tests, parse_error_tests};
     const char **c;
     ndt_context_t *ctx;
-    ndt_t *t;
-    char *s;
-    int count = 0;
+    size_t i;
+    int ret = 0, count = 0;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    for (i = 0; i < sizeof tests / sizeof tests[0]; i++) {
+        for (c = tests[i]; *c != NULL; c++) {
+            if (parse_compare(*c, ctx) < 0) {
+                ret = -1;
+            }
+            count++;
+        }
+    }
+
+    if (ret == 0) {
+        fprintf(stderr, "test_parse_backends (%d test cases)\n", count);
+    }
+
+    ndt_context_del(ctx);
+    return ret;
+}
+
+static int
+test_from_buffer(void)
+{
+    const char **c;
+    ndt_context_t *ctx;
+    ndt_t *t, *u;
+    char *buf;
+    size_t len;
+    int ret = -1, count = 0;
 
     ctx = ndt_context_new();
     if (ctx == NULL) {
@@ -289,120 +369,218 @@ test_indent(void)
     }
 
     for (c = parse_tests; *c != NULL; c++) {
-        t = ndt_from_string(*c, ctx);
-        if (t == NULL) {
-            fprintf(stderr, "test_indent: parse: FAIL: expected success: \"%s\"\n", *c);
-            fprintf(stderr, "test_indent: parse: FAIL: got: %s: %s\n\n",
-                    ndt_err_as_string(ctx->err),
-                    ndt_context_msg(ctx));
-            ndt_context_del(ctx);
-            return -1;
+        /* The buffer has no terminating NUL. */
+        len = strlen(*c);
+        buf = ndt_alloc(1, len);
+        if (buf == NULL) {
+            fprintf(stderr, "test_from_buffer: FAIL: out of memory\n");
+            goto out;
         }
+        memcpy(buf, *c, len);
 
         for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
             ndt_err_clear(ctx);
 
             ndt_set_alloc_fail();
-            s = ndt_indent(t, ctx);
+            t = ndt_from_buffer(buf, len, ctx);
             ndt_set_alloc();
 
             if (ctx->err != NDT_MemoryError) {
                 break;
             }
 
-            if (s != NULL) {
-                ndt_free(s);
+            if (t != NULL) {
                 ndt_del(t);
-                ndt_context_del(ctx);
-                fprintf(stderr, "test_indent: convert: FAIL: s != NULL after MemoryError\n");
-                fprintf(stderr, "test_indent: convert: FAIL: %s\n", *c);
-                return -1;
+                ndt_free(buf);
+                fprintf(stderr, "test_from_buffer: FAIL: t != NULL after MemoryError\n");
+                goto out;
             }
         }
-        if (s == NULL) {
-            fprintf(stderr, "test_indent: convert: FAIL: expected success: \"%s\"\n", *c);
-            fprintf(stderr, "test_indent: convert: FAIL: got: %s: %s\n\n",
-                    ndt_err_as_string(ctx->err),
-                    ndt_context_msg(ctx));
+        ndt_free(buf);
+
+        if (t == NULL) {
+            fprintf(stderr, "test_from_buffer: FAIL: expected success: \"%s\"\n", *c);
+            goto out;
+        }
+
+        u = ndt_from_string(*c, ctx);
+        if (u == NULL || !ndt_equal(t, u)) {
+            fprintf(stderr, "test_from_buffer: FAIL: different result for \"%s\"\n", *c);
             ndt_del(t);
-            ndt_context_del(ctx);
-            return -1;
+            ndt_del(u);
+            goto out;
         }
 
-        ndt_free(s);
         ndt_del(t);
+        ndt_del(u);
         count++;
     }
 
-    for (tc = indent_tests; tc->input != NULL; tc++) {
-        t = ndt_from_string(tc->input, ctx);
-        if (t == NULL) {
-            fprintf(stderr, "test_indent: parse: FAIL: expected success: \"%s\"\n", tc->input);
-            fprintf(stderr, "test_indent: parse: FAIL: got: %s: %s\n\n",
-                    ndt_err_as_string(ctx->err),
-                    ndt_context_msg(ctx));
-            ndt_context_del(ctx);
-            return -1;
+    /* Only the first 'len' bytes are parsed. */
+    t = ndt_from_buffer("int64 * 10", 5, ctx);
+    if (t == NULL || t->tag != Int64) {
+        fprintf(stderr, "test_from_buffer: FAIL: buffer length ignored\n");
+        ndt_del(t);
+        goto out;
+    }
+    ndt_del(t);
+
+    /* An embedded NUL is not the end of the input. */
+    t = ndt_from_buffer("int64\0", 6, ctx);
+    if (t != NULL || ctx->err != NDT_ParseError) {
+        fprintf(stderr, "test_from_buffer: FAIL: expected ParseError for embedded NUL\n");
+        ndt_del(t);
+        goto out;
+    }
+
+    fprintf(stderr, "test_from_buffer (%d test cases)\n", count);
+    ret = 0;
+
+out:
+    ndt_context_del(ctx);
+    return ret;
+}
+
+static int
+test_from_file(void)
+{
+    const char *name = "ndt_test_from_file.tmp";
+    const char **c;
+    ndt_context_t *ctx;
+    FILE *fp;
+    ndt_t *t, *u;
+    int ret = -1, count = 0;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    for (c = parse_tests; *c != NULL; c++) {
+        fp = fopen(name, "wb");
+        if (fp == NULL || fputs(*c, fp) == EOF || fclose(fp) == EOF) {
+            fprintf(stderr, "test_from_file: FAIL: could not write %s\n", name);
+            goto out;
         }
 
         for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
             ndt_err_clear(ctx);
 
             ndt_set_alloc_fail();
-            s = ndt_indent(t, ctx);
+            t = ndt_from_file(name, ctx);
             ndt_set_alloc();
 
             if (ctx->err != NDT_MemoryError) {
                 break;
             }
 
-            if (s != NULL) {
-                ndt_free(s);
+            if (t != NULL) {
                 ndt_del(t);
-                ndt_context_del(ctx);
-                fprintf(stderr, "test_indent: convert: FAIL: s != NULL after MemoryError\n");
-                fprintf(stderr, "test_indent: convert: FAIL: %s\n", tc->input);
-                return -1;
+                fprintf(stderr, "test_from_file: FAIL: t != NULL after MemoryError\n");
+                goto out;
             }
         }
-        if (s == NULL) {
-            fprintf(stderr, "test_indent: convert: FAIL: expected success: \"%s\"\n", tc->input);
-            fprintf(stderr, "test_indent: convert: FAIL: got: %s: %s\n\n",
-                    ndt_err_as_string(ctx->err),
-                    ndt_context_msg(ctx));
-            ndt_del(t);
-            ndt_context_del(ctx);
-            return -1;
+
+        if (t == NULL) {
+            fprintf(stderr, "test_from_file: FAIL: expected success: \"%s\"\n", *c);
+            goto out;
         }
 
-        if (strcmp(s, tc->indented) != 0) {
-            fprintf(stderr, "test_indent: convert: FAIL: expected success: \"%s\"\n", tc->input);
-            fprintf(stderr, "test_indent: convert: FAIL: got: %s: %s\n\n",
-                    ndt_err_as_string(ctx->err),
-                    ndt_context_msg(ctx));
+        u = ndt_from_string(*c, ctx);
+        if (u == NULL || !ndt_equal(t, u)) {
+            fprintf(stderr, "test_from_file: FAIL: different result for \"%s\"\n", *c);
             ndt_del(t);
-            ndt_context_del(ctx);
-            return -1;
+            ndt_del(u);
+            goto out;
         }
 
-        ndt_free(s);
         ndt_del(t);
+        ndt_del(u);
         count++;
     }
 
-    fprintf(stderr, "test_indent (%d test cases)\n", count);
+    /* An empty file cannot be mapped and is read as a stream. */
+    fp = fopen(name, "wb");
+    if (fp == NULL || fclose(fp) == EOF) {
+        fprintf(stderr, "test_from_file: FAIL: could not write %s\n", name);
+        goto out;
+    }
+
+    ndt_err_clear(ctx);
+    t = ndt_from_file(name, ctx);
+    if (t != NULL || ctx->err != NDT_ParseError) {
+        fprintf(stderr, "test_from_file: FAIL: expected ParseError for empty file\n");
+        ndt_del(t);
+        goto out;
+    }
+
+    remove(name);
+    ndt_err_clear(ctx);
+    t = ndt_from_file(name, ctx);
+    if (t != NULL || ctx->err != NDT_OSError) {
+        fprintf(stderr, "test_from_file: FAIL: expected OSError for missing file\n");
+        ndt_del(t);
+        goto out;
+    }
 
+    fprintf(stderr, "test_from_file (%d test cases)\n", count);
+    ret = 0;
+
+out:
+    remove(name);
     ndt_context_del(ctx);
-    return 0;
+    return ret;
 }
 
 static int
-test_typedef(void)
+buffer_compare(const char *input, ndt_context_t *ctx)
 {
-    const char **c;
+    ndt_t *t, *u;
+    char *buf;
+    size_t len;
+    int ret = 0;
+
+    len = strlen(input);
+    buf = ndt_alloc(1, len);
+    if (buf == NULL) {
+        fprintf(stderr, "test_parse_long_tokens: FAIL: out of memory\n");
+        return -1;
+    }
+    memcpy(buf, input, len);
+
+    ndt_err_clear(ctx);
+    t = ndt_from_string(input, ctx);
+    ndt_err_clear(ctx);
+    u = ndt_from_buffer(buf, len, ctx);
+    ndt_err_clear(ctx);
+
+    if ((t == NULL) != (u == NULL) || (t != NULL && !ndt_equal(t, u))) {
+        fprintf(stderr, "test_parse_long_tokens: FAIL: different result for \"%s\"\n", input);
+        ret = -1;
+    }
+
+    ndt_del(t);
+    ndt_del(u);
+    ndt_free(buf);
+    return ret;
+}
+
+/* Tokens and blanks of all lengths around the vector widths of the lexer. */
+static int
+test_parse_long_tokens(void)
+{
+    static const char *templates[] = {
+      "{%s: int64}",
+      "%s",
+      "(%s)",
+      "int64%s",
+    };
     ndt_context_t *ctx;
-    ndt_t *t;
-    int count = 0;
+    char run[5][101];
+    char input[256];
+    size_t i, k, n;
+    int ret = 0, count = 0;
 
     ctx = ndt_context_new();
     if (ctx == NULL) {
@@ -410,53 +588,106 @@ test_typedef(void)
         return -1;
     }
 
-    for (c = typedef_tests; *c != NULL; c++) {
-        for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
-            ndt_err_clear(ctx);
+    for (n = 1; n <= 100; n++) {
+        for (i = 0; i < n; i++) {
+            run[0][i] = "aZ_9"[i % 4];   /* identifier */
+            run[1][i] = " \t\f "[i % 4]; /* blanks */
+            run[2][i] = "x# ;"[i % 4];   /* comment text */
+            run[3][i] = i == 0 ? '1' : '0'; /* integer */
+            run[4][i] = i == 0 ? 'a' : '$'; /* name followed by garbage */
+        }
+        for (k = 0; k < 5; k++) {
+            run[k][n] = '\0';
+        }
 
-            t = ndt_from_string("10 * 20 * {a : int64, b : pointer(float64)}", ctx);
+        for (i = 0; i < sizeof templates / sizeof templates[0]; i++) {
+            snprintf(input, sizeof input, templates[i], run[0]);
+            ret |= parse_compare(input, ctx) | buffer_compare(input, ctx);
+            snprintf(input, sizeof input, templates[i], run[4]);
+            ret |= parse_compare(input, ctx) | buffer_compare(input, ctx);
+            count += 2;
+        }
 
-            ndt_set_alloc_fail();
-            (void)ndt_typedef(*c, t, ctx);
-            ndt_set_alloc();
+        snprintf(input, sizeof input, "%sint64%s", run[1], run[1]);
+        ret |= parse_compare(input, ctx) | buffer_compare(input, ctx);
+        snprintf(input, sizeof input, "#%s\nint64 #%s", run[2], run[2]);
+        ret |= parse_compare(input, ctx) | buffer_compare(input, ctx);
+        snprintf(input, sizeof input, "%s * int64", run[3]);
+        ret |= parse_compare(input, ctx) | buffer_compare(input, ctx);
+        snprintf(input, sizeof input, "%s.5e%s", run[3], run[3]);
+        ret |= parse_compare(input, ctx) | buffer_compare(input, ctx);
+        count += 4;
+    }
 
-            if (ctx->err != NDT_MemoryError) {
-                break;
-            }
+    if (ret == 0) {
+        fprintf(stderr, "test_parse_long_tokens (%d test cases)\n", count);
+    }
 
-            if (ndt_typedef_find(*c, ctx) != NULL) {
-                fprintf(stderr, "test_typedef: FAIL: key in map after MemoryError\n");
-                fprintf(stderr, "test_typedef: FAIL: input: %s\n", *c);
-                ndt_context_del(ctx);
-                return -1;
-            }
-        }
+    ndt_context_del(ctx);
+    return ret;
+}
 
-        if (ndt_typedef_find(*c, ctx) == NULL) {
-            fprintf(stderr, "test_typedef: FAIL: key not found: \"%s\"\n", *c);
-            fprintf(stderr, "test_typedef: FAIL: lookup failed after %s: %s\n",
-                    ndt_err_as_string(ctx->err),
-                    ndt_context_msg(ctx));
-            ndt_context_del(ctx);
-            return -1;
+/* The keyword table of the recursive descent lexer matches lexer.l. */
+static int
+test_keywords(void)
+{
+    char line[1024], name[64], token[64];
+    rd_lexer_t lex;
+    rd_token_t tok;
+    FILE *fp;
+    int ret = -1, count = 0;
+
+    fp = fopen("lexer.l", "r");
+    if (fp == NULL) {
+        fprintf(stderr, "test_keywords: FAIL: could not open lexer.l\n");
+        return -1;
+    }
+
+    while (fgets(line, sizeof line, fp) != NULL) {
+        /* "name"   { return TOKEN; } */
+        if (sscanf(line, "\"%63[A-Za-z0-9_]\" { return %63[A-Z0-9_];",
+                   name, token) != 2) {
+            continue;
         }
 
+        rd_lexer_init(&lex, name, strlen(name));
+        rd_lex(&lex, &tok);
+        if (tok.len != strlen(name) || strcmp(rd_token_name(tok.tag), token) != 0) {
+            fprintf(stderr, "test_keywords: FAIL: \"%s\": expected %s, got %s\n",
+                    name, token, rd_token_name(tok.tag));
+            goto out;
+        }
         count++;
     }
 
-    fprintf(stderr, "test_typedef (%d test cases)\n", count);
+    /* Each keyword has its own token, so the sets are equal. */
+    if (count != TOK_VAR - TOK_ANY_KIND + 1) {
+        fprintf(stderr, "test_keywords: FAIL: %d keywords in lexer.l, %d in rdlexer.c\n",
+                count, TOK_VAR - TOK_ANY_KIND + 1);
+        goto out;
+    }
 
-    ndt_context_del(ctx);
-    return 0;
+    fprintf(stderr, "test_keywords (%d test cases)\n", count);
+    ret = 0;
+
+out:
+    fclose(fp);
+    return ret;
 }
 
 static int
-test_typedef_duplicates(void)
+test_parse_batch(void)
 {
-    const char **c;
+    const char **tests[] = {parse_tests, parse_error_tests};
+    const char **inputs = NULL;
     ndt_context_t *ctx;
+    ndt_context_t *errors = NULL;
+    ndt_pool_t *pool = NULL;
+    ndt_t **types = NULL;
     ndt_t *t;
-    int count = 0;
+    const char **c;
+    size_t n = 0, nfail, expected, i, k;
+    int ret = -1;
 
     ctx = ndt_context_new();
     if (ctx == NULL) {
@@ -464,51 +695,95 @@ test_typedef_duplicates(void)
         return -1;
     }
 
-    for (c = typedef_tests; *c != NULL; c++) {
-        for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
-            ndt_err_clear(ctx);
+    for (i = 0; i < sizeof tests / sizeof tests[0]; i++) {
+        for (c = tests[i]; *c != NULL; c++) {
+            n++;
+        }
+    }
 
-            t = ndt_from_string("10 * 20 * {a : int64, b : pointer[float64]}", ctx);
+    inputs = ndt_alloc(n, sizeof *inputs);
+    types = ndt_alloc(n, sizeof *types);
+    errors = ndt_alloc(n, sizeof *errors);
+    pool = ndt_pool_new(4, ctx);
+    if (inputs == NULL || types == NULL || errors == NULL || pool == NULL) {
+        fprintf(stderr, "test_parse_batch: FAIL: could not allocate\n");
+        goto out;
+    }
+    for (i = 0; i < n; i++) {
+        types[i] = NULL;
+    }
 
-            ndt_set_alloc_fail();
-            (void)ndt_typedef(*c, t, ctx);
-            ndt_set_alloc();
+    n = 0;
+    for (i = 0; i < sizeof tests / sizeof tests[0]; i++) {
+        for (c = tests[i]; *c != NULL; c++) {
+            inputs[n++] = *c;
+        }
+    }
 
-            if (ctx->err != NDT_MemoryError) {
-                break;
+    for (k = 0; k < 3; k++) {
+        nfail = ndt_from_string_batch(types, k == 2 ? NULL : errors, inputs, n,
+                                      k == 0 ? NULL : pool);
+
+        expected = 0;
+        for (i = 0; i < n; i++) {
+            ndt_err_clear(ctx);
+            t = ndt_from_string(inputs[i], ctx);
+            if (t == NULL) {
+                expected++;
             }
 
-            if (ndt_typedef_find(*c, ctx) == NULL) {
-                fprintf(stderr, "test_typedef: FAIL: key should be in map\n");
-                fprintf(stderr, "test_typedef: FAIL: input: %s\n", *c);
-                ndt_context_del(ctx);
-                return -1;
+            if ((t == NULL) != (types[i] == NULL) ||
+                (t != NULL && !ndt_equal(t, types[i])) ||
+                (k != 2 && (errors[i].err != ctx->err ||
+                            strcmp(ndt_context_msg(&errors[i]), ndt_context_msg(ctx)) != 0))) {
+                fprintf(stderr, "test_parse_batch: FAIL: different result for \"%s\"\n",
+                        inputs[i]);
+                ndt_del(t);
+                goto out;
             }
-        }
 
-        if (ctx->err != NDT_ValueError) {
-            fprintf(stderr, "test_typedef: FAIL: no value error after duplicate key\n");
-            fprintf(stderr, "test_typedef: FAIL: input: %s\n", *c);
-            ndt_context_del(ctx);
-            return -1;
+            ndt_del(t);
+            ndt_del(types[i]);
+            types[i] = NULL;
+            if (k != 2) {
+                ndt_err_clear(&errors[i]);
+            }
         }
 
-        count++;
+        if (nfail != expected) {
+            fprintf(stderr, "test_parse_batch: FAIL: expected %zu failures, got %zu\n",
+                    expected, nfail);
+            goto out;
+        }
     }
 
-    fprintf(stderr, "test_typedef_duplicates (%d test cases)\n", count);
+    fprintf(stderr, "test_parse_batch (%zu test cases)\n", n);
+    ret = 0;
 
+out:
+    if (types != NULL && errors != NULL && inputs != NULL && pool != NULL) {
+        for (i = 0; i < n; i++) {
+            ndt_del(types[i]);
+        }
+    }
+    ndt_free(types);
+    ndt_free(errors);
+    ndt_free(inputs);
+    ndt_pool_del(pool);
     ndt_context_del(ctx);
-    return 0;
+    return ret;
 }
 
 static int
-test_typedef_error(void)
+test_parse_cache(void)
 {
     const char **c;
     ndt_context_t *ctx;
-    ndt_t *t;
-    int count = 0;
+    ndt_parse_cache_t *cache;
+    ndt_cache_stats_t stats;
+    ndt_t *t, *u;
+    size_t n = 0;
+    int i, count = 0;
 
     ctx = ndt_context_new();
     if (ctx == NULL) {
@@ -516,53 +791,2170 @@ test_typedef_error(void)
         return -1;
     }
 
-    for (c = typedef_error_tests; *c != NULL; c++) {
-        for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
-            ndt_err_clear(ctx);
+    for (c = parse_roundtrip_tests; *c != NULL; c++) {
+        n++;
+    }
 
-            t = ndt_from_string("10 * 20 * {a : int64, b : pointer[float64]}", ctx);
+    /* Cache large enough for all inputs: the second pass only has hits. */
+    cache = ndt_parse_cache_new(n, ctx);
+    if (cache == NULL) {
+        fprintf(stderr, "test_parse_cache: FAIL: could not create cache\n");
+        ndt_context_del(ctx);
+        return -1;
+    }
+
+    for (i = 0; i < 2; i++) {
+        for (c = parse_roundtrip_tests; *c != NULL; c++) {
+            for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+                ndt_err_clear(ctx);
+
+                ndt_set_alloc_fail();
+                t = ndt_from_string_cached(cache, *c, ctx);
+                ndt_set_alloc();
+
+                if (ctx->err != NDT_MemoryError) {
+                    break;
+                }
+
+                if (t != NULL) {
+                    ndt_parse_cache_del(cache);
+                    ndt_context_del(ctx);
+                    fprintf(stderr, "test_parse_cache: FAIL: t != NULL after MemoryError\n");
+                    fprintf(stderr, "test_parse_cache: FAIL: input: %s\n", *c);
+                    return -1;
+                }
+            }
+            if (t == NULL) {
+                ndt_parse_cache_del(cache);
+                ndt_context_del(ctx);
+                fprintf(stderr, "test_parse_cache: FAIL: could not parse \"%s\"\n", *c);
+                return -1;
+            }
+
+            u = ndt_from_string(*c, ctx);
+            if (u == NULL) {
+                ndt_del(t);
+                ndt_parse_cache_del(cache);
+                ndt_context_del(ctx);
+                fprintf(stderr, "test_parse_cache: FAIL: could not parse \"%s\"\n", *c);
+                return -1;
+            }
+
+            if (!ndt_equal(t, u)) {
+                ndt_del(t);
+                ndt_del(u);
+                ndt_parse_cache_del(cache);
+                ndt_context_del(ctx);
+                fprintf(stderr, "test_parse_cache: FAIL: cached result differs: \"%s\"\n", *c);
+                return -1;
+            }
+
+            ndt_del(t);
+            ndt_del(u);
+            count++;
+        }
+
+        ndt_parse_cache_stats(cache, &stats);
+        if (i == 1 && (stats.hits < n || stats.evictions != 0)) {
+            ndt_parse_cache_del(cache);
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_parse_cache: FAIL: unexpected misses or evictions\n");
+            return -1;
+        }
+    }
+
+    ndt_parse_cache_del(cache);
+
+    /* Small cache: the CLOCK hand must evict. */
+    cache = ndt_parse_cache_new(4, ctx);
+    if (cache == NULL) {
+        fprintf(stderr, "test_parse_cache: FAIL: could not create cache\n");
+        ndt_context_del(ctx);
+        return -1;
+    }
+
+    for (c = parse_roundtrip_tests; *c != NULL; c++) {
+        t = ndt_from_string_cached(cache, *c, ctx);
+        if (t == NULL) {
+            ndt_parse_cache_del(cache);
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_parse_cache: FAIL: could not parse \"%s\"\n", *c);
+            return -1;
+        }
+        ndt_del(t);
+        count++;
+    }
+
+    ndt_parse_cache_stats(cache, &stats);
+    if (stats.hits + stats.misses != n || stats.evictions != stats.misses-4) {
+        ndt_parse_cache_del(cache);
+        ndt_context_del(ctx);
+        fprintf(stderr, "test_parse_cache: FAIL: unexpected cache statistics\n");
+        return -1;
+    }
+
+    ndt_parse_cache_del(cache);
+    fprintf(stderr, "test_parse_cache (%d test cases)\n", count);
+
+    ndt_context_del(ctx);
+    return 0;
+}
+
+/*
+ * Parse the roundtrip and error tests from several threads at once.  Each
+ * thread uses its own context, the scanners must not share any state.
+ */
+#define PARSE_THREADS 8
+#define PARSE_ROUNDS 2
+
+typedef struct {
+    int id;
+    int count;
+    int result;
+} parse_worker_t;
+
+static int
+parse_worker_run(parse_worker_t *w)
+{
+    const char **c;
+    ndt_context_t *ctx;
+    const ndt_t *u;
+    ndt_t *t;
+    char *s;
+    int i;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    for (i = 0; i < PARSE_ROUNDS; i++) {
+        for (c = parse_roundtrip_tests; *c != NULL; c++) {
+            t = ndt_from_string(*c, ctx);
+            if (t == NULL) {
+                fprintf(stderr, "test_parse_concurrent: FAIL: thread %d: could not parse \"%s\"\n",
+                        w->id, *c);
+                ndt_context_del(ctx);
+                return -1;
+            }
+
+            /* All threads intern the same types. */
+            u = ndt_intern(t, ctx);
+            if (u == NULL) {
+                fprintf(stderr, "test_parse_concurrent: FAIL: thread %d: could not intern \"%s\"\n",
+                        w->id, *c);
+                ndt_context_del(ctx);
+                return -1;
+            }
+
+            s = ndt_as_string((ndt_t *)u, ctx);
+            if (s == NULL || strcmp(s, *c) != 0) {
+                fprintf(stderr, "test_parse_concurrent: FAIL: thread %d: input: \"%s\"\n",
+                        w->id, *c);
+                ndt_free(s);
+                ndt_context_del(ctx);
+                return -1;
+            }
+            ndt_free(s);
+            w->count++;
+        }
+
+        for (c = parse_error_tests; *c != NULL; c++) {
+            ndt_err_clear(ctx);
+            t = ndt_from_string(*c, ctx);
+            if (t != NULL || ctx->err == NDT_Success) {
+                fprintf(stderr, "test_parse_concurrent: FAIL: thread %d: unexpected success: \"%s\"\n",
+                        w->id, *c);
+                ndt_del(t);
+                ndt_context_del(ctx);
+                return -1;
+            }
+            w->count++;
+        }
+        ndt_err_clear(ctx);
+    }
+
+    ndt_context_del(ctx);
+    return 0;
+}
+
+#ifdef _WIN32
+static unsigned __stdcall
+parse_worker(void *arg)
+{
+    parse_worker_t *w = arg;
+    w->result = parse_worker_run(w);
+    return 0;
+}
+#else
+static void *
+parse_worker(void *arg)
+{
+    parse_worker_t *w = arg;
+    w->result = parse_worker_run(w);
+    return NULL;
+}
+#endif
+
+static int
+test_parse_concurrent(void)
+{
+    parse_worker_t workers[PARSE_THREADS];
+#ifdef _WIN32
+    HANDLE tid[PARSE_THREADS];
+#else
+    pthread_t tid[PARSE_THREADS];
+#endif
+    int count = 0;
+    int ret = 0;
+    int i, n;
+
+    for (n = 0; n < PARSE_THREADS; n++) {
+        workers[n].id = n;
+        workers[n].count = 0;
+        workers[n].result = 0;
+#ifdef _WIN32
+        tid[n] = (HANDLE)_beginthreadex(NULL, 0, parse_worker, &workers[n], 0, NULL);
+        if (tid[n] == 0) {
+#else
+        if (pthread_create(&tid[n], NULL, parse_worker, &workers[n]) != 0) {
+#endif
+            fprintf(stderr, "test_parse_concurrent: FAIL: could not start thread\n");
+            ret = -1;
+            break;
+        }
+    }
+
+    for (i = 0; i < n; i++) {
+#ifdef _WIN32
+        WaitForSingleObject(tid[i], INFINITE);
+        CloseHandle(tid[i]);
+#else
+        pthread_join(tid[i], NULL);
+#endif
+        if (workers[i].result < 0) {
+            ret = -1;
+        }
+        count += workers[i].count;
+    }
+
+    if (ret == 0) {
+        fprintf(stderr, "test_parse_concurrent (%d test cases)\n", count);
+    }
+
+    return ret;
+}
+
+static int
+test_indent(void)
+{
+    const indent_testcase_t *tc;
+    const char **c;
+    ndt_context_t *ctx;
+    ndt_t *t;
+    char *s;
+    int count = 0;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    for (c = parse_tests; *c != NULL; c++) {
+        t = ndt_from_string(*c, ctx);
+        if (t == NULL) {
+            fprintf(stderr, "test_indent: parse: FAIL: expected success: \"%s\"\n", *c);
+            fprintf(stderr, "test_indent: parse: FAIL: got: %s: %s\n\n",
+                    ndt_err_as_string(ctx->err),
+                    ndt_context_msg(ctx));
+            ndt_context_del(ctx);
+            return -1;
+        }
+
+        for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+            ndt_err_clear(ctx);
+
+            ndt_set_alloc_fail();
+            s = ndt_indent(t, ctx);
+            ndt_set_alloc();
+
+            if (ctx->err != NDT_MemoryError) {
+                break;
+            }
+
+            if (s != NULL) {
+                ndt_free(s);
+                ndt_del(t);
+                ndt_context_del(ctx);
+                fprintf(stderr, "test_indent: convert: FAIL: s != NULL after MemoryError\n");
+                fprintf(stderr, "test_indent: convert: FAIL: %s\n", *c);
+                return -1;
+            }
+        }
+        if (s == NULL) {
+            fprintf(stderr, "test_indent: convert: FAIL: expected success: \"%s\"\n", *c);
+            fprintf(stderr, "test_indent: convert: FAIL: got: %s: %s\n\n",
+                    ndt_err_as_string(ctx->err),
+                    ndt_context_msg(ctx));
+            ndt_del(t);
+            ndt_context_del(ctx);
+            return -1;
+        }
+
+        ndt_free(s);
+        ndt_del(t);
+        count++;
+    }
+
+    for (tc = indent_tests; tc->input != NULL; tc++) {
+        t = ndt_from_string(tc->input, ctx);
+        if (t == NULL) {
+            fprintf(stderr, "test_indent: parse: FAIL: expected success: \"%s\"\n", tc->input);
+            fprintf(stderr, "test_indent: parse: FAIL: got: %s: %s\n\n",
+                    ndt_err_as_string(ctx->err),
+                    ndt_context_msg(ctx));
+            ndt_context_del(ctx);
+            return -1;
+        }
+
+        for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+            ndt_err_clear(ctx);
+
+            ndt_set_alloc_fail();
+            s = ndt_indent(t, ctx);
+            ndt_set_alloc();
+
+            if (ctx->err != NDT_MemoryError) {
+                break;
+            }
+
+            if (s != NULL) {
+                ndt_free(s);
+                ndt_del(t);
+                ndt_context_del(ctx);
+                fprintf(stderr, "test_indent: convert: FAIL: s != NULL after MemoryError\n");
+                fprintf(stderr, "test_indent: convert: FAIL: %s\n", tc->input);
+                return -1;
+            }
+        }
+        if (s == NULL) {
+            fprintf(stderr, "test_indent: convert: FAIL: expected success: \"%s\"\n", tc->input);
+            fprintf(stderr, "test_indent: convert: FAIL: got: %s: %s\n\n",
+                    ndt_err_as_string(ctx->err),
+                    ndt_context_msg(ctx));
+            ndt_del(t);
+            ndt_context_del(ctx);
+            return -1;
+        }
+
+        if (strcmp(s, tc->indented) != 0) {
+            fprintf(stderr, "test_indent: convert: FAIL: expected success: \"%s\"\n", tc->input);
+            fprintf(stderr, "test_indent: convert: FAIL: got: %s: %s\n\n",
+                    ndt_err_as_string(ctx->err),
+                    ndt_context_msg(ctx));
+            ndt_del(t);
+            ndt_context_del(ctx);
+            return -1;
+        }
+
+        ndt_free(s);
+        ndt_del(t);
+        count++;
+    }
+
+    fprintf(stderr, "test_indent (%d test cases)\n", count);
+
+    ndt_context_del(ctx);
+    return 0;
+}
+
+static int
+test_typedef(void)
+{
+    const char **c;
+    ndt_context_t *ctx;
+    ndt_t *t;
+    int count = 0;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    for (c = typedef_tests; *c != NULL; c++) {
+        for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+            ndt_err_clear(ctx);
+
+            t = ndt_from_string("10 * 20 * {a : int64, b : pointer(float64)}", ctx);
+
+            ndt_set_alloc_fail();
+            (void)ndt_typedef(*c, t, ctx);
+            ndt_set_alloc();
+
+            if (ctx->err != NDT_MemoryError) {
+                break;
+            }
+
+            if (ndt_typedef_find(*c, ctx) != NULL) {
+                fprintf(stderr, "test_typedef: FAIL: key in map after MemoryError\n");
+                fprintf(stderr, "test_typedef: FAIL: input: %s\n", *c);
+                ndt_context_del(ctx);
+                return -1;
+            }
+        }
+
+        if (ndt_typedef_find(*c, ctx) == NULL) {
+            fprintf(stderr, "test_typedef: FAIL: key not found: \"%s\"\n", *c);
+            fprintf(stderr, "test_typedef: FAIL: lookup failed after %s: %s\n",
+                    ndt_err_as_string(ctx->err),
+                    ndt_context_msg(ctx));
+            ndt_context_del(ctx);
+            return -1;
+        }
+
+        count++;
+    }
+
+    fprintf(stderr, "test_typedef (%d test cases)\n", count);
+
+    ndt_context_del(ctx);
+    return 0;
+}
+
+static int
+test_typedef_duplicates(void)
+{
+    const char *keys[3] = { "dup_batch_a", "dup_batch_b", "dup_batch_a" };
+    const ndt_t *values[3];
+    const char **c;
+    ndt_context_t *ctx;
+    ndt_t *t, *v[3];
+    int count = 0;
+    int i, ret;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    for (c = typedef_tests; *c != NULL; c++) {
+        for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+            ndt_err_clear(ctx);
+
+            t = ndt_from_string("10 * 20 * {a : int64, b : pointer[float64]}", ctx);
+
+            ndt_set_alloc_fail();
+            (void)ndt_typedef(*c, t, ctx);
+            ndt_set_alloc();
+
+            if (ctx->err != NDT_MemoryError) {
+                break;
+            }
+
+            if (ndt_typedef_find(*c, ctx) == NULL) {
+                fprintf(stderr, "test_typedef: FAIL: key should be in map\n");
+                fprintf(stderr, "test_typedef: FAIL: input: %s\n", *c);
+                ndt_context_del(ctx);
+                return -1;
+            }
+        }
+
+        if (ctx->err != NDT_ValueError) {
+            fprintf(stderr, "test_typedef: FAIL: no value error after duplicate key\n");
+            fprintf(stderr, "test_typedef: FAIL: input: %s\n", *c);
+            ndt_context_del(ctx);
+            return -1;
+        }
+
+        count++;
+    }
+
+    /* A batch with a duplicate key leaves the map unchanged. */
+    ndt_err_clear(ctx);
+    for (i = 0; i < 3; i++) {
+        v[i] = ndt_from_string("int64", ctx);
+        values[i] = v[i];
+    }
+
+    ret = ndt_typedef_add_all(keys, values, 3, ctx);
+    for (i = 0; i < 3; i++) {
+        ndt_del(v[i]);
+    }
+
+    if (ret != -1 || ctx->err != NDT_ValueError) {
+        fprintf(stderr, "test_typedef: FAIL: no value error after duplicate key in batch\n");
+        ndt_context_del(ctx);
+        return -1;
+    }
+
+    ndt_err_clear(ctx);
+    if (ndt_typedef_find("dup_batch_b", ctx) != NULL) {
+        fprintf(stderr, "test_typedef: FAIL: map changed after error\n");
+        ndt_context_del(ctx);
+        return -1;
+    }
+    ndt_err_clear(ctx);
+
+    fprintf(stderr, "test_typedef_duplicates (%d test cases)\n", count);
+
+    ndt_context_del(ctx);
+    return 0;
+}
+
+static int
+test_typedef_error(void)
+{
+    const char **c;
+    ndt_context_t *ctx;
+    ndt_t *t;
+    int count = 0;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    for (c = typedef_error_tests; *c != NULL; c++) {
+        for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+            ndt_err_clear(ctx);
+
+            t = ndt_from_string("10 * 20 * {a : int64, b : pointer[float64]}", ctx);
+
+            ndt_set_alloc_fail();
+            (void)ndt_typedef(*c, t, ctx);
+            ndt_set_alloc();
+
+            if (ctx->err != NDT_MemoryError) {
+                break;
+            }
+
+            if (ndt_typedef_find(*c, ctx) != NULL) {
+                fprintf(stderr, "test_typedef_error: FAIL: key in map after MemoryError\n");
+                fprintf(stderr, "test_typedef: FAIL: input: %s\n", *c);
+                ndt_context_del(ctx);
+                return -1;
+            }
+        }
+
+        if (ndt_typedef_find(*c, ctx) != NULL) {
+            fprintf(stderr, "test_typedef_error: FAIL: unexpected success: \"%s\"\n", *c);
+            fprintf(stderr, "test_typedef_error: FAIL: key in map after %s: %s\n",
+                    ndt_err_as_string(ctx->err),
+                    ndt_context_msg(ctx));
+            ndt_context_del(ctx);
+            return -1;
+        }
+
+        count++;
+    }
+
+    fprintf(stderr, "test_typedef_error (%d test cases)\n", count);
+
+    ndt_context_del(ctx);
+    return 0;
+}
+
+static int
+test_module(void)
+{
+    const char *name = "ndt_test_module.tmp";
+    const module_testcase_t *t;
+    ndt_context_t *ctx;
+    const ndt_t *u;
+    ndt_t *v;
+    FILE *fp;
+    int ret = -1, count = 0;
+    int r = -1;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    for (t = module_tests; t->module != NULL; t++) {
+        for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+            ndt_err_clear(ctx);
+
+            ndt_set_alloc_fail();
+            r = ndt_module_from_string(t->module, ctx);
+            ndt_set_alloc();
+
+            if (ctx->err != NDT_MemoryError) {
+                break;
+            }
+
+            if (r != -1 || (t->name != NULL && ndt_typedef_find(t->name, ctx) != NULL)) {
+                fprintf(stderr, "test_module: FAIL: typedef registered after MemoryError\n");
+                fprintf(stderr, "test_module: FAIL: input: %s\n", t->module);
+                goto out;
+            }
+        }
+
+        if (ctx->err != t->err || (r == 0) != (t->err == NDT_Success)) {
+            fprintf(stderr, "test_module: FAIL: expected %s, got %s: \"%s\"\n",
+                    ndt_err_as_string(t->err), ndt_err_as_string(ctx->err), t->module);
+            goto out;
+        }
+
+        if (t->name != NULL) {
+            ndt_err_clear(ctx);
+            u = ndt_typedef_find(t->name, ctx);
+            if (t->expected == NULL) {
+                if (u != NULL) {
+                    fprintf(stderr, "test_module: FAIL: typedef registered after error: \"%s\"\n",
+                            t->module);
+                    goto out;
+                }
+            }
+            else {
+                v = ndt_from_string(t->expected, ctx);
+                if (u == NULL || v == NULL || !ndt_equal(u, v)) {
+                    fprintf(stderr, "test_module: FAIL: wrong type for %s: \"%s\"\n",
+                            t->name, t->module);
+                    ndt_del(v);
+                    goto out;
+                }
+                ndt_del(v);
+            }
+        }
+
+        count++;
+    }
+
+    fp = fopen(name, "wb");
+    if (fp == NULL ||
+        fputs("typedef mf_b = 2 * mf_a\ntypedef mf_a = int32\n", fp) == EOF ||
+        fclose(fp) == EOF) {
+        fprintf(stderr, "test_module: FAIL: could not write %s\n", name);
+        goto out;
+    }
+
+    ndt_err_clear(ctx);
+    if (ndt_module_from_file(name, ctx) < 0 || ndt_typedef_find("mf_b", ctx) == NULL) {
+        fprintf(stderr, "test_module: FAIL: could not load %s\n", name);
+        goto out;
+    }
+    count++;
+
+    fprintf(stderr, "test_module (%d test cases)\n", count);
+    ret = 0;
+
+out:
+    remove(name);
+    ndt_err_clear(ctx);
+    ndt_context_del(ctx);
+    return ret;
+}
+
+static int
+test_equal(void)
+{
+    const char **c;
+    ndt_context_t *ctx;
+    ndt_t *t, *u;
+    int count = 0;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    for (c = parse_roundtrip_tests; *c && *(c+1); c++) {
+        ndt_err_clear(ctx);
+
+        t = ndt_from_string(*c, ctx);
+        if (t == NULL) {
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_equal: FAIL: could not parse \"%s\"\n", *c);
+            return -1;
+        }
+
+        u = ndt_from_string(*(c+1), ctx);
+        if (u == NULL) {
+            ndt_del(t);
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_equal: FAIL: could not parse \"%s\"\n", *(c+1));
+            return -1;
+        }
+
+        if (!ndt_equal(t, t)) {
+            ndt_del(t);
+            ndt_del(u);
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_equal: FAIL: \"%s\" != \"%s\"\n", *c, *c);
+            return -1;
+        }
+
+        if (ndt_equal(t, u)) {
+            ndt_del(t);
+            ndt_del(u);
+            fprintf(stderr, "test_equal: FAIL: \"%s\" == \"%s\"\n", *c, *(c+1));
+            return -1;
+        }
+
+        ndt_del(t);
+        ndt_del(u);
+        count++;
+    }
+
+    fprintf(stderr, "test_equal (%d test cases)\n", count);
+
+    ndt_context_del(ctx);
+    return 0;
+}
+
+static int
+test_hash(void)
+{
+    const match_testcase_t *m;
+    const char **c;
+    ndt_context_t *ctx;
+    ndt_t *t, *u, *v, *w;
+    char *s, *buf;
+    size_t len;
+    int count = 0;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    /* Copies of a type have the same hash. */
+    for (c = parse_roundtrip_tests; *c != NULL; c++) {
+        t = ndt_from_string(*c, ctx);
+        if (t == NULL) {
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_hash: FAIL: could not parse \"%s\"\n", *c);
+            return -1;
+        }
+
+        s = ndt_as_string(t, ctx);
+        u = s == NULL ? NULL : ndt_from_string(s, ctx);
+        ndt_free(s);
+        v = ndt_arena_copy(t, ctx);
+        buf = ndt_serialize(t, &len, ctx);
+        w = buf == NULL ? NULL : ndt_deserialize(buf, len, ctx);
+        ndt_free(buf);
+        if (buf == NULL && strstr(ndt_context_msg(ctx), "size overflow")) {
+            /* not serializable */
+            ndt_err_clear(ctx);
+            w = ndt_incref(t);
+        }
+
+        if (u == NULL || v == NULL || w == NULL) {
+            ndt_del(t);
+            ndt_del(u);
+            ndt_del(v);
+            ndt_del(w);
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_hash: FAIL: could not copy \"%s\"\n", *c);
+            return -1;
+        }
+
+        if (ndt_hash(u) != ndt_hash(t) || ndt_hash(v) != ndt_hash(t) ||
+            ndt_hash(w) != ndt_hash(t)) {
+            ndt_del(t);
+            ndt_del(u);
+            ndt_del(v);
+            ndt_del(w);
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_hash: FAIL: hash of copy differs: \"%s\"\n", *c);
+            return -1;
+        }
+
+        ndt_del(t);
+        ndt_del(u);
+        ndt_del(v);
+        ndt_del(w);
+        count++;
+    }
+
+    /* Equal types have the same hash. */
+    for (m = match_tests; m->pattern != NULL; m++) {
+        t = ndt_from_string(m->pattern, ctx);
+        u = ndt_from_string(m->candidate, ctx);
+        if (t == NULL || u == NULL) {
+            ndt_del(t);
+            ndt_del(u);
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_hash: FAIL: could not parse \"%s\"\n", m->pattern);
+            return -1;
+        }
+
+        if (ndt_equal(t, u) && ndt_hash(t) != ndt_hash(u)) {
+            ndt_del(t);
+            ndt_del(u);
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_hash: FAIL: equal types, different hashes: \"%s\"\n",
+                    m->pattern);
+            return -1;
+        }
+
+        ndt_del(t);
+        ndt_del(u);
+        count++;
+    }
+
+    fprintf(stderr, "test_hash (%d test cases)\n", count);
+
+    ndt_context_del(ctx);
+    return 0;
+}
+
+static int
+test_intern(void)
+{
+    const char **c;
+    ndt_context_t *ctx;
+    const ndt_t *t, *u, *v;
+    ndt_t *w;
+    int count = 0;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    for (c = parse_roundtrip_tests; *c && *(c+1); c++) {
+        ndt_err_clear(ctx);
+
+        w = ndt_from_string(*c, ctx);
+        if (w == NULL) {
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_intern: FAIL: could not parse \"%s\"\n", *c);
+            return -1;
+        }
+
+        t = ndt_intern(w, ctx);
+        if (t == NULL) {
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_intern: FAIL: could not intern \"%s\"\n", *c);
+            return -1;
+        }
+
+        for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+            ndt_err_clear(ctx);
+
+            w = ndt_from_string(*(c+1), ctx);
+            if (w == NULL) {
+                ndt_context_del(ctx);
+                fprintf(stderr, "test_intern: FAIL: could not parse \"%s\"\n", *(c+1));
+                return -1;
+            }
+
+            ndt_set_alloc_fail();
+            u = ndt_intern(w, ctx);
+            ndt_set_alloc();
+
+            if (ctx->err != NDT_MemoryError) {
+                break;
+            }
+
+            if (u != NULL) {
+                ndt_context_del(ctx);
+                fprintf(stderr, "test_intern: FAIL: u != NULL after MemoryError\n");
+                fprintf(stderr, "test_intern: FAIL: input: %s\n", *(c+1));
+                return -1;
+            }
+        }
+        if (u == NULL) {
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_intern: FAIL: could not intern \"%s\"\n", *(c+1));
+            return -1;
+        }
+
+        w = ndt_from_string(*c, ctx);
+        if (w == NULL) {
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_intern: FAIL: could not parse \"%s\"\n", *c);
+            return -1;
+        }
+
+        v = ndt_intern(w, ctx);
+        if (v == NULL) {
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_intern: FAIL: could not intern \"%s\"\n", *c);
+            return -1;
+        }
+
+        if (t != v || !ndt_equal(t, v)) {
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_intern: FAIL: \"%s\" not unique\n", *c);
+            return -1;
+        }
+
+        if (t == u || ndt_equal(t, u)) {
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_intern: FAIL: \"%s\" == \"%s\"\n", *c, *(c+1));
+            return -1;
+        }
+
+        /* Interning an interned type consumes the reference. */
+        w = ndt_incref(t);
+        v = ndt_intern(w, ctx);
+        if (v != t || t->refcnt != 1) {
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_intern: FAIL: reference not consumed: \"%s\"\n", *c);
+            return -1;
+        }
+
+        count++;
+    }
+
+    fprintf(stderr, "test_intern (%d test cases)\n", count);
+
+    ndt_context_del(ctx);
+    return 0;
+}
+
+static int
+test_refcount(void)
+{
+    const char **c;
+    ndt_context_t *ctx;
+    ndt_tuple_field_t *fields;
+    ndt_t *t, *u, *v;
+    int count = 0;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    for (c = parse_roundtrip_tests; *c != NULL; c++) {
+        t = ndt_from_string(*c, ctx);
+        if (t == NULL) {
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_refcount: FAIL: could not parse \"%s\"\n", *c);
+            return -1;
+        }
+
+        /* pointer(t): the constructor steals the new reference */
+        for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+            ndt_err_clear(ctx);
+
+            ndt_set_alloc_fail();
+            u = ndt_pointer(ndt_incref(t), ctx);
+            ndt_set_alloc();
+
+            if (ctx->err != NDT_MemoryError) {
+                break;
+            }
+
+            if (u != NULL || t->refcnt != 1) {
+                ndt_del(t);
+                ndt_context_del(ctx);
+                fprintf(stderr, "test_refcount: FAIL: invalid state after MemoryError\n");
+                fprintf(stderr, "test_refcount: FAIL: input: %s\n", *c);
+                return -1;
+            }
+        }
+        if (u == NULL) {
+            ndt_del(t);
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_refcount: FAIL: could not create pointer type\n");
+            return -1;
+        }
+
+        /* (t, t): both fields share the same subtree */
+        fields = ndt_alloc(2, sizeof *fields);
+        if (fields == NULL) {
+            ndt_del(t);
+            ndt_del(u);
+            ndt_context_del(ctx);
+            fprintf(stderr, "error: out of memory");
+            return -1;
+        }
+        fields[0].type = ndt_incref(t);
+        fields[0].pad = 0;
+        fields[1].type = ndt_incref(t);
+        fields[1].pad = 0;
+
+        v = ndt_tuple(Nonvariadic, fields, 2, ctx);
+        if (v == NULL) {
+            ndt_del(t);
+            ndt_del(u);
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_refcount: FAIL: could not create tuple type\n");
+            return -1;
+        }
+
+        if (t->refcnt != 4 || u->Pointer.type != t ||
+            v->Tuple.fields[0].type != v->Tuple.fields[1].type) {
+            ndt_del(t);
+            ndt_del(u);
+            ndt_del(v);
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_refcount: FAIL: subtree not shared: \"%s\"\n", *c);
+            return -1;
+        }
+
+        /* The derived types keep the shared subtree alive. */
+        ndt_decref(t);
+        if (!ndt_equal(u->Pointer.type, v->Tuple.fields[1].type)) {
+            ndt_del(u);
+            ndt_del(v);
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_refcount: FAIL: shared subtree corrupted: \"%s\"\n", *c);
+            return -1;
+        }
+
+        ndt_decref(u);
+        ndt_decref(v);
+        count++;
+    }
+
+    fprintf(stderr, "test_refcount (%d test cases)\n", count);
+
+    ndt_context_del(ctx);
+    return 0;
+}
+
+static int
+test_arena(void)
+{
+    const char **c;
+    ndt_context_t *ctx;
+    ndt_t *t, *u;
+    char *s, *r;
+    int count = 0;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    for (c = parse_roundtrip_tests; *c != NULL; c++) {
+        t = ndt_from_string(*c, ctx);
+        if (t == NULL) {
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_arena: FAIL: could not parse \"%s\"\n", *c);
+            return -1;
+        }
+
+        for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+            ndt_err_clear(ctx);
+
+            ndt_set_alloc_fail();
+            u = ndt_arena_copy(t, ctx);
+            ndt_set_alloc();
+
+            if (ctx->err != NDT_MemoryError) {
+                break;
+            }
+
+            if (u != NULL) {
+                ndt_del(t);
+                ndt_del(u);
+                ndt_context_del(ctx);
+                fprintf(stderr, "test_arena: FAIL: u != NULL after MemoryError\n");
+                fprintf(stderr, "test_arena: FAIL: input: %s\n", *c);
+                return -1;
+            }
+        }
+        if (u == NULL) {
+            ndt_del(t);
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_arena: FAIL: could not copy \"%s\"\n", *c);
+            return -1;
+        }
+
+        if (!ndt_equal(t, u)) {
+            ndt_del(t);
+            ndt_del(u);
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_arena: FAIL: copy differs: \"%s\"\n", *c);
+            return -1;
+        }
+
+        s = ndt_as_string_with_meta(t, ctx);
+        r = ndt_as_string_with_meta(u, ctx);
+        ndt_del(t);
+        ndt_del(u);
+        if (s == NULL || r == NULL) {
+            ndt_free(s);
+            ndt_free(r);
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_arena: FAIL: could not convert \"%s\"\n", *c);
+            return -1;
+        }
+
+        if (strcmp(s, r) != 0) {
+            fprintf(stderr, "test_arena: FAIL: metadata differs: \"%s\"\n", *c);
+            ndt_free(s);
+            ndt_free(r);
+            ndt_context_del(ctx);
+            return -1;
+        }
+
+        ndt_free(s);
+        ndt_free(r);
+        count++;
+    }
+
+    fprintf(stderr, "test_arena (%d test cases)\n", count);
+
+    ndt_context_del(ctx);
+    return 0;
+}
+
+static int
+test_from_string_arena(void)
+{
+    const char **c;
+    ndt_context_t *ctx;
+    ndt_t *t, *u;
+    char *s, *r;
+    int nalloc, count = 0;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    for (c = parse_roundtrip_tests; *c != NULL; c++) {
+        for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+            ndt_err_clear(ctx);
+
+            ndt_set_alloc_fail();
+            u = ndt_from_string_arena(*c, ctx);
+            ndt_set_alloc();
+
+            if (ctx->err != NDT_MemoryError) {
+                break;
+            }
+
+            if (u != NULL) {
+                ndt_del(u);
+                ndt_context_del(ctx);
+                fprintf(stderr, "test_from_string_arena: FAIL: u != NULL after MemoryError\n");
+                fprintf(stderr, "test_from_string_arena: FAIL: input: %s\n", *c);
+                return -1;
+            }
+        }
+        nalloc = alloc_idx;
+
+        if (u == NULL) {
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_from_string_arena: FAIL: could not parse \"%s\"\n", *c);
+            return -1;
+        }
+
+        /* the intermediate tree is allocated in a few chunks */
+        if (nalloc > 4 || !u->arena || u->arena_interior ||
+            (u->tag == Array && (!u->Array.dtype->arena_interior ||
+                                 ndt_incref(u->Array.dtype)->refcnt != 1))) {
+            ndt_del(u);
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_from_string_arena: FAIL: not parsed into an arena: \"%s\"\n", *c);
+            return -1;
+        }
+
+        t = ndt_from_string(*c, ctx);
+        if (t == NULL) {
+            ndt_del(u);
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_from_string_arena: FAIL: could not parse \"%s\"\n", *c);
+            return -1;
+        }
+
+        s = ndt_as_string_with_meta(t, ctx);
+        r = ndt_as_string_with_meta(u, ctx);
+        ndt_del(t);
+        ndt_del(u);
+        if (s == NULL || r == NULL) {
+            ndt_free(s);
+            ndt_free(r);
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_from_string_arena: FAIL: could not convert \"%s\"\n", *c);
+            return -1;
+        }
+
+        if (strcmp(s, r) != 0) {
+            fprintf(stderr, "test_from_string_arena: FAIL: metadata differs: \"%s\"\n", *c);
+            ndt_free(s);
+            ndt_free(r);
+            ndt_context_del(ctx);
+            return -1;
+        }
+
+        ndt_free(s);
+        ndt_free(r);
+        count++;
+    }
+
+    /* The error message is allocated outside of the region. */
+    for (c = parse_error_tests; *c != NULL; c++) {
+        t = ndt_from_string(*c, ctx);
+        s = ndt_strdup(ndt_context_msg(ctx), ctx);
+        if (t != NULL || s == NULL) {
+            ndt_del(t);
+            ndt_free(s);
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_from_string_arena: FAIL: unexpected result: \"%s\"\n", *c);
+            return -1;
+        }
+
+        ndt_err_clear(ctx);
+        u = ndt_from_string_arena(*c, ctx);
+        if (u != NULL || strcmp(ndt_context_msg(ctx), s) != 0) {
+            ndt_del(u);
+            ndt_free(s);
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_from_string_arena: FAIL: unexpected error: \"%s\"\n", *c);
+            return -1;
+        }
+
+        ndt_free(s);
+        ndt_err_clear(ctx);
+        count++;
+    }
+
+    fprintf(stderr, "test_from_string_arena (%d test cases)\n", count);
+
+    ndt_context_del(ctx);
+    return 0;
+}
+
+static int
+test_serialize(void)
+{
+    const char **c;
+    ndt_context_t *ctx;
+    ndt_t *t, *u;
+    char *buf, *s, *r;
+    size_t len, i;
+    int count = 0;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    for (c = parse_roundtrip_tests; *c != NULL; c++) {
+        t = ndt_from_string(*c, ctx);
+        if (t == NULL) {
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_serialize: FAIL: could not parse \"%s\"\n", *c);
+            return -1;
+        }
+
+        for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+            ndt_err_clear(ctx);
+
+            ndt_set_alloc_fail();
+            buf = ndt_serialize(t, &len, ctx);
+            ndt_set_alloc();
+
+            if (ctx->err != NDT_MemoryError) {
+                break;
+            }
+
+            if (buf != NULL) {
+                ndt_free(buf);
+                ndt_del(t);
+                ndt_context_del(ctx);
+                fprintf(stderr, "test_serialize: FAIL: buf != NULL after MemoryError\n");
+                fprintf(stderr, "test_serialize: FAIL: input: %s\n", *c);
+                return -1;
+            }
+        }
+        if (buf == NULL && strstr(ndt_context_msg(ctx), "size overflow")) {
+            /* Concrete types whose size overflows cannot be serialized. */
+            ndt_err_clear(ctx);
+            ndt_del(t);
+            continue;
+        }
+        if (buf == NULL) {
+            ndt_del(t);
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_serialize: FAIL: could not serialize \"%s\"\n", *c);
+            return -1;
+        }
+
+        for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+            ndt_err_clear(ctx);
+
+            ndt_set_alloc_fail();
+            u = ndt_deserialize(buf, len, ctx);
+            ndt_set_alloc();
+
+            if (ctx->err != NDT_MemoryError) {
+                break;
+            }
+
+            if (u != NULL) {
+                ndt_free(buf);
+                ndt_del(t);
+                ndt_del(u);
+                ndt_context_del(ctx);
+                fprintf(stderr, "test_serialize: FAIL: u != NULL after MemoryError\n");
+                fprintf(stderr, "test_serialize: FAIL: input: %s\n", *c);
+                return -1;
+            }
+        }
+        if (u == NULL) {
+            ndt_free(buf);
+            ndt_del(t);
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_serialize: FAIL: could not deserialize \"%s\"\n", *c);
+            return -1;
+        }
+
+        if (!ndt_equal(t, u)) {
+            ndt_free(buf);
+            ndt_del(t);
+            ndt_del(u);
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_serialize: FAIL: result differs: \"%s\"\n", *c);
+            return -1;
+        }
+
+        s = ndt_as_string_with_meta(t, ctx);
+        r = ndt_as_string_with_meta(u, ctx);
+        ndt_del(t);
+        ndt_del(u);
+        if (s == NULL || r == NULL || strcmp(s, r) != 0) {
+            fprintf(stderr, "test_serialize: FAIL: metadata differs: \"%s\"\n", *c);
+            ndt_free(buf);
+            ndt_free(s);
+            ndt_free(r);
+            ndt_context_del(ctx);
+            return -1;
+        }
+        ndt_free(s);
+        ndt_free(r);
+
+        /* Corrupted or truncated input must be rejected without crashing. */
+        for (i = 0; i < len; i++) {
+            buf[i] ^= 0x5a;
+            u = ndt_deserialize(buf, len, ctx);
+            if (u != NULL) {
+                ndt_del(u);
+            }
+            buf[i] ^= 0x5a;
+
+            u = ndt_deserialize(buf, i, ctx);
+            if (u != NULL) {
+                ndt_free(buf);
+                ndt_del(u);
+                ndt_context_del(ctx);
+                fprintf(stderr, "test_serialize: FAIL: accepted truncated input\n");
+                return -1;
+            }
+        }
+
+        ndt_err_clear(ctx);
+        ndt_free(buf);
+        count++;
+    }
+
+    fprintf(stderr, "test_serialize (%d test cases)\n", count);
+
+    ndt_context_del(ctx);
+    return 0;
+}
+
+/* Serialized types with one or two words (counted from the start of the
+   buffer, 0 for none) replaced.  The structure stays valid, the layout or
+   the order of the categorical values does not. */
+static const struct {
+    const char *input;
+    size_t word;
+    uint64_t value;
+    size_t word2;
+    uint64_t value2;
+} deserialize_invalid_tests[] = {
+  { "int64", 4, 4, 0, 0 },                                /* size */
+  { "int64", 5, 4, 0, 0 },                                /* align */
+  { "10 * int64", 4, 8, 0, 0 },                           /* array size */
+  { "10 * int64", 12, 4, 0, 0 },                          /* dimension itemsize */
+  { "10 * int64", 13, 4, 0, 0 },                          /* dimension itemalign */
+  { "(int8, int64)", 4, 9, 0, 0 },                        /* tuple size */
+  { "(int8, int64)", 12, 1, 0, 0 },                       /* field offset */
+  { "(int8, int64)", 10, 1, 0, 0 },                       /* field padding */
+  { "{a : int8, b : int64}", 14, 4, 0, 0 },               /* field offset */
+  { "?(int8, int64)", 4, 8, 0, 0 },                       /* option size */
+  { "categorical(10 : int64, 20 : int64)", 8, 30, 0, 0 }, /* unsorted */
+  { "categorical(10 : int64, 20 : int64)", 8, 20, 0, 0 }, /* duplicate */
+  { "10 * int64", 10, UINT64_C(1) << 62, 0, 0 },          /* size overflow */
+  { "fixed_bytes(size=4, align=4)", 5, 0, 7, 0 },         /* zero alignment */
+  { NULL, 0, 0, 0, 0 }
+};
+
+static int
+test_deserialize_invalid(void)
+{
+    ndt_context_t *ctx;
+    ndt_t *t, *u;
+    char *buf;
+    size_t len, i;
+    uint64_t w;
+    int count = 0;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    for (i = 0; deserialize_invalid_tests[i].input != NULL; i++) {
+        t = ndt_from_string(deserialize_invalid_tests[i].input, ctx);
+        if (t == NULL) {
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_deserialize_invalid: FAIL: could not parse \"%s\"\n",
+                    deserialize_invalid_tests[i].input);
+            return -1;
+        }
+
+        buf = ndt_serialize(t, &len, ctx);
+        ndt_del(t);
+        if (buf == NULL) {
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_deserialize_invalid: FAIL: could not serialize \"%s\"\n",
+                    deserialize_invalid_tests[i].input);
+            return -1;
+        }
+
+        /* the unmodified buffer is valid */
+        u = ndt_deserialize(buf, len, ctx);
+        ndt_del(u);
+
+        if (u != NULL && (deserialize_invalid_tests[i].word+1) * sizeof w <= len &&
+            (deserialize_invalid_tests[i].word2+1) * sizeof w <= len) {
+            w = deserialize_invalid_tests[i].value;
+            memcpy(buf + deserialize_invalid_tests[i].word * sizeof w, &w, sizeof w);
+            if (deserialize_invalid_tests[i].word2 != 0) {
+                w = deserialize_invalid_tests[i].value2;
+                memcpy(buf + deserialize_invalid_tests[i].word2 * sizeof w, &w, sizeof w);
+            }
+            u = ndt_deserialize(buf, len, ctx);
+            if (u == NULL && ctx->err == NDT_ValueError) {
+                ndt_err_clear(ctx);
+                ndt_free(buf);
+                count++;
+                continue;
+            }
+            ndt_del(u);
+        }
+
+        ndt_free(buf);
+        ndt_context_del(ctx);
+        fprintf(stderr, "test_deserialize_invalid: FAIL: accepted invalid \"%s\"\n",
+                deserialize_invalid_tests[i].input);
+        return -1;
+    }
+
+    fprintf(stderr, "test_deserialize_invalid (%d test cases)\n", count);
+
+    ndt_context_del(ctx);
+    return 0;
+}
+
+static int
+test_match(void)
+{
+    const match_testcase_t *t;
+    ndt_context_t *ctx;
+    ndt_t *p;
+    ndt_t *c;
+    int ret, count = 0;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    for (t = match_tests; t->pattern != NULL; t++) {
+        p = ndt_from_string(t->pattern, ctx);
+        if (p == NULL) {
+            fprintf(stderr, "test_match: FAIL: could not parse \"%s\"\n", t->pattern);
+            ndt_context_del(ctx);
+            return -1;
+        }
+
+        c = ndt_from_string(t->candidate, ctx);
+        if (c == NULL) {
+            ndt_del(p);
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_match: FAIL: could not parse \"%s\"\n", t->candidate);
+            return -1;
+        }
+
+        for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+            ndt_err_clear(ctx);
+
+            ndt_set_alloc_fail();
+            ret = ndt_match(p, c, ctx);
+            ndt_set_alloc();
+
+            if (ctx->err != NDT_MemoryError) {
+                break;
+            }
+
+            if (ret != -1) {
+                ndt_del(p);
+                ndt_del(c);
+                ndt_context_del(ctx);
+                fprintf(stderr, "test_match: FAIL: expect ret == -1 after MemoryError\n");
+                fprintf(stderr, "test_match: FAIL: \"%s\"\n", t->pattern);
+                return -1;
+            }
+        }
+
+        if (ret != t->expected) {
+            ndt_del(p);
+            ndt_del(c);
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_match: FAIL: expected %s\n", t->expected ? "true" : "false");
+            fprintf(stderr, "test_match: FAIL: pattern: \"%s\"\n", t->pattern);
+            fprintf(stderr, "test_match: FAIL: candidate: \"%s\"\n", t->candidate);
+            return -1;
+        }
+
+        ndt_del(p);
+        ndt_del(c);
+        count++;
+    }
+    fprintf(stderr, "test_match (%d test cases)\n", count);
+
+    ndt_context_del(ctx);
+    return 0;
+}
+
+static int
+test_match_compiled(void)
+{
+    const match_testcase_t *t;
+    ndt_context_t *ctx;
+    ndt_pattern_t *pat;
+    ndt_t *p;
+    ndt_t *c;
+    int ret, count = 0;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    for (t = match_tests; t->pattern != NULL; t++) {
+        p = ndt_from_string(t->pattern, ctx);
+        if (p == NULL) {
+            fprintf(stderr, "test_match_compiled: FAIL: could not parse \"%s\"\n", t->pattern);
+            ndt_context_del(ctx);
+            return -1;
+        }
+
+        c = ndt_from_string(t->candidate, ctx);
+        if (c == NULL) {
+            ndt_del(p);
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_match_compiled: FAIL: could not parse \"%s\"\n", t->candidate);
+            return -1;
+        }
+
+        for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+            ndt_err_clear(ctx);
+
+            ndt_set_alloc_fail();
+            pat = ndt_pattern_compile(p, ctx);
+            ndt_set_alloc();
+
+            if (ctx->err != NDT_MemoryError) {
+                break;
+            }
+
+            if (pat != NULL) {
+                ndt_pattern_del(pat);
+                ndt_del(p);
+                ndt_del(c);
+                ndt_context_del(ctx);
+                fprintf(stderr, "test_match_compiled: FAIL: pat != NULL after MemoryError\n");
+                fprintf(stderr, "test_match_compiled: FAIL: \"%s\"\n", t->pattern);
+                return -1;
+            }
+        }
+        ndt_del(p);
+        if (pat == NULL) {
+            ndt_del(c);
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_match_compiled: FAIL: could not compile \"%s\"\n", t->pattern);
+            return -1;
+        }
+
+        for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+            ndt_err_clear(ctx);
+
+            ndt_set_alloc_fail();
+            ret = ndt_pattern_match(pat, c, ctx);
+            ndt_set_alloc();
+
+            if (ctx->err != NDT_MemoryError) {
+                break;
+            }
+
+            if (ret != -1) {
+                ndt_pattern_del(pat);
+                ndt_del(c);
+                ndt_context_del(ctx);
+                fprintf(stderr, "test_match_compiled: FAIL: expect ret == -1 after MemoryError\n");
+                fprintf(stderr, "test_match_compiled: FAIL: \"%s\"\n", t->pattern);
+                return -1;
+            }
+        }
+
+        ndt_pattern_del(pat);
+        ndt_del(c);
+
+        if (ret != t->expected) {
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_match_compiled: FAIL: expected %s\n", t->expected ? "true" : "false");
+            fprintf(stderr, "test_match_compiled: FAIL: pattern: \"%s\"\n", t->pattern);
+            fprintf(stderr, "test_match_compiled: FAIL: candidate: \"%s\"\n", t->candidate);
+            return -1;
+        }
+
+        count++;
+    }
+    fprintf(stderr, "test_match_compiled (%d test cases)\n", count);
+
+    ndt_context_del(ctx);
+    return 0;
+}
+
+#define BATCH_COPIES 3
+
+static int
+test_match_batch(void)
+{
+    const match_testcase_t *t;
+    ndt_context_t *ctx;
+    ndt_pool_t *pool = NULL;
+    const ndt_t **c = NULL;
+    ndt_t **candidates = NULL;
+    uint64_t *bitmap = NULL;
+    ndt_t *p;
+    size_t ncandidates, n, i, j;
+    int64_t count, expected;
+    int ret = -1, k, m, bit, npatterns = 0;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    for (ncandidates = 0; match_tests[ncandidates].pattern != NULL; ncandidates++);
+    n = BATCH_COPIES * ncandidates;
+
+    candidates = ndt_alloc(ncandidates, sizeof *candidates);
+    c = ndt_alloc(n, sizeof *c);
+    bitmap = ndt_alloc(n / 64 + 1, sizeof *bitmap);
+    pool = ndt_pool_new(4, ctx);
+    if (candidates == NULL || c == NULL || bitmap == NULL || pool == NULL) {
+        fprintf(stderr, "test_match_batch: FAIL: could not allocate\n");
+        goto out;
+    }
+    for (i = 0; i < ncandidates; i++) {
+        candidates[i] = NULL;
+    }
+
+    for (i = 0; i < ncandidates; i++) {
+        candidates[i] = ndt_from_string(match_tests[i].candidate, ctx);
+        if (candidates[i] == NULL) {
+            fprintf(stderr, "test_match_batch: FAIL: could not parse \"%s\"\n",
+                    match_tests[i].candidate);
+            goto out;
+        }
+    }
+    for (i = 0; i < n; i++) {
+        c[i] = candidates[i % ncandidates];
+    }
+
+    /* every 7th pattern */
+    for (j = 0; j < ncandidates; j += 7) {
+        t = &match_tests[j];
+        p = ndt_from_string(t->pattern, ctx);
+        if (p == NULL) {
+            fprintf(stderr, "test_match_batch: FAIL: could not parse \"%s\"\n", t->pattern);
+            goto out;
+        }
+
+        /* serial, with allocation failures */
+        for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+            ndt_err_clear(ctx);
+
+            ndt_set_alloc_fail();
+            count = ndt_match_batch(p, c, n, bitmap, NULL, ctx);
+            ndt_set_alloc();
+
+            if (ctx->err != NDT_MemoryError) {
+                break;
+            }
+
+            if (count != -1) {
+                ndt_del(p);
+                fprintf(stderr, "test_match_batch: FAIL: expect -1 after MemoryError\n");
+                goto out;
+            }
+        }
+
+        for (k = 0; k < 2; k++) {
+            if (k == 1) {
+                count = ndt_match_batch(p, c, n, bitmap, pool, ctx);
+            }
+
+            expected = 0;
+            for (i = 0; i < n; i++) {
+                m = ndt_match(p, c[i], ctx);
+                bit = (bitmap[i/64] >> (i%64)) & 1;
+                if (m != bit) {
+                    break;
+                }
+                expected += m;
+            }
+
+            if (i != n || count != expected) {
+                ndt_del(p);
+                fprintf(stderr, "test_match_batch: FAIL: wrong result for \"%s\"\n",
+                        t->pattern);
+                goto out;
+            }
+        }
+
+        ndt_del(p);
+        npatterns++;
+    }
+
+    fprintf(stderr, "test_match_batch (%d test cases)\n", npatterns);
+    ret = 0;
+
+out:
+    if (candidates != NULL) {
+        for (i = 0; i < ncandidates; i++) {
+            ndt_del(candidates[i]);
+        }
+    }
+    ndt_free(candidates);
+    ndt_free(c);
+    ndt_free(bitmap);
+    ndt_pool_del(pool);
+    ndt_context_del(ctx);
+    return ret;
+}
+
+static int
+test_match_cache(void)
+{
+    const match_testcase_t *t;
+    ndt_context_t *ctx;
+    ndt_matchcache_t *mc;
+    ndt_cache_stats_t stats;
+    ndt_t *p, *c;
+    int ret = -1, count = 0;
+    int m, k;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    mc = ndt_matchcache_new(0, ctx);
+    if (mc != NULL || ctx->err != NDT_ValueError) {
+        fprintf(stderr, "test_match_cache: FAIL: expected ValueError for size 0\n");
+        goto out;
+    }
+    ndt_err_clear(ctx);
+
+    mc = ndt_matchcache_new(100, ctx);
+    if (mc == NULL) {
+        fprintf(stderr, "test_match_cache: FAIL: could not create cache\n");
+        goto out;
+    }
+
+    for (t = match_tests; t->pattern != NULL; t++) {
+        p = c = NULL;
+
+        /* The first lookup misses.  The second one hits by identity, the
+           third one by structure. */
+        for (k = 0; k < 3; k++) {
+            if (k != 1) {
+                ndt_del(p);
+                ndt_del(c);
+                p = ndt_from_string(t->pattern, ctx);
+                c = ndt_from_string(t->candidate, ctx);
+                if (p == NULL || c == NULL) {
+                    ndt_del(p);
+                    ndt_del(c);
+                    fprintf(stderr, "test_match_cache: FAIL: could not parse \"%s\"\n",
+                            t->pattern);
+                    goto out;
+                }
+            }
+
+            for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+                ndt_err_clear(ctx);
+
+                ndt_set_alloc_fail();
+                m = ndt_match_cached(mc, p, c, ctx);
+                ndt_set_alloc();
+
+                if (ctx->err != NDT_MemoryError) {
+                    break;
+                }
+
+                if (m != -1) {
+                    ndt_del(p);
+                    ndt_del(c);
+                    fprintf(stderr, "test_match_cache: FAIL: expect -1 after MemoryError\n");
+                    goto out;
+                }
+            }
+
+            if (m != t->expected) {
+                ndt_del(p);
+                ndt_del(c);
+                fprintf(stderr, "test_match_cache: FAIL: wrong result for \"%s\"\n",
+                        t->pattern);
+                goto out;
+            }
+        }
+
+        /* The cache keeps its own references. */
+        ndt_del(p);
+        ndt_del(c);
+        count++;
+    }
+
+    ndt_matchcache_stats(mc, &stats);
+    /* Repeated pairs can hit on their first lookup. */
+    if (stats.hits + stats.misses != 3 * (size_t)count ||
+        stats.hits < 2 * (size_t)count ||
+        stats.evictions > stats.misses) {
+        fprintf(stderr, "test_match_cache: FAIL: unexpected statistics\n");
+        goto out;
+    }
+
+    ndt_matchcache_clear(mc);
+    ndt_matchcache_stats(mc, &stats);
+    if (stats.hits + stats.misses != 3 * (size_t)count) {
+        fprintf(stderr, "test_match_cache: FAIL: clear must keep the statistics\n");
+        goto out;
+    }
+
+    /* Inner nodes of an arena are not kept alive by the cache.  After the
+       root is freed, a new arena at the same address must not hit. */
+    p = ndt_from_string("int64", ctx);
+    if (p == NULL) {
+        fprintf(stderr, "test_match_cache: FAIL: could not parse pattern\n");
+        goto out;
+    }
+
+    for (k = 0; k < 2; k++) {
+        c = ndt_from_string_arena(k == 0 ? "10 * int64" : "10 * float64", ctx);
+        if (c == NULL) {
+            ndt_del(p);
+            fprintf(stderr, "test_match_cache: FAIL: could not parse arena type\n");
+            goto out;
+        }
+
+        for (m = 0; m < 2; m++) {
+            if (ndt_match_cached(mc, p, c->Array.dtype, ctx) != (k == 0)) {
+                ndt_del(p);
+                ndt_del(c);
+                fprintf(stderr, "test_match_cache: FAIL: wrong result for arena type\n");
+                goto out;
+            }
+        }
+
+        ndt_del(c);
+    }
+
+    ndt_del(p);
+
+    fprintf(stderr, "test_match_cache (%d test cases)\n", count);
+    ret = 0;
+
+out:
+    ndt_matchcache_del(mc);
+    ndt_context_del(ctx);
+    return ret;
+}
+
+/* ndt_equal() ignores strides: compare the strides of the outer dimensions. */
+static int
+same_strides(const ndt_t *t, const ndt_t *u)
+{
+    const ndt_dim_t *x, *y;
+    size_t i;
+
+    if (t->tag != Array || u->tag != Array) {
+        return t->tag == u->tag;
+    }
+
+    if (t->Array.ndim != u->Array.ndim) {
+        return 0;
+    }
+
+    for (i = 0; i < t->Array.ndim; i++) {
+        x = &t->Array.dim[i];
+        y = &u->Array.dim[i];
+        if ((x->tag == FixedDim && x->FixedDim.stride != y->FixedDim.stride) ||
+            (x->tag == VarDim && x->VarDim.stride != y->VarDim.stride)) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static int
+test_unify(void)
+{
+    const unify_testcase_t *t;
+    ndt_context_t *ctx;
+    ndt_bindings_t *b;
+    ndt_t *p, *c, *tmpl, *expected, *r;
+    int ret, count = 0;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    b = ndt_bindings_new(ctx);
+    if (b == NULL) {
+        ndt_context_del(ctx);
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    for (t = unify_tests; t->pattern != NULL; t++) {
+        p = ndt_from_string(t->pattern, ctx);
+        c = ndt_from_string(t->candidate, ctx);
+        tmpl = ndt_from_string(t->template, ctx);
+        expected = t->expected ? ndt_from_string(t->expected, ctx) : NULL;
+        if (p == NULL || c == NULL || tmpl == NULL ||
+            (t->expected != NULL && expected == NULL)) {
+            ndt_del(p);
+            ndt_del(c);
+            ndt_del(tmpl);
+            ndt_bindings_del(b);
+            ndt_context_del(ctx);
+            fprintf(stderr, "test_unify: FAIL: could not parse \"%s\"\n", t->pattern);
+            return -1;
+        }
+
+        for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+            ndt_err_clear(ctx);
+
+            ndt_set_alloc_fail();
+            ret = ndt_unify(p, c, b, ctx);
+            ndt_set_alloc();
+
+            if (ctx->err != NDT_MemoryError) {
+                break;
+            }
+
+            if (ret != -1) {
+                fprintf(stderr, "test_unify: FAIL: expect ret == -1 after MemoryError\n");
+                goto error;
+            }
+        }
+
+        if (ret != (expected != NULL)) {
+            fprintf(stderr, "test_unify: FAIL: expected %s\n", expected ? "match" : "no match");
+            goto error;
+        }
+
+        if (ret == 1) {
+            for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+                ndt_err_clear(ctx);
+
+                ndt_set_alloc_fail();
+                r = ndt_substitute(tmpl, b, ctx);
+                ndt_set_alloc();
+
+                if (ctx->err != NDT_MemoryError) {
+                    break;
+                }
+
+                if (r != NULL) {
+                    ndt_del(r);
+                    fprintf(stderr, "test_unify: FAIL: r != NULL after MemoryError\n");
+                    goto error;
+                }
+            }
+
+            if (r == NULL) {
+                fprintf(stderr, "test_unify: FAIL: substitution failed\n");
+                goto error;
+            }
+
+            if (!ndt_equal(r, expected) || !same_strides(r, expected) ||
+                r->size != expected->size || r->align != expected->align ||
+                r->abstract != expected->abstract) {
+                ndt_del(r);
+                fprintf(stderr, "test_unify: FAIL: unexpected result\n");
+                goto error;
+            }
+            ndt_del(r);
+        }
+
+        ndt_del(p);
+        ndt_del(c);
+        ndt_del(tmpl);
+        ndt_del(expected);
+        count++;
+    }
+
+    fprintf(stderr, "test_unify (%d test cases)\n", count);
+
+    ndt_bindings_del(b);
+    ndt_context_del(ctx);
+    return 0;
+
+error:
+    fprintf(stderr, "test_unify: FAIL: pattern: \"%s\"\n", t->pattern);
+    fprintf(stderr, "test_unify: FAIL: candidate: \"%s\"\n", t->candidate);
+    fprintf(stderr, "test_unify: FAIL: template: \"%s\"\n", t->template);
+    ndt_del(p);
+    ndt_del(c);
+    ndt_del(tmpl);
+    ndt_del(expected);
+    ndt_bindings_del(b);
+    ndt_context_del(ctx);
+    return -1;
+}
+
+static int
+test_pattern_unify(void)
+{
+    const unify_testcase_t *t;
+    ndt_context_t *ctx;
+    ndt_bindings_t *b;
+    ndt_pattern_t *pat = NULL;
+    ndt_t *p, *c, *tmpl, *expected, *r;
+    int ret, count = 0;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    b = ndt_bindings_new(ctx);
+    if (b == NULL) {
+        ndt_context_del(ctx);
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    for (t = unify_tests; t->pattern != NULL; t++) {
+        p = ndt_from_string(t->pattern, ctx);
+        c = ndt_from_string(t->candidate, ctx);
+        tmpl = ndt_from_string(t->template, ctx);
+        expected = t->expected ? ndt_from_string(t->expected, ctx) : NULL;
+        pat = p ? ndt_pattern_compile(p, ctx) : NULL;
+        if (pat == NULL || c == NULL || tmpl == NULL ||
+            (t->expected != NULL && expected == NULL)) {
+            fprintf(stderr, "test_pattern_unify: FAIL: could not parse or compile\n");
+            goto error;
+        }
+
+        for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+            ndt_err_clear(ctx);
 
             ndt_set_alloc_fail();
-            (void)ndt_typedef(*c, t, ctx);
+            ret = ndt_pattern_unify(pat, c, b, ctx);
             ndt_set_alloc();
 
             if (ctx->err != NDT_MemoryError) {
                 break;
             }
 
-            if (ndt_typedef_find(*c, ctx) != NULL) {
-                fprintf(stderr, "test_typedef_error: FAIL: key in map after MemoryError\n");
-                fprintf(stderr, "test_typedef: FAIL: input: %s\n", *c);
-                ndt_context_del(ctx);
-                return -1;
+            if (ret != -1) {
+                fprintf(stderr, "test_pattern_unify: FAIL: expect ret == -1 after MemoryError\n");
+                goto error;
             }
         }
 
-        if (ndt_typedef_find(*c, ctx) != NULL) {
-            fprintf(stderr, "test_typedef_error: FAIL: unexpected success: \"%s\"\n", *c);
-            fprintf(stderr, "test_typedef_error: FAIL: key in map after %s: %s\n",
-                    ndt_err_as_string(ctx->err),
-                    ndt_context_msg(ctx));
-            ndt_context_del(ctx);
-            return -1;
+        if (ret != (expected != NULL)) {
+            fprintf(stderr, "test_pattern_unify: FAIL: expected %s\n", expected ? "match" : "no match");
+            goto error;
         }
 
+        if (ret == 1) {
+            r = ndt_substitute(tmpl, b, ctx);
+            if (r == NULL) {
+                fprintf(stderr, "test_pattern_unify: FAIL: substitution failed\n");
+                goto error;
+            }
+
+            if (!ndt_equal(r, expected) || !same_strides(r, expected)) {
+                ndt_del(r);
+                fprintf(stderr, "test_pattern_unify: FAIL: unexpected result\n");
+                goto error;
+            }
+            ndt_del(r);
+        }
+
+        ndt_pattern_del(pat);
+        ndt_del(p);
+        ndt_del(c);
+        ndt_del(tmpl);
+        ndt_del(expected);
         count++;
     }
 
-    fprintf(stderr, "test_typedef_error (%d test cases)\n", count);
+    fprintf(stderr, "test_pattern_unify (%d test cases)\n", count);
 
+    ndt_bindings_del(b);
     ndt_context_del(ctx);
     return 0;
+
+error:
+    fprintf(stderr, "test_pattern_unify: FAIL: pattern: \"%s\"\n", t->pattern);
+    fprintf(stderr, "test_pattern_unify: FAIL: candidate: \"%s\"\n", t->candidate);
+    fprintf(stderr, "test_pattern_unify: FAIL: template: \"%s\"\n", t->template);
+    ndt_pattern_del(pat);
+    ndt_del(p);
+    ndt_del(c);
+    ndt_del(tmpl);
+    ndt_del(expected);
+    ndt_bindings_del(b);
+    ndt_context_del(ctx);
+    return -1;
 }
 
 static int
-test_equal(void)
+test_broadcast(void)
 {
-    const char **c;
+    const broadcast_testcase_t *t;
+    const ndt_t *pargs[NDT_MAX_ARGS];
+    const ndt_t *cargs[NDT_MAX_ARGS];
+    ndt_broadcast_t *out;
     ndt_context_t *ctx;
-    ndt_t *t, *u;
-    int count = 0;
+    ndt_bindings_t *b;
+    ndt_t *p, *c, *tmpl, *r, *expected;
+    int ret, nargs, i, k, count = 0;
 
     ctx = ndt_context_new();
     if (ctx == NULL) {
@@ -570,58 +2962,142 @@ test_equal(void)
         return -1;
     }
 
-    for (c = parse_roundtrip_tests; *c && *(c+1); c++) {
+    b = ndt_bindings_new(ctx);
+    out = ndt_alloc(1, sizeof *out);
+    if (b == NULL || out == NULL) {
+        ndt_bindings_del(b);
+        ndt_free(out);
+        ndt_context_del(ctx);
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    for (t = broadcast_tests; t->pattern != NULL; t++) {
         ndt_err_clear(ctx);
 
-        t = ndt_from_string(*c, ctx);
-        if (t == NULL) {
-            ndt_context_del(ctx);
-            fprintf(stderr, "test_equal: FAIL: could not parse \"%s\"\n", *c);
-            return -1;
+        p = ndt_from_string(t->pattern, ctx);
+        c = ndt_from_string(t->candidate, ctx);
+        if (p == NULL || c == NULL || p->Tuple.shape != c->Tuple.shape) {
+            ndt_del(p);
+            ndt_del(c);
+            fprintf(stderr, "test_broadcast: FAIL: invalid test case: \"%s\"\n", t->pattern);
+            goto error;
         }
 
-        u = ndt_from_string(*(c+1), ctx);
-        if (u == NULL) {
-            ndt_del(t);
-            ndt_context_del(ctx);
-            fprintf(stderr, "test_equal: FAIL: could not parse \"%s\"\n", *(c+1));
-            return -1;
+        nargs = (int)p->Tuple.shape;
+        for (i = 0; i < nargs; i++) {
+            pargs[i] = p->Tuple.fields[i].type;
+            cargs[i] = c->Tuple.fields[i].type;
         }
 
-        if (!ndt_equal(t, t)) {
-            ndt_del(t);
-            ndt_del(u);
-            ndt_context_del(ctx);
-            fprintf(stderr, "test_equal: FAIL: \"%s\" != \"%s\"\n", *c, *c);
-            return -1;
+        for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+            ndt_err_clear(ctx);
+
+            ndt_set_alloc_fail();
+            ret = ndt_broadcast(out, pargs, cargs, nargs, b, ctx);
+            ndt_set_alloc();
+
+            if (ctx->err != NDT_MemoryError) {
+                break;
+            }
+
+            if (ret != -1) {
+                ndt_del(p);
+                ndt_del(c);
+                fprintf(stderr, "test_broadcast: FAIL: expect ret == -1 after MemoryError\n");
+                goto error;
+            }
         }
 
-        if (ndt_equal(t, u)) {
-            ndt_del(t);
-            ndt_del(u);
-            fprintf(stderr, "test_equal: FAIL: \"%s\" == \"%s\"\n", *c, *(c+1));
-            return -1;
+        if (ret != t->expected) {
+            ndt_del(p);
+            ndt_del(c);
+            fprintf(stderr, "test_broadcast: FAIL: expected %d, got %d: \"%s\"\n",
+                    t->expected, ret, t->candidate);
+            goto error;
         }
 
-        ndt_del(t);
-        ndt_del(u);
+        if (ret == 1) {
+            if (out->ndim != t->ndim || out->nargs != nargs) {
+                ndt_del(p);
+                ndt_del(c);
+                fprintf(stderr, "test_broadcast: FAIL: wrong ndim: \"%s\"\n", t->candidate);
+                goto error;
+            }
+
+            for (k = 0; k < out->ndim; k++) {
+                if (out->shape[k] != t->shape[k]) {
+                    break;
+                }
+                for (i = 0; i < nargs; i++) {
+                    if (out->strides[i][k] != t->strides[i][k]) {
+                        break;
+                    }
+                }
+                if (i != nargs) {
+                    break;
+                }
+            }
+
+            if (k != out->ndim) {
+                ndt_del(p);
+                ndt_del(c);
+                fprintf(stderr, "test_broadcast: FAIL: wrong shape or strides: \"%s\"\n",
+                        t->candidate);
+                goto error;
+            }
+
+            tmpl = ndt_from_string(t->template, ctx);
+            r = tmpl == NULL ? NULL : ndt_substitute(tmpl, b, ctx);
+            expected = ndt_from_string(t->result, ctx);
+            ndt_del(tmpl);
+
+            if (r == NULL || expected == NULL || !ndt_equal(r, expected)) {
+                ndt_del(r);
+                ndt_del(expected);
+                ndt_del(p);
+                ndt_del(c);
+                fprintf(stderr, "test_broadcast: FAIL: wrong result type: \"%s\"\n",
+                        t->candidate);
+                goto error;
+            }
+
+            ndt_del(r);
+            ndt_del(expected);
+        }
+
+        ndt_del(p);
+        ndt_del(c);
         count++;
     }
 
-    fprintf(stderr, "test_equal (%d test cases)\n", count);
+    fprintf(stderr, "test_broadcast (%d test cases)\n", count);
 
+    ndt_free(out);
+    ndt_bindings_del(b);
     ndt_context_del(ctx);
     return 0;
+
+error:
+    ndt_free(out);
+    ndt_bindings_del(b);
+    ndt_context_del(ctx);
+    return -1;
 }
 
 static int
-test_match(void)
+test_sigindex(void)
 {
     const match_testcase_t *t;
     ndt_context_t *ctx;
-    ndt_t *p;
+    ndt_sigindex_t *index;
+    ndt_t **patterns = NULL;
     ndt_t *c;
-    int ret, count = 0;
+    size_t *ids = NULL;
+    size_t npatterns, i, k;
+    int64_t n, id;
+    int ret = -1, count = 0;
+    int m;
 
     ctx = ndt_context_new();
     if (ctx == NULL) {
@@ -629,72 +3105,375 @@ test_match(void)
         return -1;
     }
 
-    for (t = match_tests; t->pattern != NULL; t++) {
-        p = ndt_from_string(t->pattern, ctx);
-        if (p == NULL) {
-            fprintf(stderr, "test_match: FAIL: could not parse \"%s\"\n", t->pattern);
-            ndt_context_del(ctx);
-            return -1;
-        }
+    for (npatterns = 0; match_tests[npatterns].pattern != NULL; npatterns++);
 
-        c = ndt_from_string(t->candidate, ctx);
-        if (c == NULL) {
-            ndt_del(p);
-            ndt_context_del(ctx);
-            fprintf(stderr, "test_match: FAIL: could not parse \"%s\"\n", t->candidate);
-            return -1;
+    index = ndt_sigindex_new(ctx);
+    patterns = ndt_alloc(npatterns, sizeof *patterns);
+    ids = ndt_alloc(npatterns, sizeof *ids);
+    if (index == NULL || patterns == NULL || ids == NULL) {
+        fprintf(stderr, "test_sigindex: FAIL: out of memory\n");
+        goto out;
+    }
+    for (i = 0; i < npatterns; i++) {
+        patterns[i] = NULL;
+    }
+
+    for (i = 0; i < npatterns; i++) {
+        patterns[i] = ndt_from_string(match_tests[i].pattern, ctx);
+        if (patterns[i] == NULL) {
+            fprintf(stderr, "test_sigindex: FAIL: could not parse \"%s\"\n",
+                    match_tests[i].pattern);
+            goto out;
         }
 
         for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
             ndt_err_clear(ctx);
 
             ndt_set_alloc_fail();
-            ret = ndt_match(p, c, ctx);
+            id = ndt_sigindex_add(index, patterns[i], ctx);
             ndt_set_alloc();
 
             if (ctx->err != NDT_MemoryError) {
                 break;
             }
 
-            if (ret != -1) {
-                ndt_del(p);
-                ndt_del(c);
-                ndt_context_del(ctx);
-                fprintf(stderr, "test_match: FAIL: expect ret == -1 after MemoryError\n");
-                fprintf(stderr, "test_match: FAIL: \"%s\"\n", t->pattern);
-                return -1;
+            if (id != -1) {
+                fprintf(stderr, "test_sigindex: FAIL: expect id == -1 after MemoryError\n");
+                goto out;
             }
         }
 
-        if (ret != t->expected) {
-            ndt_del(p);
+        if (id != (int64_t)i) {
+            fprintf(stderr, "test_sigindex: FAIL: could not add \"%s\"\n",
+                    match_tests[i].pattern);
+            goto out;
+        }
+    }
+
+    for (t = match_tests; t->pattern != NULL; t++) {
+        c = ndt_from_string(t->candidate, ctx);
+        if (c == NULL) {
+            fprintf(stderr, "test_sigindex: FAIL: could not parse \"%s\"\n", t->candidate);
+            goto out;
+        }
+
+        n = ndt_sigindex_find(index, c, ids, npatterns, ctx);
+        if (n < 0) {
             ndt_del(c);
-            ndt_context_del(ctx);
-            fprintf(stderr, "test_match: FAIL: expected %s\n", t->expected ? "true" : "false");
-            fprintf(stderr, "test_match: FAIL: pattern: \"%s\"\n", t->pattern);
-            fprintf(stderr, "test_match: FAIL: candidate: \"%s\"\n", t->candidate);
-            return -1;
+            fprintf(stderr, "test_sigindex: FAIL: lookup failed for \"%s\"\n", t->candidate);
+            goto out;
+        }
+
+        /* The result must be exactly the set of linear matches. */
+        for (i = 0, k = 0; i < npatterns; i++) {
+            m = ndt_match(patterns[i], c, ctx);
+            if (m == 1) {
+                if (k >= (size_t)n || ids[k] != i) {
+                    break;
+                }
+                k++;
+            }
+        }
+
+        ndt_del(c);
+
+        if (i != npatterns || k != (size_t)n) {
+            fprintf(stderr, "test_sigindex: FAIL: wrong result for \"%s\"\n", t->candidate);
+            goto out;
         }
 
+        count++;
+    }
+    fprintf(stderr, "test_sigindex (%d test cases)\n", count);
+    ret = 0;
+
+out:
+    if (patterns != NULL) {
+        for (i = 0; i < npatterns; i++) {
+            ndt_del(patterns[i]);
+        }
+    }
+    ndt_free(patterns);
+    ndt_free(ids);
+    ndt_sigindex_del(index);
+    ndt_context_del(ctx);
+    return ret;
+}
+
+static int
+test_callsite(void)
+{
+    const match_testcase_t *t;
+    ndt_context_t *ctx;
+    ndt_sigindex_t *index;
+    ndt_callsite_t *cs = NULL;
+    ndt_cache_stats_t stats;
+    const ndt_bindings_t *b;
+    ndt_t *p, *c;
+    size_t *ids = NULL;
+    size_t npatterns, i;
+    int64_t n, id, expected;
+    int ret = -1, count = 0;
+    int m, k;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "error: out of memory");
+        return -1;
+    }
+
+    for (npatterns = 0; match_tests[npatterns].pattern != NULL; npatterns++);
+
+    index = ndt_sigindex_new(ctx);
+    ids = ndt_alloc(npatterns, sizeof *ids);
+    if (index == NULL || ids == NULL) {
+        fprintf(stderr, "test_callsite: FAIL: out of memory\n");
+        goto out;
+    }
+
+    for (i = 0; i < npatterns; i++) {
+        p = ndt_from_string(match_tests[i].pattern, ctx);
+        if (p == NULL) {
+            fprintf(stderr, "test_callsite: FAIL: could not parse \"%s\"\n",
+                    match_tests[i].pattern);
+            goto out;
+        }
+        id = ndt_sigindex_add(index, p, ctx);
         ndt_del(p);
+        if (id < 0) {
+            fprintf(stderr, "test_callsite: FAIL: could not add \"%s\"\n",
+                    match_tests[i].pattern);
+            goto out;
+        }
+    }
+
+    cs = ndt_callsite_new(index, 0, ctx);
+    if (cs != NULL || ctx->err != NDT_ValueError) {
+        fprintf(stderr, "test_callsite: FAIL: expected ValueError for size 0\n");
+        goto out;
+    }
+    ndt_err_clear(ctx);
+
+    cs = ndt_callsite_new(index, 4, ctx);
+    if (cs == NULL) {
+        fprintf(stderr, "test_callsite: FAIL: could not create call site\n");
+        goto out;
+    }
+
+    for (t = match_tests; t->pattern != NULL; t++) {
+        c = ndt_from_string(t->candidate, ctx);
+        if (c == NULL) {
+            fprintf(stderr, "test_callsite: FAIL: could not parse \"%s\"\n", t->candidate);
+            goto out;
+        }
+
+        n = ndt_sigindex_find(index, c, ids, npatterns, ctx);
+        expected = n > 0 ? (int64_t)ids[0] : -1;
+
+        /* The first lookup misses.  The second one hits by identity, the
+           third one by structure. */
+        for (k = 0; k < 3; k++) {
+            if (k == 2) {
+                ndt_del(c);
+                c = ndt_from_string(t->candidate, ctx);
+                if (c == NULL) {
+                    fprintf(stderr, "test_callsite: FAIL: could not parse \"%s\"\n",
+                            t->candidate);
+                    goto out;
+                }
+            }
+
+            for (alloc_fail = 1; alloc_fail < INT_MAX; alloc_fail++) {
+                ndt_err_clear(ctx);
+
+                ndt_set_alloc_fail();
+                m = ndt_callsite_lookup(cs, c, &id, &b, ctx);
+                ndt_set_alloc();
+
+                if (ctx->err != NDT_MemoryError) {
+                    break;
+                }
+
+                if (m != -1) {
+                    ndt_del(c);
+                    fprintf(stderr, "test_callsite: FAIL: expect -1 after MemoryError\n");
+                    goto out;
+                }
+            }
+
+            if (n < 0 || m != (expected >= 0) || (m == 1 && id != expected) ||
+                (b != NULL) != (m == 1)) {
+                ndt_del(c);
+                fprintf(stderr, "test_callsite: FAIL: wrong result for \"%s\"\n",
+                        t->candidate);
+                goto out;
+            }
+        }
+
         ndt_del(c);
         count++;
     }
-    fprintf(stderr, "test_match (%d test cases)\n", count);
 
+    ndt_callsite_stats(cs, &stats);
+    /* Repeated candidates can hit on their first lookup. */
+    if (stats.hits + stats.misses != 3 * (size_t)count ||
+        stats.hits < 2 * (size_t)count ||
+        stats.evictions != stats.misses - 4) {
+        fprintf(stderr, "test_callsite: FAIL: unexpected statistics\n");
+        goto out;
+    }
+
+    /* Inner nodes of an arena are not kept alive by the cache.  After the
+       root is freed, a new arena at the same address must not hit. */
+    for (k = 0; k < 2; k++) {
+        c = ndt_from_string_arena(k == 0 ? "10 * int64" : "10 * float64", ctx);
+        if (c == NULL) {
+            fprintf(stderr, "test_callsite: FAIL: could not parse arena type\n");
+            goto out;
+        }
+
+        n = ndt_sigindex_find(index, c->Array.dtype, ids, npatterns, ctx);
+        expected = n > 0 ? (int64_t)ids[0] : -1;
+
+        for (m = 0; m < 2; m++) {
+            if (n < 0 ||
+                ndt_callsite_lookup(cs, c->Array.dtype, &id, NULL, ctx) != (expected >= 0) ||
+                (expected >= 0 && id != expected)) {
+                ndt_del(c);
+                fprintf(stderr, "test_callsite: FAIL: wrong result for arena type\n");
+                goto out;
+            }
+        }
+
+        ndt_del(c);
+    }
+
+    /* The bindings of the pattern are cached with the dispatch result. */
+    ndt_callsite_del(cs);
+    ndt_sigindex_del(index);
+    cs = NULL;
+
+    index = ndt_sigindex_new(ctx);
+    if (index == NULL) {
+        fprintf(stderr, "test_callsite: FAIL: out of memory\n");
+        goto out;
+    }
+
+    for (i = 0; i < 2; i++) {
+        p = ndt_from_string(i == 0 ? "N * int64" : "N * M * T", ctx);
+        if (p == NULL || ndt_sigindex_add(index, p, ctx) < 0) {
+            ndt_del(p);
+            fprintf(stderr, "test_callsite: FAIL: could not add pattern\n");
+            goto out;
+        }
+        ndt_del(p);
+    }
+
+    cs = ndt_callsite_new(index, 2, ctx);
+    if (cs == NULL) {
+        fprintf(stderr, "test_callsite: FAIL: could not create call site\n");
+        goto out;
+    }
+
+    for (k = 0; k < 3; k++) {
+        c = ndt_from_string("10 * 20 * float32", ctx);
+        if (c == NULL) {
+            fprintf(stderr, "test_callsite: FAIL: could not parse candidate\n");
+            goto out;
+        }
+
+        for (i = 0; i < 2; i++) {
+            m = ndt_callsite_lookup(cs, c, &id, &b, ctx);
+            if (m != 1 || id != 1 || b == NULL ||
+                ndt_bindings_shape(b, "N") != 10 ||
+                ndt_bindings_shape(b, "M") != 20 ||
+                ndt_bindings_type(b, "T") == NULL ||
+                ndt_bindings_type(b, "T")->tag != Float32) {
+                ndt_del(c);
+                fprintf(stderr, "test_callsite: FAIL: wrong bindings\n");
+                goto out;
+            }
+        }
+
+        ndt_del(c);
+    }
+
+    c = ndt_from_string("int8", ctx);
+    if (c == NULL) {
+        fprintf(stderr, "test_callsite: FAIL: could not parse candidate\n");
+        goto out;
+    }
+    m = ndt_callsite_lookup(cs, c, &id, &b, ctx);
+    ndt_del(c);
+    if (m != 0 || id != -1 || b != NULL) {
+        fprintf(stderr, "test_callsite: FAIL: expected no bindings\n");
+        goto out;
+    }
+
+    ndt_callsite_stats(cs, &stats);
+    if (stats.hits != 5 || stats.misses != 2) {
+        fprintf(stderr, "test_callsite: FAIL: unexpected statistics\n");
+        goto out;
+    }
+
+    fprintf(stderr, "test_callsite (%d test cases)\n", count);
+    ret = 0;
+
+out:
+    ndt_free(ids);
+    ndt_callsite_del(cs);
+    ndt_sigindex_del(index);
     ndt_context_del(ctx);
-    return 0;
+    return ret;
 }
 
 static int (*tests[])(void) = {
   test_parse,
   test_parse_error,
   test_parse_roundtrip,
+  test_parse_backends,
+  test_from_buffer,
+  test_from_file,
+  test_parse_long_tokens,
+  test_keywords,
+  test_parse_batch,
+  test_parse_cache,
+  test_parse_concurrent,
   test_indent,
   test_typedef,
   test_typedef_duplicates,
   test_typedef_error,
+  test_module,
   test_equal,
+  test_hash,
+  test_intern,
+  test_refcount,
+  test_arena,
+  test_from_string_arena,
+  test_serialize,
+  test_deserialize_invalid,
+  test_match,
+  test_match_compiled,
+  test_match_batch,
+  test_match_cache,
+  test_unify,
+  test_pattern_unify,
+  test_broadcast,
+  test_sigindex,
+  test_callsite,
+  NULL
+};
+
+/* Run again with the recursive descent parser */
+static int (*descent_tests[])(void) = {
+  test_parse,
+  test_parse_error,
+  test_parse_roundtrip,
+  test_from_buffer,
+  test_from_file,
+  test_from_string_arena,
+  test_parse_concurrent,
+  test_indent,
   test_match,
   NULL
 };
@@ -717,6 +3496,16 @@ main(void)
             success++;
     }
 
+    fprintf(stderr, "\nrecursive descent parser:\n");
+    ndt_set_parser(NDT_ParserDescent);
+    for (f = descent_tests; *f != NULL; f++) {
+        if ((*f)() < 0)
+            fail++;
+        else
+            success++;
+    }
+    ndt_set_parser(NDT_ParserBison);
+
     if (fail) {
         fprintf(stderr, "\nFAIL (failures=%d)\n", fail);
     }
@@ -16,6 +16,31 @@ typedef struct {
     int expected;
 } match_testcase_t;
 
+typedef struct {
+    const char *pattern;
+    const char *candidate;
+    const char *template;
+    const char *expected;   /* NULL if the candidate does not match */
+} unify_testcase_t;
+
+typedef struct {
+    const char *pattern;    /* tuple of argument patterns */
+    const char *candidate;  /* tuple of arguments */
+    int expected;
+    int ndim;
+    int64_t shape[4];
+    int64_t strides[3][4];
+    const char *template;
+    const char *result;
+} broadcast_testcase_t;
+
+typedef struct {
+    const char *module;
+    const char *name;       /* typedef declared by the module */
+    const char *expected;   /* type of 'name', NULL if loading fails */
+    enum ndt_error err;
+} module_testcase_t;
+
 extern const char *parse_tests[];
 extern const char *parse_roundtrip_tests[];
 extern const char *parse_error_tests[];
@@ -23,6 +48,9 @@ extern const indent_testcase_t indent_tests[];
 extern const char *typedef_tests[];
 extern const char *typedef_error_tests[];
 extern const match_testcase_t match_tests[];
+extern const unify_testcase_t unify_tests[];
+extern const broadcast_testcase_t broadcast_tests[];
+extern const module_testcase_t module_tests[];
 
 
 #endif /* TEST_H */
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2016, Continuum Analytics, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * Redistributions of source code must retain the above copyright notice,
+ * 
+ * this list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <stdio.h>
+#include "test.h"
+
+
+#include <stdio.h>
+#include "test.h"
+
+
+const broadcast_testcase_t broadcast_tests[] = {
+  /* symbolic dimensions */
+  { "(N * M * T, N * M * T)", "(2 * 3 * int64, 2 * 3 * int64)", 1,
+    2, {2, 3}, {{24, 8}, {24, 8}}, "N * M * T", "2 * 3 * int64" },
+  { "(N * M * T, M * T)", "(2 * 3 * int64, 3 * int64)", 1,
+    2, {2, 3}, {{24, 8}, {0, 8}}, "N * M * T", "2 * 3 * int64" },
+  { "(N * M * T, N * M * T)", "(2 * 3 * int64, 1 * 3 * int64)", 1,
+    2, {2, 3}, {{24, 8}, {0, 8}}, "N * M * T", "2 * 3 * int64" },
+  { "(N * M * T, N * M * T)", "(1 * 3 * int64, 2 * 1 * int64)", 1,
+    2, {2, 3}, {{0, 8}, {8, 0}}, "N * M * T", "2 * 3 * int64" },
+  { "(N * M * T, N * M * T)", "(2 * 3 * int64, 2 * 4 * int64)", 0,
+    0, {0}, {{0}}, NULL, NULL },
+  { "(N * M * T, M * K * T)", "(2 * 3 * float64, 3 * 4 * float64)", 1,
+    3, {2, 3, 4}, {{24, 8, 0}, {0, 32, 8}}, "N * K * T", "2 * 4 * float64" },
+  { "(N * 3 * T, N * T)", "(2 * 3 * int32, 1 * int32)", 1,
+    1, {2}, {{12}, {0}}, "N * T", "2 * int32" },
+  { "(N * 3 * T, N * T)", "(2 * 4 * int32, 2 * int32)", 0,
+    0, {0}, {{0}}, NULL, NULL },
+  { "(N * N * T,)", "(3 * 3 * float64,)", 1,
+    1, {3}, {{32}}, "N * T", "3 * float64" },
+  { "(N * N * T, N * T)", "(1 * 3 * float64, 3 * float64)", 1,
+    1, {3}, {{8}, {8}}, "N * T", "3 * float64" },
+  { "(N * M * N * T,)", "(2 * 5 * 2 * int16,)", 1,
+    2, {2, 5}, {{22, 4}}, "N * M * T", "2 * 5 * int16" },
+
+  /* ellipsis dimensions */
+  { "(... * T, ... * T)", "(4 * 1 * 3 * float32, 2 * 1 * float32)", 1,
+    3, {4, 2, 3}, {{12, 0, 4}, {0, 4, 0}}, "T", "float32" },
+  { "(... * T, ... * T)", "(4 * 3 * float32, 2 * 3 * float32)", 0,
+    0, {0}, {{0}}, NULL, NULL },
+  { "(... * N * T, ... * N * T)", "(5 * 3 * int8, 3 * int8)", 1,
+    2, {5, 3}, {{3, 1}, {0, 1}}, "N * T", "3 * int8" },
+  { "(... * N * T, N * T)", "(7 * 5 * 2 * int8, 2 * int8)", 1,
+    3, {7, 5, 2}, {{10, 2, 1}, {0, 0, 1}}, "N * T", "2 * int8" },
+
+  /* dtypes and scalars */
+  { "(N * T, N * T)", "(2 * int8, 2 * int16)", 0,
+    0, {0}, {{0}}, NULL, NULL },
+  { "(N * T, N * T)", "(2 * int8, 2 * 2 * int8)", 0,
+    0, {0}, {{0}}, NULL, NULL },
+  { "(N * T, T)", "(3 * float64, float64)", 1,
+    1, {3}, {{8}, {0}}, "N * T", "3 * float64" },
+  { "(N * {a: T, b: U}, U)", "(3 * {a: int8, b: int64}, int64)", 1,
+    1, {3}, {{16}, {0}}, "N * (T, U)", "3 * (int8, int64)" },
+
+  /* errors */
+  { "(N * T,)", "(var * int64,)", -1,
+    0, {0}, {{0}}, NULL, NULL },
+  { "(N * ... * T,)", "(2 * 3 * int64,)", -1,
+    0, {0}, {{0}}, NULL, NULL },
+
+  { NULL, NULL, 0, 0, {0}, {{0}}, NULL, NULL }
+};
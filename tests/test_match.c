@@ -3825,6 +3825,21 @@ const match_testcase_t match_tests[] = {
 
   { "N * Z * ... * 10 * N * Z * foo_t",
     "10 * 20 * var * 10 * ... * 10 * 20 * foo_t", 0 },
+  /* more bindings than fit into the inline symbol table */
+  { "A * B * C * D * E * F * G * H * I * J * K * L * M * N * O * P * Q * R * S * T * X",
+    "1 * 2 * 3 * 4 * 5 * 6 * 7 * 8 * 9 * 10 * 11 * 12 * 13 * 14 * 15 * 16 * 17 * 18 * 19 * 20 * int64", 1 },
+
+  { "A * B * C * D * E * F * G * H * I * J * K * L * M * N * O * P * Q * R * S * T * A * J * T * int64",
+    "1 * 2 * 3 * 4 * 5 * 6 * 7 * 8 * 9 * 10 * 11 * 12 * 13 * 14 * 15 * 16 * 17 * 18 * 19 * 20 * 1 * 10 * 20 * int64", 1 },
+
+  { "A * B * C * D * E * F * G * H * I * J * K * L * M * N * O * P * Q * R * S * T * A * J * T * int64",
+    "1 * 2 * 3 * 4 * 5 * 6 * 7 * 8 * 9 * 10 * 11 * 12 * 13 * 14 * 15 * 16 * 17 * 18 * 19 * 20 * 1 * 10 * 19 * int64", 0 },
+
+  { "(A, B, C, D, E, F, G, H, I, J) -> (J, I, H, G, F, E, D, C, B, A)",
+    "(int8, int16, int32, int64, uint8, uint16, uint32, uint64, float32, float64) -> (float64, float32, uint64, uint32, uint16, uint8, int64, int32, int16, int8)", 1 },
+
+  { "(A, B, C, D, E, F, G, H, I, J) -> (J, I, H, G, F, E, D, C, B, A)",
+    "(int8, int16, int32, int64, uint8, uint16, uint32, uint64, float32, float64) -> (float64, float32, uint64, uint32, uint16, uint8, int64, int32, int16, int16)", 0 },
   /* END MANUALLY GENERATED */
 
   { NULL, NULL, 0 }
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2016, Continuum Analytics, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * Redistributions of source code must retain the above copyright notice,
+ * 
+ * this list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <stdio.h>
+#include "test.h"
+
+
+/* Every module declares its own names, since typedefs cannot be removed. */
+const module_testcase_t module_tests[] = {
+  /* empty modules */
+  { "", NULL, NULL, NDT_Success },
+  { "  # only a comment\n", NULL, NULL, NDT_Success },
+
+  { "typedef m1_a = int64", "m1_a", "int64", NDT_Success },
+  { "typedef m2_a = {x: int32, y: float64}\n"
+    "typedef m2_b = 10 * m2_a\n", "m2_b", "10 * m2_a", NDT_Success },
+
+  /* forward references */
+  { "typedef m3_b = 10 * m3_a\n"
+    "typedef m3_a = {x: int32, y: float64}\n", "m3_a", "{x: int32, y: float64}", NDT_Success },
+  { "typedef m4_c = m4_b  # declared below\n"
+    "typedef m4_b = var * m4_a\n"
+    "typedef m4_a = defined_t\n", "m4_c", "m4_b", NDT_Success },
+  { "typedef m5_d = (m5_b, m5_c) typedef m5_b = ?m5_a "
+    "typedef m5_c = 2 * m5_a typedef m5_a = int16", "m5_d", "(m5_b, m5_c)", NDT_Success },
+  { "typedef m6_f = (m6_x, ...) -> m6_x\n"
+    "typedef m6_x = int8\n", "m6_f", "(m6_x, ...) -> m6_x", NDT_Success },
+
+  /* names of fields and attributes are not references */
+  { "typedef m7_a = {m7_b: int64, typedef: m7_b}\n"
+    "typedef m7_b = float32\n", "m7_a", "{m7_b: int64, typedef: m7_b}", NDT_Success },
+  { "typedef m8_a = {m8_a: bytes(align=16)}", "m8_a", "{m8_a: bytes(align=16)}", NDT_Success },
+
+  /* syntax errors */
+  { "int64", NULL, NULL, NDT_ParseError },
+  { "typedef = int64", NULL, NULL, NDT_ParseError },
+  { "typedef e1_a int64", "e1_a", NULL, NDT_ParseError },
+  { "typedef e2_a =", "e2_a", NULL, NDT_ParseError },
+  { "typedef e3_a = int64 int32", "e3_a", NULL, NDT_ParseError },
+  { "typedef e4_a = int64 typedef e4_b = $", "e4_a", NULL, NDT_ParseError },
+  { "typedef E5_a = int64", "E5_a", NULL, NDT_ParseError },
+  { "typedef e6_a = (int64 typedef e6_b = int32", "e6_a", NULL, NDT_ParseError },
+
+  /* cycles */
+  { "typedef e7_a = e7_a", "e7_a", NULL, NDT_ValueError },
+  { "typedef e8_a = e8_b typedef e8_b = {x: e8_a}", "e8_a", NULL, NDT_ValueError },
+
+  /* nothing is registered if one declaration fails */
+  { "typedef e9_a = int64 typedef e9_a = int32", "e9_a", NULL, NDT_ValueError },
+  { "typedef e10_a = int64 typedef defined_t = int32", "e10_a", NULL, NDT_ValueError },
+  { "typedef e11_a = int64 typedef e11_b = missing_t", "e11_a", NULL, NDT_ValueError },
+  { "typedef e12_a = int64 typedef e12_b = 10 * \"x\"", "e12_a", NULL, NDT_ParseError },
+
+  { NULL, NULL, NULL, NDT_Success }
+};
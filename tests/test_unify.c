@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2016, Continuum Analytics, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * Redistributions of source code must retain the above copyright notice,
+ * 
+ * this list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <stdio.h>
+#include "test.h"
+
+
+#include <stdio.h>
+#include "test.h"
+
+
+const unify_testcase_t unify_tests[] = {
+  /* dimensions */
+  { "N * M * T", "2 * 3 * int64", "M * N * T", "3 * 2 * int64" },
+  { "N * T", "10 * float32", "N * N * (T, T)", "10 * 10 * (float32, float32)" },
+  { "N * T", "M * X", "N * T", "M * X" },
+  { "N * T", "var * int8", "N * T", NULL },
+  { "N * N * T", "2 * 3 * int64", "N * T", NULL },
+  { "... * T", "2 * 3 * float32", "... * T", "... * float32" },
+  { "... * N * T", "2 * 3 * float32", "N * ?T", "3 * ?float32" },
+  { "Fixed * T", "10 * int16", "T", "int16" },
+  { "var * T", "var * int16", "var * var * T", "var * var * int16" },
+  { "N * T", "3 * float32", "2 * N * T", "2 * 3 * float32" },
+  { "N * T", "3 * float32", "2[stride=64] * N * T", "2[stride=64] * 3 * float32" },
+  { "T", "int32", "4[stride=16] * T", "4[stride=16] * int32" },
+
+  /* type variables */
+  { "T", "int64", "(T, U)", "(int64, U)" },
+  { "T", "X", "N * T", "N * X" },
+  { "T", "categorical(10 : int64, 'a' : string, 2.5 : float64)", "?T",
+    "?categorical(10 : int64, 'a' : string, 2.5 : float64)" },
+  { "T", "defined_t", "2 * T", "2 * defined_t" },
+  { "T", "Foo(int64)", "pointer(?T)", "pointer(?Foo(int64))" },
+  { "T", "(char, bytes(align=16), string, fixed_string(10, 'utf16'), fixed_bytes(size=8, align=4))",
+    "3 * T",
+    "3 * (char, bytes(align=16), string, fixed_string(10, 'utf16'), fixed_bytes(size=8, align=4))" },
+  { "T", "SignedKind", "?T", "?SignedKind" },
+  { "(T, T)", "(int8, int8)", "T", "int8" },
+  { "(T, T)", "(int8, int16)", "T", NULL },
+
+  /* records and functions */
+  { "{a: T, b: N * U}", "{a: int8, b: 5 * string}", "(U, T, N * N * T)",
+    "(string, int8, 5 * 5 * int8)" },
+  { "{a: T, b: U}", "{a: int8, b: int64}", "{x: U, y: T}", "{x: int64, y: int8}" },
+  { "(N * T, N * T, ...)", "(10 * float64, 10 * float64, ...)", "N * T", "10 * float64" },
+  { "(N * T, M * T) -> N * M * T", "(2 * int32, 3 * int32) -> 2 * 3 * int32",
+    "(N * T, M * T) -> N * M * T", "(2 * int32, 3 * int32) -> 2 * 3 * int32" },
+  { "(A, B, C, D, E, F, G, H, I, J)", "(int8, int16, int32, int64, uint8, uint16, uint32, uint64, float32, float64)",
+    "(J, I, H, G, F, E, D, C, B, A)", "(float64, float32, uint64, uint32, uint16, uint8, int64, int32, int16, int8)" },
+
+  { NULL, NULL, NULL, NULL }
+};
@@ -27,6 +27,8 @@
 
 
 #include <stdio.h>
+#include <string.h>
+#include <time.h>
 #include "ndtypes.h"
 
 
@@ -36,12 +38,24 @@ const char *s = "{battingpost: var * {yearID: ?int32, round: ?string, playerID:
 
 
 int
-main(void)
+main(int argc, char **argv)
 {
     ndt_context_t *ctx;
     ndt_t *t;
+    clock_t start;
+    double secs;
     int i;
 
+    if (argc > 2 || (argc == 2 && strcmp(argv[1], "bison") != 0 &&
+                                  strcmp(argv[1], "descent") != 0)) {
+        fprintf(stderr, "usage: ./bench [bison|descent]\n");
+        return 1;
+    }
+
+    if (argc == 2 && strcmp(argv[1], "descent") == 0) {
+        ndt_set_parser(NDT_ParserDescent);
+    }
+
     ctx = ndt_context_new();
     if (ctx == NULL) {
         fprintf(stderr, "out of memory\n");
@@ -54,6 +68,7 @@ main(void)
         return 1;
     }
 
+    start = clock();
     for (i = 0; i < 100000; i++) {
         t = ndt_from_string(s, ctx);
         if (t == NULL) {
@@ -62,6 +77,12 @@ main(void)
         }
         ndt_del(t);
     }
+    secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    if (i > 0 && secs > 0) {
+        printf("%d parses of %zu bytes: %.1f MB/s\n", i, strlen(s),
+               (double)i * strlen(s) / secs / 1e6);
+    }
 
     ndt_context_del(ctx);
     ndt_finalize();
@@ -0,0 +1,242 @@
+/*
+ * Copyright (c) 2016, Continuum Analytics, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * Redistributions of source code must retain the above copyright notice,
+ * 
+ * this list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "ndtypes.h"
+
+#ifdef _WIN32
+  #include <windows.h>
+  #include <process.h>
+  typedef HANDLE thread_t;
+  #define THREAD_FUNC unsigned __stdcall
+  #define THREAD_RETURN 0
+#else
+  #include <pthread.h>
+  typedef pthread_t thread_t;
+  #define THREAD_FUNC void *
+  #define THREAD_RETURN NULL
+#endif
+
+
+/*
+ * Memory use and lookup throughput of the typedef registry.  Reader threads
+ * resolve existing typedefs while a writer thread registers new ones.
+ */
+
+#define NTYPEDEFS 50000
+#define NLOOKUPS 2000000
+#define NWRITES 1000
+#define MAX_THREADS 16
+
+static char names[NTYPEDEFS][32];
+static size_t registry_bytes = 0;
+
+
+static void *
+counting_malloc(size_t size)
+{
+    registry_bytes += size;
+    return malloc(size);
+}
+
+
+static THREAD_FUNC
+reader(void *arg)
+{
+    ndt_context_t *ctx;
+    int *failed = arg;
+    int i;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        *failed = 1;
+        return THREAD_RETURN;
+    }
+
+    for (i = 0; i < NLOOKUPS; i++) {
+        if (ndt_typedef_find(names[i % NTYPEDEFS], ctx) == NULL) {
+            *failed = 1;
+            break;
+        }
+    }
+
+    ndt_context_del(ctx);
+    return THREAD_RETURN;
+}
+
+static THREAD_FUNC
+writer(void *arg)
+{
+    ndt_context_t *ctx;
+    char name[32];
+    ndt_t *t;
+    int *round = arg;
+    int i;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        *round = -1;
+        return THREAD_RETURN;
+    }
+
+    for (i = 0; i < NWRITES; i++) {
+        snprintf(name, sizeof name, "extra_%d_%d", *round, i);
+        t = ndt_from_string("{a: int64, b: float64}", ctx);
+        if (t == NULL || ndt_typedef(name, t, ctx) < 0) {
+            *round = -1;
+            break;
+        }
+    }
+
+    ndt_context_del(ctx);
+    return THREAD_RETURN;
+}
+
+static int
+thread_start(thread_t *tid, THREAD_FUNC (*func)(void *), void *arg)
+{
+#ifdef _WIN32
+    *tid = (HANDLE)_beginthreadex(NULL, 0, func, arg, 0, NULL);
+    return *tid == 0 ? -1 : 0;
+#else
+    return pthread_create(tid, NULL, func, arg) != 0 ? -1 : 0;
+#endif
+}
+
+static void
+thread_join(thread_t tid)
+{
+#ifdef _WIN32
+    WaitForSingleObject(tid, INFINITE);
+    CloseHandle(tid);
+#else
+    pthread_join(tid, NULL);
+#endif
+}
+
+static double
+now(void)
+{
+    struct timespec ts;
+
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+int
+main(void)
+{
+    thread_t tid[MAX_THREADS], wid;
+    int failed[MAX_THREADS];
+    int round = 0;
+    ndt_context_t *ctx;
+    ndt_t *t;
+    double start, elapsed;
+    int nthreads, i, ret;
+
+    ctx = ndt_context_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    if (ndt_init(ctx) < 0) {
+        ndt_err_fprint(stderr, ctx);
+        ndt_context_del(ctx);
+        return 1;
+    }
+
+    t = ndt_from_string("10 * {x: int32, y: ?string}", ctx);
+    if (t == NULL) {
+        ndt_err_fprint(stderr, ctx);
+        ndt_context_del(ctx);
+        ndt_finalize();
+        return 1;
+    }
+
+    /* Count the memory that is allocated by the registry itself. */
+    for (i = 0; i < NTYPEDEFS; i++) {
+        snprintf(names[i], sizeof names[i], "schema_column_%d_t", i);
+        ndt_mallocfunc = counting_malloc;
+        ret = ndt_typedef(names[i], ndt_incref(t), ctx);
+        ndt_mallocfunc = malloc;
+        if (ret < 0) {
+            ndt_err_fprint(stderr, ctx);
+            ndt_del(t);
+            ndt_context_del(ctx);
+            ndt_finalize();
+            return 1;
+        }
+    }
+    ndt_del(t);
+
+    printf("%d typedefs: %zu bytes allocated by the registry\n\n",
+           NTYPEDEFS, registry_bytes);
+
+    printf("threads  lookups/s (total)  lookups/s (per thread)\n");
+
+    for (nthreads = 1; nthreads <= MAX_THREADS; nthreads *= 2) {
+        round++;
+        if (thread_start(&wid, writer, &round) < 0) {
+            fprintf(stderr, "could not start thread\n");
+            break;
+        }
+
+        start = now();
+        for (i = 0; i < nthreads; i++) {
+            failed[i] = 0;
+            if (thread_start(&tid[i], reader, &failed[i]) < 0) {
+                fprintf(stderr, "could not start thread\n");
+                return 1;
+            }
+        }
+        for (i = 0; i < nthreads; i++) {
+            thread_join(tid[i]);
+            if (failed[i]) {
+                fprintf(stderr, "lookup failed\n");
+                return 1;
+            }
+        }
+        elapsed = now() - start;
+        thread_join(wid);
+        if (round < 0) {
+            fprintf(stderr, "typedef failed\n");
+            return 1;
+        }
+
+        printf("%7d  %17.0f  %22.0f\n", nthreads,
+               (double)nthreads * NLOOKUPS / elapsed, NLOOKUPS / elapsed);
+    }
+
+    ndt_context_del(ctx);
+    ndt_finalize();
+
+    return 0;
+}
@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2016, Continuum Analytics, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * Redistributions of source code must retain the above copyright notice,
+ * 
+ * this list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * Generate the perfect hash for the keywords of the recursive descent lexer
+ * from the keyword rules of lexer.l:
+ *
+ *   make kwhash && ./kwhash lexer.l
+ *
+ * The output replaces the KW_* definitions and the keywords[] table in
+ * rdlexer.c.  The hash function must be the same as keyword_hash() there.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+
+#define KW_HASHBITS 7
+#define MAX_KEYWORDS 128
+#define MAX_TRIES 100000000
+
+typedef struct {
+    char name[64];
+    char token[64];
+} keyword_t;
+
+static keyword_t keywords[MAX_KEYWORDS];
+static size_t nkeywords = 0;
+
+
+static uint32_t
+keyword_hash(const unsigned char *s, size_t len, uint32_t mult)
+{
+    uint32_t k = (uint32_t)s[0] | (uint32_t)s[1] << 8 |
+                 (uint32_t)s[len-2] << 16 | (uint32_t)s[len-1] << 24;
+
+    k ^= (uint32_t)len;
+
+    return (uint32_t)(k * mult) >> (32-KW_HASHBITS);
+}
+
+/* Return 1 if no two keywords share a slot. */
+static int
+is_perfect(uint32_t mult)
+{
+    unsigned char used[1<<KW_HASHBITS] = {0};
+    uint32_t h;
+    size_t i;
+
+    for (i = 0; i < nkeywords; i++) {
+        h = keyword_hash((const unsigned char *)keywords[i].name,
+                         strlen(keywords[i].name), mult);
+        if (used[h]) {
+            return 0;
+        }
+        used[h] = 1;
+    }
+
+    return 1;
+}
+
+/* Keyword rules have the form:  "name"   { return TOKEN; } */
+static int
+read_keywords(const char *path)
+{
+    char line[1024];
+    keyword_t kw;
+    FILE *fp;
+
+    fp = fopen(path, "r");
+    if (fp == NULL) {
+        fprintf(stderr, "kwhash: could not open %s\n", path);
+        return -1;
+    }
+
+    while (fgets(line, sizeof line, fp) != NULL) {
+        if (sscanf(line, "\"%63[A-Za-z0-9_]\" { return %63[A-Z0-9_];",
+                   kw.name, kw.token) != 2) {
+            continue;
+        }
+        if (strlen(kw.name) < 2 || nkeywords == MAX_KEYWORDS) {
+            fprintf(stderr, "kwhash: unsupported keyword: %s\n", kw.name);
+            fclose(fp);
+            return -1;
+        }
+        keywords[nkeywords++] = kw;
+    }
+
+    fclose(fp);
+    return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+    const keyword_t *slots[1<<KW_HASHBITS] = {NULL};
+    size_t minlen = SIZE_MAX, maxlen = 0, len, i;
+    uint32_t mult = 2463534242U; /* xorshift32 state */
+    long tries;
+
+    if (argc != 2) {
+        fprintf(stderr, "usage: ./kwhash lexer.l\n");
+        return 1;
+    }
+
+    if (read_keywords(argv[1]) < 0) {
+        return 1;
+    }
+
+    for (tries = 0; tries < MAX_TRIES; tries++) {
+        mult ^= mult << 13;
+        mult ^= mult >> 17;
+        mult ^= mult << 5;
+        if ((mult & 1) && is_perfect(mult)) {
+            break;
+        }
+    }
+    if (tries == MAX_TRIES) {
+        fprintf(stderr, "kwhash: no multiplier found, increase KW_HASHBITS\n");
+        return 1;
+    }
+
+    for (i = 0; i < nkeywords; i++) {
+        len = strlen(keywords[i].name);
+        if (len < minlen) minlen = len;
+        if (len > maxlen) maxlen = len;
+        slots[keyword_hash((const unsigned char *)keywords[i].name, len, mult)] =
+            &keywords[i];
+    }
+
+    printf("#define KW_MINLEN %zu\n", minlen);
+    printf("#define KW_MAXLEN %zu\n", maxlen);
+    printf("#define KW_HASHBITS %d\n", KW_HASHBITS);
+    printf("#define KW_MULT 0x%08xU\n\n", (unsigned)mult);
+
+    printf("static const keyword_t keywords[1<<KW_HASHBITS] = {\n");
+    for (i = 0; i < 1<<KW_HASHBITS; i++) {
+        if (slots[i] != NULL) {
+            printf("  [%zu] = KW(\"%s\", TOK_%s),\n", i, slots[i]->name,
+                   slots[i]->token);
+        }
+    }
+    printf("};\n");
+
+    return 0;
+}